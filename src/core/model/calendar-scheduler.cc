@@ -225,6 +225,7 @@ CalendarScheduler::RemoveNext (void)
                 ", from bucket=" << m_lastBucket);
   m_qSize--;
   ResizeDown ();
+  NotifyRemoved (ev);
   return ev;
 }
 
@@ -382,4 +383,37 @@ CalendarScheduler::Resize (uint32_t newSize)
   DoResize (newSize, newWidth);
 }
 
+uint32_t
+CalendarScheduler::GetSize (void) const
+{
+  return m_qSize;
+}
+
+uint32_t
+CalendarScheduler::DoCompact (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t removed = 0;
+  for (uint32_t i = 0; i < m_nBuckets; i++)
+    {
+      Bucket::iterator j = m_buckets[i].begin ();
+      while (j != m_buckets[i].end ())
+        {
+          if (j->impl->IsCancelled ())
+            {
+              j->impl->Unref ();
+              j = m_buckets[i].erase (j);
+              removed++;
+            }
+          else
+            {
+              j++;
+            }
+        }
+    }
+  m_qSize -= removed;
+  ResizeDown ();
+  return removed;
+}
+
 } // namespace ns3
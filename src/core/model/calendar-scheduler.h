@@ -73,8 +73,12 @@ public:
   virtual Scheduler::Event PeekNext (void) const;
   virtual Scheduler::Event RemoveNext (void);
   virtual void Remove (const Scheduler::Event &ev);
+  virtual uint32_t GetSize (void) const;
 
 private:
+  // Inherited
+  virtual uint32_t DoCompact (void);
+
   /** Double the number of buckets if necessary. */
   void ResizeUp (void);
   /** Halve the number of buckets if necessary. */
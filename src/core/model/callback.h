@@ -23,12 +23,16 @@
 
 #include "ptr.h"
 #include "fatal-error.h"
+#include "assert.h"
 #include "empty.h"
 #include "type-traits.h"
 #include "attribute.h"
 #include "attribute-helper.h"
 #include "simple-ref-count.h"
 #include <typeinfo>
+#include <new>
+#include <type_traits>
+#include <stdint.h>
 
 /**
  * \file
@@ -153,8 +157,39 @@ public:
    * \return The object type as a string.
    */
   virtual std::string GetTypeid (void) const = 0;
+  /**
+   * Copy this implementation, for the Callbacks which hold it inline.
+   *
+   * Only the implementations which declare this method themselves
+   * are held inline: the others are shared by reference counting.
+   *
+   * \param [in] storage Where to construct the copy, or null to
+   *             allocate it on the heap.
+   * \return The copy, or 0 if this implementation cannot be copied.
+   */
+  virtual CallbackImplBase * Copy (void *storage) const
+  {
+    return 0;
+  }
 
 protected:
+  /**
+   * Helper to implement Copy().
+   *
+   * \tparam IMPL \deduced The type of the implementation.
+   * \param [in] impl The implementation to copy.
+   * \param [in] storage Where to construct the copy, or null.
+   * \return The copy.
+   */
+  template <typename IMPL>
+  static CallbackImplBase * CopyImpl (const IMPL *impl, void *storage)
+  {
+    if (storage == 0)
+      {
+        return new IMPL (*impl);
+      }
+    return new (storage) IMPL (*impl);
+  }
   /**
    * \param [in] mangled The mangled string
    * \return The demangled form of mangled
@@ -557,6 +592,12 @@ public:
     return m_functor (a1,a2,a3,a4,a5,a6,a7,a8,a9);
   }
   /**@}*/
+  /**
+   * \copydoc CallbackImplBase::Copy
+   */
+  virtual CallbackImplBase * Copy (void *storage) const {
+    return CallbackImplBase::CopyImpl (this, storage);
+  }
   /**
    * Equality test.
    *
@@ -704,6 +745,12 @@ public:
     return ((CallbackTraits<OBJ_PTR>::GetReference (m_objPtr)).*m_memPtr)(a1, a2, a3, a4, a5, a6, a7, a8, a9);
   }
   /**@}*/
+  /**
+   * \copydoc CallbackImplBase::Copy
+   */
+  virtual CallbackImplBase * Copy (void *storage) const {
+    return CallbackImplBase::CopyImpl (this, storage);
+  }
   /**
    * Equality test.
    *
@@ -838,6 +885,12 @@ public:
     return m_functor (m_a,a1,a2,a3,a4,a5,a6,a7,a8);
   }
   /**@}*/
+  /**
+   * \copydoc CallbackImplBase::Copy
+   */
+  virtual CallbackImplBase * Copy (void *storage) const {
+    return CallbackImplBase::CopyImpl (this, storage);
+  }
   /**
    * Equality test.
    *
@@ -959,6 +1012,12 @@ public:
     return m_functor (m_a1,m_a2,a1,a2,a3,a4,a5,a6,a7);
   }
   /**@}*/
+  /**
+   * \copydoc CallbackImplBase::Copy
+   */
+  virtual CallbackImplBase * Copy (void *storage) const {
+    return CallbackImplBase::CopyImpl (this, storage);
+  }
   /**
    * Equality test.
    *
@@ -1069,6 +1128,12 @@ public:
     return m_functor (m_a1,m_a2,m_a3,a1,a2,a3,a4,a5,a6);
   }
   /**@}*/
+  /**
+   * \copydoc CallbackImplBase::Copy
+   */
+  virtual CallbackImplBase * Copy (void *storage) const {
+    return CallbackImplBase::CopyImpl (this, storage);
+  }
   /**
    * Equality test.
    *
@@ -1100,19 +1165,190 @@ private:
  * \ingroup callbackimpl
  * Base class for Callback class.
  * Provides pimpl abstraction.
+ *
+ * Small implementations, such as a bound member function or a function
+ * with a few bound arguments, are stored inline in the Callback, which
+ * saves a heap allocation per Callback; copying such a Callback copies
+ * the implementation.  Larger ones are allocated on the heap, and shared
+ * by reference counting between the copies of the Callback.
  */
 class CallbackBase {
 public:
-  CallbackBase () : m_impl () {}
-  /** \return The impl pointer */
-  Ptr<CallbackImplBase> GetImpl (void) const { return m_impl; }
+  /** Tag to construct a Callback from a CallbackImpl object. */
+  struct ImplTag {};
+
+  CallbackBase () : m_impl (0) {}
+  /**
+   * Copy constructor
+   * \param [in] other The CallbackBase to copy
+   */
+  CallbackBase (const CallbackBase &other) : m_impl (0)
+  {
+    CopyFrom (other);
+  }
+  /**
+   * Assignment operator
+   * \param [in] other The CallbackBase to copy
+   * \return This CallbackBase
+   */
+  CallbackBase & operator = (const CallbackBase &other)
+  {
+    if (other.IsInline ())
+      {
+        // other may be held by our own implementation: copy it first
+        CallbackBase copy (other);
+        Release ();
+        CopyFrom (copy);
+      }
+    else
+      {
+        if (other.m_impl != 0)
+          {
+            other.m_impl->Ref ();
+          }
+        Release ();
+        m_impl = other.m_impl;
+      }
+    return *this;
+  }
+  ~CallbackBase ()
+  {
+    Release ();
+  }
+  /**
+   * \return The impl pointer; an implementation stored inline is
+   * copied on the heap, to outlive this Callback.
+   */
+  Ptr<CallbackImplBase> GetImpl (void) const
+  {
+    if (IsInline ())
+      {
+        CallbackImplBase *copy = m_impl->Copy (0);
+        NS_ASSERT_MSG (copy != 0, "Inline Callback implementation cannot be copied");
+        return Ptr<CallbackImplBase> (copy, false);
+      }
+    return Ptr<CallbackImplBase> (m_impl);
+  }
+  /**
+   * \return The impl pointer, valid as long as this Callback is
+   * not modified or destroyed.
+   */
+  CallbackImplBase * PeekImpl (void) const
+  {
+    return m_impl;
+  }
 protected:
   /**
    * Construct from a pimpl
    * \param [in] impl The CallbackImplBase Ptr
    */
-  CallbackBase (Ptr<CallbackImplBase> impl) : m_impl (impl) {}
-  Ptr<CallbackImplBase> m_impl;         //!< the pimpl
+  CallbackBase (Ptr<CallbackImplBase> impl) : m_impl (PeekPointer (impl))
+  {
+    if (m_impl != 0)
+      {
+        m_impl->Ref ();
+      }
+  }
+  /**
+   * Copy an implementation, inline if it fits and can copy itself,
+   * on the heap otherwise.
+   *
+   * \tparam IMPL \deduced The type of the implementation.
+   * \param [in] impl The implementation.
+   */
+  template <typename IMPL>
+  void Construct (const IMPL &impl)
+  {
+    Release ();
+    // Dispatch at compile time, so that no placement new is
+    // instantiated for implementations which do not fit.  An
+    // implementation which inherits Copy() would not copy itself
+    // whole, so it is not held inline.
+    m_impl = DoConstruct (impl, std::integral_constant<bool,
+                                  sizeof (IMPL) <= sizeof (Storage)
+                                  && std::alignment_of<IMPL>::value <= std::alignment_of<Storage>::value
+                                  && std::is_same<decltype (&IMPL::Copy),
+                                                  CallbackImplBase * (IMPL::*)(void *) const>::value> ());
+  }
+  /**
+   * Copy an implementation inline.
+   *
+   * \tparam IMPL \deduced The type of the implementation.
+   * \param [in] impl The implementation.
+   * \returns The copy.
+   */
+  template <typename IMPL>
+  CallbackImplBase * DoConstruct (const IMPL &impl, std::true_type)
+  {
+    return new (&m_storage) IMPL (impl);
+  }
+  /**
+   * Copy an implementation on the heap.
+   *
+   * \tparam IMPL \deduced The type of the implementation.
+   * \param [in] impl The implementation.
+   * \returns The copy.
+   */
+  template <typename IMPL>
+  CallbackImplBase * DoConstruct (const IMPL &impl, std::false_type)
+  {
+    return new IMPL (impl);
+  }
+  /** Drop the implementation. */
+  void Release (void)
+  {
+    if (m_impl == 0)
+      {
+        return;
+      }
+    if (IsInline ())
+      {
+        m_impl->~CallbackImplBase ();
+      }
+    else
+      {
+        m_impl->Unref ();
+      }
+    m_impl = 0;
+  }
+
+  CallbackImplBase *m_impl;             //!< the pimpl
+private:
+  /**
+   * Share or copy the implementation of another CallbackBase,
+   * this one being empty.
+   * \param [in] other The CallbackBase to copy
+   */
+  void CopyFrom (const CallbackBase &other)
+  {
+    if (other.IsInline ())
+      {
+        m_impl = other.m_impl->Copy (&m_storage);
+        NS_ASSERT_MSG (m_impl != 0, "Inline Callback implementation cannot be copied");
+      }
+    else
+      {
+        m_impl = other.m_impl;
+        if (m_impl != 0)
+          {
+            m_impl->Ref ();
+          }
+      }
+  }
+  /** \return \c true if the implementation is stored inline. */
+  bool IsInline (void) const
+  {
+    uintptr_t impl = reinterpret_cast<uintptr_t> (m_impl);
+    uintptr_t storage = reinterpret_cast<uintptr_t> (&m_storage);
+    return impl >= storage && impl < storage + sizeof (m_storage);
+  }
+
+  /**
+   * The inline storage: large enough for a bound member function,
+   * or for a function with three bound pointer arguments.
+   */
+  typedef std::aligned_storage<6 * sizeof (void *), sizeof (void *)>::type Storage;
+  Storage m_storage;                    //!< the inline implementation
 };
 
 /**
@@ -1188,8 +1424,9 @@ public:
    */
   template <typename FUNCTOR>
   Callback (FUNCTOR const &functor, bool, bool) 
-    : CallbackBase (Create<FunctorCallbackImpl<FUNCTOR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > (functor))
-  {}
+  {
+    Construct (FunctorCallbackImpl<FUNCTOR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> (functor));
+  }
 
   /**
    * Construct a member function pointer call back.
@@ -1199,8 +1436,9 @@ public:
    */
   template <typename OBJ_PTR, typename MEM_PTR>
   Callback (OBJ_PTR const &objPtr, MEM_PTR memPtr)
-    : CallbackBase (Create<MemPtrCallbackImpl<OBJ_PTR,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > (objPtr, memPtr))
-  {}
+  {
+    Construct (MemPtrCallbackImpl<OBJ_PTR,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> (objPtr, memPtr));
+  }
 
   /**
    * Construct from a CallbackImpl pointer
@@ -1211,6 +1449,19 @@ public:
     : CallbackBase (impl)
   {}
 
+  /**
+   * Construct from a CallbackImpl object, stored inline if it is
+   * small enough.
+   *
+   * \tparam IMPL \deduced The CallbackImpl type
+   * \param [in] impl The CallbackImpl
+   */
+  template <typename IMPL>
+  Callback (IMPL const &impl, CallbackBase::ImplTag)
+  {
+    Construct (impl);
+  }
+
   /**
    * Bind the first arguments
    *
@@ -1272,7 +1523,7 @@ public:
   }
   /** Discard the implementation, set it to null */
   void Nullify (void) {
-    m_impl = 0;
+    Release ();
   }
 
   /**
@@ -1391,7 +1642,7 @@ public:
    * \return \c true if we are equal
    */
   bool IsEqual (const CallbackBase &other) const {
-    return m_impl->IsEqual (other.GetImpl ());
+    return m_impl->IsEqual (other.PeekImpl ());
   }
 
   /**
@@ -1401,7 +1652,7 @@ public:
    * \return \c true if other can be dynamic_cast to my type
    */
   bool CheckType (const CallbackBase & other) const {
-    return DoCheckType (other.GetImpl ());
+    return DoCheckType (other.PeekImpl ());
   }
   /**
    * Adopt the other's implementation, if type compatible
@@ -1410,12 +1661,12 @@ public:
    * \returns \c true if \p other was type-compatible and could be adopted.
    */
   bool Assign (const CallbackBase &other) {
-    return DoAssign (other.GetImpl ());
+    return DoAssign (other);
   }
 private:
   /** \return The pimpl pointer */
   CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *DoPeekImpl (void) const {
-    return static_cast<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *> (PeekPointer (m_impl));
+    return static_cast<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *> (m_impl);
   }
   /**
    * Check for compatible types
@@ -1423,9 +1674,9 @@ private:
    * \param [in] other Callback Ptr
    * \return \c true if other can be dynamic_cast to my type
    */
-  bool DoCheckType (Ptr<const CallbackImplBase> other) const {
+  bool DoCheckType (const CallbackImplBase *other) const {
     if (other != 0 &&
-        dynamic_cast<const CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *> (PeekPointer (other)) != 0)
+        dynamic_cast<const CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *> (other) != 0)
       {
         return true;
       }
@@ -1439,17 +1690,17 @@ private:
       }
   }
   /** \copydoc Assign */
-  bool DoAssign (Ptr<const CallbackImplBase> other) {
-    if (!DoCheckType (other))
+  bool DoAssign (const CallbackBase &other) {
+    if (!DoCheckType (other.PeekImpl ()))
       {
-        std::string othTid = other->GetTypeid ();
+        std::string othTid = other.PeekImpl ()->GetTypeid ();
         std::string myTid = CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9>::DoGetTypeid ();
         NS_FATAL_ERROR_CONT ("Incompatible types. (feed to \"c++filt -t\" if needed)" << std::endl <<
                         "got=" << othTid << std::endl <<
                         "expected=" << myTid);
         return false;
       }
-    m_impl = const_cast<CallbackImplBase *> (PeekPointer (other));
+    CallbackBase::operator = (other);
     return true;
   }
 };
@@ -1684,65 +1935,47 @@ Callback<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> MakeNullCallback (void) {
  */   
 template <typename R, typename TX, typename ARG>
 Callback<R> MakeBoundCallback (R (*fnPtr)(TX), ARG a1) {
-  Ptr<CallbackImpl<R,empty,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX),R,TX,empty,empty,empty,empty,empty,empty,empty,empty> >(fnPtr, a1);
-  return Callback<R> (impl);
+  return Callback<R> (BoundFunctorCallbackImpl<R (*)(TX),R,TX,empty,empty,empty,empty,empty,empty,empty,empty> (fnPtr, a1), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX, typename ARG, 
           typename T1>
 Callback<R,T1> MakeBoundCallback (R (*fnPtr)(TX,T1), ARG a1) {
-  Ptr<CallbackImpl<R,T1,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1),R,TX,T1,empty,empty,empty,empty,empty,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1> (impl);
+  return Callback<R,T1> (BoundFunctorCallbackImpl<R (*)(TX,T1),R,TX,T1,empty,empty,empty,empty,empty,empty,empty> (fnPtr, a1), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX, typename ARG, 
           typename T1, typename T2>
 Callback<R,T1,T2> MakeBoundCallback (R (*fnPtr)(TX,T1,T2), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2),R,TX,T1,T2,empty,empty,empty,empty,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2> (impl);
+  return Callback<R,T1,T2> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2),R,TX,T1,T2,empty,empty,empty,empty,empty,empty> (fnPtr, a1), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3>
 Callback<R,T1,T2,T3> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,empty,empty,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3),R,TX,T1,T2,T3,empty,empty,empty,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3> (impl);
+  return Callback<R,T1,T2,T3> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3),R,TX,T1,T2,T3,empty,empty,empty,empty,empty> (fnPtr, a1), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3,typename T4>
 Callback<R,T1,T2,T3,T4> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,empty,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4),R,TX,T1,T2,T3,T4,empty,empty,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3,T4> (impl);
+  return Callback<R,T1,T2,T3,T4> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4),R,TX,T1,T2,T3,T4,empty,empty,empty,empty> (fnPtr, a1), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3,typename T4,typename T5>
 Callback<R,T1,T2,T3,T4,T5> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4,T5), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5),R,TX,T1,T2,T3,T4,T5,empty,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3,T4,T5> (impl);
+  return Callback<R,T1,T2,T3,T4,T5> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5),R,TX,T1,T2,T3,T4,T5,empty,empty,empty> (fnPtr, a1), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6>
 Callback<R,T1,T2,T3,T4,T5,T6> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4,T5,T6), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6),R,TX,T1,T2,T3,T4,T5,T6,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3,T4,T5,T6> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6),R,TX,T1,T2,T3,T4,T5,T6,empty,empty> (fnPtr, a1), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6, typename T7>
 Callback<R,T1,T2,T3,T4,T5,T6,T7> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4,T5,T6,T7), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6,T7),R,TX,T1,T2,T3,T4,T5,T6,T7,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3,T4,T5,T6,T7> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6,T7> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6,T7),R,TX,T1,T2,T3,T4,T5,T6,T7,empty> (fnPtr, a1), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6, typename T7, typename T8>
 Callback<R,T1,T2,T3,T4,T5,T6,T7,T8> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4,T5,T6,T7,T8), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6,T7,T8),R,TX,T1,T2,T3,T4,T5,T6,T7,T8> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3,T4,T5,T6,T7,T8> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6,T7,T8> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6,T7,T8),R,TX,T1,T2,T3,T4,T5,T6,T7,T8> (fnPtr, a1), CallbackBase::ImplTag ());
 }
 /**@}*/
 
@@ -1757,58 +1990,42 @@ Callback<R,T1,T2,T3,T4,T5,T6,T7,T8> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4
  */
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2>
 Callback<R> MakeBoundCallback (R (*fnPtr)(TX1,TX2), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,empty,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2),R,TX1,TX2,empty,empty,empty,empty,empty,empty,empty> >(fnPtr, a1, a2);
-  return Callback<R> (impl);
+  return Callback<R> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2),R,TX1,TX2,empty,empty,empty,empty,empty,empty,empty> (fnPtr, a1, a2), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1>
 Callback<R,T1> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1),R,TX1,TX2,T1,empty,empty,empty,empty,empty,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1> (impl);
+  return Callback<R,T1> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1),R,TX1,TX2,T1,empty,empty,empty,empty,empty,empty> (fnPtr, a1, a2), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2>
 Callback<R,T1,T2> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2),R,TX1,TX2,T1,T2,empty,empty,empty,empty,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2> (impl);
+  return Callback<R,T1,T2> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2),R,TX1,TX2,T1,T2,empty,empty,empty,empty,empty> (fnPtr, a1, a2), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2,typename T3>
 Callback<R,T1,T2,T3> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,T3,empty,empty,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3),R,TX1,TX2,T1,T2,T3,empty,empty,empty,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2,T3> (impl);
+  return Callback<R,T1,T2,T3> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3),R,TX1,TX2,T1,T2,T3,empty,empty,empty,empty> (fnPtr, a1, a2), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2,typename T3,typename T4>
 Callback<R,T1,T2,T3,T4> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3,T4), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,empty,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4),R,TX1,TX2,T1,T2,T3,T4,empty,empty,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2,T3,T4> (impl);
+  return Callback<R,T1,T2,T3,T4> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4),R,TX1,TX2,T1,T2,T3,T4,empty,empty,empty> (fnPtr, a1, a2), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2,typename T3,typename T4,typename T5>
 Callback<R,T1,T2,T3,T4,T5> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3,T4,T5), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5),R,TX1,TX2,T1,T2,T3,T4,T5,empty,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2,T3,T4,T5> (impl);
+  return Callback<R,T1,T2,T3,T4,T5> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5),R,TX1,TX2,T1,T2,T3,T4,T5,empty,empty> (fnPtr, a1, a2), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6>
 Callback<R,T1,T2,T3,T4,T5,T6> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3,T4,T5,T6), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5,T6),R,TX1,TX2,T1,T2,T3,T4,T5,T6,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2,T3,T4,T5,T6> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5,T6),R,TX1,TX2,T1,T2,T3,T4,T5,T6,empty> (fnPtr, a1, a2), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6, typename T7>
 Callback<R,T1,T2,T3,T4,T5,T6,T7> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3,T4,T5,T6,T7), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5,T6,T7),R,TX1,TX2,T1,T2,T3,T4,T5,T6,T7> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2,T3,T4,T5,T6,T7> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6,T7> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5,T6,T7),R,TX1,TX2,T1,T2,T3,T4,T5,T6,T7> (fnPtr, a1, a2), CallbackBase::ImplTag ());
 }
 /**@}*/
 
@@ -1824,51 +2041,37 @@ Callback<R,T1,T2,T3,T4,T5,T6,T7> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3,
  */
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3>
 Callback<R> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,empty,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3),R,TX1,TX2,TX3,empty,empty,empty,empty,empty,empty> >(fnPtr, a1, a2, a3);
-  return Callback<R> (impl);
+  return Callback<R> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3),R,TX1,TX2,TX3,empty,empty,empty,empty,empty,empty> (fnPtr, a1, a2, a3), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1>
 Callback<R,T1> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1),R,TX1,TX2,TX3,T1,empty,empty,empty,empty,empty> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1> (impl);
+  return Callback<R,T1> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1),R,TX1,TX2,TX3,T1,empty,empty,empty,empty,empty> (fnPtr, a1, a2, a3), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1, typename T2>
 Callback<R,T1,T2> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1,T2), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,T2,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2),R,TX1,TX2,TX3,T1,T2,empty,empty,empty,empty> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1,T2> (impl);
+  return Callback<R,T1,T2> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2),R,TX1,TX2,TX3,T1,T2,empty,empty,empty,empty> (fnPtr, a1, a2, a3), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1, typename T2,typename T3>
 Callback<R,T1,T2,T3> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1,T2,T3), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,T2,T3,empty,empty,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3),R,TX1,TX2,TX3,T1,T2,T3,empty,empty,empty> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1,T2,T3> (impl);
+  return Callback<R,T1,T2,T3> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3),R,TX1,TX2,TX3,T1,T2,T3,empty,empty,empty> (fnPtr, a1, a2, a3), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1, typename T2,typename T3,typename T4>
 Callback<R,T1,T2,T3,T4> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1,T2,T3,T4), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,empty,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4),R,TX1,TX2,TX3,T1,T2,T3,T4,empty,empty> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1,T2,T3,T4> (impl);
+  return Callback<R,T1,T2,T3,T4> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4),R,TX1,TX2,TX3,T1,T2,T3,T4,empty,empty> (fnPtr, a1, a2, a3), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1, typename T2,typename T3,typename T4,typename T5>
 Callback<R,T1,T2,T3,T4,T5> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1,T2,T3,T4,T5), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4,T5),R,TX1,TX2,TX3,T1,T2,T3,T4,T5,empty> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1,T2,T3,T4,T5> (impl);
+  return Callback<R,T1,T2,T3,T4,T5> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4,T5),R,TX1,TX2,TX3,T1,T2,T3,T4,T5,empty> (fnPtr, a1, a2, a3), CallbackBase::ImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6>
 Callback<R,T1,T2,T3,T4,T5,T6> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1,T2,T3,T4,T5,T6), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4,T5,T6),R,TX1,TX2,TX3,T1,T2,T3,T4,T5,T6> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1,T2,T3,T4,T5,T6> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4,T5,T6),R,TX1,TX2,TX3,T1,T2,T3,T4,T5,T6> (fnPtr, a1, a2, a3), CallbackBase::ImplTag ());
 }
 /**@}*/
 
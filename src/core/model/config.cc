@@ -18,7 +18,8 @@
  * Authors: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "config.h"
-#include "singleton.h"
+#include "simulation-local.h"
+#include "non-copyable.h"
 #include "object.h"
 #include "global-value.h"
 #include "object-ptr-container.h"
@@ -149,116 +150,94 @@ MatchContainer::DisconnectWithoutContext (std::string name, const CallbackBase &
 
 /**
  * \ingroup config-impl
- * Helper to test if an array entry matches a config path specification.
+ * Convert a string to an \c uint32_t.
+ *
+ * \param [in] str The string.
+ * \param [in] value The location to store the \c uint32_t.
+ * \returns \c true if the string could be converted.
  */
-class ArrayMatcher
+static bool
+StringToUint32 (std::string str, uint32_t *value)
 {
-public:
-  /**
-   * Construct from a Config path specification.
-   *
-   * \param [in] element The Config path specification.
-   */
-  ArrayMatcher (std::string element);
-  /**
-   * Test if a specific index matches the Config Path.
-   *
-   * \param [in] i The index.
-   * \returns \c true if the index matches the Config Path.
-   */
-  bool Matches (uint32_t i) const;
-private:
-  /**
-   * Convert a string to an \c uint32_t.
-   *
-   * \param [in] str The string.
-   * \param [in] value The location to store the \c uint32_t.
-   * \returns \c true if the string could be converted.
-   */
-  bool StringToUint32 (std::string str, uint32_t *value) const;
-  /** The Config path element. */
-  std::string m_element;
+  std::istringstream iss;
+  iss.str (str);
+  iss >> (*value);
+  return !iss.bad () && !iss.fail ();
+}
 
-};  // class ArrayMatcher
+CompiledPath::CompiledPath (std::string path)
+  : m_path (path)
+{
+  NS_LOG_FUNCTION (this << path);
 
+  // ensure that we start and end with a '/'
+  std::string canonical = path;
+  if (canonical.find ("/") != 0)
+    {
+      canonical = "/" + canonical;
+    }
+  if (canonical.find_last_of ("/") != canonical.size () - 1)
+    {
+      canonical = canonical + "/";
+    }
 
-ArrayMatcher::ArrayMatcher (std::string element)
-  : m_element (element)
-{
-  NS_LOG_FUNCTION (this << element);
+  std::string::size_type cur = 0;
+  std::string::size_type next;
+  while ((next = canonical.find ("/", cur + 1)) != std::string::npos)
+    {
+      Segment segment;
+      segment.name = canonical.substr (cur + 1, next - (cur + 1));
+      segment.wildcard = segment.name == "*";
+      segment.getObject = segment.name.find ("$") == 0;
+      segment.tidFound = segment.getObject
+        && TypeId::LookupByNameFailSafe (segment.name.substr (1), &segment.tid);
+      ParseRanges (segment.name, segment.ranges);
+      m_segments.push_back (segment);
+      cur = next;
+    }
 }
-bool
-ArrayMatcher::Matches (uint32_t i) const
+
+void
+CompiledPath::ParseRanges (std::string element, std::vector<std::pair<uint32_t, uint32_t> > &ranges)
 {
-  NS_LOG_FUNCTION (this << i);
-  if (m_element == "*")
+  if (element == "*")
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches *");
-      return true;
+      ranges.push_back (std::make_pair (0U, ~0U));
+      return;
     }
-  std::string::size_type tmp;
-  tmp = m_element.find ("|");
+  std::string::size_type tmp = element.find ("|");
   if (tmp != std::string::npos)
     {
-      std::string left = m_element.substr (0, tmp-0);
-      std::string right = m_element.substr (tmp+1, m_element.size () - (tmp + 1));
-      ArrayMatcher matcher = ArrayMatcher (left);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<left);
-          return true;
-        }
-      matcher = ArrayMatcher (right);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<right);
-          return true;
-        }
-      NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
-      return false;
+      ParseRanges (element.substr (0, tmp), ranges);
+      ParseRanges (element.substr (tmp + 1), ranges);
+      return;
     }
-  std::string::size_type leftBracket = m_element.find ("[");
-  std::string::size_type rightBracket = m_element.find ("]");
-  std::string::size_type dash = m_element.find ("-");
-  if (leftBracket == 0 && rightBracket == m_element.size () - 1 &&
+  std::string::size_type leftBracket = element.find ("[");
+  std::string::size_type rightBracket = element.find ("]");
+  std::string::size_type dash = element.find ("-");
+  if (leftBracket == 0 && rightBracket == element.size () - 1 &&
       dash > leftBracket && dash < rightBracket)
     {
-      std::string lowerBound = m_element.substr (leftBracket + 1, dash - (leftBracket + 1));
-      std::string upperBound = m_element.substr (dash + 1, rightBracket - (dash + 1));
       uint32_t min;
       uint32_t max;
-      if (StringToUint32 (lowerBound, &min) && 
-          StringToUint32 (upperBound, &max) &&
-          i >= min && i <= max)
+      if (StringToUint32 (element.substr (leftBracket + 1, dash - (leftBracket + 1)), &min)
+          && StringToUint32 (element.substr (dash + 1, rightBracket - (dash + 1)), &max))
         {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
-          return true;
-        }
-      else
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" does not "<<m_element);
-          return false;
+          ranges.push_back (std::make_pair (min, max));
         }
+      return;
     }
   uint32_t value;
-  if (StringToUint32 (m_element, &value) &&
-      i == value)
+  if (StringToUint32 (element, &value))
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
-      return true;
+      ranges.push_back (std::make_pair (value, value));
     }
-  NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
-  return false;
 }
 
-bool
-ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
+std::string
+CompiledPath::GetPath (void) const
 {
-  NS_LOG_FUNCTION (this << str << value);
-  std::istringstream iss;
-  iss.str (str);
-  iss >> (*value);
-  return !iss.bad () && !iss.fail ();
+  return m_path;
 }
 
 /**
@@ -269,11 +248,12 @@ class Resolver
 {
 public:
   /**
-   * Construct from a base Config path.
+   * Construct from the first segments of a compiled Config path.
    *
    * \param [in] path The Config path.
+   * \param [in] n The number of segments to resolve.
    */
-  Resolver (std::string path);
+  Resolver (const CompiledPath &path, uint32_t n);
   /** Destructor. */
   virtual ~Resolver ();
 
@@ -287,23 +267,39 @@ public:
   void Resolve (Ptr<Object> root);
   
 private:
-  /** Ensure the Config path starts and ends with a '/'. */
-  void Canonicalize (void);
   /**
    * Parse the next element in the Config path.
    *
-   * \param [in] path The remaining portion of the Config path.
+   * \param [in] i The index of the segment to parse.
    * \param [in] root The object corresponding to the current positon
    *                  in the Config path.
    */
-  void DoResolve (std::string path, Ptr<Object> root);
+  void DoResolve (uint32_t i, Ptr<Object> root);
   /**
    * Parse an index on the Config path.
    *
-   * \param [in] path The remaining Config path.
-   * \param [in,out] vector The resulting list of matching objects.
+   * \param [in] i The index of the segment to parse.
+   * \param [in] root The object holding the container.
+   * \param [in] attribute The container attribute.
+   */
+  void DoArrayResolve (uint32_t i, Ptr<Object> root, const CompiledPath::Attribute &attribute);
+  /**
+   * Continue with an item of a container.
+   *
+   * \param [in] i The index of the next segment to parse.
+   * \param [in] index The index of the item in the container.
+   * \param [in] item The item.
    */
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void DoResolveItem (uint32_t i, uint32_t index, Ptr<Object> item);
+  /**
+   * Find the attributes of a TypeId matched by a segment.
+   *
+   * \param [in] segment The segment.
+   * \param [in] tid The TypeId of the object.
+   * \returns The attributes.
+   */
+  static const std::vector<CompiledPath::Attribute> &
+  GetAttributes (const CompiledPath::Segment &segment, TypeId tid);
   /**
    * Handle one object found on the path.
    *
@@ -327,46 +323,29 @@ private:
   /** Current list of path tokens. */
   std::vector<std::string> m_workStack;
   /** The Config path. */
-  std::string m_path;
+  const CompiledPath &m_path;
+  /** The number of segments to resolve. */
+  uint32_t m_n;
 
 };  // class Resolver
 
-Resolver::Resolver (std::string path)
-  : m_path (path)
+Resolver::Resolver (const CompiledPath &path, uint32_t n)
+  : m_path (path),
+    m_n (n)
 {
-  NS_LOG_FUNCTION (this << path);
-  Canonicalize ();
+  NS_LOG_FUNCTION (this << path.GetPath () << n);
 }
 Resolver::~Resolver ()
 {
   NS_LOG_FUNCTION (this);
 }
-void
-Resolver::Canonicalize (void)
-{
-  NS_LOG_FUNCTION (this);
-
-  // ensure that we start and end with a '/'
-  std::string::size_type tmp = m_path.find ("/");
-  if (tmp != 0)
-    {
-      // no slash at start
-      m_path = "/" + m_path;
-    }
-  tmp = m_path.find_last_of ("/");
-  if (tmp != (m_path.size () - 1))
-    {
-      // no slash at end
-      m_path = m_path + "/";
-    }
-}
 
 void 
 Resolver::Resolve (Ptr<Object> root)
 {
   NS_LOG_FUNCTION (this << root);
 
-  DoResolve (m_path, root);
+  DoResolve (0, root);
 }
 
 std::string
@@ -391,14 +370,59 @@ Resolver::DoResolveOne (Ptr<Object> object)
   DoOne (object, GetResolvedPath ());
 }
 
+const std::vector<CompiledPath::Attribute> &
+Resolver::GetAttributes (const CompiledPath::Segment &segment, TypeId tid)
+{
+  std::map<TypeId, std::vector<CompiledPath::Attribute> >::const_iterator found =
+    segment.attributes.find (tid);
+  if (found != segment.attributes.end ())
+    {
+      return found->second;
+    }
+  std::vector<CompiledPath::Attribute> &attributes = segment.attributes[tid];
+  TypeId nextTid = tid;
+  do
+    {
+      tid = nextTid;
+      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+        {
+          struct TypeId::AttributeInformation info = tid.GetAttribute (i);
+          if (info.name != segment.name && !segment.wildcard)
+            {
+              continue;
+            }
+          if (!(info.flags & TypeId::ATTR_GET) || !info.accessor->HasGetter ())
+            {
+              continue;
+            }
+          CompiledPath::Attribute attribute;
+          attribute.name = info.name;
+          attribute.accessor = info.accessor;
+          // a pointer to an object, or a container of objects
+          if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              attribute.container = false;
+              attributes.push_back (attribute);
+            }
+          else if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              attribute.container = true;
+              attributes.push_back (attribute);
+            }
+          // this could be anything else and we don't know what to do with it.
+          // So, we just ignore it.
+        }
+      nextTid = tid.GetParent ();
+    } while (nextTid != tid);
+  return attributes;
+}
+
 void
-Resolver::DoResolve (std::string path, Ptr<Object> root)
+Resolver::DoResolve (uint32_t i, Ptr<Object> root)
 {
-  NS_LOG_FUNCTION (this << path << root);
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
+  NS_LOG_FUNCTION (this << i << root);
 
-  if (next == std::string::npos)
+  if (i == m_n)
     {
       //
       // If root is zero, we're beginning to see if we can use the object name 
@@ -414,8 +438,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
         }
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  const CompiledPath::Segment &segment = m_path.m_segments[i];
 
   //
   // If root is zero, we're beginning to see if we can use the object name 
@@ -424,16 +447,12 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   // the root of the "/Names" namespace, so we just ignore it and move on to 
   // the next segment.
   //
-  if (root == 0)
+  if (root == 0 && segment.name == "Names")
     {
-      std::string::size_type offset = path.find ("/Names");
-      if (offset == 0)
-        {
-          m_workStack.push_back (item);
-          DoResolve (pathLeft, root);
-          m_workStack.pop_back ();
-          return;
-        }
+      m_workStack.push_back (segment.name);
+      DoResolve (i + 1, root);
+      m_workStack.pop_back ();
+      return;
     }
 
   //
@@ -442,12 +461,12 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   // zero, this means to look in the root of the "/Names" name space, otherwise
   // it refers to a name space context (level).
   //
-  Ptr<Object> namedObject = Names::Find<Object> (root, item);
+  Ptr<Object> namedObject = Names::Find<Object> (root, segment.name);
   if (namedObject)
     {
-      NS_LOG_DEBUG ("Name system resolved item = " << item << " to " << namedObject);
-      m_workStack.push_back (item);
-      DoResolve (pathLeft, namedObject);
+      NS_LOG_DEBUG ("Name system resolved item = " << segment.name << " to " << namedObject);
+      m_workStack.push_back (segment.name);
+      DoResolve (i + 1, namedObject);
       m_workStack.pop_back ();
       return;
     }
@@ -463,126 +482,166 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       return;
     }
-  std::string::size_type dollarPos = item.find ("$");
-  if (dollarPos == 0)
+  if (segment.getObject)
     {
       // This is a call to GetObject
-      std::string tidString = item.substr (1, item.size () - 1);
-      NS_LOG_DEBUG ("GetObject="<<tidString<<" on path="<<GetResolvedPath ());
-      TypeId tid = TypeId::LookupByName (tidString);
-      Ptr<Object> object = root->GetObject<Object> (tid);
+      NS_LOG_DEBUG ("GetObject="<<segment.name<<" on path="<<GetResolvedPath ());
+      if (!segment.tidFound)
+        {
+          // an unknown TypeId is a fatal error, as it is likely a typo
+          TypeId::LookupByName (segment.name.substr (1));
+        }
+      Ptr<Object> object = root->GetObject<Object> (segment.tid);
       if (object == 0)
         {
-          NS_LOG_DEBUG ("GetObject ("<<tidString<<") failed on path="<<GetResolvedPath ());
+          NS_LOG_DEBUG ("GetObject ("<<segment.name<<") failed on path="<<GetResolvedPath ());
           return;
         }
-      m_workStack.push_back (item);
-      DoResolve (pathLeft, object);
+      m_workStack.push_back (segment.name);
+      DoResolve (i + 1, object);
       m_workStack.pop_back ();
+      return;
     }
-  else 
+
+  // this is a normal attribute.
+  const std::vector<CompiledPath::Attribute> &attributes =
+    GetAttributes (segment, root->GetInstanceTypeId ());
+  for (std::vector<CompiledPath::Attribute>::const_iterator j = attributes.begin ();
+       j != attributes.end (); ++j)
     {
-      // this is a normal attribute.
-      TypeId tid;
-      TypeId nextTid = root->GetInstanceTypeId ();
-      bool foundMatch = false;
-      
-      do
+      if (j->container)
         {
-          tid = nextTid;
-          
-          for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
-            {
-              struct TypeId::AttributeInformation info;
-              info = tid.GetAttribute(i);
-              if (info.name != item && item != "*")
-                {
-                  continue;
-                }
-              // attempt to cast to a pointer checker.
-              const PointerChecker *ptr = dynamic_cast<const PointerChecker *> (PeekPointer (info.checker));
-              if (ptr != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(ptr)="<<info.name<<" on path="<<GetResolvedPath ());
-                  PointerValue ptr;
-                  root->GetAttribute (info.name, ptr);
-                  Ptr<Object> object = ptr.Get<Object> ();
-                  if (object == 0)
-                    {
-                      NS_LOG_ERROR ("Requested object name=\""<<item<<
-                                    "\" exists on path=\""<<GetResolvedPath ()<<"\""
-                                    " but is null.");
-                      continue;
-                    }
-                  foundMatch = true;
-                  m_workStack.push_back (info.name);
-                  DoResolve (pathLeft, object);
-                  m_workStack.pop_back ();
-                }
-              // attempt to cast to an object vector.
-              const ObjectPtrContainerChecker *vectorChecker = 
-                dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
-              if (vectorChecker != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(vector)="<<info.name<<" on path="<<GetResolvedPath () << pathLeft);
-                  foundMatch = true;
-                  ObjectPtrContainerValue vector;
-                  root->GetAttribute (info.name, vector);
-                  m_workStack.push_back (info.name);
-                  DoArrayResolve (pathLeft, vector);
-                  m_workStack.pop_back ();
-                }
-              // this could be anything else and we don't know what to do with it.
-              // So, we just ignore it.
-            }
-
-          nextTid = tid.GetParent ();
-        } while (nextTid != tid);
-      
-      if (!foundMatch)
+          NS_LOG_DEBUG ("GetAttribute(vector)="<<j->name<<" on path="<<GetResolvedPath ());
+          m_workStack.push_back (j->name);
+          DoArrayResolve (i + 1, root, *j);
+          m_workStack.pop_back ();
+          continue;
+        }
+      NS_LOG_DEBUG ("GetAttribute(ptr)="<<j->name<<" on path="<<GetResolvedPath ());
+      PointerValue ptr;
+      if (!j->accessor->Get (PeekPointer (root), ptr))
         {
-          NS_LOG_DEBUG ("Requested item="<<item<<" does not exist on path="<<GetResolvedPath ());
-          return;
+          continue;
         }
+      Ptr<Object> object = ptr.Get<Object> ();
+      if (object == 0)
+        {
+          NS_LOG_ERROR ("Requested object name=\""<<segment.name<<
+                        "\" exists on path=\""<<GetResolvedPath ()<<"\""
+                        " but is null.");
+          continue;
+        }
+      m_workStack.push_back (j->name);
+      DoResolve (i + 1, object);
+      m_workStack.pop_back ();
     }
+  if (attributes.empty ())
+    {
+      NS_LOG_DEBUG ("Requested item="<<segment.name<<" does not exist on path="<<GetResolvedPath ());
+    }
+}
+
+void
+Resolver::DoResolveItem (uint32_t i, uint32_t index, Ptr<Object> item)
+{
+  std::ostringstream oss;
+  oss << index;
+  m_workStack.push_back (oss.str ());
+  DoResolve (i, item);
+  m_workStack.pop_back ();
 }
 
 void 
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
+Resolver::DoArrayResolve (uint32_t i, Ptr<Object> root, const CompiledPath::Attribute &attribute)
 {
-  NS_LOG_FUNCTION(this << path << &container);
-  NS_ASSERT (path != "");
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-  if (next == std::string::npos)
+  NS_LOG_FUNCTION (this << i << root << attribute.name);
+  if (i == m_n)
     {
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  const std::vector<std::pair<uint32_t, uint32_t> > &ranges = m_path.m_segments[i].ranges;
 
-  ArrayMatcher matcher = ArrayMatcher (item);
-  ObjectPtrContainerValue::Iterator it;
-  for (it = container.Begin (); it != container.End (); ++it)
+  const ObjectPtrContainerAccessor *accessor =
+    dynamic_cast<const ObjectPtrContainerAccessor *> (PeekPointer (attribute.accessor));
+  if (accessor == 0)
     {
-      if (matcher.Matches ((*it).first))
+      ObjectPtrContainerValue container;
+      if (!attribute.accessor->Get (PeekPointer (root), container))
         {
-          std::ostringstream oss;
-          oss << (*it).first;
-          m_workStack.push_back (oss.str ());
-          DoResolve (pathLeft, (*it).second);
-          m_workStack.pop_back ();
+          return;
+        }
+      for (ObjectPtrContainerValue::Iterator it = container.Begin (); it != container.End (); ++it)
+        {
+          for (uint32_t j = 0; j < ranges.size (); j++)
+            {
+              if (it->first >= ranges[j].first && it->first <= ranges[j].second)
+                {
+                  DoResolveItem (i + 1, it->first, it->second);
+                  break;
+                }
+            }
+        }
+      return;
+    }
+
+  uint32_t n;
+  if (!accessor->GetN (PeekPointer (root), &n))
+    {
+      return;
+    }
+  uint32_t index;
+  if (ranges.size () == 1 && ranges[0].first == ranges[0].second)
+    {
+      // a single index: try the item at that position first
+      uint32_t wanted = ranges[0].first;
+      if (wanted < n)
+        {
+          Ptr<Object> item = accessor->GetItem (PeekPointer (root), wanted, &index);
+          if (index == wanted)
+            {
+              DoResolveItem (i + 1, index, item);
+              return;
+            }
+        }
+    }
+  for (uint32_t k = 0; k < n; k++)
+    {
+      Ptr<Object> item = accessor->GetItem (PeekPointer (root), k, &index);
+      for (uint32_t j = 0; j < ranges.size (); j++)
+        {
+          if (index >= ranges[j].first && index <= ranges[j].second)
+            {
+              DoResolveItem (i + 1, index, item);
+              break;
+            }
         }
     }
 }
 
+/**
+ * \ingroup config-impl
+ * The generation of the objects reachable from the roots, incremented
+ * by InvalidateMatchCache().
+ */
+static NS_SIMULATION_LOCAL uint64_t g_matchGeneration = 0;
+
 /**
  * \ingroup config-impl
  * Config system implementation class.
  */
-class ConfigImpl : public Singleton<ConfigImpl>
+class ConfigImpl : private NonCopyable
 {
 public:
+  /**
+   * Get the ConfigImpl of the calling simulation.
+   *
+   * The roots and the match cache belong to the simulation, so with
+   * --enable-thread-local-simulator each thread has its own.
+   *
+   * \returns The singleton ConfigImpl.
+   */
+  static ConfigImpl *Get (void);
+
   /** \copydoc Config::Set() */
   void Set (std::string path, const AttributeValue &value);
   /** \copydoc Config::ConnectWithoutContext() */
@@ -595,6 +654,20 @@ public:
   void Disconnect (std::string path, const CallbackBase &cb);
   /** \copydoc Config::LookupMatches() */
   MatchContainer LookupMatches (std::string path);
+  /**
+   * Match the objects of the first segments of a compiled path.
+   *
+   * \param [in] path The compiled Config path.
+   * \param [in] n The number of segments to match.
+   * \param [in] pathString The path to report in the container.
+   * \returns A container with the matching objects.
+   */
+  MatchContainer LookupMatches (const CompiledPath &path, uint32_t n,
+                                std::string pathString) const;
+  /** \copydoc Config::EnableMatchCache() */
+  void EnableMatchCache (void);
+  /** \copydoc Config::DisableMatchCache() */
+  void DisableMatchCache (void);
 
   /** \copydoc Config::RegisterRootNamespaceObject() */
   void RegisterRootNamespaceObject (Ptr<Object> obj);
@@ -622,8 +695,34 @@ private:
   /** The list of Config path roots. */
   Roots m_roots;
 
+  /** Container type to hold the cached matches, by path. */
+  typedef std::map<std::string, MatchContainer> MatchCache;
+
+  /** Whether LookupMatches() uses the cache. */
+  bool m_matchCacheEnabled;
+  /** The cached matches. */
+  MatchCache m_matchCache;
+  /** The generation of the objects in the cache. */
+  uint64_t m_matchCacheGeneration;
+
+  /** Constructor. */
+  ConfigImpl ();
+
 };  // class ConfigImpl
 
+ConfigImpl *
+ConfigImpl::Get (void)
+{
+  static NS_SIMULATION_LOCAL ConfigImpl config;
+  return &config;
+}
+
+ConfigImpl::ConfigImpl ()
+  : m_matchCacheEnabled (false),
+    m_matchCacheGeneration (0)
+{
+}
+
 void 
 ConfigImpl::ParsePath (std::string path, std::string *root, std::string *leaf) const
 {
@@ -689,11 +788,37 @@ MatchContainer
 ConfigImpl::LookupMatches (std::string path)
 {
   NS_LOG_FUNCTION (this << path);
+  if (!m_matchCacheEnabled)
+    {
+      return CompiledPath (path).LookupMatches ();
+    }
+  if (m_matchCacheGeneration != g_matchGeneration)
+    {
+      // drop the stale matches, and the references they hold
+      m_matchCache.clear ();
+      m_matchCacheGeneration = g_matchGeneration;
+    }
+  MatchCache::const_iterator i = m_matchCache.find (path);
+  if (i != m_matchCache.end ())
+    {
+      NS_LOG_LOGIC ("cached matches for " << path);
+      return i->second;
+    }
+  MatchContainer container = CompiledPath (path).LookupMatches ();
+  m_matchCache.insert (std::make_pair (path, container));
+  return container;
+}
+
+MatchContainer
+ConfigImpl::LookupMatches (const CompiledPath &path, uint32_t n,
+                           std::string pathString) const
+{
+  NS_LOG_FUNCTION (this << path.GetPath () << n << pathString);
   class LookupMatchesResolver : public Resolver 
   {
   public:
-    LookupMatchesResolver (std::string path)
-      : Resolver (path)
+    LookupMatchesResolver (const CompiledPath &path, uint32_t n)
+      : Resolver (path, n)
     {}
     virtual void DoOne (Ptr<Object> object, std::string path)
     {
@@ -702,7 +827,7 @@ ConfigImpl::LookupMatches (std::string path)
     }
     std::vector<Ptr<Object> > m_objects;
     std::vector<std::string> m_contexts;
-  } resolver = LookupMatchesResolver (path);
+  } resolver (path, n);
   for (Roots::const_iterator i = m_roots.begin (); i != m_roots.end (); i++)
     {
       resolver.Resolve (*i);
@@ -715,7 +840,22 @@ ConfigImpl::LookupMatches (std::string path)
   //
   resolver.Resolve (0);
 
-  return MatchContainer (resolver.m_objects, resolver.m_contexts, path);
+  return MatchContainer (resolver.m_objects, resolver.m_contexts, pathString);
+}
+
+void
+ConfigImpl::EnableMatchCache (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_matchCacheEnabled = true;
+}
+
+void
+ConfigImpl::DisableMatchCache (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_matchCacheEnabled = false;
+  m_matchCache.clear ();
 }
 
 void 
@@ -723,6 +863,7 @@ ConfigImpl::RegisterRootNamespaceObject (Ptr<Object> obj)
 {
   NS_LOG_FUNCTION (this << obj);
   m_roots.push_back (obj);
+  InvalidateMatchCache ();
 }
 
 void 
@@ -735,6 +876,7 @@ ConfigImpl::UnregisterRootNamespaceObject (Ptr<Object> obj)
       if (*i == obj)
         {
           m_roots.erase (i);
+          InvalidateMatchCache ();
           return;
         }
     }
@@ -753,6 +895,66 @@ ConfigImpl::GetRootNamespaceObject (uint32_t i) const
   return m_roots[i];
 }
 
+MatchContainer
+CompiledPath::DoLookupMatches (uint32_t n, std::string path) const
+{
+  NS_LOG_FUNCTION (this << n << path);
+  return ConfigImpl::Get ()->LookupMatches (*this, n, path);
+}
+
+MatchContainer
+CompiledPath::LookupMatches (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return DoLookupMatches (m_segments.size (), m_path);
+}
+
+MatchContainer
+CompiledPath::LookupLeaf (std::string *leaf) const
+{
+  NS_LOG_FUNCTION (this << leaf);
+  std::string::size_type slash = m_path.find_last_of ("/");
+  NS_ASSERT (slash != std::string::npos && !m_segments.empty ());
+  *leaf = m_path.substr (slash + 1, m_path.size () - (slash + 1));
+  return DoLookupMatches (m_segments.size () - 1, m_path.substr (0, slash));
+}
+
+void
+CompiledPath::Set (const AttributeValue &value) const
+{
+  NS_LOG_FUNCTION (this << &value);
+  std::string leaf;
+  LookupLeaf (&leaf).Set (leaf, value);
+}
+void
+CompiledPath::Connect (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  std::string leaf;
+  LookupLeaf (&leaf).Connect (leaf, cb);
+}
+void
+CompiledPath::ConnectWithoutContext (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  std::string leaf;
+  LookupLeaf (&leaf).ConnectWithoutContext (leaf, cb);
+}
+void
+CompiledPath::Disconnect (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  std::string leaf;
+  LookupLeaf (&leaf).Disconnect (leaf, cb);
+}
+void
+CompiledPath::DisconnectWithoutContext (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  std::string leaf;
+  LookupLeaf (&leaf).DisconnectWithoutContext (leaf, cb);
+}
+
 
 void Reset (void)
 {
@@ -851,6 +1053,20 @@ Disconnect (std::string path, const CallbackBase &cb)
   NS_LOG_FUNCTION (path << &cb);
   ConfigImpl::Get ()->Disconnect (path, cb);
 }
+void EnableMatchCache (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  ConfigImpl::Get ()->EnableMatchCache ();
+}
+void DisableMatchCache (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  ConfigImpl::Get ()->DisableMatchCache ();
+}
+void InvalidateMatchCache (void)
+{
+  g_matchGeneration++;
+}
 MatchContainer LookupMatches (std::string path)
 {
   NS_LOG_FUNCTION (path);
@@ -21,6 +21,8 @@
 #define CONFIG_H
 
 #include "ptr.h"
+#include "type-id.h"
+#include <map>
 #include <string>
 #include <vector>
 
@@ -33,6 +35,7 @@
 namespace ns3 {
 
 class AttributeValue;
+class AttributeAccessor;
 class Object;
 class CallbackBase;
 
@@ -258,6 +261,145 @@ private:
  */
 MatchContainer LookupMatches (std::string path);
 
+/**
+ * \ingroup config
+ * \brief A Config path, parsed once to be matched many times.
+ *
+ * Config::Set, Config::Connect and Config::LookupMatches parse their
+ * path on every call.  A CompiledPath parses it once: the TypeId of
+ * the \c $TypeId segments is looked up, the index specifications
+ * (\c *, \c [2-5], \c 1|3) are turned into ranges, and the
+ * attributes of each segment are found once per TypeId.  A segment
+ * which is a single index, such as \c 5 in \c /NodeList/5/, fetches
+ * that item of the container directly instead of going through all
+ * the items.
+ *
+ * The objects are matched again at each call, so a CompiledPath can
+ * be kept and reused while the topology changes.  As with Config::Set,
+ * reaching a \c $TypeId segment whose TypeId does not exist while
+ * matching is a fatal error.
+ */
+class CompiledPath
+{
+public:
+  /**
+   * Parse a Config path.
+   *
+   * \param [in] path The Config path.
+   */
+  CompiledPath (std::string path);
+
+  /** \returns The Config path. */
+  std::string GetPath (void) const;
+  /**
+   * \returns A container with all the objects which match the path.
+   * \sa ns3::Config::LookupMatches
+   */
+  MatchContainer LookupMatches (void) const;
+  /**
+   * \param [in] value The value to set in all matching attributes.
+   * \sa ns3::Config::Set
+   */
+  void Set (const AttributeValue &value) const;
+  /**
+   * \param [in] cb The callback to connect to the matching trace sources.
+   * \sa ns3::Config::Connect
+   */
+  void Connect (const CallbackBase &cb) const;
+  /**
+   * \param [in] cb The callback to connect to the matching trace sources.
+   * \sa ns3::Config::ConnectWithoutContext
+   */
+  void ConnectWithoutContext (const CallbackBase &cb) const;
+  /**
+   * \param [in] cb The callback to disconnect from the matching trace sources.
+   * \sa ns3::Config::Disconnect
+   */
+  void Disconnect (const CallbackBase &cb) const;
+  /**
+   * \param [in] cb The callback to disconnect from the matching trace sources.
+   * \sa ns3::Config::DisconnectWithoutContext
+   */
+  void DisconnectWithoutContext (const CallbackBase &cb) const;
+
+private:
+  friend class Resolver;
+
+  /** An attribute of a TypeId which can be followed on a path. */
+  struct Attribute
+  {
+    std::string name;                            //!< The attribute name.
+    bool container;                              //!< \c true for a container, \c false for a pointer.
+    Ptr<const AttributeAccessor> accessor;       //!< The attribute accessor.
+  };
+  /** A parsed segment of the path. */
+  struct Segment
+  {
+    std::string name;                            //!< The text of the segment.
+    bool wildcard;                               //!< \c true if the segment is \c *.
+    bool getObject;                              //!< \c true if the segment is \c $TypeId.
+    bool tidFound;                               //!< \c true if the TypeId of a \c $TypeId segment exists.
+    TypeId tid;                                  //!< The TypeId of a \c $TypeId segment.
+    /** The index ranges matched by the segment, as a container index. */
+    std::vector<std::pair<uint32_t, uint32_t> > ranges;
+    /** The attributes matched by the segment, by TypeId, found on demand. */
+    mutable std::map<TypeId, std::vector<Attribute> > attributes;
+  };
+
+  /**
+   * Parse an index specification.
+   *
+   * \param [in] element The index specification.
+   * \param [in,out] ranges The ranges to which the matched indexes are added.
+   */
+  static void ParseRanges (std::string element, std::vector<std::pair<uint32_t, uint32_t> > &ranges);
+  /**
+   * Match the objects of the first segments of the path.
+   *
+   * \param [in] n The number of segments to match.
+   * \param [in] path The path to report in the container.
+   * \returns A container with the matching objects.
+   */
+  MatchContainer DoLookupMatches (uint32_t n, std::string path) const;
+  /**
+   * Split the path into its objects and its last segment.
+   *
+   * \param [out] leaf The last segment.
+   * \returns A container with the objects matched by the other segments.
+   */
+  MatchContainer LookupLeaf (std::string *leaf) const;
+
+  /** The Config path. */
+  std::string m_path;
+  /** The segments of the path. */
+  std::vector<Segment> m_segments;
+};
+
+/**
+ * \ingroup config
+ * Cache the result of Config::LookupMatches, and thus of Config::Set
+ * and Config::Connect, by path.
+ *
+ * The cache is valid until the objects reachable from the roots
+ * change.  ns-3 clears it when a root namespace object is registered,
+ * an object is aggregated, a Names entry is added, or a Node, a
+ * Channel, a NetDevice or an Application is added; a model which adds
+ * objects to other containers after matching them should call
+ * Config::InvalidateMatchCache.
+ */
+void EnableMatchCache (void);
+/**
+ * \ingroup config
+ * Disable and clear the cache of Config::LookupMatches.
+ */
+void DisableMatchCache (void);
+/**
+ * \ingroup config
+ * Clear the cache of Config::LookupMatches, because the objects
+ * reachable from the roots have changed.
+ */
+void InvalidateMatchCache (void);
+
 /**
  * \ingroup config
  * \param [in] obj A new root object
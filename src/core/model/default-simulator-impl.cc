@@ -25,10 +25,14 @@
 
 #include "ptr.h"
 #include "pointer.h"
+#include "string.h"
+#include "enum.h"
 #include "assert.h"
 #include "log.h"
 
+#include <algorithm>
 #include <cmath>
+#include <fstream>
 
 
 /**
@@ -53,11 +57,44 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("ProfileFile",
+                   "If not empty, profile the events run and write the "
+                   "profile to this file at Simulator::Destroy.",
+                   StringValue (""),
+                   MakeStringAccessor (&DefaultSimulatorImpl::m_profileFile),
+                   MakeStringChecker ())
+    .AddAttribute ("ProfileFormat",
+                   "The format of the profile: a report sorted by time, "
+                   "or folded stacks for flame graphs.",
+                   EnumValue (EventProfiler::REPORT),
+                   MakeEnumAccessor (&DefaultSimulatorImpl::m_profileFormat),
+                   MakeEnumChecker (EventProfiler::REPORT, "Report",
+                                    EventProfiler::FOLDED, "Folded"))
+    .AddAttribute ("ProgressInterval",
+                   "If not zero, the wall clock interval between reports "
+                   "of the progress of the simulation.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&DefaultSimulatorImpl::m_progressInterval),
+                   MakeTimeChecker (Seconds (0)))
+    .AddAttribute ("ProgressFile",
+                   "The file to write the progress reports to, "
+                   "or empty for std::cerr.",
+                   StringValue (""),
+                   MakeStringAccessor (&DefaultSimulatorImpl::m_progressFile),
+                   MakeStringChecker ())
+    .AddAttribute ("ProgressFormat",
+                   "The format of the progress reports: text lines, "
+                   "or one JSON object per line.",
+                   EnumValue (ProgressReporter::TEXT),
+                   MakeEnumAccessor (&DefaultSimulatorImpl::m_progressFormat),
+                   MakeEnumChecker (ProgressReporter::TEXT, "Text",
+                                    ProgressReporter::JSON, "Json"))
   ;
   return tid;
 }
 
 DefaultSimulatorImpl::DefaultSimulatorImpl ()
+  : m_eventsWithContextQueue (1024)
 {
   NS_LOG_FUNCTION (this);
   m_stop = false;
@@ -71,7 +108,10 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentTs = 0;
   m_currentContext = Simulator::NO_CONTEXT;
   m_unscheduledEvents = 0;
-  m_eventsWithContextEmpty = true;
+  m_eventsWithContextEmpty.store (true, std::memory_order_release);
+  m_profiler = 0;
+  m_progress = 0;
+  m_stopTs = ~0ULL;
   m_main = SystemThread::Self();
 }
 
@@ -92,6 +132,10 @@ DefaultSimulatorImpl::DoDispose (void)
       next.impl->Unref ();
     }
   m_events = 0;
+  delete m_profiler;
+  m_profiler = 0;
+  delete m_progress;
+  m_progress = 0;
   SimulatorImpl::DoDispose ();
 }
 void
@@ -108,6 +152,7 @@ DefaultSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+  WriteProfile ();
 }
 
 void
@@ -146,12 +191,51 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (m_profiler == 0)
+    {
+      next.impl->Invoke ();
+    }
+  else
+    {
+      ProfileOneEvent (next);
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
 }
 
+void
+DefaultSimulatorImpl::ProfileOneEvent (const Scheduler::Event &next)
+{
+  if (next.impl->IsCancelled ())
+    {
+      m_profiler->RecordCancelled (next.key.m_context);
+      return;
+    }
+  uint64_t start = EventProfiler::Now ();
+  next.impl->Invoke ();
+  m_profiler->Record (next.impl, next.key.m_context,
+                      EventProfiler::Now () - start, m_unscheduledEvents);
+}
+
+void
+DefaultSimulatorImpl::WriteProfile (void)
+{
+  if (m_profiler == 0)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this << m_profileFile);
+  std::ofstream os (m_profileFile.c_str ());
+  if (!os.is_open ())
+    {
+      NS_LOG_WARN ("Cannot open " << m_profileFile << " to write the event profile");
+    }
+  m_profiler->Write (os, m_profileFormat);
+  delete m_profiler;
+  m_profiler = 0;
+}
+
 bool 
 DefaultSimulatorImpl::IsFinished (void) const
 {
@@ -161,7 +245,20 @@ DefaultSimulatorImpl::IsFinished (void) const
 void
 DefaultSimulatorImpl::ProcessEventsWithContext (void)
 {
-  if (m_eventsWithContextEmpty)
+  if (m_eventsWithContextQueue.IsEmpty ()
+      && m_eventsWithContextEmpty.load (std::memory_order_acquire))
+    {
+      return;
+    }
+
+  // The lock-free queue first: a thread only uses the overflow list
+  // after it found the queue full, and until the list is emptied here.
+  EventWithContext event;
+  while (m_eventsWithContextQueue.TryPop (event))
+    {
+      InsertEventWithContext (event);
+    }
+  if (m_eventsWithContextEmpty.load (std::memory_order_acquire))
     {
       return;
     }
@@ -171,23 +268,28 @@ DefaultSimulatorImpl::ProcessEventsWithContext (void)
   {
     CriticalSection cs (m_eventsWithContextMutex);
     m_eventsWithContext.swap(eventsWithContext);
-    m_eventsWithContextEmpty = true;
+    m_eventsWithContextEmpty.store (true, std::memory_order_release);
   }
   while (!eventsWithContext.empty ())
     {
-       EventWithContext event = eventsWithContext.front ();
+       InsertEventWithContext (eventsWithContext.front ());
        eventsWithContext.pop_front ();
-       Scheduler::Event ev;
-       ev.impl = event.event;
-       ev.key.m_ts = m_currentTs + event.timestamp;
-       ev.key.m_context = event.context;
-       ev.key.m_uid = m_uid;
-       m_uid++;
-       m_unscheduledEvents++;
-       m_events->Insert (ev);
     }
 }
 
+void
+DefaultSimulatorImpl::InsertEventWithContext (const EventWithContext &event)
+{
+  Scheduler::Event ev;
+  ev.impl = event.event;
+  ev.key.m_ts = m_currentTs + event.timestamp;
+  ev.key.m_context = event.context;
+  ev.key.m_uid = m_uid;
+  m_uid++;
+  m_unscheduledEvents++;
+  m_events->Insert (ev);
+}
+
 void
 DefaultSimulatorImpl::Run (void)
 {
@@ -196,11 +298,36 @@ DefaultSimulatorImpl::Run (void)
   m_main = SystemThread::Self();
   ProcessEventsWithContext ();
   m_stop = false;
+  if (!m_profileFile.empty () && m_profiler == 0)
+    {
+      m_profiler = new EventProfiler ();
+    }
+  if (m_progressInterval.IsStrictlyPositive () && m_progress == 0)
+    {
+      m_progress = new ProgressReporter (m_progressFile, m_progressFormat,
+                                         m_progressInterval.GetNanoSeconds ());
+    }
 
-  while (!m_events->IsEmpty () && !m_stop) 
+  if (m_progress == 0)
     {
-      ProcessOneEvent ();
+      while (!m_events->IsEmpty () && !m_stop) 
+        {
+          ProcessOneEvent ();
+        }
     }
+  else
+    {
+      m_progress->SetStopTime (m_stopTs);
+      while (!m_events->IsEmpty () && !m_stop) 
+        {
+          ProcessOneEvent ();
+          m_progress->Notify (m_currentTs, m_unscheduledEvents);
+        }
+      m_progress->Finish (m_currentTs, m_unscheduledEvents);
+    }
+  // The stop time which ended this run is in the past: a later run
+  // estimates its time left from the next call to Stop (delay).
+  m_stopTs = ~0ULL;
 
   // If the simulator stopped naturally by lack of events, make a
   // consistency test to check that we didn't lose any events along the way.
@@ -218,6 +345,15 @@ void
 DefaultSimulatorImpl::Stop (Time const &delay)
 {
   NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  uint64_t stopTs = (delay + TimeStep (m_currentTs)).GetTimeStep ();
+  if (m_stopTs <= m_currentTs || stopTs < m_stopTs)
+    {
+      m_stopTs = stopTs;
+    }
+  if (m_progress != 0)
+    {
+      m_progress->SetStopTime (m_stopTs);
+    }
   Simulator::Schedule (delay, &Simulator::Stop);
 }
 
@@ -269,14 +405,54 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
       // Current time added in ProcessEventsWithContext()
       ev.timestamp = delay.GetTimeStep ();
       ev.event = event;
+      // Keep the order of the events of this thread: once one went
+      // to the overflow list, the next ones follow until it is emptied.
+      if (m_eventsWithContextEmpty.load (std::memory_order_acquire)
+          && m_eventsWithContextQueue.TryPush (ev))
+        {
+          return;
+        }
       {
         CriticalSection cs (m_eventsWithContextMutex);
         m_eventsWithContext.push_back(ev);
-        m_eventsWithContextEmpty = false;
+        m_eventsWithContextEmpty.store (false, std::memory_order_release);
       }
     }
 }
 
+void
+DefaultSimulatorImpl::ScheduleBatch (const std::vector<Simulator::BatchEvent> &batch)
+{
+  NS_LOG_FUNCTION (this << batch.size ());
+
+  if (!SystemThread::Equals (m_main))
+    {
+      SimulatorImpl::ScheduleBatch (batch);
+      return;
+    }
+  m_batch.clear ();
+  m_batch.reserve (batch.size ());
+  for (std::vector<Simulator::BatchEvent>::const_iterator i = batch.begin (); i != batch.end (); ++i)
+    {
+      Time tAbsolute = i->delay + TimeStep (m_currentTs);
+      Scheduler::Event ev;
+      ev.impl = i->event;
+      ev.key.m_ts = (uint64_t) tAbsolute.GetTimeStep ();
+      ev.key.m_context = i->context;
+      ev.key.m_uid = m_uid;
+      m_uid++;
+      m_batch.push_back (ev);
+    }
+  m_unscheduledEvents += batch.size ();
+  // The uids increase along the batch, so the events are already sorted
+  // when they have the same delay, as for a broadcast.
+  if (!std::is_sorted (m_batch.begin (), m_batch.end ()))
+    {
+      std::sort (m_batch.begin (), m_batch.end ());
+    }
+  m_events->InsertSorted (m_batch);
+}
+
 EventId
 DefaultSimulatorImpl::ScheduleNow (EventImpl *event)
 {
@@ -360,10 +536,23 @@ DefaultSimulatorImpl::Remove (const EventId &id)
 void
 DefaultSimulatorImpl::Cancel (const EventId &id)
 {
-  if (!IsExpired (id))
+  if (IsExpired (id))
     {
+      return;
+    }
+  if (id.GetUid () == 2)
+    {
+      // destroy events are not in the event list.
       id.PeekEventImpl ()->Cancel ();
+      return;
     }
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  // the scheduler releases the events it compacts away.
+  m_unscheduledEvents -= m_events->Cancel (event);
 }
 
 bool
@@ -26,9 +26,14 @@
 #include "event-impl.h"
 #include "system-thread.h"
 #include "system-mutex.h"
+#include "mpsc-queue.h"
+#include "event-profiler.h"
+#include "progress-reporter.h"
+#include "nstime.h"
 
 #include "ptr.h"
 
+#include <atomic>
 #include <list>
 
 /**
@@ -65,6 +70,7 @@ public:
   virtual void Stop (const Time &delay);
   virtual EventId Schedule (const Time &delay, EventImpl *event);
   virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
+  virtual void ScheduleBatch (const std::vector<Simulator::BatchEvent> &batch);
   virtual EventId ScheduleNow (EventImpl *event);
   virtual EventId ScheduleDestroy (EventImpl *event);
   virtual void Remove (const EventId &id);
@@ -83,6 +89,14 @@ private:
 
   /** Process the next event. */
   void ProcessOneEvent (void);
+  /**
+   * Run an event and record it in the profile.
+   *
+   * \param [in] next The event.
+   */
+  void ProfileOneEvent (const Scheduler::Event &next);
+  /** Write the profile at the end of the simulation. */
+  void WriteProfile (void);
   /** Move events from a different context into the main event queue. */
   void ProcessEventsWithContext (void);
  
@@ -95,15 +109,31 @@ private:
     /** The event implementation. */
     EventImpl *event;
   };
+  /**
+   * Insert an event from a different thread in the event queue.
+   *
+   * \param [in] event The event, with its delay.
+   */
+  void InsertEventWithContext (const struct EventWithContext &event);
+  /**
+   * Lock-free queue of the events from a different thread.
+   * When it is full, events go to \c m_eventsWithContext instead.
+   */
+  MpscQueue<struct EventWithContext> m_eventsWithContextQueue;
   /** Container type for the events from a different context. */
   typedef std::list<struct EventWithContext> EventsWithContext;
-  /** The container of events from a different context. */
+  /** The overflow container of events from a different context. */
   EventsWithContext m_eventsWithContext;
   /**
    * Flag \c true if all events with context have been moved to the
    * primary event queue.
+   *
+   * Other threads read it without taking the mutex, to decide whether
+   * they may use the lock-free queue, so it is atomic: the main thread
+   * sets it with release ordering once it emptied the overflow list,
+   * and the other threads load it with acquire ordering.
    */
-  bool m_eventsWithContextEmpty;
+  std::atomic<bool> m_eventsWithContextEmpty;
   /** Mutex to control access to the list of events with context. */
   SystemMutex m_eventsWithContextMutex;
 
@@ -115,6 +145,8 @@ private:
   bool m_stop;
   /** The event priority queue. */
   Ptr<Scheduler> m_events;
+  /** The events of ScheduleBatch(), kept to reuse the storage. */
+  std::vector<Scheduler::Event> m_batch;
 
   /** Next event unique id. */
   uint32_t m_uid;
@@ -130,6 +162,33 @@ private:
    */
   int m_unscheduledEvents;
 
+  /**
+   * The event profiler, or 0 if profiling is disabled.
+   * See the \c ProfileFile attribute.
+   */
+  EventProfiler *m_profiler;
+  /** The file to write the profile to at Destroy, empty to disable profiling. */
+  std::string m_profileFile;
+  /** The format of the profile. */
+  EventProfiler::Format m_profileFormat;
+
+  /**
+   * The progress reporter, or 0 if progress reports are disabled.
+   * See the \c ProgressInterval attribute.
+   */
+  ProgressReporter *m_progress;
+  /** The wall clock interval between progress reports, zero to disable them. */
+  Time m_progressInterval;
+  /** The file to write the progress reports to, empty for std::cerr. */
+  std::string m_progressFile;
+  /** The format of the progress reports. */
+  ProgressReporter::Format m_progressFormat;
+  /**
+   * The earliest time given to Stop(const Time&) since the last run
+   * ended, or ~0 if none.
+   */
+  uint64_t m_stopTs;
+
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
 };
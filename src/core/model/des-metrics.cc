@@ -28,16 +28,82 @@
 #include "des-metrics.h"
 #include "simulator.h"
 #include "system-path.h"
+#include "global-value.h"
+#include "enum.h"
 
+#include <cstring>  // memcmp
 #include <ctime>    // time_t, time()
 #include <sstream>
 #include <string>
 
 namespace ns3 {
 
+namespace {
+
+/**
+ * @ingroup simulator
+ * The format of the DES Metrics trace file.
+ */
+GlobalValue g_desMetricsFormat =
+  GlobalValue ("DesMetricsFormat",
+               "The format of the DES Metrics trace file, when ns-3 is "
+               "configured with --enable-des-metrics: JSON, or binary "
+               "records written in blocks.",
+               EnumValue (DesMetrics::JSON),
+               MakeEnumChecker (DesMetrics::JSON, "Json",
+                                DesMetrics::BINARY, "Binary"));
+
+/** The magic string which starts a binary trace. */
+const char g_binaryMagic[8] = { 'n', 's', '3', 'd', 'e', 's', 'm', '\0' };
+/** The version of the binary trace format. */
+const uint32_t g_binaryVersion = 1;
+
+/**
+ * @ingroup simulator
+ * Write a string of a binary trace header.
+ * @param os [in,out] The trace file.
+ * @param value [in] The string.
+ */
+void
+WriteString (std::ostream &os, const std::string &value)
+{
+  uint32_t length = value.size ();
+  os.write (reinterpret_cast<const char *> (&length), sizeof (length));
+  os.write (value.data (), length);
+}
+
+/**
+ * @ingroup simulator
+ * Read a string of a binary trace header.
+ * @param is [in,out] The trace file.
+ * @param value [out] The string.
+ * @returns \c false if the file is truncated.
+ */
+bool
+ReadString (std::istream &is, std::string &value)
+{
+  uint32_t length;
+  if (!is.read (reinterpret_cast<char *> (&length), sizeof (length)))
+    {
+      return false;
+    }
+  value.resize (length);
+  return length == 0 || is.read (&value[0], length);
+}
+
+} // unnamed namespace
+
 /* static */
 std::string DesMetrics::m_outputDir; // = "";
 
+DesMetrics::DesMetrics (void)
+  : m_initialized (false),
+    m_separator (' '),
+    m_format (JSON),
+    m_child (0)
+{
+}
+
 void 
 DesMetrics::Initialize (int argc, char * argv[], std::string outDir /* = "" */ )
 {
@@ -49,46 +115,79 @@ DesMetrics::Initialize (int argc, char * argv[], std::string outDir /* = "" */ )
 
   m_initialized = true;
 
-  std::string model_name ("desTraceFile");
+  m_modelName = "desTraceFile";
   if (argc)
     {
       std::string arg0 = argv[0];
-      model_name = SystemPath::Split (arg0).back ();
+      m_modelName = SystemPath::Split (arg0).back ();
     }
-  std::string jsonFile = model_name + ".json";
+  EnumValue format;
+  g_desMetricsFormat.GetValue (format);
+  m_format = static_cast<Format> (format.Get ());
+  m_fileName = m_modelName + (m_format == BINARY ? ".desm" : ".json");
   if (outDir != "")
     {
       DesMetrics::m_outputDir = outDir;
     }
   if (DesMetrics::m_outputDir != "")
     {
-      jsonFile = SystemPath::Append (DesMetrics::m_outputDir, jsonFile);
+      m_fileName = SystemPath::Append (DesMetrics::m_outputDir, m_fileName);
     }
 
-  time_t current_time;
-  time (&current_time);
-  const char * date = ctime (&current_time);
-  std::string capture_date (date, 24);  // discard trailing newline from ctime
-
-  m_os.open (jsonFile.c_str ());
-  m_os << "{" << std::endl;
-  m_os << " \"simulator_name\" : \"ns-3\"," << std::endl;
-  m_os << " \"model_name\" : \"" << model_name << "\"," << std::endl;
-  m_os << " \"capture_date\" : \"" << capture_date << "\"," << std::endl;
-  m_os << " \"command_line_arguments\" : \"";
+  m_arguments = "";
   if (argc)
     {
       for (int i = 0; i < argc; ++i) 
         {
-          if (i > 0) m_os << " ";
-          m_os << argv[i];
+          if (i > 0) m_arguments += " ";
+          m_arguments += argv[i];
         }
     }
   else
     {
-      m_os << "[argv empty or not available]";
+      m_arguments = "[argv empty or not available]";
+    }
+
+  Open ();
+}
+
+void
+DesMetrics::Open (void)
+{
+  std::string jsonFile = m_fileName;
+  if (m_child != 0)
+    {
+      std::ostringstream oss;
+      oss << m_fileName << "." << m_child;
+      jsonFile = oss.str ();
+    }
+
+  time_t current_time;
+  time (&current_time);
+  const char * date = ctime (&current_time);
+  std::string capture_date (date, 24);  // discard trailing newline from ctime
+
+  if (m_format == BINARY)
+    {
+      m_os.open (jsonFile.c_str (), std::ios::out | std::ios::binary);
+      uint32_t recordSize = sizeof (Record);
+      uint64_t resolution = TimeStep (1).GetFemtoSeconds ();
+      m_os.write (g_binaryMagic, sizeof (g_binaryMagic));
+      m_os.write (reinterpret_cast<const char *> (&g_binaryVersion), sizeof (g_binaryVersion));
+      m_os.write (reinterpret_cast<const char *> (&recordSize), sizeof (recordSize));
+      m_os.write (reinterpret_cast<const char *> (&resolution), sizeof (resolution));
+      WriteString (m_os, m_modelName);
+      WriteString (m_os, m_arguments);
+      m_records.reserve (BUFFER_RECORDS);
+      return;
     }
-  m_os << "\"," << std::endl;
+
+  m_os.open (jsonFile.c_str ());
+  m_os << "{" << std::endl;
+  m_os << " \"simulator_name\" : \"ns-3\"," << std::endl;
+  m_os << " \"model_name\" : \"" << m_modelName << "\"," << std::endl;
+  m_os << " \"capture_date\" : \"" << capture_date << "\"," << std::endl;
+  m_os << " \"command_line_arguments\" : \"" << m_arguments << "\"," << std::endl;
   m_os << " \"events\" : [" << std::endl;
 
   m_separator = ' ';
@@ -109,6 +208,24 @@ DesMetrics::TraceWithContext (uint32_t context, const Time & now, const Time & d
       Initialize (0, 0);
     }
 
+  if (m_format == BINARY)
+    {
+      Record record;
+      record.sendTime = now.GetTimeStep ();
+      record.recvTime = (now + delay).GetTimeStep ();
+      record.sendContext = Simulator::GetContext ();
+      record.recvContext = context;
+      CriticalSection cs (m_mutex);
+      m_records.push_back (record);
+      if (m_records.size () >= BUFFER_RECORDS)
+        {
+          m_os.write (reinterpret_cast<const char *> (&m_records[0]),
+                      m_records.size () * sizeof (Record));
+          m_records.clear ();
+        }
+      return;
+    }
+
   std::ostringstream ss;
   if (m_separator == ',')
     {
@@ -139,9 +256,76 @@ DesMetrics::~DesMetrics (void)
   Close ();
 }
 
+void
+DesMetrics::Flush (void)
+{
+  CriticalSection cs (m_mutex);
+  if (!m_records.empty ())
+    {
+      m_os.write (reinterpret_cast<const char *> (&m_records[0]),
+                  m_records.size () * sizeof (Record));
+      m_records.clear ();
+    }
+  m_os.flush ();
+}
+
+void
+DesMetrics::AfterFork (uint32_t child)
+{
+  CriticalSection cs (m_mutex);
+  if (child == 0)
+    {
+      return;
+    }
+  // A trace started later in the child goes to its own file as well.
+  m_child = child;
+  if (!m_initialized)
+    {
+      return;
+    }
+  // The trace of the parent was flushed, so closing it here writes
+  // nothing more to it.
+  m_records.clear ();
+  m_os.close ();
+  Open ();
+}
+
+bool
+DesMetrics::ReadBinaryHeader (std::istream &is, BinaryHeader &header)
+{
+  char magic[sizeof (g_binaryMagic)];
+  uint32_t version;
+  uint32_t recordSize;
+  if (!is.read (magic, sizeof (magic))
+      || std::memcmp (magic, g_binaryMagic, sizeof (magic)) != 0
+      || !is.read (reinterpret_cast<char *> (&version), sizeof (version))
+      || version != g_binaryVersion
+      || !is.read (reinterpret_cast<char *> (&recordSize), sizeof (recordSize))
+      || recordSize != sizeof (Record)
+      || !is.read (reinterpret_cast<char *> (&header.resolution), sizeof (header.resolution)))
+    {
+      return false;
+    }
+  return ReadString (is, header.modelName) && ReadString (is, header.commandLine);
+}
+
+bool
+DesMetrics::ReadRecord (std::istream &is, Record &record)
+{
+  return static_cast<bool> (is.read (reinterpret_cast<char *> (&record), sizeof (record)));
+}
+
 void
 DesMetrics::Close (void)
 {
+  if (m_format == BINARY)
+    {
+      Flush ();
+      m_os.close ();
+      m_initialized = false;
+      return;
+    }
+
   m_os << std::endl;    // Finish the last event line
   
   m_os << " ]" << std::endl;
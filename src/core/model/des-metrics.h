@@ -33,7 +33,9 @@
 
 #include <stdint.h>    // uint32_t
 #include <fstream>
+#include <istream>
 #include <string>
+#include <vector>
 
 namespace ns3 {
 
@@ -83,6 +85,29 @@ namespace ns3 {
  * and the event execution time.  Times are given in the
  * current Time resolution.
  *
+ * <b> Binary format </b>
+ *
+ * Formatting a JSON record for each event slows large simulations
+ * down a lot.  With the \c DesMetricsFormat global value set to
+ * \c Binary (for example with \c --DesMetricsFormat=Binary on the
+ * command line), the trace is written to a \c .desm file instead, as
+ * fixed-width records buffered in memory and written in large blocks.
+ * The file starts with a header:
+ * \verbatim
+   char     magic[8]       "ns3desm" and a NUL
+   uint32_t version        1; any other value means another byte order
+   uint32_t recordSize     the size of a Record, 24
+   uint64_t resolution     the length of a time step, in femtoseconds
+   uint32_t length, char[] the model name
+   uint32_t length, char[] the command line \endverbatim
+ * followed by one Record per event, in the byte order of the host
+ * which wrote it.  ReadBinaryHeader() and ReadRecord() read the file,
+ * and the \c des-metrics-stats utility computes from it the lookahead
+ * and the traffic between partitions of the contexts, to help choose
+ * the partitions of a distributed simulation:
+ * \verbatim
+   $ ./waf --run "des-metrics-stats --file=my-program.desm --partitions=4" \endverbatim
+ *
  * <b> Enabling DES Metrics </b>
  *
  * Enable DES Metrics at configure time with
@@ -108,6 +133,33 @@ class DesMetrics : public Singleton<DesMetrics>
 {
 public:
 
+  /** The trace file formats. */
+  enum Format
+  {
+    JSON,     //!< One JSON array per event.
+    BINARY    //!< One fixed-width Record per event.
+  };
+
+  /** An event of a binary trace. */
+  struct Record
+  {
+    int64_t sendTime;       //!< The time the event was scheduled, in time steps.
+    int64_t recvTime;       //!< The time the event runs, in time steps.
+    uint32_t sendContext;   //!< The context which scheduled the event.
+    uint32_t recvContext;   //!< The context of the event.
+  };
+
+  /** The header of a binary trace. */
+  struct BinaryHeader
+  {
+    uint64_t resolution;       //!< The length of a time step, in femtoseconds.
+    std::string modelName;     //!< The name of the program.
+    std::string commandLine;   //!< The command line of the program.
+  };
+
+  /** Constructor. */
+  DesMetrics (void);
+
   /**
    * Open the DesMetrics trace file and print the header.
    *
@@ -137,6 +189,43 @@ public:
    */
   void TraceWithContext (uint32_t context,  const Time & now, const Time & delay);
 
+  /**
+   * Write the buffered records of a binary trace to the trace file.
+   */
+  void Flush (void);
+
+  /**
+   * Give a child of Simulator::ForkAt() a trace file of its own.
+   *
+   * The file inherited from the parent shares its file offset with
+   * the parent, so the child closes it without writing to it, and
+   * writes its trace to a file named after it followed by a dot and
+   * the index of the child.  The trace of the parent must have been
+   * flushed before the fork.
+   *
+   * \param child [in] The index of the child, or 0 in the parent.
+   */
+  void AfterFork (uint32_t child);
+
+  /**
+   * Read the header of a binary trace.
+   *
+   * \param is [in,out] The binary trace.
+   * \param header [out] The header.
+   * \returns \c false if \p is is not a binary trace written on a
+   *          host with the same byte order.
+   */
+  static bool ReadBinaryHeader (std::istream &is, BinaryHeader &header);
+
+  /**
+   * Read the next record of a binary trace.
+   *
+   * \param is [in,out] The binary trace, after its header.
+   * \param record [out] The record.
+   * \returns \c false at the end of the trace.
+   */
+  static bool ReadRecord (std::istream &is, Record &record);
+
   /**
    * Destructor, closes the trace file.
    */
@@ -147,6 +236,12 @@ private:
   /** Close the output file. */
   void Close (void);
 
+  /** Open the output file and write its header. */
+  void Open (void);
+
+  /** The number of records buffered before they are written. */
+  static const uint32_t BUFFER_RECORDS = 16384;
+
   /**
    * Cache the last-used output directory.
    *
@@ -156,8 +251,14 @@ private:
   static std::string m_outputDir;
   
   bool m_initialized;    //!< Have we been initialized.
-  std::ofstream m_os;    //!< The output JSON trace file stream.
+  std::ofstream m_os;    //!< The output trace file stream.
   char m_separator;      //!< The separator between event records.
+  Format m_format;       //!< The format of the trace file.
+  std::vector<Record> m_records;  //!< The buffered records of a binary trace.
+  std::string m_fileName;      //!< The name of the trace file, before the child suffix.
+  std::string m_modelName;     //!< The name of the program.
+  std::string m_arguments;     //!< The command line of the program.
+  uint32_t m_child;            //!< The index of the ForkAt child, or 0.
 
   /** Mutex to control access to the output file. */
   SystemMutex m_mutex;
@@ -20,6 +20,10 @@
 
 #include "event-impl.h"
 #include "log.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
 
 /**
  * \file
@@ -31,6 +35,163 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+namespace {
+
+/**
+ * The live events counted by one thread.
+ *
+ * Only the owning thread updates them, so each update is a plain
+ * load and store, on a cache line of its own; the other threads only
+ * read them.  Since an event may be freed by another thread than the
+ * one which allocated it, the counts of a thread can be negative.
+ */
+struct alignas (64) EventCounters
+{
+  std::atomic<int64_t> live;   //!< Events allocated minus events freed.
+  std::atomic<int64_t> peak;   //!< The largest value of live.
+  bool registered;             //!< Whether the counters are summed.
+  bool retired;                //!< Whether the thread exits.
+};
+
+/**
+ * The counters of the calling thread.  This is trivially destructible,
+ * so that it is still usable by the events deleted when the thread exits.
+ */
+thread_local EventCounters g_counters;
+
+/** The counters of all the threads, and of those which exited. */
+struct EventCounterRegistry
+{
+  std::mutex mutex;                      //!< Protects the other members.
+  std::vector<EventCounters *> threads;  //!< The counters of the running threads.
+  int64_t retiredLive;                   //!< The live events of the exited threads.
+};
+
+/**
+ * Get the registry of the counters.
+ * \returns The registry.
+ */
+EventCounterRegistry &
+GetRegistry (void)
+{
+  static EventCounterRegistry *registry = new EventCounterRegistry ();
+  return *registry;
+}
+
+/** Add the counters of a thread to the retired ones when it exits. */
+struct EventCounterRetirer
+{
+  ~EventCounterRetirer ()
+  {
+    EventCounterRegistry &registry = GetRegistry ();
+    std::lock_guard<std::mutex> lock (registry.mutex);
+    for (std::vector<EventCounters *>::iterator i = registry.threads.begin ();
+         i != registry.threads.end (); ++i)
+      {
+        if (*i == &g_counters)
+          {
+            registry.threads.erase (i);
+            break;
+          }
+      }
+    registry.retiredLive += g_counters.live.load (std::memory_order_relaxed);
+    g_counters.retired = true;
+  }
+};
+/** The retirer of the counters of the calling thread. */
+thread_local EventCounterRetirer g_counterRetirer;
+
+/**
+ * Count the events of a thread whose counters are not summed yet,
+ * or not anymore.
+ *
+ * \param [in] delta The events allocated, or freed if negative.
+ */
+void
+CountSlow (int64_t delta)
+{
+  EventCounterRegistry &registry = GetRegistry ();
+  std::lock_guard<std::mutex> lock (registry.mutex);
+  if (g_counters.retired)
+    {
+      registry.retiredLive += delta;
+      return;
+    }
+  registry.threads.push_back (&g_counters);
+  // make sure the counters are retired on exit
+  (void)&g_counterRetirer;
+  g_counters.registered = true;
+  g_counters.live.store (delta, std::memory_order_relaxed);
+  g_counters.peak.store (std::max<int64_t> (delta, 0), std::memory_order_relaxed);
+}
+
+} // unnamed namespace
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  if (g_counters.registered && !g_counters.retired)
+    {
+      int64_t live = g_counters.live.load (std::memory_order_relaxed) + 1;
+      g_counters.live.store (live, std::memory_order_relaxed);
+      if (live > g_counters.peak.load (std::memory_order_relaxed))
+        {
+          g_counters.peak.store (live, std::memory_order_relaxed);
+        }
+    }
+  else
+    {
+      CountSlow (1);
+    }
+  return EventImpl::Allocator::Allocate (size);
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  if (g_counters.registered && !g_counters.retired)
+    {
+      g_counters.live.store (g_counters.live.load (std::memory_order_relaxed) - 1,
+                             std::memory_order_relaxed);
+    }
+  else
+    {
+      CountSlow (-1);
+    }
+  EventImpl::Allocator::Deallocate (p, size);
+}
+
+uint64_t
+EventImpl::GetLiveCount (void)
+{
+  EventCounterRegistry &registry = GetRegistry ();
+  std::lock_guard<std::mutex> lock (registry.mutex);
+  int64_t live = registry.retiredLive;
+  for (std::vector<EventCounters *>::const_iterator i = registry.threads.begin ();
+       i != registry.threads.end (); ++i)
+    {
+      live += (*i)->live.load (std::memory_order_relaxed);
+    }
+  return live;
+}
+
+uint64_t
+EventImpl::GetPeakCount (void)
+{
+  return std::max<int64_t> (g_counters.peak.load (std::memory_order_relaxed), 0);
+}
+
+void
+EventImpl::ResetPeakCount (void)
+{
+  g_counters.peak.store (g_counters.live.load (std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+}
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
@@ -59,6 +220,15 @@ EventImpl::Cancel (void)
   m_cancel = true;
 }
 
+EventImpl::Function
+EventImpl::GetFunction (void) const
+{
+  Function function;
+  function.type = &typeid (*this);
+  std::memset (function.pointer, 0, sizeof (function.pointer));
+  return function;
+}
+
 bool
 EventImpl::IsCancelled (void)
 {
@@ -21,7 +21,11 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
+#include <cstring>
+#include <typeinfo>
 #include "simple-ref-count.h"
+#include "size-class-allocator.h"
 
 /**
  * \file
@@ -40,6 +44,12 @@ namespace ns3 {
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * Events are short-lived and created at a high rate, so their memory
+ * is recycled: freed events are kept on per-thread free lists, one per
+ * size class, and reused by the next events of the same size.  The
+ * number of live events can be monitored with GetLiveCount(), in all
+ * threads, and GetPeakCount(), in the calling thread.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
@@ -66,6 +76,74 @@ public:
    */
   bool IsCancelled (void);
 
+  /** The allocator of the events: larger events are not recycled. */
+  typedef SizeClassAllocator<EventImpl, 16> Allocator;
+
+  /**
+   * Allocate the memory of an event from the free list of its size class.
+   *
+   * \param [in] size The size of the event object.
+   * \returns The memory block.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Release the memory of an event to the free list of its size class.
+   *
+   * \param [in] p The memory block.
+   * \param [in] size The size of the event object.
+   */
+  static void operator delete (void *p, std::size_t size);
+
+  /**
+   * Get the number of events currently allocated, in all threads.
+   *
+   * \returns The number of live events.
+   */
+  static uint64_t GetLiveCount (void);
+  /**
+   * Get the largest number of events allocated at the same time by
+   * the calling thread since it started or last called
+   * ResetPeakCount().
+   *
+   * The number of events of a thread is the number of events it
+   * allocated minus the number of events it freed, so this is the
+   * peak number of live events of a simulation run by this thread
+   * alone.  It is meaningless for a thread which frees the events of
+   * other threads, or whose events other threads free, as with
+   * MultithreadedSimulatorImpl.
+   *
+   * \returns The peak number of live events of the calling thread.
+   */
+  static uint64_t GetPeakCount (void);
+  /**
+   * Reset the peak number of live events of the calling thread to its
+   * current number.
+   */
+  static void ResetPeakCount (void);
+
+  /**
+   * Identify the function invoked by an event.
+   *
+   * This is used by the event profiler to attribute events to the
+   * model code they run.
+   */
+  struct Function
+  {
+    /** The dynamic type of the event, or 0 for unknown. */
+    const std::type_info *type;
+    /** The representation of the function pointer, or zeros. */
+    uint8_t pointer[16];
+  };
+  /**
+   * Get the function this event invokes.
+   *
+   * The events made by MakeEvent() report their function pointer;
+   * the default implementation only reports the type of the event.
+   *
+   * \returns The function identifier.
+   */
+  virtual Function GetFunction (void) const;
+
 protected:
   /**
    * Implementation for Invoke().
@@ -75,10 +153,42 @@ protected:
    */
   virtual void Notify (void) = 0;
 
+  /**
+   * Build the identifier of a function invoked by an event.
+   *
+   * \tparam F \deduced The type of the function or method pointer.
+   * \param [in] type The dynamic type of the event.
+   * \param [in] f The function or method pointer.
+   * \returns The function identifier.
+   */
+  template <typename F>
+  static Function MakeFunction (const std::type_info &type, F f);
+
 private:
   bool m_cancel;  /**< Has this event been cancelled. */
 };
 
 } // namespace ns3
 
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename F>
+EventImpl::Function
+EventImpl::MakeFunction (const std::type_info &type, F f)
+{
+  Function function;
+  function.type = &type;
+  std::memset (function.pointer, 0, sizeof (function.pointer));
+  std::memcpy (function.pointer, &f,
+               sizeof (F) < sizeof (function.pointer) ? sizeof (F) : sizeof (function.pointer));
+  return function;
+}
+
+} // namespace ns3
+
 #endif /* EVENT_IMPL_H */
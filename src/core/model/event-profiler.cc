@@ -0,0 +1,301 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+#include "simulator.h"
+#include "log.h"
+#include "ns3/core-config.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <cxxabi.h>
+#ifdef HAVE_DLFCN_H
+#include <dlfcn.h>
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventProfiler");
+
+namespace {
+
+/**
+ * Demangle a C++ symbol or type name.
+ *
+ * \param [in] mangled The mangled name.
+ * \returns The demangled name, or \p mangled if it cannot be demangled.
+ */
+std::string
+Demangle (const char *mangled)
+{
+  int status;
+  char *demangled = abi::__cxa_demangle (mangled, 0, 0, &status);
+  if (status != 0 || demangled == 0)
+    {
+      return mangled;
+    }
+  std::string name = demangled;
+  std::free (demangled);
+  return name;
+}
+
+/** Statistics of a function or context, for the report. */
+struct ReportLine
+{
+  std::string name;         //!< The function or context name.
+  uint64_t count;           //!< Number of events.
+  uint64_t time;            //!< Total time, in nanoseconds.
+  uint64_t queueDepthSum;   //!< Sum of the queue depths.
+  uint32_t queueDepthMax;   //!< Largest queue depth.
+};
+
+/**
+ * Order report lines by decreasing time.
+ *
+ * \param [in] a The first line.
+ * \param [in] b The second line.
+ * \returns \c true if \p a comes first.
+ */
+bool
+ByDecreasingTime (const ReportLine &a, const ReportLine &b)
+{
+  if (a.time != b.time)
+    {
+      return a.time > b.time;
+    }
+  return a.name < b.name;
+}
+
+/**
+ * Get the name of a context.
+ *
+ * \param [in] context The context.
+ * \returns The name.
+ */
+std::string
+GetContextName (uint32_t context)
+{
+  if (context == Simulator::NO_CONTEXT)
+    {
+      return "no context";
+    }
+  std::ostringstream oss;
+  oss << "context " << context;
+  return oss.str ();
+}
+
+/**
+ * Write a table of the report.
+ *
+ * \param [in,out] os The output stream.
+ * \param [in] title The title of the name column.
+ * \param [in] lines The lines, sorted.
+ * \param [in] total The total time, in nanoseconds.
+ */
+void
+WriteTable (std::ostream &os, const std::string &title,
+            const std::vector<ReportLine> &lines, uint64_t total)
+{
+  os << std::setw (12) << "Time (s)"
+     << std::setw (9) << "Share"
+     << std::setw (14) << "Events"
+     << std::setw (12) << "Mean (us)"
+     << std::setw (12) << "Queue avg"
+     << std::setw (12) << "Queue max"
+     << "  " << title << std::endl;
+  for (std::vector<ReportLine>::const_iterator i = lines.begin (); i != lines.end (); ++i)
+    {
+      os << std::fixed
+         << std::setw (12) << std::setprecision (6) << i->time / 1e9
+         << std::setw (8) << std::setprecision (2) << (total ? 100.0 * i->time / total : 0.0) << "%"
+         << std::setw (14) << i->count
+         << std::setw (12) << std::setprecision (3) << (i->count ? i->time / 1e3 / i->count : 0.0)
+         << std::setw (12) << std::setprecision (1) << (i->count ? double (i->queueDepthSum) / i->count : 0.0)
+         << std::setw (12) << i->queueDepthMax
+         << "  " << i->name << std::endl;
+    }
+}
+
+} // unnamed namespace
+
+std::size_t
+EventProfiler::FunctionHash::operator () (const EventImpl::Function &f) const
+{
+  uint64_t h = reinterpret_cast<uintptr_t> (f.type);
+  for (uint32_t i = 0; i < sizeof (f.pointer); i += sizeof (uint64_t))
+    {
+      uint64_t word;
+      std::memcpy (&word, f.pointer + i, sizeof (word));
+      h = (h ^ word) * 0x100000001b3ULL;
+    }
+  return h ^ (h >> 32);
+}
+
+bool
+EventProfiler::FunctionEqual::operator () (const EventImpl::Function &a, const EventImpl::Function &b) const
+{
+  return a.type == b.type && std::memcmp (a.pointer, b.pointer, sizeof (a.pointer)) == 0;
+}
+
+EventProfiler::EventProfiler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+EventProfiler::Stats &
+EventProfiler::GetStats (const EventImpl::Function &function, uint32_t context)
+{
+  std::pair<std::unordered_map<EventImpl::Function, uint32_t, FunctionHash, FunctionEqual>::iterator, bool> f =
+    m_functionIndex.insert (std::make_pair (function, static_cast<uint32_t> (m_functions.size ())));
+  if (f.second)
+    {
+      m_functions.push_back (function);
+    }
+  uint64_t key = (static_cast<uint64_t> (f.first->second) << 32) | context;
+  // a new Stats is value-initialized, i.e., zeroed
+  return m_stats[key];
+}
+
+void
+EventProfiler::Record (const EventImpl *event, uint32_t context, uint64_t duration, uint32_t queueDepth)
+{
+  Stats &stats = GetStats (event->GetFunction (), context);
+  stats.count++;
+  stats.time += duration;
+  stats.queueDepthSum += queueDepth;
+  stats.queueDepthMax = std::max (stats.queueDepthMax, queueDepth);
+}
+
+void
+EventProfiler::RecordCancelled (uint32_t context)
+{
+  EventImpl::Function cancelled;
+  cancelled.type = 0;
+  std::memset (cancelled.pointer, 0, sizeof (cancelled.pointer));
+  GetStats (cancelled, context).count++;
+}
+
+std::string
+EventProfiler::GetName (const EventImpl::Function &function)
+{
+  if (function.type == 0)
+    {
+      return "(cancelled events)";
+    }
+#ifdef HAVE_DLFCN_H
+  // Function pointers, and pointers to non-virtual methods with the
+  // Itanium C++ ABI, start with the address of the code.
+  void *address;
+  std::memcpy (&address, function.pointer, sizeof (address));
+  Dl_info info;
+  if (address != 0
+      && dladdr (address, &info) != 0
+      && info.dli_sname != 0
+      && info.dli_saddr == address)
+    {
+      return Demangle (info.dli_sname);
+    }
+#endif /* HAVE_DLFCN_H */
+  return Demangle (function.type->name ());
+}
+
+void
+EventProfiler::Write (std::ostream &os, Format format) const
+{
+  NS_LOG_FUNCTION (this << &os << format);
+  std::vector<std::string> names;
+  for (std::vector<EventImpl::Function>::const_iterator i = m_functions.begin (); i != m_functions.end (); ++i)
+    {
+      names.push_back (GetName (*i));
+    }
+
+  if (format == FOLDED)
+    {
+      std::map<std::string, uint64_t> stacks;
+      for (std::unordered_map<uint64_t, Stats>::const_iterator i = m_stats.begin (); i != m_stats.end (); ++i)
+        {
+          std::string name = names[i->first >> 32];
+          // ';' separates the frames of a stack
+          std::replace (name.begin (), name.end (), ';', ',');
+          stacks[GetContextName (i->first & 0xffffffff) + ";" + name] += i->second.time;
+        }
+      for (std::map<std::string, uint64_t>::const_iterator i = stacks.begin (); i != stacks.end (); ++i)
+        {
+          if (i->second != 0)
+            {
+              os << i->first << " " << i->second << std::endl;
+            }
+        }
+      return;
+    }
+
+  // Merge the statistics by function and by context; several
+  // functions may have the same name.
+  std::map<std::string, ReportLine> byFunction;
+  std::map<uint32_t, ReportLine> byContext;
+  uint64_t totalTime = 0;
+  uint64_t totalCount = 0;
+  for (std::unordered_map<uint64_t, Stats>::const_iterator i = m_stats.begin (); i != m_stats.end (); ++i)
+    {
+      const Stats &stats = i->second;
+      const std::string &name = names[i->first >> 32];
+      uint32_t context = i->first & 0xffffffff;
+      ReportLine *lines[2] = { &byFunction[name], &byContext[context] };
+      lines[0]->name = name;
+      lines[1]->name = GetContextName (context);
+      for (uint32_t j = 0; j < 2; ++j)
+        {
+          lines[j]->count += stats.count;
+          lines[j]->time += stats.time;
+          lines[j]->queueDepthSum += stats.queueDepthSum;
+          lines[j]->queueDepthMax = std::max (lines[j]->queueDepthMax, stats.queueDepthMax);
+        }
+      totalTime += stats.time;
+      totalCount += stats.count;
+    }
+
+  std::vector<ReportLine> lines;
+  os << "Event profile: " << totalCount << " events, "
+     << std::fixed << std::setprecision (6) << totalTime / 1e9 << " s" << std::endl
+     << std::endl << "By function:" << std::endl;
+  for (std::map<std::string, ReportLine>::const_iterator i = byFunction.begin (); i != byFunction.end (); ++i)
+    {
+      lines.push_back (i->second);
+    }
+  std::sort (lines.begin (), lines.end (), ByDecreasingTime);
+  WriteTable (os, "Function", lines, totalTime);
+
+  lines.clear ();
+  os << std::endl << "By context:" << std::endl;
+  for (std::map<uint32_t, ReportLine>::const_iterator i = byContext.begin (); i != byContext.end (); ++i)
+    {
+      lines.push_back (i->second);
+    }
+  std::sort (lines.begin (), lines.end (), ByDecreasingTime);
+  WriteTable (os, "Context", lines, totalTime);
+}
+
+} // namespace ns3
@@ -0,0 +1,159 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include "event-impl.h"
+#include <stdint.h>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \brief Attribute the wall clock time spent running events to the
+ * functions they invoke and to their context.
+ *
+ * The simulator implementation measures each event it runs and calls
+ * Record(); at the end of the simulation, Write() prints the profile,
+ * either as a report sorted by decreasing time, or as "folded stacks"
+ * (one <tt>context;function nanoseconds</tt> line per pair) which can
+ * be turned into a flame graph by <tt>flamegraph.pl</tt>.
+ *
+ * The functions are named after their symbol when it can be found
+ * with \c dladdr, and otherwise after the type of their event, which
+ * gives the class and signature of the function.
+ */
+class EventProfiler
+{
+public:
+  /** The output formats. */
+  enum Format
+  {
+    REPORT,    //!< Tables sorted by decreasing time.
+    FOLDED     //!< Folded stacks, for flame graphs.
+  };
+
+  /** Constructor. */
+  EventProfiler ();
+
+  /**
+   * Get the current wall clock time.
+   *
+   * \returns The time, in nanoseconds from an arbitrary origin.
+   */
+  static inline uint64_t Now (void);
+  /**
+   * Record the run of an event.
+   *
+   * \param [in] event The event.
+   * \param [in] context The context of the event.
+   * \param [in] duration The wall clock time spent running it, in nanoseconds.
+   * \param [in] queueDepth The number of events pending when it ran.
+   */
+  void Record (const EventImpl *event, uint32_t context, uint64_t duration, uint32_t queueDepth);
+  /**
+   * Record a cancelled event reaching the head of the event list.
+   *
+   * \param [in] context The context of the event.
+   */
+  void RecordCancelled (uint32_t context);
+  /**
+   * Write the profile.
+   *
+   * \param [in,out] os The output stream.
+   * \param [in] format The output format.
+   */
+  void Write (std::ostream &os, Format format) const;
+
+private:
+  /** Accumulated statistics. */
+  struct Stats
+  {
+    uint64_t count;           //!< Number of events.
+    uint64_t time;            //!< Total wall clock time, in nanoseconds.
+    uint64_t queueDepthSum;   //!< Sum of the queue depths sampled.
+    uint32_t queueDepthMax;   //!< Largest queue depth sampled.
+  };
+  /** Hash an EventImpl::Function. */
+  struct FunctionHash
+  {
+    /**
+     * \param [in] f The function.
+     * \returns The hash value.
+     */
+    std::size_t operator () (const EventImpl::Function &f) const;
+  };
+  /** Compare two EventImpl::Function. */
+  struct FunctionEqual
+  {
+    /**
+     * \param [in] a The first function.
+     * \param [in] b The second function.
+     * \returns \c true if they are the same function.
+     */
+    bool operator () (const EventImpl::Function &a, const EventImpl::Function &b) const;
+  };
+
+  /**
+   * Get the statistics of a function on a context.
+   *
+   * \param [in] function The function.
+   * \param [in] context The context.
+   * \returns The statistics.
+   */
+  Stats & GetStats (const EventImpl::Function &function, uint32_t context);
+  /**
+   * Get a readable name for a function.
+   *
+   * \param [in] function The function.
+   * \returns The name.
+   */
+  static std::string GetName (const EventImpl::Function &function);
+
+  /** The index of each function seen. */
+  std::unordered_map<EventImpl::Function, uint32_t, FunctionHash, FunctionEqual> m_functionIndex;
+  /** The functions seen, by index. */
+  std::vector<EventImpl::Function> m_functions;
+  /** The statistics, by function index (high word) and context (low word). */
+  std::unordered_map<uint64_t, Stats> m_stats;
+};
+
+/********************************************************************
+ *  Implementation of the inline methods declared above.
+ ********************************************************************/
+
+uint64_t
+EventProfiler::Now (void)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>
+           (std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+}
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
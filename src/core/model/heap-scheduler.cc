@@ -206,6 +206,36 @@ HeapScheduler::Insert (const Event &ev)
   BottomUp ();
 }
 
+void
+HeapScheduler::InsertSorted (const std::vector<Event> &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+  uint32_t size = GetSize ();
+  uint32_t n = events.size ();
+  // n insertions cost about n log (size) exchanges, and rebuilding the
+  // heap about 2 (size + n): rebuild it when the batch is large enough.
+  uint32_t log = 1;
+  while ((size >> log) != 0)
+    {
+      log++;
+    }
+  if (n * log <= 2 * (size + n))
+    {
+      for (std::vector<Event>::const_iterator i = events.begin (); i != events.end (); ++i)
+        {
+          m_heap.push_back (*i);
+          BottomUp ();
+        }
+      return;
+    }
+  m_heap.insert (m_heap.end (), events.begin (), events.end ());
+  // restore the heap property, from the last parent up to the root
+  for (uint32_t i = Last () / 2; i >= Root (); i--)
+    {
+      TopDown (i);
+    }
+}
+
 Scheduler::Event
 HeapScheduler::PeekNext (void) const
 {
@@ -220,6 +250,7 @@ HeapScheduler::RemoveNext (void)
   Exch (Root (), Last ());
   m_heap.pop_back ();
   TopDown (Root ());
+  NotifyRemoved (next);
   return next;
 }
 
@@ -243,5 +274,38 @@ HeapScheduler::Remove (const Event &ev)
   NS_ASSERT (false);
 }
 
+uint32_t
+HeapScheduler::GetSize (void) const
+{
+  return m_heap.size () - 1;
+}
+
+uint32_t
+HeapScheduler::DoCompact (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t last = Root ();
+  for (uint32_t i = Root (); i < m_heap.size (); i++)
+    {
+      if (m_heap[i].impl->IsCancelled ())
+        {
+          m_heap[i].impl->Unref ();
+        }
+      else
+        {
+          m_heap[last] = m_heap[i];
+          last++;
+        }
+    }
+  uint32_t removed = m_heap.size () - last;
+  m_heap.resize (last);
+  // restore the heap property, from the last parent up to the root
+  for (uint32_t i = Last () / 2; i >= Root (); i--)
+    {
+      TopDown (i);
+    }
+  return removed;
+}
+
 } // namespace ns3
 
@@ -0,0 +1,369 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include <algorithm>
+#include "assert.h"
+#include "log.h"
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topMin (~0ULL),
+    m_topMax (0),
+    m_topStart (0),
+    m_nRungs (0),
+    m_bottomHead (0),
+    m_qSize (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_rungs.resize (MAX_RUNGS);
+}
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+LadderScheduler::CurrentStart (const Rung &rung) const
+{
+  return rung.start + rung.current * rung.width;
+}
+
+uint32_t
+LadderScheduler::FindRung (uint64_t ts) const
+{
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      if (ts >= CurrentStart (m_rungs[i]))
+        {
+          return i;
+        }
+    }
+  return m_nRungs;
+}
+
+LadderScheduler::Rung &
+LadderScheduler::PushRung (uint64_t start, uint64_t span, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << start << span << n);
+  NS_ASSERT (m_nRungs < MAX_RUNGS && n > 0);
+  Rung &rung = m_rungs[m_nRungs];
+  m_nRungs++;
+  // about one event per bucket
+  rung.width = span / n;
+  if (rung.width * n < span)
+    {
+      rung.width++;
+    }
+  rung.nBuckets = (span + rung.width - 1) / rung.width;
+  if (rung.buckets.size () < rung.nBuckets)
+    {
+      rung.buckets.resize (rung.nBuckets);
+    }
+  rung.start = start;
+  rung.current = 0;
+  rung.count = 0;
+  NS_LOG_LOGIC ("rung " << m_nRungs - 1 << ": nBuckets=" << rung.nBuckets << ", width=" << rung.width);
+  return rung;
+}
+
+void
+LadderScheduler::InsertBottom (const Event &ev)
+{
+  Bucket::iterator i = std::upper_bound (m_bottom.begin () + m_bottomHead, m_bottom.end (), ev);
+  m_bottom.insert (i, ev);
+}
+
+bool
+LadderScheduler::InsertAbove (const Event &ev)
+{
+  if (m_qSize == 0)
+    {
+      // start over, so that the new events are spread again
+      m_nRungs = 0;
+      m_bottom.clear ();
+      m_bottomHead = 0;
+      m_topStart = 0;
+    }
+  m_qSize++;
+
+  uint64_t ts = ev.key.m_ts;
+  if (ts >= m_topStart)
+    {
+      m_top.push_back (ev);
+      m_topMin = std::min (m_topMin, ts);
+      m_topMax = std::max (m_topMax, ts);
+      return true;
+    }
+  uint32_t i = FindRung (ts);
+  if (i < m_nRungs)
+    {
+      Rung &rung = m_rungs[i];
+      rung.buckets[(ts - rung.start) / rung.width].push_back (ev);
+      rung.count++;
+      return true;
+    }
+  return false;
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  if (!InsertAbove (ev))
+    {
+      InsertBottom (ev);
+    }
+}
+
+void
+LadderScheduler::InsertSorted (const std::vector<Event> &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+  // Append the events of the bottom, already sorted, and merge them
+  // with the bottom once, rather than inserting them one by one.
+  Bucket::size_type sorted = m_bottom.size ();
+  for (std::vector<Event>::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      if (m_qSize == 0)
+        {
+          sorted = 0;
+        }
+      if (!InsertAbove (*i))
+        {
+          m_bottom.push_back (*i);
+        }
+    }
+  if (m_bottom.size () > sorted)
+    {
+      std::inplace_merge (m_bottom.begin () + m_bottomHead,
+                          m_bottom.begin () + sorted,
+                          m_bottom.end ());
+    }
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  return m_qSize == 0;
+}
+
+void
+LadderScheduler::FillBottom (void)
+{
+  if (m_bottomHead < m_bottom.size ())
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  m_bottom.clear ();
+  m_bottomHead = 0;
+  while (true)
+    {
+      if (m_nRungs == 0)
+        {
+          NS_ASSERT (!m_top.empty ());
+          // spread the top on the first rung
+          Rung &rung = PushRung (m_topMin, m_topMax - m_topMin + 1, m_top.size ());
+          for (Bucket::const_iterator i = m_top.begin (); i != m_top.end (); ++i)
+            {
+              rung.buckets[(i->key.m_ts - rung.start) / rung.width].push_back (*i);
+            }
+          rung.count = m_top.size ();
+          m_topStart = m_topMax + 1;
+          m_top.clear ();
+          m_topMin = ~0ULL;
+          m_topMax = 0;
+        }
+      Rung &rung = m_rungs[m_nRungs - 1];
+      if (rung.count == 0)
+        {
+          m_nRungs--;
+          continue;
+        }
+      while (rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+        }
+      Bucket &bucket = rung.buckets[rung.current];
+      uint64_t bucketStart = CurrentStart (rung);
+      rung.current++;
+      rung.count -= bucket.size ();
+      if (bucket.size () > THRESHOLD && rung.width > 1 && m_nRungs < MAX_RUNGS)
+        {
+          // too many events to sort: spread them on a finer rung
+          Rung &child = PushRung (bucketStart, rung.width, bucket.size ());
+          for (Bucket::const_iterator i = bucket.begin (); i != bucket.end (); ++i)
+            {
+              child.buckets[(i->key.m_ts - child.start) / child.width].push_back (*i);
+            }
+          child.count = bucket.size ();
+          bucket.clear ();
+          continue;
+        }
+      // swap rather than copy, to keep the storage of both arrays
+      m_bottom.swap (bucket);
+      std::sort (m_bottom.begin (), m_bottom.end ());
+      return;
+    }
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  // Sorting the next bucket does not change the content of the queue.
+  const_cast<LadderScheduler *> (this)->FillBottom ();
+  return m_bottom[m_bottomHead];
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  FillBottom ();
+  Scheduler::Event ev = m_bottom[m_bottomHead];
+  m_bottomHead++;
+  m_qSize--;
+  NotifyRemoved (ev);
+  NS_LOG_LOGIC ("remove ts=" << ev.key.m_ts << ", key=" << ev.key.m_uid);
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!IsEmpty ());
+  uint64_t ts = ev.key.m_ts;
+  Bucket *bucket;
+  if (ts >= m_topStart)
+    {
+      bucket = &m_top;
+    }
+  else
+    {
+      uint32_t i = FindRung (ts);
+      if (i == m_nRungs)
+        {
+          Bucket::iterator j = std::lower_bound (m_bottom.begin () + m_bottomHead, m_bottom.end (), ev);
+          NS_ASSERT (j != m_bottom.end () && j->key.m_uid == ev.key.m_uid);
+          m_bottom.erase (j);
+          m_qSize--;
+          return;
+        }
+      Rung &rung = m_rungs[i];
+      bucket = &rung.buckets[(ts - rung.start) / rung.width];
+      rung.count--;
+    }
+  for (Bucket::iterator j = bucket->begin (); j != bucket->end (); ++j)
+    {
+      if (j->key.m_uid == ev.key.m_uid)
+        {
+          NS_ASSERT (ev.impl == j->impl);
+          // buckets are not sorted: move the last event in the hole
+          *j = bucket->back ();
+          bucket->pop_back ();
+          if (m_top.empty ())
+            {
+              m_topMin = ~0ULL;
+              m_topMax = 0;
+            }
+          m_qSize--;
+          return;
+        }
+    }
+  NS_ASSERT (false);
+}
+
+uint32_t
+LadderScheduler::GetSize (void) const
+{
+  return m_qSize;
+}
+
+uint32_t
+LadderScheduler::RemoveCancelled (Bucket &bucket, uint32_t first)
+{
+  uint32_t last = first;
+  for (uint32_t i = first; i < bucket.size (); i++)
+    {
+      if (bucket[i].impl->IsCancelled ())
+        {
+          bucket[i].impl->Unref ();
+        }
+      else
+        {
+          bucket[last] = bucket[i];
+          last++;
+        }
+    }
+  uint32_t removed = bucket.size () - last;
+  bucket.resize (last);
+  return removed;
+}
+
+uint32_t
+LadderScheduler::DoCompact (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t removed = RemoveCancelled (m_top, 0);
+  if (m_top.empty ())
+    {
+      m_topMin = ~0ULL;
+      m_topMax = 0;
+    }
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      Rung &rung = m_rungs[i];
+      for (uint32_t j = rung.current; j < rung.nBuckets; j++)
+        {
+          uint32_t n = RemoveCancelled (rung.buckets[j], 0);
+          rung.count -= n;
+          removed += n;
+        }
+    }
+  removed += RemoveCancelled (m_bottom, m_bottomHead);
+  m_qSize -= removed;
+  return removed;
+}
+
+} // namespace ns3
@@ -0,0 +1,182 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue described in
+ * "Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by Wai Teng Tang, Rick Siow Mong Goh
+ * and Ian Li-Jin Thng (ACM TOMACS, 2005).
+ *
+ * The events are kept in three tiers:
+ *  - the top, an unsorted array of the events far in the future;
+ *  - the ladder, a stack of rungs of unsorted buckets, each rung
+ *    spreading the events of one bucket of the rung above;
+ *  - the bottom, a small sorted array of the earliest events.
+ *
+ * Events are only sorted when they reach the bottom, and a bucket
+ * which holds too many events to be sorted cheaply is spread on a
+ * new, finer, rung instead. The bucket widths thus adapt to the
+ * event distribution without the periodic resizing of the calendar
+ * queue, and insert and remove-next run in amortized constant time.
+ * All the tiers are arrays whose storage is reused, so that in steady
+ * state no memory is allocated per event.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual void InsertSorted (const std::vector<Scheduler::Event> &events);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+  virtual uint32_t GetSize (void) const;
+
+private:
+  // Inherited
+  virtual uint32_t DoCompact (void);
+
+  /** An array of unsorted events. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /** One rung of the ladder. */
+  struct Rung
+  {
+    /** The buckets; only the first \c nBuckets are in use. */
+    std::vector<Bucket> buckets;
+    /** Number of buckets in use. */
+    uint32_t nBuckets;
+    /** Duration of a bucket, in dimensionless time units. */
+    uint64_t width;
+    /** Start time of the first bucket. */
+    uint64_t start;
+    /** Index of the first bucket which has not been dequeued. */
+    uint32_t current;
+    /** Number of events in the rung. */
+    uint32_t count;
+  };
+
+  /**
+   * Get the start time of the current bucket of a rung.
+   *
+   * \param [in] rung The rung.
+   * \returns The start time of the current bucket.
+   */
+  inline uint64_t CurrentStart (const Rung &rung) const;
+  /**
+   * Find the rung an event belongs to.
+   *
+   * \param [in] ts The event timestamp.
+   * \returns The index of the rung, or \c m_nRungs for the bottom.
+   */
+  uint32_t FindRung (uint64_t ts) const;
+  /**
+   * Prepare a new rung at the bottom of the ladder.
+   *
+   * \param [in] start The start time of the first bucket.
+   * \param [in] span The time interval covered by the rung.
+   * \param [in] n The number of events which will be spread.
+   * \returns The new rung.
+   */
+  Rung & PushRung (uint64_t start, uint64_t span, uint32_t n);
+  /**
+   * Insert an event in the sorted bottom.
+   *
+   * \param [in] ev The event.
+   */
+  void InsertBottom (const Scheduler::Event &ev);
+  /**
+   * Count a new event, and insert it in the top or in a rung.
+   *
+   * \param [in] ev The event.
+   * \returns \c false if the event belongs to the bottom, where
+   *          it was not inserted.
+   */
+  bool InsertAbove (const Scheduler::Event &ev);
+  /**
+   * Remove and Unref the cancelled events of a bucket.
+   *
+   * \param [in,out] bucket The bucket.
+   * \param [in] first The index of the first event to check.
+   * \returns The number of events removed.
+   */
+  static uint32_t RemoveCancelled (Bucket &bucket, uint32_t first);
+  /** Move the earliest events to the bottom if it is empty. */
+  void FillBottom (void);
+
+  /**
+   * Maximum number of events in a bucket sorted into the bottom,
+   * beyond which the bucket is spread on a new rung.
+   */
+  static const uint32_t THRESHOLD = 50;
+  /** Maximum number of rungs. */
+  static const uint32_t MAX_RUNGS = 8;
+
+  /** The events far in the future. */
+  Bucket m_top;
+  /** Smallest timestamp in the top. */
+  uint64_t m_topMin;
+  /** Largest timestamp in the top. */
+  uint64_t m_topMax;
+  /** Events at or after this timestamp go to the top. */
+  uint64_t m_topStart;
+  /** The rungs; only the first \c m_nRungs are in use. */
+  std::vector<Rung> m_rungs;
+  /** Number of rungs in use. */
+  uint32_t m_nRungs;
+  /** The earliest events, sorted, starting at \c m_bottomHead. */
+  Bucket m_bottom;
+  /** Index of the first event of the bottom. */
+  uint32_t m_bottomHead;
+  /** Number of events in queue. */
+  uint32_t m_qSize;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
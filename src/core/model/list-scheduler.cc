@@ -70,6 +70,22 @@ ListScheduler::Insert (const Event &ev)
     }
   m_events.push_back (ev);
 }
+void
+ListScheduler::InsertSorted (const std::vector<Event> &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+  // Merge: each event goes after the previous one.
+  EventsI i = m_events.begin ();
+  for (std::vector<Event>::const_iterator j = events.begin (); j != events.end (); ++j)
+    {
+      while (i != m_events.end () && !(j->key < i->key))
+        {
+          i++;
+        }
+      m_events.insert (i, *j);
+    }
+}
+
 bool
 ListScheduler::IsEmpty (void) const
 {
@@ -89,6 +105,7 @@ ListScheduler::RemoveNext (void)
   NS_LOG_FUNCTION (this);
   Event next = m_events.front ();
   m_events.pop_front ();
+  NotifyRemoved (next);
   return next;
 }
 
@@ -108,4 +125,32 @@ ListScheduler::Remove (const Event &ev)
   NS_ASSERT (false);
 }
 
+uint32_t
+ListScheduler::GetSize (void) const
+{
+  return m_events.size ();
+}
+
+uint32_t
+ListScheduler::DoCompact (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t removed = 0;
+  EventsI i = m_events.begin ();
+  while (i != m_events.end ())
+    {
+      if (i->impl->IsCancelled ())
+        {
+          i->impl->Unref ();
+          i = m_events.erase (i);
+          removed++;
+        }
+      else
+        {
+          i++;
+        }
+    }
+  return removed;
+}
+
 } // namespace ns3
@@ -0,0 +1,715 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "log.h"
+#include "ns3/core-config.h"
+#include "fatal-error.h"
+#include "mpsc-queue.h"
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <streambuf>
+#include <unordered_map>
+#include <vector>
+
+#ifdef HAVE_PTHREAD_H
+#include <thread>
+#include "callback.h"
+#include "system-condition.h"
+#include "system-thread.h"
+#endif
+
+/**
+ * \file
+ * \ingroup logging
+ * Binary log output: LogSetBinaryOutput() and LogDecodeBinary().
+ *
+ * A binary log file starts with an 8 byte magic string and a 32 bit
+ * version number.  It is followed by records, each starting with a
+ * one byte type:
+ *
+ *   - a string record (type 1) defines a component or function name:
+ *     a 32 bit id, a 32 bit length, and the characters of the name;
+ *   - a message record (type 2): one byte each of flags, level and time
+ *     digits, the 32 bit ids of the component and function names, the
+ *     32 bit node id, the 64 bit time, a 32 bit length and the
+ *     characters of the message.
+ *
+ * Integers are written in the byte order of the machine which wrote
+ * the file.
+ */
+
+namespace ns3 {
+
+namespace {
+
+/** The magic string at the start of a binary log file. */
+const char LOG_MAGIC[8] = { 'N', 'S', '3', 'B', 'L', 'O', 'G', '\0' };
+/** The version of the binary log file format. */
+const uint32_t LOG_VERSION = 1;
+
+/** The types of binary log records. */
+enum LogRecordType
+{
+  LOG_RECORD_STRING = 1,  //!< Definition of a component or function name.
+  LOG_RECORD_MESSAGE = 2  //!< A log message.
+};
+
+/** The flags of a message record. */
+enum LogRecordFlags
+{
+  LOG_FLAG_FUNC  = 0x01,  //!< LOG_PREFIX_FUNC was enabled.
+  LOG_FLAG_TIME  = 0x02,  //!< LOG_PREFIX_TIME was enabled, with a time.
+  LOG_FLAG_NODE  = 0x04,  //!< LOG_PREFIX_NODE was enabled, with a node id.
+  LOG_FLAG_LEVEL = 0x08,  //!< LOG_PREFIX_LEVEL was enabled.
+  LOG_FLAG_CALL  = 0x10   //!< The record of an NS_LOG_FUNCTION().
+};
+
+/** Node id of a record logged outside of any node. */
+const uint32_t LOG_NO_CONTEXT = 0xffffffff;
+
+/** Message length which is stored without an allocation. */
+const uint32_t LOG_INLINE_TEXT = 192;
+
+/**
+ * \ingroup logging
+ * A message record, from the thread which logged it to the writer.
+ *
+ * The component and function are identified by address: function
+ * names are string literals, and LogComponents are static.  The writer
+ * assigns them ids the first time it sees them.
+ */
+struct LogRecord
+{
+  const LogComponent *component;   //!< The LogComponent.
+  const char *function;            //!< The function name.
+  int64_t time;                    //!< The simulation time.
+  uint32_t context;                //!< The node id.
+  uint32_t length;                 //!< The message length.
+  uint8_t flags;                   //!< LogRecordFlags.
+  uint8_t level;                   //!< The LogLevel.
+  uint8_t digits;                  //!< The decimal places of the time.
+  char *overflow;                  //!< The message, if too long for text.
+  char text[LOG_INLINE_TEXT];      //!< The message.
+};
+
+/**
+ * \ingroup logging
+ * A growable output buffer, whose contents can be read without a copy.
+ */
+class LogRecordBuffer : public std::streambuf
+{
+public:
+  /** Constructor. */
+  LogRecordBuffer ()
+    : m_data (256),
+      m_stream (this)
+  {
+    m_flags = m_stream.flags ();
+    m_precision = m_stream.precision ();
+    setp (&m_data[0], &m_data[0] + m_data.size ());
+  }
+  /**
+   * Empty the buffer, and reset the formatting state of its stream.
+   * \returns The stream.
+   */
+  std::ostream & Reset (void)
+  {
+    setp (&m_data[0], &m_data[0] + m_data.size ());
+    m_stream.clear ();
+    m_stream.flags (m_flags);
+    m_stream.precision (m_precision);
+    m_stream.fill (' ');
+    return m_stream;
+  }
+  /** \returns The characters written since Reset(). */
+  const char * Data (void) const
+  {
+    return pbase ();
+  }
+  /** \returns The number of characters written since Reset(). */
+  uint32_t Size (void) const
+  {
+    return static_cast<uint32_t> (pptr () - pbase ());
+  }
+
+protected:
+  /**
+   * Grow the buffer.
+   * \param [in] c The character which did not fit.
+   * \returns \p c, or \c eof on success if \p c is \c eof.
+   */
+  virtual int_type overflow (int_type c)
+  {
+    std::size_t used = pptr () - pbase ();
+    m_data.resize (m_data.size () * 2);
+    setp (&m_data[0], &m_data[0] + m_data.size ());
+    pbump (static_cast<int> (used));
+    if (!traits_type::eq_int_type (c, traits_type::eof ()))
+      {
+        *pptr () = traits_type::to_char_type (c);
+        pbump (1);
+      }
+    return traits_type::not_eof (c);
+  }
+
+private:
+  std::vector<char> m_data;          //!< The characters.
+  std::ostream m_stream;             //!< The stream writing to this buffer.
+  std::ios_base::fmtflags m_flags;   //!< The initial format flags.
+  std::streamsize m_precision;       //!< The initial precision.
+};
+
+/**
+ * \ingroup logging
+ * The record buffers of this thread.
+ *
+ * A message may log while it is formatted, for instance from the
+ * operator<< of one of its arguments, so there is one buffer per
+ * nesting depth.
+ */
+struct LogRecordBuffers
+{
+  /** Destructor. */
+  ~LogRecordBuffers ()
+  {
+    for (std::size_t i = 0; i < buffers.size (); ++i)
+      {
+        delete buffers[i];
+      }
+  }
+  std::vector<LogRecordBuffer *> buffers;  //!< The buffers, by depth.
+  std::size_t depth = 0;                   //!< The current depth.
+};
+
+/** The record buffers of this thread. */
+thread_local LogRecordBuffers t_buffers;
+
+/**
+ * \ingroup logging
+ * Writes the binary log file.
+ *
+ * Threads which log only queue their records.  When threads are
+ * available, a writer thread assigns the name ids and writes the
+ * file; otherwise the records are written as they are queued.
+ */
+class LogBinaryWriter
+{
+public:
+  /** Constructor. */
+  LogBinaryWriter ();
+  /** Destructor, closes the file. */
+  ~LogBinaryWriter ();
+  /**
+   * Open a file, and start the writer thread.
+   * \param [in] filename The file name.
+   */
+  void Open (const std::string &filename);
+  /** Write the queued records, and close the file. */
+  void Close (void);
+  /** Stop the writer thread and flush the file, before a fork. */
+  void PrepareFork (void);
+  /**
+   * Restart the writer thread after a fork.
+   * \param [in] child 0 in the parent, else the index of the child,
+   *             which opens a file of its own.
+   */
+  void AfterFork (uint32_t child);
+  /**
+   * Queue a record.  Safe to call from any thread.
+   * \param [in] record The record.
+   */
+  void Push (const LogRecord &record);
+
+private:
+  /** Start the writer thread. */
+  void Start (void);
+  /** Stop the writer thread. */
+  void Stop (void);
+  /** Run the writer thread. */
+  void Run (void);
+  /**
+   * Write the queued records.
+   * \returns \c true if there was any.
+   */
+  bool Drain (void);
+  /**
+   * Write a message record.
+   * \param [in] record The record.
+   */
+  void Write (const LogRecord &record);
+  /**
+   * Get the id of a name, writing its string record the first time.
+   * \param [in] key The address identifying the name.
+   * \param [in] name The name.
+   * \returns The id.
+   */
+  uint32_t Intern (const void *key, const char *name);
+  /**
+   * Write an integer in machine byte order.
+   * \param [in] value The value.
+   */
+  template <typename T>
+  void Put (T value);
+
+  /** The file name. */
+  std::string m_filename;
+  /** The file. */
+  std::ofstream m_file;
+  /** The records queued by the logging threads. */
+  MpscQueue<LogRecord> m_queue;
+  /** The ids of the names already written. */
+  std::unordered_map<const void *, uint32_t> m_ids;
+#ifdef HAVE_PTHREAD_H
+  /** The writer thread. */
+  Ptr<SystemThread> m_thread;
+  /** Wakes up the writer thread. */
+  SystemCondition m_wakeup;
+  /** Set to stop the writer thread. */
+  std::atomic<bool> m_stop;
+#endif
+};
+
+LogBinaryWriter::LogBinaryWriter ()
+  : m_queue (4096)
+{
+}
+
+LogBinaryWriter::~LogBinaryWriter ()
+{
+  Close ();
+}
+
+void
+LogBinaryWriter::Open (const std::string &filename)
+{
+  m_file.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_file.good ())
+    {
+      NS_FATAL_ERROR ("Cannot open binary log file \"" << filename << "\"");
+    }
+  m_filename = filename;
+  m_file.write (LOG_MAGIC, sizeof (LOG_MAGIC));
+  Put (LOG_VERSION);
+  m_ids.clear ();
+  Start ();
+}
+
+void
+LogBinaryWriter::Close (void)
+{
+  if (!m_file.is_open ())
+    {
+      return;
+    }
+  Stop ();
+  Drain ();
+  m_file.close ();
+}
+
+void
+LogBinaryWriter::PrepareFork (void)
+{
+  if (!m_file.is_open ())
+    {
+      return;
+    }
+  Stop ();
+  Drain ();
+  m_file.flush ();
+}
+
+void
+LogBinaryWriter::AfterFork (uint32_t child)
+{
+  if (!m_file.is_open ())
+    {
+      return;
+    }
+  if (child == 0)
+    {
+      Start ();
+      return;
+    }
+  // The file of the parent was flushed, so closing it here writes
+  // nothing more to it.
+  m_file.close ();
+  std::ostringstream oss;
+  oss << m_filename << "." << child;
+  Open (oss.str ());
+}
+
+void
+LogBinaryWriter::Start (void)
+{
+#ifdef HAVE_PTHREAD_H
+  m_stop = false;
+  m_wakeup.SetCondition (false);
+  m_thread = Create<SystemThread> (MakeCallback (&LogBinaryWriter::Run, this));
+  m_thread->Start ();
+#endif
+}
+
+void
+LogBinaryWriter::Stop (void)
+{
+#ifdef HAVE_PTHREAD_H
+  m_stop = true;
+  m_wakeup.SetCondition (true);
+  m_wakeup.Signal ();
+  m_thread->Join ();
+  m_thread = 0;
+#endif
+}
+
+void
+LogBinaryWriter::Push (const LogRecord &record)
+{
+#ifdef HAVE_PTHREAD_H
+  while (!m_queue.TryPush (record))
+    {
+      // The writer is behind: wake it up, and wait for room rather
+      // than drop the message.
+      m_wakeup.SetCondition (true);
+      m_wakeup.Signal ();
+      std::this_thread::yield ();
+    }
+#else
+  Write (record);
+#endif
+}
+
+void
+LogBinaryWriter::Run (void)
+{
+#ifdef HAVE_PTHREAD_H
+  while (!m_stop)
+    {
+      // TimedWait returns at once while the condition is set, so clear
+      // it before looking at the queue, not to miss a later wake-up.
+      m_wakeup.SetCondition (false);
+      if (!Drain ())
+        {
+          m_file.flush ();
+          m_wakeup.TimedWait (1000000);
+        }
+    }
+#endif
+}
+
+bool
+LogBinaryWriter::Drain (void)
+{
+  LogRecord record;
+  bool any = false;
+  while (m_queue.TryPop (record))
+    {
+      Write (record);
+      any = true;
+    }
+  return any;
+}
+
+template <typename T>
+void
+LogBinaryWriter::Put (T value)
+{
+  m_file.write (reinterpret_cast<const char *> (&value), sizeof (value));
+}
+
+uint32_t
+LogBinaryWriter::Intern (const void *key, const char *name)
+{
+  std::unordered_map<const void *, uint32_t>::const_iterator i = m_ids.find (key);
+  if (i != m_ids.end ())
+    {
+      return i->second;
+    }
+  uint32_t id = static_cast<uint32_t> (m_ids.size ());
+  m_ids[key] = id;
+  uint32_t length = static_cast<uint32_t> (std::strlen (name));
+  Put<uint8_t> (LOG_RECORD_STRING);
+  Put (id);
+  Put (length);
+  m_file.write (name, length);
+  return id;
+}
+
+void
+LogBinaryWriter::Write (const LogRecord &record)
+{
+  uint32_t component = Intern (record.component, record.component->Name ());
+  uint32_t function = Intern (record.function, record.function);
+  Put<uint8_t> (LOG_RECORD_MESSAGE);
+  Put (record.flags);
+  Put (record.level);
+  Put (record.digits);
+  Put (component);
+  Put (function);
+  Put (record.context);
+  Put (record.time);
+  Put (record.length);
+  if (record.overflow != 0)
+    {
+      m_file.write (record.overflow, record.length);
+      delete [] record.overflow;
+    }
+  else
+    {
+      m_file.write (record.text, record.length);
+    }
+}
+
+/**
+ * \ingroup logging
+ * Get the binary log writer.
+ *
+ * It is created the first time a file is opened, after the static
+ * LogComponents, so it is destroyed, and writes its last records,
+ * before them.
+ *
+ * \returns The writer.
+ */
+LogBinaryWriter *
+GetWriter (void)
+{
+  static LogBinaryWriter writer;
+  return &writer;
+}
+
+/** Whether messages are written to the binary log file. */
+std::atomic<bool> g_binaryOutput (false);
+
+/**
+ * \ingroup logging
+ * Read an integer in machine byte order.
+ *
+ * \param [in,out] is The stream to read.
+ * \param [out] value The value.
+ * \returns \c true on success.
+ */
+template <typename T>
+bool
+Get (std::istream &is, T &value)
+{
+  return static_cast<bool> (is.read (reinterpret_cast<char *> (&value), sizeof (value)));
+}
+
+/**
+ * \ingroup logging
+ * Read a string.
+ *
+ * \param [in,out] is The stream to read.
+ * \param [out] value The string.
+ * \returns \c true on success.
+ */
+bool
+GetString (std::istream &is, std::string &value)
+{
+  uint32_t length;
+  if (!Get (is, length))
+    {
+      return false;
+    }
+  value.resize (length);
+  return length == 0 || static_cast<bool> (is.read (&value[0], length));
+}
+
+} // unnamed namespace
+
+
+void
+LogSetBinaryOutput (const std::string &filename)
+{
+  LogBinaryWriter *writer = GetWriter ();
+  g_binaryOutput = false;
+  writer->Close ();
+  if (!filename.empty ())
+    {
+      writer->Open (filename);
+      g_binaryOutput = true;
+    }
+}
+
+void
+LogBinaryPrepareFork (void)
+{
+  GetWriter ()->PrepareFork ();
+}
+
+void
+LogBinaryAfterFork (uint32_t child)
+{
+  GetWriter ()->AfterFork (child);
+}
+
+bool
+LogIsBinaryOutput (void)
+{
+  return g_binaryOutput.load (std::memory_order_relaxed);
+}
+
+std::ostream &
+LogBinaryBegin (void)
+{
+  LogRecordBuffers &b = t_buffers;
+  if (b.depth == b.buffers.size ())
+    {
+      b.buffers.push_back (new LogRecordBuffer);
+    }
+  return b.buffers[b.depth++]->Reset ();
+}
+
+void
+LogBinaryEnd (const LogComponent &component, enum LogLevel level,
+              const char *function, bool call)
+{
+  LogRecordBuffers &b = t_buffers;
+  NS_ASSERT (b.depth > 0);
+  const LogRecordBuffer *buffer = b.buffers[--b.depth];
+
+  LogRecord record;
+  record.component = &component;
+  record.function = function;
+  record.level = static_cast<uint8_t> (level);
+  record.flags = call ? LOG_FLAG_CALL : 0;
+  if (!call && component.IsEnabled (LOG_PREFIX_FUNC))
+    {
+      record.flags |= LOG_FLAG_FUNC;
+    }
+  if (!call && component.IsEnabled (LOG_PREFIX_LEVEL))
+    {
+      record.flags |= LOG_FLAG_LEVEL;
+    }
+  record.time = 0;
+  record.digits = 0;
+  record.context = LOG_NO_CONTEXT;
+  LogStampGetter getter = LogGetStampGetter ();
+  if (getter != 0)
+    {
+      (*getter)(record.time, record.digits, record.context);
+      if (component.IsEnabled (LOG_PREFIX_TIME))
+        {
+          record.flags |= LOG_FLAG_TIME;
+        }
+      if (component.IsEnabled (LOG_PREFIX_NODE))
+        {
+          record.flags |= LOG_FLAG_NODE;
+        }
+    }
+  record.length = buffer->Size ();
+  if (record.length <= LOG_INLINE_TEXT)
+    {
+      record.overflow = 0;
+      std::memcpy (record.text, buffer->Data (), record.length);
+    }
+  else
+    {
+      record.overflow = new char [record.length];
+      std::memcpy (record.overflow, buffer->Data (), record.length);
+    }
+  GetWriter ()->Push (record);
+}
+
+bool
+LogDecodeBinary (std::istream &is, std::ostream &os)
+{
+  char magic[sizeof (LOG_MAGIC)];
+  uint32_t version;
+  if (!is.read (magic, sizeof (magic))
+      || std::memcmp (magic, LOG_MAGIC, sizeof (magic)) != 0
+      || !Get (is, version) || version != LOG_VERSION)
+    {
+      return false;
+    }
+
+  std::map<uint32_t, std::string> names;
+  std::string text;
+  uint8_t type;
+  while (Get (is, type))
+    {
+      if (type == LOG_RECORD_STRING)
+        {
+          uint32_t id;
+          if (!Get (is, id) || !GetString (is, names[id]))
+            {
+              return false;
+            }
+          continue;
+        }
+      uint8_t flags, level, digits;
+      uint32_t component, function, context;
+      int64_t time;
+      if (type != LOG_RECORD_MESSAGE
+          || !Get (is, flags) || !Get (is, level) || !Get (is, digits)
+          || !Get (is, component) || !Get (is, function)
+          || !Get (is, context) || !Get (is, time)
+          || !GetString (is, text))
+        {
+          return false;
+        }
+
+      if (flags & LOG_FLAG_TIME)
+        {
+          int64_t scale = 1;
+          for (uint8_t i = 0; i < digits; ++i)
+            {
+              scale *= 10;
+            }
+          os << "+" << time / scale;
+          if (digits > 0)
+            {
+              os << "." << std::setfill ('0') << std::setw (digits)
+                 << time % scale << std::setfill (' ');
+            }
+          os << "s ";
+        }
+      if (flags & LOG_FLAG_NODE)
+        {
+          if (context == LOG_NO_CONTEXT)
+            {
+              os << "-1 ";
+            }
+          else
+            {
+              os << context << " ";
+            }
+        }
+      if (flags & LOG_FLAG_CALL)
+        {
+          os << names[component] << ":" << names[function]
+             << "(" << text << ")" << std::endl;
+          continue;
+        }
+      if (flags & LOG_FLAG_FUNC)
+        {
+          os << names[component] << ":" << names[function] << "(): ";
+        }
+      if (flags & LOG_FLAG_LEVEL)
+        {
+          os << "[" << LogComponent::GetLevelLabel (static_cast<enum LogLevel> (level))
+             << "] ";
+        }
+      os << text << std::endl;
+    }
+  return is.eof ();
+}
+
+} // namespace ns3
@@ -112,6 +112,23 @@
 #endif /* NS_LOG_APPEND_CONTEXT */
 
 
+#ifndef NS_LOG_COMPILE_LEVEL
+/**
+ * \ingroup logging
+ * The LogLevels which are compiled in.
+ *
+ * Messages of the other levels are removed at compile time, so they cost
+ * nothing even in a build with logging enabled.  Define this before
+ * including any ns-3 header to limit the levels of one file:
+ * \code
+ *   #define NS_LOG_COMPILE_LEVEL ns3::LOG_LEVEL_WARN
+ * \endcode
+ * or add it to the compiler flags to limit the levels of the whole build.
+ */
+#define NS_LOG_COMPILE_LEVEL ns3::LOG_LEVEL_ALL
+#endif /* NS_LOG_COMPILE_LEVEL */
+
+
 #ifndef NS_LOG_CONDITION
 /**
  * \ingroup logging
@@ -153,14 +170,24 @@
   NS_LOG_CONDITION                                              \
   do                                                            \
     {                                                           \
-      if (g_log.IsEnabled (level))                              \
+      if (((level) & NS_LOG_COMPILE_LEVEL)                      \
+          && g_log.IsEnabled (level))                           \
         {                                                       \
-          NS_LOG_APPEND_TIME_PREFIX;                            \
-          NS_LOG_APPEND_NODE_PREFIX;                            \
-          NS_LOG_APPEND_CONTEXT;                                \
-          NS_LOG_APPEND_FUNC_PREFIX;                            \
-          NS_LOG_APPEND_LEVEL_PREFIX (level);                   \
-          std::clog << msg << std::endl;                        \
+          if (ns3::LogIsBinaryOutput ())                        \
+            {                                                   \
+              ns3::LogBinaryBegin () << msg;                    \
+              ns3::LogBinaryEnd (g_log, level,                  \
+                                 __FUNCTION__, false);          \
+            }                                                   \
+          else                                                  \
+            {                                                   \
+              NS_LOG_APPEND_TIME_PREFIX;                        \
+              NS_LOG_APPEND_NODE_PREFIX;                        \
+              NS_LOG_APPEND_CONTEXT;                            \
+              NS_LOG_APPEND_FUNC_PREFIX;                        \
+              NS_LOG_APPEND_LEVEL_PREFIX (level);               \
+              std::clog << msg << std::endl;                    \
+            }                                                   \
         }                                                       \
     }                                                           \
   while (false)
@@ -177,13 +204,23 @@
   NS_LOG_CONDITION                                              \
   do                                                            \
     {                                                           \
-      if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
+      if ((ns3::LOG_FUNCTION & NS_LOG_COMPILE_LEVEL)            \
+          && g_log.IsEnabled (ns3::LOG_FUNCTION))               \
         {                                                       \
-          NS_LOG_APPEND_TIME_PREFIX;                            \
-          NS_LOG_APPEND_NODE_PREFIX;                            \
-          NS_LOG_APPEND_CONTEXT;                                \
-          std::clog << g_log.Name () << ":"                     \
-                    << __FUNCTION__ << "()" << std::endl;       \
+          if (ns3::LogIsBinaryOutput ())                        \
+            {                                                   \
+              ns3::LogBinaryBegin ();                           \
+              ns3::LogBinaryEnd (g_log, ns3::LOG_FUNCTION,      \
+                                 __FUNCTION__, true);           \
+            }                                                   \
+          else                                                  \
+            {                                                   \
+              NS_LOG_APPEND_TIME_PREFIX;                        \
+              NS_LOG_APPEND_NODE_PREFIX;                        \
+              NS_LOG_APPEND_CONTEXT;                            \
+              std::clog << g_log.Name () << ":"                 \
+                        << __FUNCTION__ << "()" << std::endl;   \
+            }                                                   \
         }                                                       \
     }                                                           \
   while (false)
@@ -214,15 +251,26 @@
   NS_LOG_CONDITION                                              \
   do                                                            \
     {                                                           \
-      if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
+      if ((ns3::LOG_FUNCTION & NS_LOG_COMPILE_LEVEL)            \
+          && g_log.IsEnabled (ns3::LOG_FUNCTION))               \
         {                                                       \
-          NS_LOG_APPEND_TIME_PREFIX;                            \
-          NS_LOG_APPEND_NODE_PREFIX;                            \
-          NS_LOG_APPEND_CONTEXT;                                \
-          std::clog << g_log.Name () << ":"                     \
-                    << __FUNCTION__ << "(";                     \
-          ns3::ParameterLogger (std::clog) << parameters;       \
-          std::clog << ")" << std::endl;                        \
+          if (ns3::LogIsBinaryOutput ())                        \
+            {                                                   \
+              ns3::ParameterLogger (ns3::LogBinaryBegin ())     \
+                << parameters;                                  \
+              ns3::LogBinaryEnd (g_log, ns3::LOG_FUNCTION,      \
+                                 __FUNCTION__, true);           \
+            }                                                   \
+          else                                                  \
+            {                                                   \
+              NS_LOG_APPEND_TIME_PREFIX;                        \
+              NS_LOG_APPEND_NODE_PREFIX;                        \
+              NS_LOG_APPEND_CONTEXT;                            \
+              std::clog << g_log.Name () << ":"                 \
+                        << __FUNCTION__ << "(";                 \
+              ns3::ParameterLogger (std::clog) << parameters;   \
+              std::clog << ")" << std::endl;                    \
+            }                                                   \
         }                                                       \
     }                                                           \
   while (false)
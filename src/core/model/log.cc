@@ -26,6 +26,7 @@
 #include <stdexcept>
 #include "ns3/core-config.h"
 #include "fatal-error.h"
+#include "simulation-local.h"
 
 #ifdef HAVE_GETENV
 #include <cstring>
@@ -49,12 +50,17 @@ namespace ns3 {
  * The LogTimePrinter.
  * This is private to the logging implementation.
  */
-static LogTimePrinter g_logTimePrinter = 0;
+static NS_SIMULATION_LOCAL LogTimePrinter g_logTimePrinter = 0;
 /**
  * \ingroup logging
  * The LogNodePrinter.
  */
-static LogNodePrinter g_logNodePrinter = 0;
+static NS_SIMULATION_LOCAL LogNodePrinter g_logNodePrinter = 0;
+/**
+ * \ingroup logging
+ * The LogStampGetter.
+ */
+static NS_SIMULATION_LOCAL LogStampGetter g_logStampGetter = 0;
 
 /**
  * \ingroup logging
@@ -649,6 +655,15 @@ LogNodePrinter LogGetNodePrinter (void)
   return g_logNodePrinter;
 }
 
+void LogSetStampGetter (LogStampGetter getter)
+{
+  g_logStampGetter = getter;
+}
+LogStampGetter LogGetStampGetter (void)
+{
+  return g_logStampGetter;
+}
+
 
 ParameterLogger::ParameterLogger (std::ostream &os)
   : m_first (true),
@@ -336,6 +336,123 @@ void LogSetNodePrinter (LogNodePrinter np);
  */
 LogNodePrinter LogGetNodePrinter (void);
 
+/**
+ * Function signature for getting the simulation time and node id
+ * of a binary log record.
+ *
+ * \param [out] time The simulation time, in units of
+ *              10<sup>-digits</sup> seconds.
+ * \param [out] digits The number of decimal places with which the
+ *              time is printed.
+ * \param [out] context The simulation node id.
+ */
+typedef void (*LogStampGetter)(int64_t &time, uint8_t &digits, uint32_t &context);
+
+/**
+ * Set the LogStampGetter function to be used to stamp binary
+ * log records with the simulation time and node id.
+ *
+ * \param [in] getter The LogStampGetter function.
+ */
+void LogSetStampGetter (LogStampGetter getter);
+/**
+ * Get the LogStampGetter function currently in use.
+ * \returns The LogStampGetter function.
+ */
+LogStampGetter LogGetStampGetter (void);
+
+/**
+ * Write log messages to a binary file instead of \c std::clog.
+ *
+ * Each message enabled by NS_LOG() and NS_LOG_FUNCTION() is formatted
+ * as usual, but its prefixes are not: the component, function, level,
+ * simulation time and node id are stored as binary fields of the
+ * record, and the record is queued to a writer thread instead of
+ * being written by the simulation.  Component and function names are
+ * written once, the first time they are used.
+ *
+ * Use LogDecodeBinary(), or the \c decode-log utility, to print the
+ * file as the same text which \c std::clog would have shown, except
+ * for file-local NS_LOG_APPEND_CONTEXT prefixes, which are not kept.
+ * NS_LOG_UNCOND() still writes to \c std::clog.
+ *
+ * This should be called before any other thread logs.
+ *
+ * \param [in] filename The file to write, or an empty string to
+ *             flush and close the current file and return to
+ *             \c std::clog.
+ */
+void LogSetBinaryOutput (const std::string &filename);
+
+/**
+ * Check if log messages are written to a binary file.
+ * \returns \c true if LogSetBinaryOutput() opened a file.
+ */
+bool LogIsBinaryOutput (void);
+
+/**
+ * Print the records of a file written after LogSetBinaryOutput().
+ *
+ * \param [in,out] is The binary log file.
+ * \param [in,out] os The stream to print the messages on.
+ * \returns \c false if \p is is not a binary log file, or is truncated.
+ */
+bool LogDecodeBinary (std::istream &is, std::ostream &os);
+
+/**
+ * Prepare the binary log file for a fork().
+ *
+ * \internal
+ * Simulator::ForkAt() implementation function; should not be called
+ * directly.
+ *
+ * The writer thread is not inherited by the child process, so it is
+ * stopped after writing the queued records, and the file is flushed.
+ */
+void LogBinaryPrepareFork (void);
+
+/**
+ * Resume writing the binary log file after a fork().
+ *
+ * \internal
+ * Simulator::ForkAt() implementation function; should not be called
+ * directly.
+ *
+ * \param [in] child 0 in the calling process, which goes on writing
+ *             its file; the index of the child in a child process,
+ *             which writes its messages to a new file named after the
+ *             file of the calling process followed by a dot and
+ *             \p child.
+ */
+void LogBinaryAfterFork (uint32_t child);
+
+/**
+ * Start a binary log record.
+ *
+ * \internal
+ * Logging implementation function; should not be called directly.
+ *
+ * \returns The stream to format the message on.
+ */
+std::ostream & LogBinaryBegin (void);
+
+class LogComponent;
+
+/**
+ * Queue the binary log record started by LogBinaryBegin().
+ *
+ * \internal
+ * Logging implementation function; should not be called directly.
+ *
+ * \param [in] component The LogComponent of the message.
+ * \param [in] level The LogLevel of the message.
+ * \param [in] function The name of the logging function.
+ * \param [in] call \c true for NS_LOG_FUNCTION() records, whose message
+ *             holds the function arguments.
+ */
+void LogBinaryEnd (const LogComponent &component, enum LogLevel level,
+                   const char *function, bool call);
+
 
 /**
  * A single log component configuration.
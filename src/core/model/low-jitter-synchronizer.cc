@@ -0,0 +1,444 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "low-jitter-synchronizer.h"
+#include "log.h"
+#include "abort.h"
+#include "unused.h"
+#include "integer.h"
+#include "uinteger.h"
+#include "string.h"
+#include "trace-source-accessor.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <ctime>       // clock_gettime
+#include <pthread.h>
+#include <sched.h>
+
+#ifdef HAVE_SYS_TIMERFD_H
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @file
+ * @ingroup realtime
+ * ns3::LowJitterSynchronizer implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LowJitterSynchronizer");
+
+NS_OBJECT_ENSURE_REGISTERED (LowJitterSynchronizer);
+
+TypeId
+LowJitterSynchronizer::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LowJitterSynchronizer")
+    .SetParent<Synchronizer> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LowJitterSynchronizer> ()
+    .AddAttribute ("MinSpinWindow",
+                   "The shortest time to busy-wait before an event.",
+                   TimeValue (MicroSeconds (20)),
+                   MakeTimeAccessor (&LowJitterSynchronizer::m_minSpinWindow),
+                   MakeTimeChecker (Time (0)))
+    .AddAttribute ("MaxSpinWindow",
+                   "The longest time to busy-wait before an event.",
+                   TimeValue (MilliSeconds (2)),
+                   MakeTimeAccessor (&LowJitterSynchronizer::m_maxSpinWindow),
+                   MakeTimeChecker (Time (0)))
+    .AddAttribute ("CpuAffinity",
+                   "The CPU to pin the simulation thread to, or -1 to not pin it.",
+                   IntegerValue (-1),
+                   MakeIntegerAccessor (&LowJitterSynchronizer::m_cpu),
+                   MakeIntegerChecker<int32_t> (-1))
+    .AddAttribute ("LatenessBinWidth",
+                   "The width of the bins of the lateness histogram.",
+                   TimeValue (MicroSeconds (1)),
+                   MakeTimeAccessor (&LowJitterSynchronizer::m_latenessBinWidth),
+                   MakeTimeChecker (NanoSeconds (1)))
+    .AddAttribute ("LatenessBins",
+                   "The number of bins of the lateness histogram; the last "
+                   "bin counts all the later events.",
+                   UintegerValue (1000),
+                   MakeUintegerAccessor (&LowJitterSynchronizer::SetLatenessBins,
+                                         &LowJitterSynchronizer::GetLatenessBins),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("LatenessHistogram",
+                   "The lateness histogram, as bin-start-ns:count pairs "
+                   "of the non-empty bins.",
+                   TypeId::ATTR_GET,
+                   StringValue (""),
+                   MakeStringAccessor (&LowJitterSynchronizer::GetLatenessHistogramString),
+                   MakeStringChecker ())
+    .AddAttribute ("MaxLateness",
+                   "The largest lateness of an event.",
+                   TypeId::ATTR_GET,
+                   TimeValue (Time (0)),
+                   MakeTimeAccessor (&LowJitterSynchronizer::GetMaxLateness),
+                   MakeTimeChecker ())
+    .AddTraceSource ("Lateness",
+                     "The real time at which an event starts minus its "
+                     "simulation time.",
+                     MakeTraceSourceAccessor (&LowJitterSynchronizer::m_latenessTrace),
+                     "ns3::LowJitterSynchronizer::LatenessTracedCallback")
+  ;
+  return tid;
+}
+
+LowJitterSynchronizer::LowJitterSynchronizer ()
+  : m_cpu (-1),
+    m_spinWindow (0),
+    m_wakeupLatency (0),
+    m_nsEventStart (0),
+    m_maxLateness (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_condition = false;
+#ifdef HAVE_SYS_TIMERFD_H
+  m_timerFd = timerfd_create (CLOCK_MONOTONIC, TFD_CLOEXEC);
+  NS_ABORT_MSG_IF (m_timerFd < 0, "timerfd_create failed: " << std::strerror (errno));
+  m_eventFd = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+  NS_ABORT_MSG_IF (m_eventFd < 0, "eventfd failed: " << std::strerror (errno));
+#endif
+}
+
+LowJitterSynchronizer::~LowJitterSynchronizer ()
+{
+  NS_LOG_FUNCTION (this);
+#ifdef HAVE_SYS_TIMERFD_H
+  close (m_timerFd);
+  close (m_eventFd);
+#endif
+}
+
+std::vector<uint64_t>
+LowJitterSynchronizer::GetLatenessHistogram (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_lateness;
+}
+
+Time
+LowJitterSynchronizer::GetMaxLateness (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return NanoSeconds (m_maxLateness);
+}
+
+Time
+LowJitterSynchronizer::GetSpinWindow (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return NanoSeconds (m_spinWindow);
+}
+
+void
+LowJitterSynchronizer::ResetLateness (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::fill (m_lateness.begin (), m_lateness.end (), 0);
+  m_maxLateness = 0;
+}
+
+void
+LowJitterSynchronizer::SetLatenessBins (uint32_t bins)
+{
+  NS_LOG_FUNCTION (this << bins);
+  m_lateness.assign (bins, 0);
+  m_maxLateness = 0;
+}
+
+uint32_t
+LowJitterSynchronizer::GetLatenessBins (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_lateness.size ();
+}
+
+std::string
+LowJitterSynchronizer::GetLatenessHistogramString (void) const
+{
+  NS_LOG_FUNCTION (this);
+  std::ostringstream oss;
+  uint64_t width = m_latenessBinWidth.GetNanoSeconds ();
+  for (uint32_t i = 0; i < m_lateness.size (); ++i)
+    {
+      if (m_lateness[i] != 0)
+        {
+          if (!oss.str ().empty ())
+            {
+              oss << " ";
+            }
+          oss << i * width << ":" << m_lateness[i];
+        }
+    }
+  return oss.str ();
+}
+
+bool
+LowJitterSynchronizer::DoRealtime (void)
+{
+  NS_LOG_FUNCTION (this);
+  return true;
+}
+
+uint64_t
+LowJitterSynchronizer::DoGetCurrentRealtime (void)
+{
+  NS_LOG_FUNCTION (this);
+  return GetNormalizedRealtime ();
+}
+
+void
+LowJitterSynchronizer::DoSetOrigin (uint64_t ns)
+{
+  NS_LOG_FUNCTION (this << ns);
+  // SetOrigin is called by the thread which runs the simulation,
+  // just before it starts.
+  SetAffinity ();
+  m_spinWindow = m_maxSpinWindow.GetNanoSeconds ();
+  m_wakeupLatency = 0;
+  m_realtimeOriginNano = GetRealtime ();
+  NS_LOG_INFO ("origin = " << m_realtimeOriginNano);
+}
+
+int64_t
+LowJitterSynchronizer::DoGetDrift (uint64_t ns)
+{
+  NS_LOG_FUNCTION (this << ns);
+  uint64_t nsNow = GetNormalizedRealtime ();
+  if (nsNow > ns)
+    {
+      return (int64_t)(nsNow - ns);
+    }
+  else
+    {
+      return -(int64_t)(ns - nsNow);
+    }
+}
+
+bool
+LowJitterSynchronizer::DoSynchronize (uint64_t nsCurrent, uint64_t nsDelay)
+{
+  NS_LOG_FUNCTION (this << nsCurrent << nsDelay);
+  //
+  // The target is an absolute time, so time spent since nsCurrent was
+  // read is corrected for without looking at the drift.
+  //
+  uint64_t target = nsCurrent + nsDelay;
+  uint64_t now = GetNormalizedRealtime ();
+  if (target > now + m_spinWindow)
+    {
+      uint64_t wakeup = target - m_spinWindow;
+      if (!SleepUntil (wakeup))
+        {
+          NS_LOG_INFO ("Sleep interrupted");
+          return false;
+        }
+      //
+      // Track the decaying peak of the wake-up latency, and spin for
+      // twice as long, so that the next sleeps seldom end late.
+      //
+      now = GetNormalizedRealtime ();
+      uint64_t latency = now > wakeup ? now - wakeup : 0;
+      m_wakeupLatency = std::max (latency, m_wakeupLatency - m_wakeupLatency / 16);
+      m_spinWindow = std::min<uint64_t> (std::max<uint64_t> (2 * m_wakeupLatency,
+                                                             m_minSpinWindow.GetNanoSeconds ()),
+                                         m_maxSpinWindow.GetNanoSeconds ());
+      NS_LOG_INFO ("Wake-up latency " << latency << " ns, spin window "
+                                      << m_spinWindow << " ns");
+    }
+  return SpinUntil (target);
+}
+
+void
+LowJitterSynchronizer::DoSignal (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_condition = true;
+#ifdef HAVE_SYS_TIMERFD_H
+  uint64_t one = 1;
+  ssize_t written = write (m_eventFd, &one, sizeof (one));
+  // The write only fails if the counter is full, that is, if the
+  // eventfd is already readable.
+  NS_UNUSED (written);
+#else
+  m_wakeup.SetCondition (true);
+  m_wakeup.Signal ();
+#endif
+}
+
+void
+LowJitterSynchronizer::DoSetCondition (bool cond)
+{
+  NS_LOG_FUNCTION (this << cond);
+  m_condition = cond;
+#ifdef HAVE_SYS_TIMERFD_H
+  if (!cond)
+    {
+      uint64_t count;
+      ssize_t got = read (m_eventFd, &count, sizeof (count));
+      NS_UNUSED (got);
+    }
+#else
+  m_wakeup.SetCondition (cond);
+#endif
+}
+
+void
+LowJitterSynchronizer::DoEventStart (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nsEventStart = GetNormalizedRealtime ();
+}
+
+uint64_t
+LowJitterSynchronizer::DoEventEnd (void)
+{
+  NS_LOG_FUNCTION (this);
+  return GetNormalizedRealtime () - m_nsEventStart;
+}
+
+void
+LowJitterSynchronizer::DoSetEventTime (uint64_t ns)
+{
+  NS_LOG_FUNCTION (this << ns);
+  int64_t lateness = DoGetDrift (ns);
+  if (lateness > m_maxLateness)
+    {
+      m_maxLateness = lateness;
+    }
+  if (!m_lateness.empty ())
+    {
+      uint64_t bin = lateness > 0 ? lateness / m_latenessBinWidth.GetNanoSeconds () : 0;
+      bin = std::min<uint64_t> (bin, m_lateness.size () - 1);
+      m_lateness[bin]++;
+    }
+  m_latenessTrace (NanoSeconds (lateness));
+}
+
+bool
+LowJitterSynchronizer::SleepUntil (uint64_t ns)
+{
+  NS_LOG_FUNCTION (this << ns);
+#ifdef HAVE_SYS_TIMERFD_H
+  uint64_t deadline = m_realtimeOriginNano + ns;
+  struct itimerspec its;
+  std::memset (&its, 0, sizeof (its));
+  its.it_value.tv_sec = deadline / 1000000000;
+  its.it_value.tv_nsec = deadline % 1000000000;
+  timerfd_settime (m_timerFd, TFD_TIMER_ABSTIME, &its, 0);
+  struct pollfd fds[2];
+  fds[0].fd = m_timerFd;
+  fds[0].events = POLLIN;
+  fds[1].fd = m_eventFd;
+  fds[1].events = POLLIN;
+  for (;;)
+    {
+      if (m_condition)
+        {
+          return false;
+        }
+      int ready = poll (fds, 2, -1);
+      if (ready < 0 && errno == EINTR)
+        {
+          continue;
+        }
+      if (fds[1].revents & POLLIN || m_condition)
+        {
+          return false;
+        }
+      if (fds[0].revents & POLLIN)
+        {
+          uint64_t expirations;
+          ssize_t got = read (m_timerFd, &expirations, sizeof (expirations));
+          NS_UNUSED (got);
+          return true;
+        }
+    }
+#else
+  uint64_t now = GetNormalizedRealtime ();
+  if (ns <= now)
+    {
+      return !m_condition;
+    }
+  return m_wakeup.TimedWait (ns - now);
+#endif
+}
+
+bool
+LowJitterSynchronizer::SpinUntil (uint64_t ns)
+{
+  NS_LOG_FUNCTION (this << ns);
+  for (;;)
+    {
+      if (GetNormalizedRealtime () >= ns)
+        {
+          return true;
+        }
+      if (m_condition)
+        {
+          return false;
+        }
+    }
+}
+
+uint64_t
+LowJitterSynchronizer::GetRealtime (void) const
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+uint64_t
+LowJitterSynchronizer::GetNormalizedRealtime (void) const
+{
+  return GetRealtime () - m_realtimeOriginNano;
+}
+
+void
+LowJitterSynchronizer::SetAffinity (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_cpu < 0)
+    {
+      return;
+    }
+#ifdef __linux__
+  cpu_set_t cpus;
+  CPU_ZERO (&cpus);
+  CPU_SET (m_cpu, &cpus);
+  int error = pthread_setaffinity_np (pthread_self (), sizeof (cpus), &cpus);
+  if (error != 0)
+    {
+      NS_LOG_WARN ("Cannot pin the simulation thread to CPU " << m_cpu
+                   << ": " << std::strerror (error));
+    }
+#else
+  NS_LOG_WARN ("CpuAffinity is only supported on Linux");
+#endif
+}
+
+} // namespace ns3
@@ -0,0 +1,206 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LOW_JITTER_SYNCHRONIZER_H
+#define LOW_JITTER_SYNCHRONIZER_H
+
+#include "ns3/core-config.h"
+#include "synchronizer.h"
+#include "nstime.h"
+#include "traced-callback.h"
+
+#ifndef HAVE_SYS_TIMERFD_H
+#include "system-condition.h"
+#endif
+
+#include <atomic>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @file
+ * @ingroup realtime
+ * ns3::LowJitterSynchronizer declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * @ingroup realtime
+ * @brief A Synchronizer which sleeps on a monotonic clock until shortly
+ * before each event, then spins, and measures the lateness of the events.
+ *
+ * It is selected with the \c SynchronizerType attribute of the
+ * RealtimeSimulatorImpl:
+ *
+ * @code
+ *   GlobalValue::Bind ("SimulatorImplementationType",
+ *                      StringValue ("ns3::RealtimeSimulatorImpl"));
+ *   Config::SetDefault ("ns3::RealtimeSimulatorImpl::SynchronizerType",
+ *                       TypeIdValue (LowJitterSynchronizer::GetTypeId ()));
+ * @endcode
+ *
+ * Where @c timerfd is available, the synchronizer sleeps on a @c timerfd
+ * armed with the absolute @c CLOCK_MONOTONIC time of the end of the
+ * sleep, and is woken early by an @c eventfd when another thread
+ * schedules an event.  Elsewhere it sleeps on a SystemCondition, as
+ * the WallClockSynchronizer does.
+ *
+ * The sleep ends a spin window before the event is due, and the
+ * synchronizer busy-waits for the rest.  The window adapts to the
+ * wake-up latency of the sleeps: it is twice the largest recent latency,
+ * within the \c MinSpinWindow and \c MaxSpinWindow attributes.
+ *
+ * The \c CpuAffinity attribute pins the simulation thread to one CPU
+ * (on Linux), to avoid migrations.
+ *
+ * The lateness of each event, the real time at which it starts minus
+ * its simulation time, is reported by the \c Lateness trace source and
+ * counted in a histogram of \c LatenessBins bins of \c LatenessBinWidth,
+ * the last of which counts all the later events.  The histogram is
+ * returned by GetLatenessHistogram, and by the \c LatenessHistogram
+ * attribute as a string of <tt>bin-start-ns:count</tt> pairs of the
+ * non-empty bins.
+ */
+class LowJitterSynchronizer : public Synchronizer
+{
+public:
+  /**
+   * Get the registered TypeId for this class.
+   * @returns The TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LowJitterSynchronizer ();
+  /** Destructor. */
+  virtual ~LowJitterSynchronizer ();
+
+  /**
+   * Get the lateness histogram.
+   *
+   * @returns The number of events in each bin.
+   */
+  std::vector<uint64_t> GetLatenessHistogram (void) const;
+  /**
+   * Get the largest lateness of an event.
+   *
+   * @returns The largest lateness.
+   */
+  Time GetMaxLateness (void) const;
+  /**
+   * Get the current spin window.
+   *
+   * @returns The time spent spinning before an event.
+   */
+  Time GetSpinWindow (void) const;
+  /** Clear the lateness histogram. */
+  void ResetLateness (void);
+
+  /**
+   * TracedCallback signature for the lateness of an event.
+   *
+   * @param [in] lateness The real time at which the event starts minus
+   *             its simulation time.
+   */
+  typedef void (* LatenessTracedCallback)(Time lateness);
+
+protected:
+  // Inherited from Synchronizer
+  virtual void DoSetOrigin (uint64_t ns);
+  virtual bool DoRealtime (void);
+  virtual uint64_t DoGetCurrentRealtime (void);
+  virtual bool DoSynchronize (uint64_t nsCurrent, uint64_t nsDelay);
+  virtual void DoSignal (void);
+  virtual void DoSetCondition (bool cond);
+  virtual int64_t DoGetDrift (uint64_t ns);
+  virtual void DoEventStart (void);
+  virtual uint64_t DoEventEnd (void);
+  virtual void DoSetEventTime (uint64_t ns);
+
+private:
+  /**
+   * Sleep until a normalized real time, or until Signal is called.
+   *
+   * @param [in] ns The normalized real time to wake up at.
+   * @returns @c true if the sleep went until the end,
+   *          @c false if it was interrupted.
+   */
+  bool SleepUntil (uint64_t ns);
+  /**
+   * Busy-wait until a normalized real time, or until the condition is set.
+   *
+   * @param [in] ns The normalized real time to wait for.
+   * @returns @c true if we reached the target time,
+   *          @c false if we returned because the condition was set.
+   */
+  bool SpinUntil (uint64_t ns);
+  /**
+   * Get the absolute monotonic real time.
+   * @returns The real time, in ns.
+   */
+  uint64_t GetRealtime (void) const;
+  /**
+   * Get the normalized real time.
+   * @returns The real time since DoSetOrigin, in ns.
+   */
+  uint64_t GetNormalizedRealtime (void) const;
+  /** Pin the calling thread to m_cpu, if set. */
+  void SetAffinity (void);
+  /**
+   * Get the lateness histogram as a string.
+   * @returns The <tt>bin-start-ns:count</tt> pairs of the non-empty bins.
+   */
+  std::string GetLatenessHistogramString (void) const;
+  /**
+   * Set the number of lateness bins, and clear the histogram.
+   * @param [in] bins The number of bins.
+   */
+  void SetLatenessBins (uint32_t bins);
+  /**
+   * Get the number of lateness bins.
+   * @returns The number of bins.
+   */
+  uint32_t GetLatenessBins (void) const;
+
+  Time m_minSpinWindow;          //!< The shortest spin window.
+  Time m_maxSpinWindow;          //!< The longest spin window.
+  int32_t m_cpu;                 //!< The CPU to run on, or -1.
+  Time m_latenessBinWidth;       //!< The width of a lateness bin.
+
+  uint64_t m_spinWindow;         //!< The current spin window, in ns.
+  uint64_t m_wakeupLatency;      //!< The decaying peak wake-up latency, in ns.
+  uint64_t m_nsEventStart;       //!< Time recorded by DoEventStart.
+  std::vector<uint64_t> m_lateness;  //!< The lateness histogram.
+  int64_t m_maxLateness;         //!< The largest lateness, in ns.
+
+  /** Set by DoSignal to interrupt the waits. */
+  std::atomic<bool> m_condition;
+#ifdef HAVE_SYS_TIMERFD_H
+  int m_timerFd;                 //!< The timerfd the sleeps wait on.
+  int m_eventFd;                 //!< The eventfd DoSignal writes to.
+#else
+  SystemCondition m_wakeup;      //!< The condition the sleeps wait on.
+#endif
+
+  /** The lateness of each event. */
+  TracedCallback<Time> m_latenessTrace;
+};
+
+} // namespace ns3
+
+#endif /* LOW_JITTER_SYNCHRONIZER_H */
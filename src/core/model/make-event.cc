@@ -52,6 +52,10 @@ protected:
     {
       (*m_function)();
     }
+    virtual Function GetFunction (void) const
+    {
+      return MakeFunction (typeid (*this), m_function);
+    }
 private:
     F m_function;
   } *ev = new EventFunctionImpl0 (f);
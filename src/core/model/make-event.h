@@ -375,6 +375,10 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)();
     }
+    virtual Function GetFunction (void) const
+    {
+      return MakeFunction (typeid (*this), m_function);
+    }
     OBJ m_obj;
     MEM m_function;
   } *ev = new EventMemberImpl0 (obj, mem_ptr);
@@ -405,6 +409,10 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1);
     }
+    virtual Function GetFunction (void) const
+    {
+      return MakeFunction (typeid (*this), m_function);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -436,6 +444,10 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2);
     }
+    virtual Function GetFunction (void) const
+    {
+      return MakeFunction (typeid (*this), m_function);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -469,6 +481,10 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3);
     }
+    virtual Function GetFunction (void) const
+    {
+      return MakeFunction (typeid (*this), m_function);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -504,6 +520,10 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4);
     }
+    virtual Function GetFunction (void) const
+    {
+      return MakeFunction (typeid (*this), m_function);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -542,6 +562,10 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5);
     }
+    virtual Function GetFunction (void) const
+    {
+      return MakeFunction (typeid (*this), m_function);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -582,6 +606,10 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
     }
+    virtual Function GetFunction (void) const
+    {
+      return MakeFunction (typeid (*this), m_function);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -617,6 +645,10 @@ private:
     {
       (*m_function)(m_a1);
     }
+    virtual Function GetFunction (void) const
+    {
+      return MakeFunction (typeid (*this), m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
   } *ev = new EventFunctionImpl1 (f, a1);
@@ -647,6 +679,10 @@ private:
     {
       (*m_function)(m_a1, m_a2);
     }
+    virtual Function GetFunction (void) const
+    {
+      return MakeFunction (typeid (*this), m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -680,6 +716,10 @@ private:
     {
       (*m_function)(m_a1, m_a2, m_a3);
     }
+    virtual Function GetFunction (void) const
+    {
+      return MakeFunction (typeid (*this), m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -715,6 +755,10 @@ private:
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4);
     }
+    virtual Function GetFunction (void) const
+    {
+      return MakeFunction (typeid (*this), m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -752,6 +796,10 @@ private:
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5);
     }
+    virtual Function GetFunction (void) const
+    {
+      return MakeFunction (typeid (*this), m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -791,6 +839,10 @@ private:
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
     }
+    virtual Function GetFunction (void) const
+    {
+      return MakeFunction (typeid (*this), m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -66,6 +66,29 @@ MapScheduler::Insert (const Event &ev)
   NS_ASSERT (result.second);
 }
 
+void
+MapScheduler::InsertSorted (const std::vector<Event> &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+  if (events.empty ())
+    {
+      return;
+    }
+  // Each event usually goes right after the previous one: use the
+  // position after the previous event as a hint, while it is valid.
+  EventMapI hint = m_list.lower_bound (events.front ().key);
+  for (std::vector<Event>::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      if (hint != m_list.end () && hint->first < i->key)
+        {
+          hint = m_list.lower_bound (i->key);
+        }
+      hint = m_list.insert (hint, std::make_pair (i->key, i->impl));
+      NS_ASSERT_MSG (hint->second == i->impl, "Event already in the schedule");
+      ++hint;
+    }
+}
+
 bool
 MapScheduler::IsEmpty (void) const
 {
@@ -96,6 +119,7 @@ MapScheduler::RemoveNext (void)
   ev.impl = i->second;
   ev.key = i->first;
   m_list.erase (i);
+  NotifyRemoved (ev);
   NS_LOG_DEBUG (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
   return ev;
 }
@@ -109,4 +133,32 @@ MapScheduler::Remove (const Event &ev)
   m_list.erase (i);
 }
 
+uint32_t
+MapScheduler::GetSize (void) const
+{
+  return m_list.size ();
+}
+
+uint32_t
+MapScheduler::DoCompact (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t removed = 0;
+  EventMapI i = m_list.begin ();
+  while (i != m_list.end ())
+    {
+      if (i->second->IsCancelled ())
+        {
+          i->second->Unref ();
+          m_list.erase (i++);
+          removed++;
+        }
+      else
+        {
+          i++;
+        }
+    }
+  return removed;
+}
+
 } // namespace ns3
@@ -57,12 +57,17 @@ public:
 
   // Inherited
   virtual void Insert (const Scheduler::Event &ev);
+  virtual void InsertSorted (const std::vector<Scheduler::Event> &events);
   virtual bool IsEmpty (void) const;
   virtual Scheduler::Event PeekNext (void) const;
   virtual Scheduler::Event RemoveNext (void);
   virtual void Remove (const Scheduler::Event &ev);
+  virtual uint32_t GetSize (void) const;
 
 private:
+  // Inherited
+  virtual uint32_t DoCompact (void);
+
   /** Event list type: a Map from EventKey to EventImpl. */
   typedef std::map<Scheduler::EventKey, EventImpl*> EventMap;
   /** EventMap iterator. */
@@ -0,0 +1,232 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <atomic>
+#include "assert.h"
+
+/**
+ * \file
+ * \ingroup system
+ * ns3::MpscQueue template class declaration and implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup system
+ * \brief A bounded, lock-free, multiple producer, single consumer queue.
+ *
+ * Any number of threads may call TryPush() concurrently, while a single
+ * thread, the consumer, calls TryPop() and IsEmpty().  No call ever
+ * blocks: TryPush() fails when the queue is full, and the caller decides
+ * what to do then (typically, fall back to a slower locked path).
+ *
+ * This is the bounded queue of Dmitry Vyukov: each slot of the ring
+ * carries a sequence number which tells whether it may be written by
+ * the producer holding a given position, or read by the consumer.
+ * The producers only contend on the atomic increment of the write
+ * position, and the consumer on nothing at all.
+ *
+ * \tparam T \explicit The type of the items, which must be copyable.
+ */
+template <typename T>
+class MpscQueue
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param [in] capacity The minimum number of items the queue can hold,
+   *             rounded up to a power of two.
+   */
+  MpscQueue (uint32_t capacity);
+  /** Destructor. */
+  ~MpscQueue ();
+
+  /**
+   * Append an item to the queue.  Safe to call from any thread.
+   *
+   * \param [in] item The item.
+   * \returns \c false if the queue is full.
+   */
+  bool TryPush (const T &item);
+  /**
+   * Remove the oldest item of the queue.  Consumer thread only.
+   *
+   * An item whose TryPush() is still in progress is not visible yet.
+   *
+   * \param [out] item The item.
+   * \returns \c false if the queue is empty.
+   */
+  bool TryPop (T &item);
+  /**
+   * Check, without modifying the queue, if TryPop() would fail.
+   * Consumer thread only.
+   *
+   * \returns \c true if the queue is empty.
+   */
+  bool IsEmpty (void) const;
+  /**
+   * Get the number of items the queue can hold.
+   *
+   * \returns The capacity.
+   */
+  uint32_t GetCapacity (void) const;
+
+private:
+  /** Copy constructor, not implemented. */
+  MpscQueue (const MpscQueue &);
+  /**
+   * Copy assignment, not implemented.
+   * \returns This queue.
+   */
+  MpscQueue & operator = (const MpscQueue &);
+
+  /** A slot of the ring. */
+  struct Cell
+  {
+    /**
+     * Equal to the write position of the producer allowed to fill this
+     * slot, or to the read position plus one once it is filled.
+     */
+    std::atomic<uint64_t> sequence;
+    /** The item. */
+    T item;
+  };
+
+  /** The ring of slots. */
+  Cell *m_cells;
+  /** The capacity minus one, to wrap the positions. */
+  uint64_t m_mask;
+  /** Padding, to keep the consumer and producer positions apart. */
+  char m_pad0[64];
+  /** The next position to read, owned by the consumer. */
+  uint64_t m_readPos;
+  /** Padding, to keep the consumer and producer positions apart. */
+  char m_pad1[64];
+  /** The next position to write, shared by the producers. */
+  std::atomic<uint64_t> m_writePos;
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename T>
+MpscQueue<T>::MpscQueue (uint32_t capacity)
+  : m_readPos (0),
+    m_writePos (0)
+{
+  NS_ASSERT (capacity > 0);
+  uint64_t size = 1;
+  while (size < capacity)
+    {
+      size <<= 1;
+    }
+  m_mask = size - 1;
+  m_cells = new Cell [size];
+  for (uint64_t i = 0; i < size; i++)
+    {
+      m_cells[i].sequence.store (i, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+MpscQueue<T>::~MpscQueue ()
+{
+  delete [] m_cells;
+  m_cells = 0;
+}
+
+template <typename T>
+bool
+MpscQueue<T>::TryPush (const T &item)
+{
+  uint64_t pos = m_writePos.load (std::memory_order_relaxed);
+  Cell *cell;
+  while (true)
+    {
+      cell = &m_cells[pos & m_mask];
+      uint64_t sequence = cell->sequence.load (std::memory_order_acquire);
+      int64_t diff = static_cast<int64_t> (sequence - pos);
+      if (diff == 0)
+        {
+          // the slot is free for this position: try to claim it
+          if (m_writePos.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed))
+            {
+              break;
+            }
+        }
+      else if (diff < 0)
+        {
+          // the slot still holds the item of the previous lap
+          return false;
+        }
+      else
+        {
+          // another producer claimed this position
+          pos = m_writePos.load (std::memory_order_relaxed);
+        }
+    }
+  cell->item = item;
+  cell->sequence.store (pos + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T>
+bool
+MpscQueue<T>::TryPop (T &item)
+{
+  Cell *cell = &m_cells[m_readPos & m_mask];
+  if (cell->sequence.load (std::memory_order_acquire) != m_readPos + 1)
+    {
+      return false;
+    }
+  item = cell->item;
+  // free the slot for the producer of the next lap
+  cell->sequence.store (m_readPos + m_mask + 1, std::memory_order_release);
+  m_readPos++;
+  return true;
+}
+
+template <typename T>
+bool
+MpscQueue<T>::IsEmpty (void) const
+{
+  const Cell *cell = &m_cells[m_readPos & m_mask];
+  return cell->sequence.load (std::memory_order_acquire) != m_readPos + 1;
+}
+
+template <typename T>
+uint32_t
+MpscQueue<T>::GetCapacity (void) const
+{
+  return m_mask + 1;
+}
+
+} // namespace ns3
+
+#endif /* MPSC_QUEUE_H */
@@ -0,0 +1,825 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "simulator.h"
+#include "multithreaded-simulator-impl.h"
+#include "scheduler.h"
+#include "event-impl.h"
+#include "config.h"
+#include "uinteger.h"
+
+#include "ptr.h"
+#include "pointer.h"
+#include "assert.h"
+#include "log.h"
+#include "abort.h"
+#include "ns3/core-config.h"
+
+#include <pthread.h>
+#include <unistd.h>
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::MultithreadedSimulatorImpl implementation.
+ */
+
+namespace ns3 {
+
+// Note:  Logging in this file is largely avoided due to the
+// number of calls that are made to these functions and the possibility
+// of causing recursions leading to stack overflow
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+/**
+ * \ingroup simulator
+ * The partition of the calling thread, set by each worker thread.
+ */
+static thread_local uint32_t g_partitionIndex = 0xffffffff;
+
+/**
+ * \ingroup simulator
+ * A reusable barrier for a fixed number of threads.
+ */
+class WindowBarrier
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param [in] count The number of threads taking part in the barrier.
+   */
+  WindowBarrier (uint32_t count);
+  /** Destructor. */
+  ~WindowBarrier ();
+  /** Block until \c count threads have called this method. */
+  void Wait (void);
+
+private:
+  /** Mutex controlling access to the counters. */
+  pthread_mutex_t m_mutex;
+  /** The condition the waiting threads sleep on. */
+  pthread_cond_t m_cond;
+  /** Number of threads taking part in the barrier. */
+  uint32_t m_count;
+  /** Number of threads waiting in the current generation. */
+  uint32_t m_waiting;
+  /** Number of times the barrier has been released. */
+  uint32_t m_generation;
+};
+
+WindowBarrier::WindowBarrier (uint32_t count)
+  : m_count (count),
+    m_waiting (0),
+    m_generation (0)
+{
+  pthread_mutex_init (&m_mutex, NULL);
+  pthread_cond_init (&m_cond, NULL);
+}
+
+WindowBarrier::~WindowBarrier ()
+{
+  pthread_mutex_destroy (&m_mutex);
+  pthread_cond_destroy (&m_cond);
+}
+
+void
+WindowBarrier::Wait (void)
+{
+  pthread_mutex_lock (&m_mutex);
+  uint32_t generation = m_generation;
+  m_waiting++;
+  if (m_waiting == m_count)
+    {
+      m_waiting = 0;
+      m_generation++;
+      pthread_cond_broadcast (&m_cond);
+    }
+  else
+    {
+      while (generation == m_generation)
+        {
+          pthread_cond_wait (&m_cond, &m_mutex);
+        }
+    }
+  pthread_mutex_unlock (&m_mutex);
+}
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Core")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("ThreadCount",
+                   "The number of worker threads (0 for one per online processor). "
+                   "Must be set before the simulator is created.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MultithreadedSimulatorImpl::m_threadCount),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("LookAhead",
+                   "The minimum delay of an event sent to another worker thread "
+                   "(0 to use the smallest channel Delay attribute).",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&MultithreadedSimulatorImpl::m_configuredLookAhead),
+                   MakeTimeChecker (Seconds (0)))
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+#ifdef ENABLE_THREAD_LOCAL_SIMULATOR
+  NS_FATAL_ERROR ("MultithreadedSimulatorImpl cannot run with --enable-thread-local-simulator: "
+                  "its workers would not see the simulation of the main thread");
+#endif /* ENABLE_THREAD_LOCAL_SIMULATOR */
+  m_threadCount = 0;
+  m_lookAhead = 0;
+  m_windowEnd = 0;
+  m_parity = 0;
+  m_running = false;
+  m_exit = false;
+  m_barrier = 0;
+  m_stop = false;
+  m_eventsWithContextEmpty = true;
+  m_main = SystemThread::Self ();
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  ProcessEventsWithContext ();
+
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      Partition *partition = m_partitions[i];
+      while (!partition->events->IsEmpty ())
+        {
+          Scheduler::Event next = partition->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      delete partition;
+    }
+  m_partitions.clear ();
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  NS_ASSERT_MSG (!m_running, "Cannot change the scheduler while running");
+
+  if (m_partitions.empty ())
+    {
+      if (m_threadCount == 0)
+        {
+          long online = sysconf (_SC_NPROCESSORS_ONLN);
+          m_threadCount = online > 0 ? online : 1;
+        }
+      // one partition per worker, plus one for the global events
+      for (uint32_t i = 0; i <= m_threadCount; ++i)
+        {
+          Partition *partition = new Partition ();
+          // uids are allocated from 4.
+          // uid 0 is "invalid" events
+          // uid 1 is "now" events
+          // uid 2 is "destroy" events
+          partition->uid = 4;
+          // before ::Run is entered, the currentUid will be zero
+          partition->currentUid = 0;
+          partition->currentTs = 0;
+          partition->currentContext = Simulator::NO_CONTEXT;
+          partition->stop = false;
+          for (uint32_t parity = 0; parity < 2; ++parity)
+            {
+              partition->outbox[parity].resize (m_threadCount + 1);
+              partition->minSentTs[parity] = GetMaximumSimulationTime ().GetTimeStep ();
+            }
+          m_partitions.push_back (partition);
+        }
+    }
+
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      Ptr<Scheduler> old = m_partitions[i]->events;
+      if (old != 0)
+        {
+          while (!old->IsEmpty ())
+            {
+              Scheduler::Event next = old->RemoveNext ();
+              scheduler->Insert (next);
+            }
+        }
+      m_partitions[i]->events = scheduler;
+    }
+}
+
+// System ID for non-distributed simulation is always zero
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return 0;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetThreadCount (void) const
+{
+  return m_threadCount;
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookAhead (void) const
+{
+  return TimeStep (m_lookAhead);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartitionIndex (uint32_t context) const
+{
+  if (context == Simulator::NO_CONTEXT)
+    {
+      return m_threadCount;
+    }
+  return context % m_threadCount;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetCurrentPartitionIndex (void) const
+{
+  if (g_partitionIndex != NO_PARTITION)
+    {
+      return g_partitionIndex;
+    }
+  if (SystemThread::Equals (m_main))
+    {
+      return m_threadCount;
+    }
+  return NO_PARTITION;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::Insert (Partition *partition, uint64_t ts, uint32_t context, EventImpl *event)
+{
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = partition->uid;
+  partition->uid++;
+  partition->events->Insert (ev);
+  return ev.key.m_uid;
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent (Partition *partition)
+{
+  Scheduler::Event next = partition->events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= partition->currentTs);
+
+  NS_LOG_LOGIC ("handle " << next.key.m_ts);
+  partition->currentTs = next.key.m_ts;
+  partition->currentContext = next.key.m_context;
+  partition->currentUid = next.key.m_uid;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::ProcessInbox (uint32_t index, uint32_t parity)
+{
+  Partition *partition = m_partitions[index];
+  // Visit the senders in a fixed order so that the uids, and thus
+  // the order of simultaneous events, do not depend on thread timing.
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      EventsWithContext &inbox = m_partitions[i]->outbox[parity][index];
+      for (EventsWithContext::const_iterator it = inbox.begin (); it != inbox.end (); ++it)
+        {
+          Insert (partition, it->timestamp, it->context, it->event);
+        }
+      inbox.clear ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ProcessEventsWithContext (void)
+{
+  if (m_eventsWithContextEmpty)
+    {
+      return;
+    }
+
+  // swap queues
+  ExternalEvents eventsWithContext;
+  {
+    CriticalSection cs (m_eventsWithContextMutex);
+    m_eventsWithContext.swap (eventsWithContext);
+    m_eventsWithContextEmpty = true;
+  }
+  // All the events before the end of the last window have run
+  uint64_t now = std::max (m_windowEnd, m_partitions[m_threadCount]->currentTs);
+  while (!eventsWithContext.empty ())
+    {
+      EventWithContext event = eventsWithContext.front ();
+      eventsWithContext.pop_front ();
+      Partition *partition = m_partitions[GetPartitionIndex (event.context)];
+      Insert (partition, now + event.timestamp, event.context, event.event);
+    }
+}
+
+uint64_t
+MultithreadedSimulatorImpl::NextWorkerTs (void) const
+{
+  uint64_t next = GetMaximumSimulationTime ().GetTimeStep ();
+  for (uint32_t i = 0; i < m_threadCount; ++i)
+    {
+      Partition *partition = m_partitions[i];
+      if (!partition->events->IsEmpty ())
+        {
+          next = std::min (next, partition->events->PeekNext ().key.m_ts);
+        }
+      // Events sent during the last window are still in the outboxes.
+      next = std::min (next, partition->minSentTs[m_parity]);
+    }
+  return next;
+}
+
+void
+MultithreadedSimulatorImpl::CalculateLookAhead (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_threadCount == 1)
+    {
+      // Nothing can be sent to another worker.
+      m_lookAhead = GetMaximumSimulationTime ().GetTimeStep ();
+      return;
+    }
+  if (m_configuredLookAhead.IsStrictlyPositive ())
+    {
+      m_lookAhead = m_configuredLookAhead.GetTimeStep ();
+      return;
+    }
+
+  Time lookAhead = GetMaximumSimulationTime ();
+  bool found = false;
+  Config::MatchContainer channels = Config::LookupMatches ("/ChannelList/*");
+  for (Config::MatchContainer::Iterator i = channels.Begin (); i != channels.End (); ++i)
+    {
+      Ptr<Object> channel = *i;
+      struct TypeId::AttributeInformation info;
+      if (!channel->GetInstanceTypeId ().LookupAttributeByName ("Delay", &info)
+          || info.checker->GetValueTypeName () != "ns3::TimeValue")
+        {
+          // Skipping the channel could make the lookahead larger than
+          // its propagation delay.
+          NS_FATAL_ERROR ("MultithreadedSimulatorImpl: cannot derive the lookahead from channel "
+                          << channel->GetInstanceTypeId ().GetName ()
+                          << ", which has no Delay attribute, set the LookAhead attribute");
+        }
+      TimeValue delay;
+      channel->GetAttribute ("Delay", delay);
+      lookAhead = Min (lookAhead, delay.Get ());
+      found = true;
+    }
+  if (!found || !lookAhead.IsStrictlyPositive ())
+    {
+      NS_FATAL_ERROR ("MultithreadedSimulatorImpl: cannot derive a strictly positive lookahead "
+                      "from the channel delays, set the LookAhead attribute");
+    }
+  m_lookAhead = lookAhead.GetTimeStep ();
+}
+
+void
+MultithreadedSimulatorImpl::WorkerRun (uint32_t index)
+{
+  g_partitionIndex = index;
+  Partition *partition = m_partitions[index];
+  while (true)
+    {
+      // wait for the main thread to open the next window
+      m_barrier->Wait ();
+      if (m_exit)
+        {
+          break;
+        }
+      ProcessInbox (index, m_parity ^ 1);
+      while (!partition->stop
+             && !partition->events->IsEmpty ()
+             && partition->events->PeekNext ().key.m_ts < m_windowEnd)
+        {
+          ProcessOneEvent (partition);
+        }
+      m_barrier->Wait ();
+    }
+  g_partitionIndex = NO_PARTITION;
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_stop)
+    {
+      return true;
+    }
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      if (!m_partitions[i]->events->IsEmpty ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  // Set the current threadId as the main threadId
+  m_main = SystemThread::Self ();
+  ProcessEventsWithContext ();
+  m_stop = false;
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      m_partitions[i]->stop = false;
+      m_partitions[i]->minSentTs[0] = GetMaximumSimulationTime ().GetTimeStep ();
+      m_partitions[i]->minSentTs[1] = GetMaximumSimulationTime ().GetTimeStep ();
+    }
+  CalculateLookAhead ();
+  NS_LOG_LOGIC ("running " << m_threadCount << " workers with lookahead " << m_lookAhead);
+
+  const uint64_t maxTs = GetMaximumSimulationTime ().GetTimeStep ();
+  Partition *global = m_partitions[m_threadCount];
+  m_barrier = new WindowBarrier (m_threadCount + 1);
+  m_exit = false;
+  m_running = true;
+  for (uint32_t i = 0; i < m_threadCount; ++i)
+    {
+      m_partitions[i]->thread = Create<SystemThread> (
+          MakeCallback (&MultithreadedSimulatorImpl::WorkerRun, this).Bind (i));
+      m_partitions[i]->thread->Start ();
+    }
+
+  while (!m_stop)
+    {
+      ProcessEventsWithContext ();
+      uint64_t next = NextWorkerTs ();
+      uint64_t nextGlobal = global->events->IsEmpty () ? maxTs : global->events->PeekNext ().key.m_ts;
+      if (next == maxTs && nextGlobal == maxTs)
+        {
+          break;
+        }
+      if (nextGlobal <= next)
+        {
+          // The workers are all blocked: the global events can
+          // touch any partition.
+          ProcessOneEvent (global);
+          continue;
+        }
+      if (m_lookAhead >= maxTs - next)
+        {
+          m_windowEnd = nextGlobal;
+        }
+      else
+        {
+          m_windowEnd = std::min (next + m_lookAhead, nextGlobal);
+        }
+      // The outboxes for this window were emptied at the start of the
+      // previous one.
+      m_parity ^= 1;
+      for (uint32_t i = 0; i < m_threadCount; ++i)
+        {
+          m_partitions[i]->minSentTs[m_parity] = maxTs;
+        }
+      m_barrier->Wait ();
+      // The workers run the window.
+      m_barrier->Wait ();
+      ProcessInbox (m_threadCount, m_parity);
+    }
+
+  m_exit = true;
+  m_barrier->Wait ();
+  for (uint32_t i = 0; i < m_threadCount; ++i)
+    {
+      m_partitions[i]->thread->Join ();
+      m_partitions[i]->thread = 0;
+    }
+  m_running = false;
+  delete m_barrier;
+  m_barrier = 0;
+
+  // Hand over the events sent during the last window, and move the
+  // clock of the main thread to the last event executed.
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      ProcessInbox (i, m_parity);
+      global->currentTs = std::max (global->currentTs, m_partitions[i]->currentTs);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t index = GetCurrentPartitionIndex ();
+  if (index != NO_PARTITION)
+    {
+      // the calling worker stops at once, the others at the end of
+      // the current window.
+      m_partitions[index]->stop = true;
+    }
+  CriticalSection cs (m_stopMutex);
+  m_stop = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  uint32_t index = GetCurrentPartitionIndex ();
+  if (index != m_threadCount && index != NO_PARTITION
+      && (uint64_t)delay.GetTimeStep () < m_lookAhead)
+    {
+      // Too close to be ordered with the other workers: stop at the
+      // end of the current window.
+      Stop ();
+      return;
+    }
+  ScheduleWithContext (Simulator::NO_CONTEXT, delay, MakeEvent (&Simulator::Stop));
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << event);
+  uint32_t index = GetCurrentPartitionIndex ();
+  NS_ASSERT_MSG (index != NO_PARTITION, "Simulator::Schedule Thread-unsafe invocation!");
+
+  Partition *partition = m_partitions[index];
+  Time tAbsolute = delay + TimeStep (partition->currentTs);
+
+  NS_ASSERT (tAbsolute.IsPositive ());
+  NS_ASSERT (tAbsolute >= TimeStep (partition->currentTs));
+  uint64_t ts = (uint64_t) tAbsolute.GetTimeStep ();
+  uint32_t context = partition->currentContext;
+  uint32_t uid = Insert (partition, ts, context, event);
+  return EventId (event, ts, context, uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << event);
+
+  uint32_t index = GetCurrentPartitionIndex ();
+  if (index == NO_PARTITION)
+    {
+      EventWithContext ev;
+      ev.context = context;
+      // Current time added in ProcessEventsWithContext()
+      ev.timestamp = delay.GetTimeStep ();
+      ev.event = event;
+      {
+        CriticalSection cs (m_eventsWithContextMutex);
+        m_eventsWithContext.push_back (ev);
+        m_eventsWithContextEmpty = false;
+      }
+      return;
+    }
+
+  Partition *partition = m_partitions[index];
+  uint64_t ts = (uint64_t)(delay + TimeStep (partition->currentTs)).GetTimeStep ();
+  uint32_t destination = GetPartitionIndex (context);
+  if (destination == index || index == m_threadCount)
+    {
+      // Either a local event, or the main thread while the workers
+      // are blocked.
+      Insert (m_partitions[destination], ts, context, event);
+      return;
+    }
+  if (ts < m_windowEnd)
+    {
+      NS_FATAL_ERROR ("Event for context " << context << " scheduled " << delay
+                      << " ahead, which is less than the lookahead " << TimeStep (m_lookAhead));
+    }
+  EventWithContext ev;
+  ev.context = context;
+  ev.timestamp = ts;
+  ev.event = event;
+  partition->outbox[m_parity][destination].push_back (ev);
+  if (destination != m_threadCount)
+    {
+      // The main thread takes the global events at the end of the window.
+      partition->minSentTs[m_parity] = std::min (partition->minSentTs[m_parity], ts);
+    }
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  return Schedule (TimeStep (0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  NS_ASSERT_MSG (GetCurrentPartitionIndex () != NO_PARTITION, "Simulator::ScheduleDestroy Thread-unsafe invocation!");
+
+  EventId id (Ptr<EventImpl> (event, false), m_partitions[GetCurrentPartitionIndex ()]->currentTs, 0xffffffff, 2);
+  CriticalSection cs (m_destroyEventsMutex);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  uint32_t index = GetCurrentPartitionIndex ();
+  if (index == NO_PARTITION)
+    {
+      index = m_threadCount;
+    }
+  return TimeStep (m_partitions[index]->currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs ()) - Now ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      CriticalSection cs (m_destroyEventsMutex);
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  uint32_t index = GetPartitionIndex (id.GetContext ());
+  if (m_running && index != GetCurrentPartitionIndex ())
+    {
+      // The queue belongs to another thread, or the event may not
+      // have been handed over yet: leave it there.
+      id.PeekEventImpl ()->Cancel ();
+      return;
+    }
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  m_partitions[index]->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (IsExpired (id))
+    {
+      return;
+    }
+  uint32_t index = GetPartitionIndex (id.GetContext ());
+  if (id.GetUid () == 2
+      || (m_running && index != GetCurrentPartitionIndex ()))
+    {
+      // Not in the event list, or in the event list of another thread.
+      id.PeekEventImpl ()->Cancel ();
+      return;
+    }
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  m_partitions[index]->events->Cancel (event);
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0 ||
+          id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      CriticalSection cs (const_cast<SystemMutex &> (m_destroyEventsMutex));
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  if (id.PeekEventImpl () == 0)
+    {
+      return true;
+    }
+  const Partition *partition = m_partitions[GetPartitionIndex (id.GetContext ())];
+  if (id.GetTs () < partition->currentTs ||
+      (id.GetTs () == partition->currentTs &&
+       id.GetUid () <= partition->currentUid) ||
+      id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  uint32_t index = GetCurrentPartitionIndex ();
+  if (index == NO_PARTITION)
+    {
+      return Simulator::NO_CONTEXT;
+    }
+  return m_partitions[index]->currentContext;
+}
+
+} // namespace ns3
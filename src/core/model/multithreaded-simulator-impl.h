@@ -0,0 +1,279 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTITHREADED_SIMULATOR_IMPL_H
+#define MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "simulator-impl.h"
+#include "scheduler.h"
+#include "event-impl.h"
+#include "system-thread.h"
+#include "system-mutex.h"
+#include "nstime.h"
+
+#include "ptr.h"
+
+#include <list>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::MultithreadedSimulatorImpl declaration.
+ */
+
+namespace ns3 {
+
+class WindowBarrier;
+
+/**
+ * \ingroup simulator
+ *
+ * A conservative, shared-memory parallel simulator implementation.
+ *
+ * The event contexts (node ids) are split across a fixed number of
+ * worker threads, each with its own event queue: context \c c is
+ * handled by worker <tt>c % ThreadCount</tt>.  Events without a context
+ * (Simulator::NO_CONTEXT, e.g. events scheduled from the main program)
+ * are kept in a separate global queue and are run by the main thread
+ * while all the workers are stopped.
+ *
+ * The workers advance in lock step through time windows.  A window
+ * starts at the timestamp of the earliest pending event and is
+ * \c LookAhead long (or shorter, if a global event is due before
+ * its end); every worker runs the events of its own queue which fall
+ * inside the window and then waits on a barrier.  Events scheduled
+ * for a context owned by another worker are buffered and handed over
+ * at the next window boundary, so they must be scheduled at least
+ * one lookahead in the future: a violation of this rule is a fatal
+ * error.  The results do not depend on thread timing: two runs of
+ * the same scenario execute the same events in the same order on
+ * each worker.
+ *
+ * Unless the \c LookAhead attribute is set, the lookahead is the
+ * smallest \c Delay attribute of the channels registered under
+ * /ChannelList, which is the minimum time any packet needs to go
+ * from one node to another.  If a channel has no such attribute, as
+ * the wireless channels whose delay comes from a propagation delay
+ * model, Run() stops with a fatal error: the \c LookAhead attribute
+ * must then be set.
+ *
+ * Models running on different workers must not share mutable state
+ * without their own synchronization. Remove() of an event owned by
+ * another worker is degraded to Cancel().
+ *
+ * The workers share the simulation of the main thread, so this
+ * implementation is not available when ns-3 is configured with
+ * --enable-thread-local-simulator.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  MultithreadedSimulatorImpl ();
+  /** Destructor. */
+  ~MultithreadedSimulatorImpl ();
+
+  // Inherited
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (const Time &delay);
+  virtual EventId Schedule (const Time &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+
+  /**
+   * Get the number of worker threads.
+   *
+   * \return The number of worker threads.
+   */
+  uint32_t GetThreadCount (void) const;
+  /**
+   * Get the lookahead used by the last call to Run().
+   *
+   * \return The lookahead.
+   */
+  Time GetLookAhead (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  /** Wrap an event sent to a partition with its execution context. */
+  struct EventWithContext {
+    /** The event context. */
+    uint32_t context;
+    /** Absolute event timestamp. */
+    uint64_t timestamp;
+    /** The event implementation. */
+    EventImpl *event;
+  };
+  /** Container type for the events sent to a partition. */
+  typedef std::vector<struct EventWithContext> EventsWithContext;
+
+  /** The event queue and clock owned by one thread. */
+  struct Partition {
+    /** The event priority queue. */
+    Ptr<Scheduler> events;
+    /** Next event unique id. */
+    uint32_t uid;
+    /** Unique id of the current event. */
+    uint32_t currentUid;
+    /** Timestamp of the current event. */
+    uint64_t currentTs;
+    /** Execution context of the current event. */
+    uint32_t currentContext;
+    /** Flag calling for this partition to stop at once. */
+    bool stop;
+    /**
+     * Events sent to other partitions, indexed by the parity of the
+     * window they were sent in and by the destination partition.
+     */
+    std::vector<EventsWithContext> outbox[2];
+    /** Smallest timestamp sent to another partition, by window parity. */
+    uint64_t minSentTs[2];
+    /** The worker thread, null for the global partition. */
+    Ptr<SystemThread> thread;
+  };
+
+  /**
+   * Get the index of the partition in charge of a context.
+   *
+   * \param [in] context The event context.
+   * \return The partition index.
+   */
+  uint32_t GetPartitionIndex (uint32_t context) const;
+  /**
+   * Get the index of the partition of the calling thread.
+   *
+   * \return The partition index, or \c NO_PARTITION for a thread
+   *         which is neither a worker nor the main thread.
+   */
+  uint32_t GetCurrentPartitionIndex (void) const;
+  /**
+   * Insert an event in the queue of a partition.
+   *
+   * \param [in] partition The partition.
+   * \param [in] ts The absolute event timestamp.
+   * \param [in] context The event context.
+   * \param [in] event The event implementation.
+   * \return The unique id given to the event.
+   */
+  uint32_t Insert (Partition *partition, uint64_t ts, uint32_t context, EventImpl *event);
+  /**
+   * Process the next event of a partition.
+   *
+   * \param [in] partition The partition.
+   */
+  void ProcessOneEvent (Partition *partition);
+  /**
+   * Insert the events sent to a partition during a window.
+   *
+   * \param [in] index The partition index.
+   * \param [in] parity The parity of the window.
+   */
+  void ProcessInbox (uint32_t index, uint32_t parity);
+  /** Move events from a non-simulator thread into the event queues. */
+  void ProcessEventsWithContext (void);
+  /**
+   * Get the earliest timestamp pending in the worker partitions,
+   * including the events not yet handed over to their destination.
+   *
+   * \return The earliest timestamp.
+   */
+  uint64_t NextWorkerTs (void) const;
+  /** Compute the lookahead for this run. */
+  void CalculateLookAhead (void);
+  /**
+   * The main loop of a worker thread.
+   *
+   * \param [in] index The partition index of the worker.
+   */
+  void WorkerRun (uint32_t index);
+
+  /** Partition index used for non-simulator threads. */
+  static const uint32_t NO_PARTITION = 0xffffffff;
+
+  /**
+   * The partitions: one per worker thread, then one for the global
+   * events run by the main thread.
+   */
+  std::vector<Partition *> m_partitions;
+  /** Number of worker threads, as configured. */
+  uint32_t m_threadCount;
+  /** Lookahead, as configured. */
+  Time m_configuredLookAhead;
+  /** Lookahead of the current run, in time steps. */
+  uint64_t m_lookAhead;
+  /** The exclusive upper bound of the current window. */
+  uint64_t m_windowEnd;
+  /** The parity of the current window. */
+  uint32_t m_parity;
+  /** Flag \c true while the worker threads are running. */
+  bool m_running;
+  /** Flag calling for the worker threads to exit. */
+  bool m_exit;
+  /** Barrier between the main thread and the workers. */
+  WindowBarrier *m_barrier;
+
+  /** Flag calling for the end of the simulation. */
+  bool m_stop;
+  /** Mutex to control access to the stop flag. */
+  SystemMutex m_stopMutex;
+
+  /** Container type for the events from a non-simulator thread. */
+  typedef std::list<struct EventWithContext> ExternalEvents;
+  /** The container of events from a non-simulator thread. */
+  ExternalEvents m_eventsWithContext;
+  /**
+   * Flag \c true if all events with context have been moved to the
+   * event queues.
+   */
+  bool m_eventsWithContextEmpty;
+  /** Mutex to control access to the list of events with context. */
+  SystemMutex m_eventsWithContextMutex;
+
+  /** Container type for the events to run at Simulator::Destroy() */
+  typedef std::list<EventId> DestroyEvents;
+  /** The container of events to run at Destroy. */
+  DestroyEvents m_destroyEvents;
+  /** Mutex to control access to the list of destroy events. */
+  SystemMutex m_destroyEventsMutex;
+
+  /** Main execution thread. */
+  SystemThread::ThreadId m_main;
+};
+
+} // namespace ns3
+
+#endif /* MULTITHREADED_SIMULATOR_IMPL_H */
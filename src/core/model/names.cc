@@ -16,13 +16,16 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
-#include <map>
+#include <unordered_map>
+#include <vector>
 #include "object.h"
 #include "log.h"
 #include "assert.h"
 #include "abort.h"
 #include "names.h"
-#include "singleton.h"
+#include "simulation-local.h"
+#include "non-copyable.h"
+#include "config.h"
 
 /**
  * \file
@@ -74,13 +77,19 @@ public:
   std::string m_name;
   /** The object corresponding to this NameNode. */
   Ptr<Object> m_object;
+  /**
+   * The fully qualified path of this NameNode, e.g. "/Names/client/eth0".
+   * Kept up to date on Add and Rename so that FindPath does not have
+   * to walk the tree.
+   */
+  std::string m_path;
 
   /** Children of this NameNode. */
-  std::map<std::string, NameNode *> m_nameMap;
+  std::unordered_map<std::string, NameNode *> m_nameMap;
 };
 
 NameNode::NameNode ()
-  : m_parent (0), m_name (""), m_object (0)
+  : m_parent (0), m_name (""), m_object (0), m_path ("")
 {
 }
 
@@ -89,6 +98,7 @@ NameNode::NameNode (const NameNode &nameNode)
   m_parent = nameNode.m_parent;
   m_name = nameNode.m_name;
   m_object = nameNode.m_object;
+  m_path = nameNode.m_path;
   m_nameMap = nameNode.m_nameMap;
 }
 
@@ -98,6 +108,7 @@ NameNode::operator = (const NameNode &rhs)
   m_parent = rhs.m_parent;
   m_name = rhs.m_name;
   m_object = rhs.m_object;
+  m_path = rhs.m_path;
   m_nameMap = rhs.m_nameMap;
   return *this;
 }
@@ -106,6 +117,7 @@ NameNode::NameNode (NameNode *parent, std::string name, Ptr<Object> object)
   : m_parent (parent), m_name (name), m_object (object)
 {
   NS_LOG_FUNCTION (this << parent << name << object);
+  m_path = parent->m_path + "/" + name;
 }
 
 NameNode::~NameNode ()
@@ -117,9 +129,19 @@ NameNode::~NameNode ()
  * \ingroup config
  * The singleton root Names object.
  */
-class NamesPriv : public Singleton<NamesPriv>
+class NamesPriv : private NonCopyable
 {
 public:
+  /**
+   * Get the NamesPriv of the calling simulation.
+   *
+   * The instance is deleted when the process exits, or when the
+   * thread exits with --enable-thread-local-simulator.
+   *
+   * \returns The singleton NamesPriv.
+   */
+  static NamesPriv *Get (void);
+
   /** Constructor. */
   NamesPriv ();
   /** Destructor. */
@@ -157,6 +179,33 @@ public:
    * \return \c true if the object was named successfully.
    */
   bool Add (Ptr<Object> context, std::string name, Ptr<Object> object);
+  /**
+   * Internal implementation for
+   * Names::AddMany(std::string,const std::vector<std::string>&,const std::vector<Ptr<Object> >&)
+   *
+   * \param [in] path A path name describing a previously named object
+   *             under which you want the new names to be defined.
+   * \param [in] names The names of the objects you want to associate.
+   * \param [in] objects Smart pointers to the objects themselves.
+   *
+   * \return \c true if all of the objects were named successfully.
+   */
+  bool AddMany (std::string path, const std::vector<std::string> &names,
+                const std::vector<Ptr<Object> > &objects);
+  /**
+   * Internal implementation for
+   * Names::AddMany(Ptr<Object>,const std::vector<std::string>&,const std::vector<Ptr<Object> >&)
+   *
+   * \param [in] context A smart pointer to an object that is used
+   *             in place of the path under which you want the new
+   *             names to be defined.
+   * \param [in] names The names of the objects you want to associate.
+   * \param [in] objects Smart pointers to the objects themselves.
+   *
+   * \return \c true if all of the objects were named successfully.
+   */
+  bool AddMany (Ptr<Object> context, const std::vector<std::string> &names,
+                const std::vector<Ptr<Object> > &objects);
 
   /**
    * Internal implementation for Names::Rename(std::string,std::string)
@@ -266,15 +315,39 @@ private:
    * \param [in] name The name to search for.
    * \returns \c true if \c name already exists as a child of \c node.
    */
-  bool IsDuplicateName (NameNode *node, std::string name);
+  bool IsDuplicateName (NameNode *node, const std::string &name);
+  /**
+   * Create a new NameNode and enter it in all of the lookup maps.
+   *
+   * \param [in] parent The NameNode under which the name is defined.
+   * \param [in] name The name of the new NameNode.
+   * \param [in] object The object corresponding to the new NameNode.
+   */
+  void Insert (NameNode *parent, const std::string &name, Ptr<Object> object);
+  /**
+   * Recompute the fully qualified path of a NameNode and of all of
+   * its descendants, and re-enter them in the path map.
+   *
+   * \param [in] node The first NameNode whose path has changed.
+   */
+  void UpdatePaths (NameNode *node);
 
   /** The root NameNode. */
   NameNode m_root;
 
   /** Map from object pointers to their NameNodes. */
-  std::map<Ptr<Object>, NameNode *> m_objectMap;
+  std::unordered_map<const Object *, NameNode *> m_objectMap;
+  /** Map from fully qualified paths to their NameNodes. */
+  std::unordered_map<std::string, NameNode *> m_pathMap;
 };
 
+NamesPriv *
+NamesPriv::Get (void)
+{
+  static NS_SIMULATION_LOCAL NamesPriv names;
+  return &names;
+}
+
 NamesPriv::NamesPriv ()
 {
   NS_LOG_FUNCTION (this);
@@ -282,6 +355,7 @@ NamesPriv::NamesPriv ()
   m_root.m_parent = 0;
   m_root.m_name = "Names";
   m_root.m_object = 0;
+  m_root.m_path = "/Names";
 }
 
 NamesPriv::~NamesPriv ()
@@ -299,18 +373,21 @@ NamesPriv::Clear (void)
   // Every name is associated with an object in the object map, so freeing the
   // NameNodes in this map will free all of the memory allocated for the NameNodes
   //
-  for (std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.begin (); i != m_objectMap.end (); ++i)
+  for (std::unordered_map<const Object *, NameNode *>::iterator i = m_objectMap.begin (); i != m_objectMap.end (); ++i)
     {
       delete i->second;
       i->second = 0;
     }
 
   m_objectMap.clear ();
+  m_pathMap.clear ();
 
   m_root.m_parent = 0;
   m_root.m_name = "Names";
   m_root.m_object = 0;
+  m_root.m_path = "/Names";
   m_root.m_nameMap.clear ();
+  Config::InvalidateMatchCache ();
 }
 
 bool
@@ -414,13 +491,113 @@ NamesPriv::Add (Ptr<Object> context, std::string name, Ptr<Object> object)
       return false;
     }
 
-  NameNode *newNode = new NameNode (node, name, object);
-  node->m_nameMap[name] = newNode;
-  m_objectMap[object] = newNode;
+  Insert (node, name, object);
+  Config::InvalidateMatchCache ();
+
+  return true;
+}
+
+bool
+NamesPriv::AddMany (std::string path, const std::vector<std::string> &names,
+                    const std::vector<Ptr<Object> > &objects)
+{
+  NS_LOG_FUNCTION (this << path << names.size ());
+  if (path == "/Names")
+    {
+      return AddMany (Ptr<Object> (0, false), names, objects);
+    }
+  Ptr<Object> context = Find (path);
+  if (context == 0)
+    {
+      NS_LOG_LOGIC ("Path does not name an object");
+      return false;
+    }
+  return AddMany (context, names, objects);
+}
+
+bool
+NamesPriv::AddMany (Ptr<Object> context, const std::vector<std::string> &names,
+                    const std::vector<Ptr<Object> > &objects)
+{
+  NS_LOG_FUNCTION (this << context << names.size ());
+
+  if (names.size () != objects.size ())
+    {
+      NS_LOG_LOGIC ("Number of names and objects differ");
+      return false;
+    }
+
+  NameNode *node = 0;
+  if (context)
+    {
+      node = IsNamed (context);
+      NS_ASSERT_MSG (node, "NamesPriv::AddMany(): context must point to a previously named node");
+    }
+  else
+    {
+      node = &m_root;
+    }
+
+  //
+  // Check the whole batch before touching the tree so that a failure
+  // leaves the name space as it was.  Names and objects must be unique
+  // both against the existing tree and within the batch itself.
+  //
+  std::unordered_map<std::string, const Object *> batchNames;
+  std::unordered_map<const Object *, std::string> batchObjects;
+  batchNames.reserve (names.size ());
+  batchObjects.reserve (objects.size ());
+  for (std::size_t i = 0; i < names.size (); ++i)
+    {
+      const Object *object = PeekPointer (objects[i]);
+      if (IsNamed (objects[i]) || !batchObjects.insert (std::make_pair (object, names[i])).second)
+        {
+          NS_LOG_LOGIC ("Object " << object << " is already named");
+          return false;
+        }
+      if (IsDuplicateName (node, names[i]) || !batchNames.insert (std::make_pair (names[i], object)).second)
+        {
+          NS_LOG_LOGIC ("Name " << names[i] << " is already taken");
+          return false;
+        }
+    }
+
+  node->m_nameMap.reserve (node->m_nameMap.size () + names.size ());
+  m_objectMap.reserve (m_objectMap.size () + objects.size ());
+  m_pathMap.reserve (m_pathMap.size () + names.size ());
+  for (std::size_t i = 0; i < names.size (); ++i)
+    {
+      Insert (node, names[i], objects[i]);
+    }
+  Config::InvalidateMatchCache ();
 
   return true;
 }
 
+void
+NamesPriv::Insert (NameNode *parent, const std::string &name, Ptr<Object> object)
+{
+  NS_LOG_FUNCTION (this << parent << name << object);
+  NameNode *newNode = new NameNode (parent, name, object);
+  parent->m_nameMap[name] = newNode;
+  m_objectMap[PeekPointer (object)] = newNode;
+  m_pathMap[newNode->m_path] = newNode;
+}
+
+void
+NamesPriv::UpdatePaths (NameNode *node)
+{
+  NS_LOG_FUNCTION (this << node);
+  m_pathMap.erase (node->m_path);
+  node->m_path = node->m_parent->m_path + "/" + node->m_name;
+  m_pathMap[node->m_path] = node;
+  for (std::unordered_map<std::string, NameNode *>::iterator i = node->m_nameMap.begin ();
+       i != node->m_nameMap.end (); ++i)
+    {
+      UpdatePaths (i->second);
+    }
+}
+
 bool
 NamesPriv::Rename (std::string oldpath, std::string newname)
 {
@@ -518,7 +695,7 @@ NamesPriv::Rename (Ptr<Object> context, std::string oldname, std::string newname
       return false;
     }
 
-  std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (oldname);
+  std::unordered_map<std::string, NameNode *>::iterator i = node->m_nameMap.find (oldname);
   if (i == node->m_nameMap.end ())
     {
       NS_LOG_LOGIC ("Old name does not exist in name map");
@@ -533,12 +710,15 @@ NamesPriv::Rename (Ptr<Object> context, std::string oldname, std::string newname
       // 1.  Getting the pointer to the name node from the map and remembering it;
       // 2.  Removing the map entry corresponding to oldname from the map;
       // 3.  Changing the name string in the name node;
-      // 4.  Adding the name node back in the map under the newname.
+      // 4.  Adding the name node back in the map under the newname;
+      // 5.  Updating the cached paths of the node and its descendants.
       //
       NameNode *changeNode = i->second;
       node->m_nameMap.erase (i);
       changeNode->m_name = newname;
       node->m_nameMap[newname] = changeNode;
+      UpdatePaths (changeNode);
+      Config::InvalidateMatchCache ();
       return true;
     }
 }
@@ -548,8 +728,8 @@ NamesPriv::FindName (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
-  if (i == m_objectMap.end ())
+  NameNode *node = IsNamed (object);
+  if (node == 0)
     {
       NS_LOG_LOGIC ("Object does not exist in object map");
       return "";
@@ -557,7 +737,7 @@ NamesPriv::FindName (Ptr<Object> object)
   else
     {
       NS_LOG_LOGIC ("Object exists in object map");
-      return i->second->m_name;
+      return node->m_name;
     }
 }
 
@@ -566,26 +746,15 @@ NamesPriv::FindPath (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
-  if (i == m_objectMap.end ())
+  NameNode *p = IsNamed (object);
+  if (p == 0)
     {
       NS_LOG_LOGIC ("Object does not exist in object map");
       return "";
     }
 
-  NameNode *p = i->second;
-  NS_ASSERT_MSG (p, "NamesPriv::FindFullName(): Internal error: Invalid NameNode pointer from map");
-
-  std::string path;
-
-  do
-    {
-      path = "/" + p->m_name + path;
-      NS_LOG_LOGIC ("path is " << path);
-    }
-  while ((p = p->m_parent) != 0);
-
-  return path;
+  NS_LOG_LOGIC ("path is " << p->m_path);
+  return p->m_path;
 }
 
 
@@ -609,78 +778,31 @@ NamesPriv::Find (std::string path)
 
   NS_LOG_FUNCTION (this << path);
   std::string namespaceName = "/Names/";
-  std::string remaining;
 
-  std::string::size_type offset = path.find (namespaceName);
-  if (offset == 0)
+  //
+  // Every NameNode is entered in the path map under its fully qualified
+  // path, so once the path has been canonicalized the whole lookup is a
+  // single hash probe rather than a walk down the tree.
+  //
+  std::unordered_map<std::string, NameNode *>::iterator i;
+  if (path.compare (0, namespaceName.size (), namespaceName) == 0)
     {
       NS_LOG_LOGIC (path << " is a fully qualified name");
-      remaining = path.substr (namespaceName.size ());
+      i = m_pathMap.find (path);
     }
   else
     {
       NS_LOG_LOGIC (path << " begins with a relative name");
-      remaining = path;
+      i = m_pathMap.find (namespaceName + path);
     }
 
-  NameNode *node = &m_root;
-
-  //
-  // The string <remaining> is now composed entirely of path segments in
-  // the /Names name space and we have eaten the leading slash. e.g., 
-  // remaining = "ClientNode/eth0"
-  //
-  // The start of the search is always at the root of the name space.
-  //
-  for (;;)
+  if (i == m_pathMap.end ())
     {
-      NS_LOG_LOGIC ("Looking for the object of name " << remaining);
-      offset = remaining.find ("/");
-      if (offset == std::string::npos)
-        {
-          //
-          // There are no remaining slashes so this is the last segment of the 
-          // specified name.  We're done when we find it
-          //
-          std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (remaining);
-          if (i == node->m_nameMap.end ())
-            {
-              NS_LOG_LOGIC ("Name does not exist in name map");
-              return 0;
-            }
-          else
-            {
-              NS_LOG_LOGIC ("Name parsed, found object");
-              return i->second->m_object;
-            }
-        }
-      else
-        {
-          //
-          // There are more slashes so this is an intermediate segment of the 
-          // specified name.  We need to "recurse" when we find this segment.
-          //
-          offset = remaining.find ("/");
-          std::string segment = remaining.substr (0, offset);
-
-          std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (segment);
-          if (i == node->m_nameMap.end ())
-            {
-              NS_LOG_LOGIC ("Name does not exist in name map");
-              return 0;
-            }
-          else
-            {
-              node = i->second;
-              remaining = remaining.substr (offset + 1);
-              NS_LOG_LOGIC ("Intermediate segment parsed");
-              continue;
-            }
-        }
+      NS_LOG_LOGIC ("Name does not exist in path map");
+      return 0;
     }
-
-  NS_ASSERT_MSG (node, "NamesPriv::Find(): Internal error:  this can't happen");
-  return 0;
+  NS_LOG_LOGIC ("Name parsed, found object");
+  return i->second->m_object;
 }
 
 Ptr<Object>
@@ -717,7 +839,7 @@ NamesPriv::Find (Ptr<Object> context, std::string name)
         }
     }
 
-  std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (name);
+  std::unordered_map<std::string, NameNode *>::iterator i = node->m_nameMap.find (name);
   if (i == node->m_nameMap.end ())
     {
       NS_LOG_LOGIC ("Name does not exist in name map");
@@ -735,7 +857,7 @@ NamesPriv::IsNamed (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
+  std::unordered_map<const Object *, NameNode *>::iterator i = m_objectMap.find (PeekPointer (object));
   if (i == m_objectMap.end ())
     {
       NS_LOG_LOGIC ("Object does not exist in object map, returning NameNode 0");
@@ -749,11 +871,11 @@ NamesPriv::IsNamed (Ptr<Object> object)
 }
 
 bool
-NamesPriv::IsDuplicateName (NameNode *node, std::string name)
+NamesPriv::IsDuplicateName (NameNode *node, const std::string &name)
 {
   NS_LOG_FUNCTION (this << node << name);
 
-  std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (name);
+  std::unordered_map<std::string, NameNode *>::iterator i = node->m_nameMap.find (name);
   if (i == node->m_nameMap.end ())
     {
       NS_LOG_LOGIC ("Name does not exist in name map");
@@ -836,6 +958,24 @@ Names::Clear (void)
   return NamesPriv::Get ()->Clear ();
 }
 
+void
+Names::AddMany (std::string path, const std::vector<std::string> &names,
+                const std::vector<Ptr<Object> > &objects)
+{
+  NS_LOG_FUNCTION (path << names.size ());
+  bool result = NamesPriv::Get ()->AddMany (path, names, objects);
+  NS_ABORT_MSG_UNLESS (result, "Names::AddMany(): Error adding " << names.size () << " names under " << path);
+}
+
+void
+Names::AddMany (Ptr<Object> context, const std::vector<std::string> &names,
+                const std::vector<Ptr<Object> > &objects)
+{
+  NS_LOG_FUNCTION (context << names.size ());
+  bool result = NamesPriv::Get ()->AddMany (context, names, objects);
+  NS_ABORT_MSG_UNLESS (result, "Names::AddMany(): Error adding " << names.size () << " names under context " << context);
+}
+
 Ptr<Object>
 Names::FindInternal (std::string name)
 {
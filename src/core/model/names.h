@@ -19,6 +19,7 @@
 #ifndef OBJECT_NAMES_H
 #define OBJECT_NAMES_H
 
+#include <vector>
 #include "ptr.h"
 #include "object.h"
 
@@ -171,6 +172,48 @@ public:
    */
   static void Add (Ptr<Object> context, std::string name, Ptr<Object> object);
 
+  /**
+   * \brief Associate many names with objects under a single path.
+   *
+   * This is equivalent to calling Names::Add (path, names[i], objects[i])
+   * for every element, but the whole batch is checked before any name
+   * is defined, storage is reserved once, and dependent caches (such as
+   * the Config path match cache) are invalidated once at the end.
+   * Topology loaders that name every node and device should prefer
+   * this over repeated calls to Add.
+   *
+   * The same rules as Names::Add apply: every name must be unique at
+   * this level of the name space, both against existing names and
+   * within the batch, and no object may already be named.
+   *
+   * \param [in] path A path name describing a previously named object
+   *             under which you want the new names to be defined,
+   *             or "/Names" for the root of the name space.
+   * \param [in] names The names of the objects you want to associate.
+   * \param [in] objects Smart pointers to the objects themselves;
+   *             must be the same length as \p names.
+   */
+  static void AddMany (std::string path, const std::vector<std::string> &names,
+                       const std::vector<Ptr<Object> > &objects);
+
+  /**
+   * \brief Associate many names with objects under a single context.
+   *
+   * This is the context-based form of
+   * AddMany(std::string,const std::vector<std::string>&,const std::vector<Ptr<Object> >&)
+   * and follows the same rules.
+   *
+   * \param [in] context A smart pointer to an object that is used
+   *             in place of the path under which you want the new
+   *             names to be defined; a null pointer means the root
+   *             of the name space.
+   * \param [in] names The names of the objects you want to associate.
+   * \param [in] objects Smart pointers to the objects themselves;
+   *             must be the same length as \p names.
+   */
+  static void AddMany (Ptr<Object> context, const std::vector<std::string> &names,
+                       const std::vector<Ptr<Object> > &objects);
+
   /**
    * \brief Rename a previously associated name.
    *
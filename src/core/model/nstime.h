@@ -441,6 +441,50 @@ public:
   }
   inline static Time FromDouble (double value, enum Unit unit)
   {
+    struct Information *info = PeekInformation (unit);
+    if (info->fromMul && int64x64_t::implementation != int64x64_t::ld_impl)
+      {
+        // Fast path: with value = m 2^-s, floor (value * factor) is
+        // computed with integers, exactly as From() would.  Like
+        // int64x64_t, round m 2^-s to 64 fractional bits first.
+        int exponent;
+        const double mantissa = std::frexp (value, &exponent);
+        int shift = 53 - exponent;
+        if (shift > 0)
+          {
+            const int64_t m = static_cast<int64_t> (std::ldexp (mantissa, 53));
+            uint64_t absM = m < 0 ? -static_cast<uint64_t> (m) : m;
+            if (shift > 64)
+              {
+                const int extra = shift - 64;
+                absM = extra < 64 ? (absM + (1ULL << (extra - 1))) >> extra : 0;
+                shift = 64;
+              }
+            uint64_t hi, lo;
+            Multiply (absM, info->factor, hi, lo);
+            uint64_t q, r;
+            if (shift == 64)
+              {
+                q = hi;
+                r = lo;
+              }
+            else
+              {
+                q = (hi << (64 - shift)) | (lo >> shift);
+                r = lo << (64 - shift);
+                hi >>= shift;
+              }
+            if ((shift == 64 || hi == 0)
+                && q <= static_cast<uint64_t> (std::numeric_limits<int64_t>::max ()))
+              {
+                if (m < 0)
+                  {
+                    return Time (-static_cast<int64_t> (q) - (r != 0 ? 1 : 0));
+                  }
+                return Time (static_cast<int64_t> (q));
+              }
+          }
+      }
     return From (int64x64_t (value), unit);
   }
   inline static Time From (const int64x64_t & value, enum Unit unit)
@@ -490,7 +534,31 @@ public:
   }
   inline double ToDouble (enum Unit unit) const
   {
-    return To (unit).GetDouble ();
+    struct Information *info = PeekInformation (unit);
+    if (int64x64_t::implementation == int64x64_t::ld_impl)
+      {
+        return To (unit).GetDouble ();
+      }
+    const uint64_t absData = m_data < 0 ? -static_cast<uint64_t> (m_data) : m_data;
+    if (info->toMul)
+      {
+        // Fast path: the product is an integer, exact in To().
+        if (absData <= static_cast<uint64_t> (info->maxTo))
+          {
+            return static_cast<double> (m_data * info->factor);
+          }
+        return To (unit).GetDouble ();
+      }
+    // Fast path: the same multiplication by the inverse of the factor,
+    // and the same rounding, as To() and int64x64_t::GetDouble().
+    uint64_t hi, lo, midHi, midLo;
+    Multiply (absData, info->timeTo.GetHigh (), hi, lo);
+    Multiply (absData, info->timeTo.GetLow (), midHi, midLo);
+    lo += midHi;
+    hi += (lo < midHi) ? 1 : 0;
+    long double retval = hi;
+    retval += lo * (1.0L / 18446744073709551616.0L);
+    return m_data < 0 ? -retval : retval;
   }
   inline int64x64_t To (enum Unit unit) const
   {
@@ -540,6 +608,7 @@ private:
     int64_t factor;                 //!< Ratio of this unit / current unit
     int64x64_t timeTo;              //!< Multiplier to convert to this unit
     int64x64_t timeFrom;            //!< Multiplier to convert from this unit
+    int64_t maxTo;                  //!< Largest magnitude which converts To this unit without overflow
   };
   /** Current time unit, and conversion info. */
   struct Resolution
@@ -569,6 +638,33 @@ private:
     return & (PeekResolution ()->info[timeUnit]);
   }
 
+  /**
+   *  Multiply two integers to 128 bits.
+   *
+   *  \param [in] a The first factor.
+   *  \param [in] b The second factor.
+   *  \param [out] hi The high 64 bits of the product.
+   *  \param [out] lo The low 64 bits of the product.
+   */
+  static inline void Multiply (uint64_t a, uint64_t b, uint64_t & hi, uint64_t & lo)
+  {
+#if defined (INT64X64_USE_128) && !defined (PYTHON_SCAN)
+    const uint128_t product = static_cast<uint128_t> (a) * b;
+    hi = product >> 64;
+    lo = product;
+#else
+    const uint64_t aL = a & 0xffffffffULL;
+    const uint64_t aH = a >> 32;
+    const uint64_t bL = b & 0xffffffffULL;
+    const uint64_t bH = b >> 32;
+    const uint64_t loPart = aL * bL;
+    const uint64_t mid1 = aH * bL + (loPart >> 32);
+    const uint64_t mid2 = aL * bH + (mid1 & 0xffffffffULL);
+    hi = aH * bH + (mid1 >> 32) + (mid2 >> 32);
+    lo = (mid2 << 32) | (loPart & 0xffffffffULL);
+#endif
+  }
+
   /**
    *  Set the default resolution
    *
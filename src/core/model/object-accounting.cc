@@ -0,0 +1,436 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "object-accounting.h"
+#include "ns3/core-config.h"
+#include "type-id.h"
+#include "global-value.h"
+#include "double.h"
+#include "string.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#ifdef __GNUC__
+#include <cxxabi.h>
+#endif
+
+#ifdef HAVE_PTHREAD_H
+#include "callback.h"
+#include "system-condition.h"
+#include "system-thread.h"
+#endif
+
+/**
+ * \file
+ * \ingroup object
+ * ns3::ObjectAccounting implementation.
+ */
+
+namespace ns3 {
+
+namespace {
+
+#ifdef ENABLE_OBJECT_ACCOUNTING
+/**
+ * \ingroup object
+ * The wall clock interval between object accounting reports.
+ */
+GlobalValue g_accountingInterval =
+  GlobalValue ("ObjectAccountingInterval",
+               "The wall clock interval, in seconds, between reports of the "
+               "live objects, or 0 to report only when the program exits",
+               DoubleValue (0),
+               MakeDoubleChecker<double> (0));
+
+/**
+ * \ingroup object
+ * The file of the object accounting reports.
+ */
+GlobalValue g_accountingFile =
+  GlobalValue ("ObjectAccountingFile",
+               "The file to write the reports of the live objects to, "
+               "or empty for std::cerr",
+               StringValue (""),
+               MakeStringChecker ());
+#endif /* ENABLE_OBJECT_ACCOUNTING */
+
+/** The list of all counters. */
+std::atomic<ObjectAccounting::Counter *> g_counters (0);
+
+/**
+ * \ingroup object
+ * Writes the reports.
+ *
+ * Created with the first counter, and never deleted, so that
+ * instances destroyed by static destructors can still be counted.
+ */
+class Reporter
+{
+public:
+  /** Constructor. */
+  Reporter ();
+  /**
+   * Open the output file and start the periodic reports.
+   * \param [in] filename The output file, or empty for std::cerr.
+   * \param [in] interval The wall clock interval, in seconds.
+   */
+  void Start (const std::string &filename, double interval);
+  /** Stop the periodic reports, and write the final report. */
+  void Finish (void);
+
+private:
+  /**
+   * Write a report.
+   * \param [in] label What the report is.
+   */
+  void Report (const std::string &label);
+  /** Run the periodic reports thread. */
+  void Run (void);
+
+  bool m_started;                   //!< Whether Start() was called.
+  std::ofstream m_file;             //!< The output file, if any.
+  std::ostream *m_os;               //!< The output stream.
+  double m_interval;                //!< The interval, in seconds.
+  /** The time Start() was called. */
+  std::chrono::steady_clock::time_point m_start;
+#ifdef HAVE_PTHREAD_H
+  Ptr<SystemThread> m_thread;       //!< The periodic reports thread.
+  SystemCondition m_wakeup;         //!< Wakes up the thread to stop it.
+  std::atomic<bool> m_stop;         //!< Set to stop the thread.
+#endif
+};
+
+Reporter::Reporter ()
+  : m_started (false),
+    m_os (&std::cerr),
+    m_interval (0)
+{
+#ifdef HAVE_PTHREAD_H
+  m_stop = false;
+#endif
+}
+
+void
+Reporter::Start (const std::string &filename, double interval)
+{
+  if (m_started)
+    {
+      return;
+    }
+  m_started = true;
+  m_start = std::chrono::steady_clock::now ();
+  if (!filename.empty ())
+    {
+      m_file.open (filename.c_str ());
+      if (m_file.good ())
+        {
+          m_os = &m_file;
+        }
+    }
+  m_interval = interval;
+#ifdef HAVE_PTHREAD_H
+  if (m_interval > 0)
+    {
+      m_thread = Create<SystemThread> (MakeCallback (&Reporter::Run, this));
+      m_thread->Start ();
+    }
+#endif
+}
+
+void
+Reporter::Run (void)
+{
+#ifdef HAVE_PTHREAD_H
+  uint64_t ns = static_cast<uint64_t> (m_interval * 1e9);
+  while (true)
+    {
+      m_wakeup.TimedWait (ns);
+      if (m_stop)
+        {
+          break;
+        }
+      Report ("sample");
+    }
+#endif
+}
+
+void
+Reporter::Finish (void)
+{
+#ifdef HAVE_PTHREAD_H
+  if (m_thread != 0)
+    {
+      m_stop = true;
+      m_wakeup.SetCondition (true);
+      m_wakeup.Signal ();
+      m_thread->Join ();
+      m_thread = 0;
+    }
+#endif
+  Report ("exit");
+  if (m_file.is_open ())
+    {
+      m_file.close ();
+      m_os = &std::cerr;
+    }
+}
+
+void
+Reporter::Report (const std::string &label)
+{
+  double elapsed = 0;
+  if (m_started)
+    {
+      elapsed = std::chrono::duration<double> (std::chrono::steady_clock::now () - m_start).count ();
+    }
+  *m_os << "# object accounting, " << label << " after "
+        << std::fixed << std::setprecision (3) << elapsed << " s" << std::endl;
+  ObjectAccounting::Print (*m_os);
+  m_os->flush ();
+}
+
+/**
+ * \ingroup object
+ * Get the reporter.
+ * \returns The reporter.
+ */
+Reporter *
+GetReporter (void)
+{
+  static Reporter *reporter = new Reporter ();
+  return reporter;
+}
+
+/**
+ * \ingroup object
+ * Write the final report when the program exits.
+ */
+void
+FinishAtExit (void)
+{
+  GetReporter ()->Finish ();
+}
+
+/**
+ * \ingroup object
+ * Create a counter, and add it to the list of all counters.
+ *
+ * \param [in] name The name of the counted type.
+ * \param [in] size The size of one instance.
+ * \returns The counter.
+ */
+ObjectAccounting::Counter *
+NewCounter (const std::string &name, std::size_t size)
+{
+  ObjectAccounting::Counter *counter = new ObjectAccounting::Counter;
+  counter->name = name;
+  counter->live = 0;
+  counter->peak = 0;
+  counter->total = 0;
+  counter->bytes = 0;
+  counter->peakBytes = 0;
+  counter->size = size;
+  counter->next = g_counters.load ();
+  if (counter->next == 0)
+    {
+      // The first counter: report when the program exits.
+      GetReporter ();
+      std::atexit (&FinishAtExit);
+    }
+  while (!g_counters.compare_exchange_weak (counter->next, counter))
+    {
+    }
+  return counter;
+}
+
+/**
+ * \ingroup object
+ * Get the table of the counters of each TypeId, indexed by TypeId uid.
+ * \returns The table.
+ */
+std::atomic<ObjectAccounting::Counter *> *
+GetTypeIdCounters (void)
+{
+  static std::atomic<ObjectAccounting::Counter *> *counters =
+    new std::atomic<ObjectAccounting::Counter *> [1 << 16] ();
+  return counters;
+}
+
+/**
+ * \ingroup object
+ * A row of the report.
+ */
+struct Row
+{
+  std::string name;     //!< The type name.
+  int64_t live;         //!< The live instances.
+  int64_t peak;         //!< The peak live instances.
+  uint64_t total;       //!< The instances ever constructed.
+  int64_t bytes;        //!< The live bytes.
+  int64_t peakBytes;    //!< The peak bytes.
+};
+
+/**
+ * \ingroup object
+ * Compare rows by decreasing bytes, then by name.
+ * \param [in] a The first row.
+ * \param [in] b The second row.
+ * \returns \c true if \p a is printed before \p b.
+ */
+bool
+LargerRow (const Row &a, const Row &b)
+{
+  if (a.bytes != b.bytes)
+    {
+      return a.bytes > b.bytes;
+    }
+  return a.name < b.name;
+}
+
+} // unnamed namespace
+
+
+ObjectAccounting::Counter *
+ObjectAccounting::GetCounter (TypeId tid)
+{
+  std::atomic<Counter *> &slot = GetTypeIdCounters ()[tid.GetUid ()];
+  Counter *counter = slot.load (std::memory_order_acquire);
+  if (counter == 0)
+    {
+      // Counters are never deleted, so if another thread wins the
+      // race, the counter created here is merely unused.
+      Counter *created = NewCounter (tid.GetName (), 0);
+      if (slot.compare_exchange_strong (counter, created, std::memory_order_acq_rel))
+        {
+          counter = created;
+        }
+    }
+  return counter;
+}
+
+ObjectAccounting::Counter *
+ObjectAccounting::GetCounter (const std::type_info &type, std::size_t size)
+{
+  std::string name = type.name ();
+#ifdef __GNUC__
+  int status;
+  char *demangled = abi::__cxa_demangle (name.c_str (), 0, 0, &status);
+  if (status == 0 && demangled != 0)
+    {
+      name = demangled;
+    }
+  std::free (demangled);
+#endif
+  return NewCounter (name, size);
+}
+
+ObjectAccounting::Counter *
+ObjectAccounting::GetCounter (const std::string &name, std::size_t size)
+{
+  return NewCounter (name, size);
+}
+
+void
+ObjectAccounting::SetSize (TypeId tid, std::size_t size)
+{
+  GetCounter (tid)->size.store (size, std::memory_order_relaxed);
+}
+
+void
+ObjectAccounting::Print (std::ostream &os)
+{
+  // Counters of the same name, such as the SimpleRefCount counters of
+  // one type in several libraries, are merged.
+  std::vector<Row> rows;
+  for (Counter *counter = g_counters.load (); counter != 0; counter = counter->next)
+    {
+      if (counter->total == 0)
+        {
+          continue;
+        }
+      Row row;
+      row.name = counter->name;
+      row.live = counter->live;
+      row.peak = counter->peak;
+      row.total = counter->total;
+      row.bytes = counter->bytes + row.live * static_cast<int64_t> (counter->size);
+      row.peakBytes = counter->peakBytes + row.peak * static_cast<int64_t> (counter->size);
+      std::vector<Row>::iterator i = rows.begin ();
+      while (i != rows.end () && i->name != row.name)
+        {
+          ++i;
+        }
+      if (i == rows.end ())
+        {
+          rows.push_back (row);
+        }
+      else
+        {
+          i->live += row.live;
+          i->peak += row.peak;
+          i->total += row.total;
+          i->bytes += row.bytes;
+          i->peakBytes += row.peakBytes;
+        }
+    }
+  std::sort (rows.begin (), rows.end (), &LargerRow);
+
+  os << std::setw (12) << "live"
+     << std::setw (12) << "peak"
+     << std::setw (14) << "total"
+     << std::setw (14) << "bytes"
+     << std::setw (14) << "peak bytes"
+     << "  type" << std::endl;
+  for (std::vector<Row>::const_iterator i = rows.begin (); i != rows.end (); ++i)
+    {
+      os << std::setw (12) << i->live
+         << std::setw (12) << i->peak
+         << std::setw (14) << i->total
+         << std::setw (14) << i->bytes
+         << std::setw (14) << i->peakBytes
+         << "  " << i->name << std::endl;
+    }
+}
+
+void
+ObjectAccounting::Start (void)
+{
+  static bool started = false;
+  if (started)
+    {
+      return;
+    }
+  started = true;
+  double interval = 0;
+  std::string filename;
+#ifdef ENABLE_OBJECT_ACCOUNTING
+  DoubleValue intervalValue;
+  g_accountingInterval.GetValue (intervalValue);
+  interval = intervalValue.Get ();
+  StringValue filenameValue;
+  g_accountingFile.GetValue (filenameValue);
+  filename = filenameValue.Get ();
+#endif
+  GetReporter ()->Start (filename, interval);
+}
+
+} // namespace ns3
@@ -0,0 +1,207 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef OBJECT_ACCOUNTING_H
+#define OBJECT_ACCOUNTING_H
+
+#include <atomic>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup object
+ * ns3::ObjectAccounting declaration.
+ */
+
+namespace ns3 {
+
+class TypeId;
+
+/**
+ * \ingroup object
+ * \brief Counts the live instances of each TypeId and reference
+ * counted type, to find which model holds the memory of a simulation.
+ *
+ * When ns-3 is configured with
+ * \verbatim
+   $ waf configure ... --enable-object-accounting \endverbatim
+ * each Object is counted under its TypeId, each other SimpleRefCount
+ * instance under its C++ type, and the packet Buffer data under
+ * \c ns3::Buffer::Data.  For each of them, the report gives the number
+ * of live instances, the peak number of live instances, the number of
+ * instances ever constructed, and the approximate bytes they use: the
+ * size of the C++ type times the number of instances, or the exact
+ * size for the Buffer data.
+ *
+ * The report is written when the program exits.  Setting the
+ * \c ObjectAccountingInterval global value to a non-zero (wall clock)
+ * interval also writes it periodically while the program runs.  The
+ * report is written to the file named by the \c ObjectAccountingFile
+ * global value, or to \c std::cerr.  Both global values are read when
+ * the simulation starts running, so they can be set with CommandLine.
+ *
+ * Without the configure option, the hooks are compiled out, and the
+ * report is empty.
+ */
+class ObjectAccounting
+{
+public:
+  /** The counts of one type. */
+  struct Counter
+  {
+    std::string name;                 //!< The type name.
+    std::atomic<int64_t> live;        //!< The live instances.
+    std::atomic<int64_t> peak;        //!< The peak live instances.
+    std::atomic<uint64_t> total;      //!< The instances ever constructed.
+    std::atomic<int64_t> bytes;       //!< The bytes counted explicitly.
+    std::atomic<int64_t> peakBytes;   //!< The peak of \c bytes.
+    std::atomic<uint64_t> size;       //!< The size of one instance.
+    Counter *next;                    //!< The next Counter of the list.
+  };
+
+  /**
+   * Get the counter of Objects of a TypeId.
+   *
+   * \param [in] tid The TypeId.
+   * \returns The counter.
+   */
+  static Counter * GetCounter (TypeId tid);
+  /**
+   * Get the counter of a C++ type.
+   *
+   * \param [in] type The type.
+   * \param [in] size The size of one instance.
+   * \returns The counter.
+   */
+  static Counter * GetCounter (const std::type_info &type, std::size_t size);
+  /**
+   * Get a counter by name.
+   *
+   * \param [in] name The name of the counted items.
+   * \param [in] size The size of one item, or 0 if the bytes are
+   *             counted explicitly.
+   * \returns The counter.
+   */
+  static Counter * GetCounter (const std::string &name, std::size_t size);
+
+  /**
+   * Set the size of the Objects of a TypeId.
+   *
+   * \param [in] tid The TypeId.
+   * \param [in] size The size of the C++ type created for \p tid.
+   */
+  static void SetSize (TypeId tid, std::size_t size);
+
+  /**
+   * Count a new instance.
+   *
+   * \param [in] counter The counter of its type.
+   * \param [in] bytes The bytes it uses, in addition to the size
+   *             of the counter.
+   */
+  static void Add (Counter *counter, int64_t bytes = 0);
+  /**
+   * Count a deleted instance.
+   *
+   * \param [in] counter The counter of its type.
+   * \param [in] bytes The bytes given to Add().
+   */
+  static void Remove (Counter *counter, int64_t bytes = 0);
+  /**
+   * Count an instance under another type, as when an Object
+   * learns its TypeId after it is constructed.
+   *
+   * \param [in] from The counter of its old type.
+   * \param [in] to The counter of its new type.
+   */
+  static void Move (Counter *from, Counter *to);
+
+  /**
+   * Print the counters of the types with live or past instances,
+   * largest first.
+   *
+   * \param [in,out] os The stream to print on.
+   */
+  static void Print (std::ostream &os);
+
+  /**
+   * Read the global values, and start the periodic reports.
+   * Called when the simulation starts running; only the first
+   * call has any effect.
+   */
+  static void Start (void);
+
+private:
+  /**
+   * Raise a peak to a new value.
+   *
+   * \param [in,out] peak The peak.
+   * \param [in] value The new value.
+   */
+  static void UpdatePeak (std::atomic<int64_t> &peak, int64_t value);
+};
+
+inline void
+ObjectAccounting::UpdatePeak (std::atomic<int64_t> &peak, int64_t value)
+{
+  int64_t current = peak.load (std::memory_order_relaxed);
+  while (value > current
+         && !peak.compare_exchange_weak (current, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+inline void
+ObjectAccounting::Add (Counter *counter, int64_t bytes)
+{
+  int64_t live = counter->live.fetch_add (1, std::memory_order_relaxed) + 1;
+  UpdatePeak (counter->peak, live);
+  counter->total.fetch_add (1, std::memory_order_relaxed);
+  if (bytes != 0)
+    {
+      int64_t total = counter->bytes.fetch_add (bytes, std::memory_order_relaxed) + bytes;
+      UpdatePeak (counter->peakBytes, total);
+    }
+}
+
+inline void
+ObjectAccounting::Remove (Counter *counter, int64_t bytes)
+{
+  counter->live.fetch_sub (1, std::memory_order_relaxed);
+  if (bytes != 0)
+    {
+      counter->bytes.fetch_sub (bytes, std::memory_order_relaxed);
+    }
+}
+
+inline void
+ObjectAccounting::Move (Counter *from, Counter *to)
+{
+  if (from != to)
+    {
+      from->live.fetch_sub (1, std::memory_order_relaxed);
+      from->total.fetch_sub (1, std::memory_order_relaxed);
+      Add (to);
+    }
+}
+
+} // namespace ns3
+
+#endif /* OBJECT_ACCOUNTING_H */
@@ -22,7 +22,14 @@
 #include "trace-source-accessor.h"
 #include "attribute-construction-list.h"
 #include "string.h"
+#include "pointer.h"
+#include "object-ptr-container.h"
+#include "object-factory.h"
+#include "simple-ref-count.h"
+#include "simulation-local.h"
 #include "ns3/core-config.h"
+#include <map>
+#include <vector>
 #ifdef HAVE_STDLIB_H
 #include <cstdlib>
 #endif
@@ -76,93 +83,243 @@ ObjectBase::NotifyConstructionCompleted (void)
   NS_LOG_FUNCTION (this);
 }
 
-void
-ObjectBase::ConstructSelf (const AttributeConstructionList &attributes)
+namespace {
+
+/**
+ * \ingroup object
+ * One attribute to initialize in ObjectBase::ConstructSelf.
+ */
+struct ConstructionStep
+{
+  /** The TypeId which declares the attribute, for error messages. */
+  TypeId tid;
+  /** The attribute name, for error messages. */
+  std::string name;
+  /** \c true if the attribute may be set at construction. */
+  bool construct;
+  /** The attribute accessor. */
+  Ptr<const AttributeAccessor> accessor;
+  /** The attribute checker. */
+  Ptr<const AttributeChecker> checker;
+  /** The default value. */
+  Ptr<const AttributeValue> value;
+  /** \c true if \c value is already valid for the checker. */
+  bool valid;  /**
+   * The value of the NS_ATTRIBUTE_DEFAULT environment variable, set
+   * before the default value, or null.
+   */
+  Ptr<const AttributeValue> env;
+};
+
+/**
+ * \ingroup object
+ * The attributes to initialize for a TypeId, in the order of
+ * ObjectBase::ConstructSelf: the attributes of the TypeId, then those
+ * of its parent, and so on.
+ */
+struct ConstructionPlan : public SimpleRefCount<ConstructionPlan>
+{
+  /** The TypeId attribute generation the plan was built for. */
+  uint32_t generation;
+  /** The attributes. */
+  std::vector<ConstructionStep> steps;
+};
+
+/**
+ * \ingroup object
+ * Check if converting a string to a value of a checker may create
+ * objects, so that the conversion must be done again for each object
+ * instead of sharing its result.
+ *
+ * \param [in] checker The checker.
+ * \returns \c true if the conversion may create objects.
+ */
+bool
+MayCreateObjects (Ptr<const AttributeChecker> checker)
+{
+  return dynamic_cast<const PointerChecker *> (PeekPointer (checker)) != 0
+    || dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (checker)) != 0
+    || dynamic_cast<const ObjectFactoryChecker *> (PeekPointer (checker)) != 0;
+}
+
+/**
+ * \ingroup object
+ * Find the default value of an attribute in the NS_ATTRIBUTE_DEFAULT
+ * environment variable.
+ *
+ * \param [in] fullName The full name of the attribute.
+ * \param [out] value The value.
+ * \returns \c true if the variable sets the attribute.
+ */
+bool
+GetEnvironmentDefault (std::string fullName, std::string *value)
+{
+#ifdef HAVE_GETENV
+  char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
+  if (envVar != 0)
+    {
+      std::string env = std::string (envVar);
+      std::string::size_type cur = 0;
+      std::string::size_type next = 0;
+      while (next != std::string::npos)
+        {
+          next = env.find (";", cur);
+          std::string tmp = std::string (env, cur, next-cur);
+          std::string::size_type equal = tmp.find ("=");
+          if (equal != std::string::npos)
+            {
+              std::string name = tmp.substr (0, equal);
+              if (name == fullName)
+                {
+                  *value = tmp.substr (equal+1, tmp.size () - equal - 1);
+                  return true;
+                }
+            }
+          cur = next + 1;
+        }
+    }
+#endif /* HAVE_GETENV */
+  return false;
+}
+
+/**
+ * \ingroup object
+ * Build the construction plan of a TypeId.
+ *
+ * \param [in] instanceTid The TypeId.
+ * \returns The plan.
+ */
+Ptr<const ConstructionPlan>
+BuildConstructionPlan (TypeId instanceTid)
 {
+  NS_LOG_FUNCTION (instanceTid.GetName ());
+  Ptr<ConstructionPlan> plan = Create<ConstructionPlan> ();
+  plan->generation = TypeId::GetAttributeGeneration ();
+  TypeId tid = instanceTid;
   // loop over the inheritance tree back to the Object base class.
-  NS_LOG_FUNCTION (this << &attributes);
-  TypeId tid = GetInstanceTypeId ();
   do {
-      // loop over all attributes in object type
-      NS_LOG_DEBUG ("construct tid="<<tid.GetName ()<<", params="<<tid.GetAttributeN ());
       for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
         {
-          struct TypeId::AttributeInformation info = tid.GetAttribute(i);
-          NS_LOG_DEBUG ("try to construct \""<< tid.GetName ()<<"::"<<
-                        info.name <<"\"");
-          // is this attribute stored in this AttributeConstructionList instance ?
-          Ptr<AttributeValue> value = attributes.Find(info.checker);
-          // See if this attribute should not be set here in the
-          // constructor.
-          if (!(info.flags & TypeId::ATTR_CONSTRUCT))
+          struct TypeId::AttributeInformation info = tid.GetAttribute (i);
+          ConstructionStep step;
+          step.tid = tid;
+          step.name = info.name;
+          step.construct = (info.flags & TypeId::ATTR_CONSTRUCT) != 0;
+          step.accessor = info.accessor;
+          step.checker = info.checker;
+          step.value = info.initialValue;
+          std::string env;
+          if (GetEnvironmentDefault (tid.GetAttributeFullName (i), &env))
             {
-              // Handle this attribute if it should not be 
-              // set here.
-              if (value == 0)
-                {
-                  // Skip this attribute if it's not in the
-                  // AttributeConstructionList.
-                  continue;
-                }              
-              else
+              step.env = Create<StringValue> (env);
+            }
+          step.valid = info.checker->Check (*step.value);
+          if (!step.valid && !MayCreateObjects (info.checker))
+            {
+              // convert the string once and for all
+              Ptr<const AttributeValue> v = info.checker->CreateValidValue (*step.value);
+              if (v != 0)
                 {
-                  // This is an error because this attribute is not
-                  // settable in its constructor but is present in
-                  // the AttributeConstructionList.
-                  NS_FATAL_ERROR ("Attribute name="<<info.name<<" tid="<<tid.GetName () << ": initial value cannot be set using attributes");
+                  step.value = v;
+                  step.valid = true;
                 }
             }
+          plan->steps.push_back (step);
+        }
+      tid = tid.GetParent ();
+    } while (tid != ObjectBase::GetTypeId ());
+  return plan;
+}
+
+/**
+ * \ingroup object
+ * Get the construction plan of a TypeId, building it if needed.
+ *
+ * The plan is shared: constructing an attribute may construct other
+ * objects, and change the defaults, which replaces the plan in the
+ * cache but not the one being used.
+ *
+ * \param [in] tid The TypeId.
+ * \returns The plan.
+ */
+Ptr<const ConstructionPlan>
+GetConstructionPlan (TypeId tid)
+{
+  // The plans are reference counted without locking, so each
+  // simulation thread keeps its own.
+  static NS_SIMULATION_LOCAL std::map<uint16_t, Ptr<const ConstructionPlan> > plans;
+  Ptr<const ConstructionPlan> &plan = plans[tid.GetUid ()];
+  if (plan == 0 || plan->generation != TypeId::GetAttributeGeneration ())
+    {
+      plan = BuildConstructionPlan (tid);
+    }
+  return plan;
+}
+
+} // unnamed namespace
 
-          if (value != 0)
+void
+ObjectBase::ConstructSelf (const AttributeConstructionList &attributes)
+{
+  NS_LOG_FUNCTION (this << &attributes);
+  // The attributes of the TypeId, their default values, and the
+  // NS_ATTRIBUTE_DEFAULT environment variable are only looked up and
+  // parsed the first time a TypeId is constructed, and again when
+  // the defaults change.
+  Ptr<const ConstructionPlan> plan = GetConstructionPlan (GetInstanceTypeId ());
+  bool empty = attributes.Begin () == attributes.End ();
+  for (std::vector<ConstructionStep>::const_iterator i = plan->steps.begin ();
+       i != plan->steps.end (); ++i)
+    {
+      // is this attribute stored in this AttributeConstructionList instance ?
+      Ptr<AttributeValue> value = empty ? 0 : attributes.Find (i->checker);
+      // See if this attribute should not be set here in the
+      // constructor.
+      if (!i->construct)
+        {
+          if (value == 0)
             {
-              // We have a matching attribute value.
-              if (DoSet (info.accessor, info.checker, *value))
-                {
-                  NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
-                                info.name<<"\"");
-                  continue;
-                }
+              // Skip this attribute if it's not in the
+              // AttributeConstructionList.
+              continue;
             }
+          // This is an error because this attribute is not
+          // settable in its constructor but is present in
+          // the AttributeConstructionList.
+          NS_FATAL_ERROR ("Attribute name="<<i->name<<" tid="<<i->tid.GetName () << ": initial value cannot be set using attributes");
+        }
 
-#ifdef HAVE_GETENV
-          // No matching attribute value so we try to look at the env var.
-          char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
-          if (envVar != 0)
+      if (value != 0)
+        {
+          // We have a matching attribute value.
+          if (DoSet (i->accessor, i->checker, *value))
             {
-              std::string env = std::string (envVar);
-              std::string::size_type cur = 0;
-              std::string::size_type next = 0;
-              while (next != std::string::npos)
-                {
-                  next = env.find (";", cur);
-                  std::string tmp = std::string (env, cur, next-cur);
-                  std::string::size_type equal = tmp.find ("=");
-                  if (equal != std::string::npos)
-                    {
-                      std::string name = tmp.substr (0, equal);
-                      std::string value = tmp.substr (equal+1, tmp.size () - equal - 1);
-                      if (name == tid.GetAttributeFullName (i))
-                        {
-                          if (DoSet (info.accessor, info.checker, StringValue (value)))
-                            {
-                              NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
-                                            info.name <<"\" from env var");
-                              break;
-                            }
-                        }
-                    }
-                  cur = next + 1;
-                }
+              NS_LOG_DEBUG ("construct \""<< i->tid.GetName ()<<"::"<<
+                            i->name<<"\"");
+              continue;
             }
-#endif /* HAVE_GETENV */
+        }
 
-          // No matching attribute value so we try to set the default value.
-          DoSet (info.accessor, info.checker, *info.initialValue);
-          NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
-                        info.name <<"\" from initial value.");
+      // No matching attribute value so we try to look at the env var.
+      if (i->env != 0 && DoSet (i->accessor, i->checker, *i->env))
+        {
+          NS_LOG_DEBUG ("construct \""<< i->tid.GetName ()<<"::"<<
+                        i->name <<"\" from env var");
         }
-      tid = tid.GetParent ();
-    } while (tid != ObjectBase::GetTypeId ());
+
+      // No matching attribute value so we set the default value.
+      if (i->valid)
+        {
+          i->accessor->Set (this, *i->value);
+        }
+      else
+        {
+          DoSet (i->accessor, i->checker, *i->value);
+        }
+      NS_LOG_DEBUG ("construct \""<< i->tid.GetName ()<<"::"<<
+                    i->name <<"\" from initial value.");
+    }
+
   NotifyConstructionCompleted ();
 }
 
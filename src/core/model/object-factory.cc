@@ -105,6 +105,25 @@ ObjectFactory::Create (void) const
   return object;
 }
 
+std::vector<Ptr<Object> >
+ObjectFactory::Create (uint32_t n) const
+{
+  NS_LOG_FUNCTION (this << n);
+  Callback<ObjectBase *> cb = m_tid.GetConstructor ();
+  std::vector<Ptr<Object> > objects;
+  objects.reserve (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      ObjectBase *base = cb ();
+      Object *derived = dynamic_cast<Object *> (base);
+      NS_ASSERT (derived != 0);
+      derived->SetTypeId (m_tid);
+      derived->Construct (m_parameters);
+      objects.push_back (Ptr<Object> (derived, false));
+    }
+  return objects;
+}
+
 std::ostream & operator << (std::ostream &os, const ObjectFactory &factory)
 {
   os << factory.m_tid.GetName () << "[";
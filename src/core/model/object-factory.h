@@ -23,6 +23,7 @@
 #include "attribute-construction-list.h"
 #include "object.h"
 #include "type-id.h"
+#include <vector>
 
 /**
  * \file
@@ -104,6 +105,26 @@ public:
    */
   template <typename T>
   Ptr<T> Create (void) const;
+  /**
+   * Create several Object instances of the configured TypeId.
+   *
+   * The constructor and the attributes of the TypeId are looked up
+   * once for all the instances, which makes this faster than calling
+   * Create() in a loop.
+   *
+   * \param [in] n The number of objects to create.
+   * \returns The new object instances.
+   */
+  std::vector<Ptr<Object> > Create (uint32_t n) const;
+  /**
+   * Create several Object instances of the requested type.
+   *
+   * \tparam T \explicit The requested Object type.
+   * \param [in] n The number of objects to create.
+   * \returns The new object instances.
+   */
+  template <typename T>
+  std::vector<Ptr<T> > Create (uint32_t n) const;
 
 private:
   /**
@@ -201,6 +222,20 @@ ObjectFactory::Create (void) const
   return object->GetObject<T> ();
 }
 
+template <typename T>
+std::vector<Ptr<T> >
+ObjectFactory::Create (uint32_t n) const
+{
+  std::vector<Ptr<Object> > objects = Create (n);
+  std::vector<Ptr<T> > result;
+  result.reserve (n);
+  for (std::vector<Ptr<Object> >::const_iterator i = objects.begin (); i != objects.end (); ++i)
+    {
+      result.push_back ((*i)->GetObject<T> ());
+    }
+  return result;
+}
+
 template <typename T>
 Ptr<T> 
 CreateObjectWithAttributes (std::string n1, const AttributeValue & v1,
@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "object-pool.h"
+#include "log.h"
+
+#include <cstdlib>
+#include <iomanip>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __GNUC__
+#include <cxxabi.h>
+#endif
+
+/**
+ * \file
+ * \ingroup object
+ * ns3::ObjectPoolRegistry implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ObjectPool");
+
+namespace {
+
+/** A registered pool: its type name and statistics getter. */
+typedef std::pair<std::string, ObjectPoolRegistry::StatisticsGetter> Pool;
+
+/**
+ * \ingroup object
+ * Get the registered pools.
+ * \returns The pools.
+ */
+std::vector<Pool> &
+GetPools (void)
+{
+  static std::vector<Pool> pools;
+  return pools;
+}
+
+/**
+ * \ingroup object
+ * Get the mutex of the registered pools.
+ * \returns The mutex.
+ */
+std::mutex &
+GetMutex (void)
+{
+  static std::mutex mutex;
+  return mutex;
+}
+
+} // unnamed namespace
+
+bool
+ObjectPoolRegistry::Register (const std::type_info &type, StatisticsGetter getter)
+{
+  std::string name = type.name ();
+#ifdef __GNUC__
+  int status;
+  char *demangled = abi::__cxa_demangle (name.c_str (), 0, 0, &status);
+  if (status == 0 && demangled != 0)
+    {
+      name = demangled;
+    }
+  std::free (demangled);
+#endif
+  NS_LOG_FUNCTION (name);
+  std::lock_guard<std::mutex> lock (GetMutex ());
+  GetPools ().push_back (std::make_pair (name, getter));
+  return true;
+}
+
+void
+ObjectPoolRegistry::Print (std::ostream &os)
+{
+  NS_LOG_FUNCTION (&os);
+  std::lock_guard<std::mutex> lock (GetMutex ());
+  std::ios_base::fmtflags flags = os.flags ();
+  os << std::left << std::setw (40) << "pool" << std::right
+     << std::setw (14) << "allocations" << std::setw (9) << "reused"
+     << std::setw (14) << "releases" << std::setw (10) << "free" << std::endl;
+  const std::vector<Pool> &pools = GetPools ();
+  for (std::vector<Pool>::const_iterator i = pools.begin (); i != pools.end (); ++i)
+    {
+      ObjectPoolStatistics statistics = i->second ();
+      double rate = 0;
+      if (statistics.allocations > 0)
+        {
+          rate = 100.0 * statistics.reuses / statistics.allocations;
+        }
+      os << std::left << std::setw (40) << i->first << std::right
+         << std::setw (14) << statistics.allocations
+         << std::fixed << std::setprecision (1) << std::setw (8) << rate << "%"
+         << std::setw (14) << statistics.releases
+         << std::setw (10) << statistics.freeBlocks << std::endl;
+    }
+  os.flags (flags);
+}
+
+} // namespace ns3
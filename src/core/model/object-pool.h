@@ -0,0 +1,180 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef OBJECT_POOL_H
+#define OBJECT_POOL_H
+
+#include "size-class-allocator.h"
+
+#include <cstddef>
+#include <ostream>
+#include <typeinfo>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup object
+ * ns3::ObjectPool declaration and template implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup object
+ * The allocations of an ObjectPool in one thread.
+ */
+typedef SizeClassAllocatorStatistics ObjectPoolStatistics;
+
+/**
+ * \ingroup object
+ * \brief The list of the ObjectPool types, to report their statistics.
+ */
+class ObjectPoolRegistry
+{
+public:
+  /** A function which gets the statistics of a pool. */
+  typedef ObjectPoolStatistics (*StatisticsGetter)(void);
+
+  /**
+   * Register a pool.  Called by the pool on its first allocation.
+   *
+   * \param [in] type The type of the pool.
+   * \param [in] getter The function which gets its statistics.
+   * \returns \c true.
+   */
+  static bool Register (const std::type_info &type, StatisticsGetter getter);
+  /**
+   * Print the statistics of each pool in the calling thread: the
+   * allocations, the reuse rate, the releases and the free blocks.
+   * The allocations and free lists of the other threads are not
+   * included.
+   *
+   * \param [in] os The output stream.
+   */
+  static void Print (std::ostream &os);
+};
+
+/**
+ * \ingroup object
+ * \brief Recycle the memory of the instances of a type and its subclasses.
+ *
+ * A type opts in by deriving from ObjectPool of itself,
+ * \code
+ *   class Packet : public SimpleRefCount<Packet>, public ObjectPool<Packet>
+ * \endcode
+ * and from then on Create() and CreateObject() take its memory from
+ * per-thread free lists, and the deletion of the object when its last
+ * reference goes away returns the memory there, instead of to the
+ * global heap.  Like the events, the memory comes from a
+ * SizeClassAllocator, with one free list per size class, so the
+ * subclasses of the type, whatever their size, are recycled too; only
+ * objects larger than MAX_SIZE bytes are not.
+ *
+ * An object deleted by another thread than the one which created it
+ * goes to the free lists of the deleting thread, which keep at most
+ * MAX_FREE_BLOCKS blocks per size class.  The free lists of a thread
+ * are released when it exits; Purge() releases those of the calling
+ * thread earlier.  GetStatistics() and ObjectPoolRegistry::Print()
+ * tell how many allocations were served from the free lists.
+ *
+ * Recycled memory is not seen by memory checkers such as valgrind,
+ * so a use after free of a pooled type goes unnoticed by them.
+ *
+ * \tparam T \explicit The type which derives from this class.
+ */
+template <typename T>
+class ObjectPool
+{
+public:
+  /** The allocator of the pool. */
+  typedef SizeClassAllocator<T, 32> Allocator;
+  /** Granularity of the size classes, in bytes. */
+  static const std::size_t SIZE_STEP = Allocator::SIZE_STEP;
+  /** The size of the largest objects recycled. */
+  static const std::size_t MAX_SIZE = Allocator::MAX_SIZE;
+  /** The largest number of blocks on each free list of a thread. */
+  static const uint64_t MAX_FREE_BLOCKS = Allocator::MAX_FREE_BLOCKS;
+
+  /**
+   * Allocate the memory of an object from the free list of its size class.
+   *
+   * \param [in] size The size of the object.
+   * \returns The memory block.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Release the memory of an object to the free list of its size class.
+   *
+   * \param [in] p The memory block.
+   * \param [in] size The size of the object.
+   */
+  static void operator delete (void *p, std::size_t size);
+
+  /**
+   * Get the allocations of this pool in the calling thread.
+   *
+   * \returns The statistics.
+   */
+  static ObjectPoolStatistics GetStatistics (void);
+  /**
+   * Release the free blocks of the calling thread to the global heap.
+   * Those of the other threads are kept until they purge or exit.
+   */
+  static void Purge (void);
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename T>
+void *
+ObjectPool<T>::operator new (std::size_t size)
+{
+  static const bool registered = ObjectPoolRegistry::Register (typeid (T), &GetStatistics);
+  (void)registered;
+  return Allocator::Allocate (size);
+}
+
+template <typename T>
+void
+ObjectPool<T>::operator delete (void *p, std::size_t size)
+{
+  Allocator::Deallocate (p, size);
+}
+
+template <typename T>
+ObjectPoolStatistics
+ObjectPool<T>::GetStatistics (void)
+{
+  return Allocator::GetStatistics ();
+}
+
+template <typename T>
+void
+ObjectPool<T>::Purge (void)
+{
+  Allocator::Purge ();
+}
+
+} // namespace ns3
+
+#endif /* OBJECT_POOL_H */
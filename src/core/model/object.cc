@@ -25,6 +25,7 @@
 #include "attribute.h"
 #include "log.h"
 #include "string.h"
+#include "config.h"
 #include <vector>
 #include <sstream>
 #include <cstdlib>
@@ -97,17 +98,22 @@ Object::Object ()
   : m_tid (Object::GetTypeId ()),
     m_disposed (false),
     m_initialized (false),
-    m_aggregates ((struct Aggregates *) std::malloc (sizeof (struct Aggregates))),
-    m_getObjectCount (0)
+    m_aggregates (0)
 {
   NS_LOG_FUNCTION (this);
-  m_aggregates->n = 1;
-  m_aggregates->buffer[0] = this;
+  Object *self = this;
+  m_aggregates = NewAggregates (&self, 1);
+#ifdef ENABLE_OBJECT_ACCOUNTING
+  ObjectAccounting::Add (ObjectAccounting::GetCounter (m_tid));
+#endif
 }
 Object::~Object () 
 {
   // remove this object from the aggregate list
   NS_LOG_FUNCTION (this);
+#ifdef ENABLE_OBJECT_ACCOUNTING
+  ObjectAccounting::Remove (ObjectAccounting::GetCounter (m_tid));
+#endif
   uint32_t n = m_aggregates->n;
   for (uint32_t i = 0; i < n; i++)
     {
@@ -121,22 +127,29 @@ Object::~Object ()
         }
     }
   // finally, if all objects have been removed from the list,
-  // delete the aggregate list
+  // delete the aggregate list; otherwise, forget this object
+  // in the index.
   if (m_aggregates->n == 0)
     {
       std::free (m_aggregates);
     }
+  else if (m_aggregates->index != 0)
+    {
+      BuildIndex (m_aggregates);
+    }
   m_aggregates = 0;
 }
 Object::Object (const Object &o)
   : m_tid (o.m_tid),
     m_disposed (false),
     m_initialized (false),
-    m_aggregates ((struct Aggregates *) std::malloc (sizeof (struct Aggregates))),
-    m_getObjectCount (0)
+    m_aggregates (0)
 {
-  m_aggregates->n = 1;
-  m_aggregates->buffer[0] = this;
+  Object *self = this;
+  m_aggregates = NewAggregates (&self, 1);
+#ifdef ENABLE_OBJECT_ACCOUNTING
+  ObjectAccounting::Add (ObjectAccounting::GetCounter (m_tid));
+#endif
 }
 void
 Object::Construct (const AttributeConstructionList &attributes)
@@ -151,33 +164,30 @@ Object::DoGetObject (TypeId tid) const
   NS_LOG_FUNCTION (this << tid);
   NS_ASSERT (CheckLoose ());
 
-  uint32_t n = m_aggregates->n;
-  TypeId objectTid = Object::GetTypeId ();
-  for (uint32_t i = 0; i < n; i++)
+  const struct Aggregates *aggregates = m_aggregates;
+  if (aggregates->index == 0)
     {
-      Object *current = m_aggregates->buffer[i];
-      TypeId cur = current->GetInstanceTypeId ();
-      while (cur != tid && cur != objectTid)
+      // a single object: compare with its ancestors
+      TypeId cur = GetInstanceTypeId ();
+      if (cur == tid || cur.IsChildOf (tid))
         {
-          cur = cur.GetParent ();
+          return const_cast<Object *> (this);
+        }
+      return 0;
+    }
+  uint16_t uid = tid.GetUid ();
+  for (uint32_t i = uid & aggregates->mask; ; i = (i + 1) & aggregates->mask)
+    {
+      const struct AggregateIndexEntry &entry = aggregates->index[i];
+      if (entry.object == 0)
+        {
+          return 0;
         }
-      if (cur == tid)
+      if (entry.uid == uid)
         {
-          // This is an attempt to 'cache' the result of this lookup.
-          // the idea is that if we perform a lookup for a TypeId on this object,
-          // we are likely to perform the same lookup later so, we make sure
-          // that the aggregate array is sorted by the number of accesses
-          // to each object.
-
-          // first, increment the access count
-          current->m_getObjectCount++;
-          // then, update the sort
-          UpdateSortedArray (m_aggregates, i);
-          // finally, return the match
-          return const_cast<Object *> (current);
+          return entry.object;
         }
     }
-  return 0;
 }
 void
 Object::Initialize (void)
@@ -235,17 +245,91 @@ restart:
         }
     }
 }
+uint32_t
+Object::CountTypeIds (const Object *object)
+{
+  NS_LOG_FUNCTION (object);
+  uint32_t count = 1;
+  TypeId cur = object->GetInstanceTypeId ();
+  while (cur.HasParent () && cur.GetParent ().GetUid () != 0)
+    {
+      cur = cur.GetParent ();
+      count++;
+    }
+  return count;
+}
+
+struct Object::Aggregates *
+Object::NewAggregates (Object * const *objects, uint32_t n)
+{
+  NS_LOG_FUNCTION (objects << n);
+  std::size_t size = sizeof (struct Aggregates) + (n - 1) * sizeof (Object *);
+  uint32_t slots = 0;
+  if (n > 1)
+    {
+      // keep the index at most half full, so that the probes are short
+      uint32_t count = 0;
+      for (uint32_t i = 0; i < n; i++)
+        {
+          count += CountTypeIds (objects[i]);
+        }
+      slots = 8;
+      while (slots < 2 * count)
+        {
+          slots <<= 1;
+        }
+    }
+  struct Aggregates *aggregates =
+    (struct Aggregates *)std::malloc (size + slots * sizeof (struct AggregateIndexEntry));
+  aggregates->n = n;
+  std::memcpy (&aggregates->buffer[0], objects, n * sizeof (Object *));
+  if (slots == 0)
+    {
+      aggregates->mask = 0;
+      aggregates->index = 0;
+    }
+  else
+    {
+      aggregates->mask = slots - 1;
+      aggregates->index = (struct AggregateIndexEntry *)((char *)aggregates + size);
+      BuildIndex (aggregates);
+    }
+  return aggregates;
+}
+
 void
-Object::UpdateSortedArray (struct Aggregates *aggregates, uint32_t j) const
+Object::BuildIndex (struct Aggregates *aggregates)
 {
-  NS_LOG_FUNCTION (this << aggregates << j);
-  while (j > 0 && 
-         aggregates->buffer[j]->m_getObjectCount > aggregates->buffer[j-1]->m_getObjectCount)
+  NS_LOG_FUNCTION (aggregates);
+  struct AggregateIndexEntry *index = aggregates->index;
+  for (uint32_t i = 0; i <= aggregates->mask; i++)
+    {
+      index[i].object = 0;
+    }
+  for (uint32_t i = 0; i < aggregates->n; i++)
     {
-      Object *tmp = aggregates->buffer[j-1];
-      aggregates->buffer[j-1] = aggregates->buffer[j];
-      aggregates->buffer[j] = tmp;
-      j--;
+      Object *current = aggregates->buffer[i];
+      TypeId cur = current->GetInstanceTypeId ();
+      while (true)
+        {
+          // the first object of a TypeId wins
+          uint16_t uid = cur.GetUid ();
+          uint32_t j = uid & aggregates->mask;
+          while (index[j].object != 0 && index[j].uid != uid)
+            {
+              j = (j + 1) & aggregates->mask;
+            }
+          if (index[j].object == 0)
+            {
+              index[j].object = current;
+              index[j].uid = uid;
+            }
+          if (!cur.HasParent () || cur.GetParent ().GetUid () == 0)
+            {
+              break;
+            }
+          cur = cur.GetParent ();
+        }
     }
 }
 void 
@@ -258,21 +342,9 @@ Object::AggregateObject (Ptr<Object> o)
   NS_ASSERT (o->CheckLoose ());
 
   Object *other = PeekPointer (o);
-  // first create the new aggregate buffer.
-  uint32_t total = m_aggregates->n + other->m_aggregates->n;
-  struct Aggregates *aggregates = 
-    (struct Aggregates *)std::malloc (sizeof(struct Aggregates)+(total-1)*sizeof(Object*));
-  aggregates->n = total;
-
-  // copy our buffer to the new buffer
-  std::memcpy (&aggregates->buffer[0], 
-          &m_aggregates->buffer[0], 
-          m_aggregates->n*sizeof(Object*));
-
-  // append the other buffer into the new buffer too
+  // first check that the other objects are of new types
   for (uint32_t i = 0; i < other->m_aggregates->n; i++)
     {
-      aggregates->buffer[m_aggregates->n+i] = other->m_aggregates->buffer[i];
       const TypeId typeId = other->m_aggregates->buffer[i]->GetInstanceTypeId ();
       if (DoGetObject (typeId))
         {
@@ -281,9 +353,17 @@ Object::AggregateObject (Ptr<Object> o)
                           other->GetInstanceTypeId () <<
                           " on objects of type " << typeId);
         }
-      UpdateSortedArray (aggregates, m_aggregates->n + i);
     }
 
+  // then create the new aggregate buffer, with our buffer followed
+  // by the other buffer, and its index.
+  uint32_t total = m_aggregates->n + other->m_aggregates->n;
+  std::vector<Object *> objects (total);
+  std::memcpy (&objects[0], &m_aggregates->buffer[0], m_aggregates->n * sizeof (Object *));
+  std::memcpy (&objects[m_aggregates->n], &other->m_aggregates->buffer[0],
+               other->m_aggregates->n * sizeof (Object *));
+  struct Aggregates *aggregates = NewAggregates (&objects[0], total);
+
   // keep track of the old aggregate buffers for the iteration
   // of NotifyNewAggregates
   struct Aggregates *a = m_aggregates;
@@ -296,6 +376,8 @@ Object::AggregateObject (Ptr<Object> o)
       Object *current = aggregates->buffer[i];
       current->m_aggregates = aggregates;
     }
+  // GetObject on a Config path may now match more objects
+  Config::InvalidateMatchCache ();
 
   // Finally, call NotifyNewAggregate on all the objects aggregates together.
   // We purposely use the old aggregate buffers to iterate over the objects
@@ -339,6 +421,10 @@ Object::SetTypeId (TypeId tid)
 {
   NS_LOG_FUNCTION (this << tid);
   NS_ASSERT (Check ());
+#ifdef ENABLE_OBJECT_ACCOUNTING
+  ObjectAccounting::Move (ObjectAccounting::GetCounter (m_tid),
+                          ObjectAccounting::GetCounter (tid));
+#endif
   m_tid = tid;
 }
 
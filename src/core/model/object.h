@@ -29,6 +29,9 @@
 #include "object-base.h"
 #include "attribute-construction-list.h"
 #include "simple-ref-count.h"
+#ifdef ENABLE_OBJECT_ACCOUNTING
+#include "object-accounting.h"
+#endif
 
 /**
  * \file
@@ -320,6 +323,14 @@ private:
   friend class AggregateIterator;
   friend struct ObjectDeleter;
 
+  /** A slot of the index of the aggregates. */
+  struct AggregateIndexEntry {
+    /** The first Object of the TypeId, or 0 for a free slot. */
+    Object *object;
+    /** The uid of the TypeId. */
+    uint16_t uid;
+  };
+
   /**
    * The list of Objects aggregated to this one.
    *
@@ -331,10 +342,19 @@ private:
    * chunk of memory than the struct to allow space for a larger
    * variable sized buffer whose size is indicated by the element
    * \c n
+   *
+   * When several Objects are aggregated, the same chunk also holds
+   * an open-addressing hash table which maps the TypeId of each
+   * Object, and of all its ancestors, to the first Object of that
+   * TypeId, so that GetObject() takes constant time.
    */
   struct Aggregates {
     /** The number of entries in \c buffer. */
     uint32_t n;
+    /** The number of slots of \c index minus one. */
+    uint32_t mask;
+    /** The index by TypeId, or 0 for a single Object. */
+    struct AggregateIndexEntry *index;
     /** The array of Objects. */
     Object *buffer[1];
   };
@@ -387,12 +407,27 @@ private:
   void Construct (const AttributeConstructionList &attributes);
 
   /**
-   * Keep the list of aggregates in most-recently-used order
+   * Allocate a list of aggregates, with its index.
+   *
+   * \param [in] objects The aggregated Objects.
+   * \param [in] n The number of Objects.
+   * \returns The list of aggregates.
+   */
+  static struct Aggregates * NewAggregates (Object * const *objects, uint32_t n);
+  /**
+   * Count the TypeIds of an Object, i.e., the TypeId of its instance
+   * and all its ancestors.
+   *
+   * \param [in] object The Object.
+   * \returns The number of TypeIds.
+   */
+  static uint32_t CountTypeIds (const Object *object);
+  /**
+   * Fill the index of a list of aggregates, whose size is already set.
    *
    * \param [in,out] aggregates The list of aggregated Objects.
-   * \param [in] i The most recently used entry in the list.
    */
-  void UpdateSortedArray (struct Aggregates *aggregates, uint32_t i) const;
+  static void BuildIndex (struct Aggregates *aggregates);
   /**
    * Attempt to delete this Object.
    *
@@ -424,14 +459,6 @@ private:
    * so the size of the array is indirectly a reference count.
    */
   struct Aggregates * m_aggregates;
-  /**
-   * The number of times the Object was accessed with a
-   * call to GetObject().
-   *
-   * This integer is used to implement a heuristic to sort
-   * the array of aggregates in most-frequently accessed order.
-   */
-  uint32_t m_getObjectCount;
 };
 
 template <typename T>
@@ -510,6 +537,9 @@ template <typename T>
 Ptr<T> CompleteConstruct (T *object)
 {
   object->SetTypeId (T::GetTypeId ());
+#ifdef ENABLE_OBJECT_ACCOUNTING
+  ObjectAccounting::SetSize (T::GetTypeId (), sizeof (T));
+#endif
   object->Object::Construct (AttributeConstructionList ());
   return Ptr<T> (object, false);
 }
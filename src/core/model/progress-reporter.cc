@@ -0,0 +1,223 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "progress-reporter.h"
+#include "nstime.h"
+#include "log.h"
+#include "ns3/core-config.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+#ifdef HAVE_SYS_RESOURCE_H
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::ProgressReporter implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ProgressReporter");
+
+namespace {
+
+/**
+ * \ingroup simulator
+ * Get a wall clock duration in seconds.
+ * \param [in] d The duration.
+ * \returns The duration, in seconds.
+ */
+double
+ToSeconds (std::chrono::steady_clock::duration d)
+{
+  return std::chrono::duration<double> (d).count ();
+}
+
+} // unnamed namespace
+
+ProgressReporter::ProgressReporter (const std::string &filename, Format format, uint64_t interval)
+  : m_os (&std::cerr),
+    m_format (format),
+    m_interval (interval),
+    m_stopTs (~0ULL),
+    m_events (0),
+    m_countdown (1),
+    m_checkEvery (1),
+    m_lastEvents (0),
+    m_lastTs (0)
+{
+  NS_LOG_FUNCTION (this << filename << format << interval);
+  if (!filename.empty ())
+    {
+      m_file.open (filename.c_str ());
+      if (m_file.is_open ())
+        {
+          m_os = &m_file;
+        }
+      else
+        {
+          NS_LOG_WARN ("Cannot open " << filename << " to write the progress reports");
+        }
+    }
+  m_start = std::chrono::steady_clock::now ();
+  m_lastCheck = m_start;
+  m_lastReport = m_start;
+}
+
+void
+ProgressReporter::SetStopTime (uint64_t ts)
+{
+  NS_LOG_FUNCTION (this << ts);
+  m_stopTs = ts;
+}
+
+void
+ProgressReporter::Check (uint64_t ts, uint64_t pending)
+{
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now ();
+  // Read the clock about 16 times per interval: often enough to report
+  // on time, seldom enough to cost nothing.
+  std::chrono::steady_clock::duration sinceCheck = now - m_lastCheck;
+  double perCheck = static_cast<double> (m_interval.count ()) / 16;
+  double every = m_checkEvery * perCheck / std::max<double> (1, std::chrono::duration_cast<std::chrono::nanoseconds> (sinceCheck).count ());
+  // At most double the count, so that a burst of cheap events does
+  // not postpone the next checks past many intervals.
+  every = std::min (every, 2.0 * m_checkEvery);
+  m_checkEvery = static_cast<uint32_t> (std::max (1.0, std::min (every, 65536.0)));
+  m_countdown = m_checkEvery;
+  m_lastCheck = now;
+  if (now - m_lastReport >= m_interval)
+    {
+      Report (now, ts, pending, false);
+    }
+}
+
+void
+ProgressReporter::Finish (uint64_t ts, uint64_t pending)
+{
+  NS_LOG_FUNCTION (this << ts << pending);
+  Report (std::chrono::steady_clock::now (), ts, pending, true);
+}
+
+void
+ProgressReporter::Report (std::chrono::steady_clock::time_point now,
+                          uint64_t ts, uint64_t pending, bool done)
+{
+  double wall = ToSeconds (now - m_start);
+  double interval = ToSeconds (now - m_lastReport);
+  double rate = 0;
+  if (interval > 0)
+    {
+      rate = (m_events - m_lastEvents) / interval;
+    }
+  // Estimate the time left from the simulation time covered during the
+  // last interval, or since the start if it did not advance.
+  double eta = -1;
+  if (m_stopTs != ~0ULL && !done)
+    {
+      double left = (ts < m_stopTs) ? static_cast<double> (m_stopTs - ts) : 0;
+      if (ts > m_lastTs && interval > 0)
+        {
+          eta = left * interval / (ts - m_lastTs);
+        }
+      else if (ts > 0 && wall > 0)
+        {
+          eta = left * wall / ts;
+        }
+    }
+  double sim = TimeStep (ts).GetSeconds ();
+  uint64_t rss = GetResidentMemory ();
+
+  std::ostream &os = *m_os;
+  std::ios_base::fmtflags flags = os.flags ();
+  os << std::fixed;
+  if (m_format == JSON)
+    {
+      os << "{\"state\":\"" << (done ? "done" : "running") << "\""
+         << ",\"wall\":" << std::setprecision (3) << wall
+         << ",\"sim\":" << std::setprecision (9) << sim
+         << ",\"events\":" << m_events
+         << ",\"eventsPerSecond\":" << std::setprecision (0) << rate
+         << ",\"pending\":" << pending
+         << ",\"rss\":" << rss
+         << ",\"eta\":";
+      if (eta < 0)
+        {
+          os << "null";
+        }
+      else
+        {
+          os << std::setprecision (1) << eta;
+        }
+      os << "}";
+    }
+  else
+    {
+      os << "progress: " << (done ? "done" : "running")
+         << ", wall " << std::setprecision (3) << wall << " s"
+         << ", sim " << std::setprecision (9) << sim << " s"
+         << ", " << m_events << " events"
+         << ", " << std::setprecision (0) << rate << " events/s"
+         << ", " << pending << " pending"
+         << ", rss " << std::setprecision (1) << rss / 1048576.0 << " MiB";
+      if (eta >= 0)
+        {
+          os << ", eta " << std::setprecision (1) << eta << " s";
+        }
+    }
+  os << std::endl;
+  os.flags (flags);
+
+  m_lastReport = now;
+  m_lastEvents = m_events;
+  m_lastTs = ts;
+}
+
+uint64_t
+ProgressReporter::GetResidentMemory (void)
+{
+  // The second field of /proc/self/statm is the resident set, in pages.
+  std::ifstream statm ("/proc/self/statm");
+  uint64_t size, resident;
+  if (statm >> size >> resident)
+    {
+#ifdef HAVE_SYS_RESOURCE_H
+      return resident * sysconf (_SC_PAGESIZE);
+#else
+      return resident * 4096;
+#endif
+    }
+#ifdef HAVE_SYS_RESOURCE_H
+  struct rusage usage;
+  if (getrusage (RUSAGE_SELF, &usage) == 0)
+    {
+#ifdef __APPLE__
+      return usage.ru_maxrss;
+#else
+      return usage.ru_maxrss * 1024ULL;
+#endif
+    }
+#endif
+  return 0;
+}
+
+} // namespace ns3
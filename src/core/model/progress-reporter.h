@@ -0,0 +1,155 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PROGRESS_REPORTER_H
+#define PROGRESS_REPORTER_H
+
+#include <stdint.h>
+#include <chrono>
+#include <fstream>
+#include <ostream>
+#include <string>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::ProgressReporter declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \brief Report the progress of a simulation at a wall clock interval.
+ *
+ * The simulator implementation calls Notify() after each event it
+ * runs.  Every so many events, the reporter reads the wall clock, and
+ * once per interval writes a line with the wall clock time elapsed,
+ * the simulation time, the number of events run, the events run per
+ * second during the last interval, the number of pending events, the
+ * resident memory of the process and, when the stop time of the
+ * simulation is known, an estimate of the wall clock time left.
+ *
+ * The lines are either text, or JSON objects (one per line) such as
+ * \verbatim
+   {"state":"running","wall":12.001,"sim":3.5,"events":1234567,"eventsPerSecond":102345,"pending":4321,"rss":123456789,"eta":240.2} \endverbatim
+ * where \c eta is \c null when the stop time is unknown.  A last line
+ * is written, with the state \c done, when the simulation stops.
+ *
+ * No event is scheduled to write the reports, so they do not change
+ * the simulation.
+ */
+class ProgressReporter
+{
+public:
+  /** The output formats. */
+  enum Format
+  {
+    TEXT,    //!< One readable line per report.
+    JSON     //!< One JSON object per line.
+  };
+
+  /**
+   * Constructor.
+   *
+   * \param [in] filename The file to write to, or empty for std::cerr.
+   * \param [in] format The output format.
+   * \param [in] interval The wall clock interval between reports, in nanoseconds.
+   */
+  ProgressReporter (const std::string &filename, Format format, uint64_t interval);
+
+  /**
+   * Set the simulation time at which the simulation stops,
+   * to estimate the time left.  It replaces the previous stop time.
+   *
+   * \param [in] ts The stop time, in time steps, or ~0 if unknown.
+   */
+  void SetStopTime (uint64_t ts);
+  /**
+   * Count an event run, and report if the interval elapsed.
+   *
+   * \param [in] ts The current simulation time, in time steps.
+   * \param [in] pending The number of pending events.
+   */
+  inline void Notify (uint64_t ts, uint64_t pending);
+  /**
+   * Write the last report.
+   *
+   * \param [in] ts The current simulation time, in time steps.
+   * \param [in] pending The number of pending events.
+   */
+  void Finish (uint64_t ts, uint64_t pending);
+
+  /**
+   * Get the resident memory of the process.
+   *
+   * \returns The resident memory, in bytes, or the peak resident memory
+   *          where the current one is unknown, or 0.
+   */
+  static uint64_t GetResidentMemory (void);
+
+private:
+  /**
+   * Read the wall clock, and report if the interval elapsed.
+   *
+   * \param [in] ts The current simulation time, in time steps.
+   * \param [in] pending The number of pending events.
+   */
+  void Check (uint64_t ts, uint64_t pending);
+  /**
+   * Write a report.
+   *
+   * \param [in] now The wall clock time.
+   * \param [in] ts The current simulation time, in time steps.
+   * \param [in] pending The number of pending events.
+   * \param [in] done Whether the simulation stopped.
+   */
+  void Report (std::chrono::steady_clock::time_point now,
+               uint64_t ts, uint64_t pending, bool done);
+
+  std::ofstream m_file;         //!< The output file, if any.
+  std::ostream *m_os;           //!< The output stream.
+  Format m_format;              //!< The output format.
+  std::chrono::nanoseconds m_interval;  //!< The interval between reports.
+  uint64_t m_stopTs;            //!< The stop time, or ~0 if unknown.
+
+  uint64_t m_events;            //!< The number of events run.
+  uint32_t m_countdown;         //!< The events left until the next check.
+  uint32_t m_checkEvery;        //!< The events between two checks.
+  std::chrono::steady_clock::time_point m_start;       //!< The construction.
+  std::chrono::steady_clock::time_point m_lastCheck;   //!< The last check.
+  std::chrono::steady_clock::time_point m_lastReport;  //!< The last report.
+  uint64_t m_lastEvents;        //!< The events run at the last report.
+  uint64_t m_lastTs;            //!< The simulation time at the last report.
+};
+
+/********************************************************************
+ *  Implementation of the inline methods declared above.
+ ********************************************************************/
+
+void
+ProgressReporter::Notify (uint64_t ts, uint64_t pending)
+{
+  m_events++;
+  if (--m_countdown == 0)
+    {
+      Check (ts, pending);
+    }
+}
+
+} // namespace ns3
+
+#endif /* PROGRESS_REPORTER_H */
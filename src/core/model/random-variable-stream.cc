@@ -33,9 +33,12 @@
 #include "log.h"
 #include "rng-stream.h"
 #include "rng-seed-manager.h"
+#include "simulation-local.h"
 #include "unused.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <unordered_set>
 
 /**
  * \file
@@ -47,6 +50,37 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("RandomVariableStream");
 
+namespace {
+
+/**
+ * \ingroup randomvariable
+ * Get the set of existing RandomVariableStreams, for
+ * RandomVariableStream::ReseedAll.
+ *
+ * The set is never deleted, so that streams held by static
+ * objects can still remove themselves when they are destroyed.
+ * Each simulation thread has its own set, so that ReseedAll only
+ * restarts the streams of the calling simulation.
+ *
+ * \returns The set of existing streams.
+ */
+std::unordered_set<RandomVariableStream *> *
+GetStreams (void)
+{
+  static NS_SIMULATION_LOCAL std::unordered_set<RandomVariableStream *> *streams =
+    new std::unordered_set<RandomVariableStream *> ();
+  return streams;
+}
+
+/**
+ * \ingroup randomvariable
+ * Number of uniforms drawn at a time when a batch of integers is
+ * computed from a batch of doubles.
+ */
+const std::size_t BATCH_SIZE = 64;
+
+} // unnamed namespace
+
 NS_OBJECT_ENSURE_REGISTERED (RandomVariableStream);
 
 TypeId 
@@ -73,13 +107,16 @@ RandomVariableStream::GetTypeId (void)
 }
 
 RandomVariableStream::RandomVariableStream()
-  : m_rng (0)
+  : m_rng (0),
+    m_streamIndex (0)
 {
   NS_LOG_FUNCTION (this);
+  GetStreams ()->insert (this);
 }
 RandomVariableStream::~RandomVariableStream()
 {
   NS_LOG_FUNCTION (this);
+  GetStreams ()->erase (this);
   delete m_rng;
 }
 
@@ -111,6 +148,7 @@ RandomVariableStream::SetStream (int64_t stream)
       m_rng = new RngStream (RngSeedManager::GetSeed (),
                              nextStream,
                              RngSeedManager::GetRun ());
+      m_streamIndex = nextStream;
     }
   else
     {
@@ -121,6 +159,7 @@ RandomVariableStream::SetStream (int64_t stream)
       m_rng = new RngStream (RngSeedManager::GetSeed (),
                              target,
                              RngSeedManager::GetRun ());
+      m_streamIndex = target;
     }
   m_stream = stream;
 }
@@ -138,6 +177,55 @@ RandomVariableStream::Peek(void) const
   return m_rng;
 }
 
+void
+RandomVariableStream::DiscardCachedValues (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+RandomVariableStream::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      values[i] = GetValue ();
+    }
+}
+
+void
+RandomVariableStream::GetIntegers (uint32_t *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      values[i] = GetInteger ();
+    }
+}
+
+void
+RandomVariableStream::ReseedAll (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  std::unordered_set<RandomVariableStream *> *streams = GetStreams ();
+  for (std::unordered_set<RandomVariableStream *>::iterator i = streams->begin ();
+       i != streams->end (); ++i)
+    {
+      RandomVariableStream *stream = *i;
+      if (stream->m_rng == 0)
+        {
+          // The stream number has not been set yet; the stream will
+          // pick up the current seed and run when it is.
+          continue;
+        }
+      delete stream->m_rng;
+      stream->m_rng = new RngStream (RngSeedManager::GetSeed (),
+                                     stream->m_streamIndex,
+                                     RngSeedManager::GetRun ());
+      stream->DiscardCachedValues ();
+    }
+}
+
 NS_OBJECT_ENSURE_REGISTERED(UniformRandomVariable);
 
 TypeId 
@@ -208,6 +296,54 @@ UniformRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_min, m_max + 1);
 }
+void
+UniformRandomVariable::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  Peek ()->RandU01 (values, n);
+  const double min = m_min;
+  const double max = m_max;
+  if (IsAntithetic ())
+    {
+      for (std::size_t i = 0; i < n; ++i)
+        {
+          double v = min + values[i] * (max - min);
+          values[i] = min + (max - v);
+        }
+    }
+  else
+    {
+      for (std::size_t i = 0; i < n; ++i)
+        {
+          values[i] = min + values[i] * (max - min);
+        }
+    }
+}
+void
+UniformRandomVariable::GetIntegers (uint32_t *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  const double min = m_min;
+  const double max = m_max + 1;
+  const bool antithetic = IsAntithetic ();
+  double u[BATCH_SIZE];
+  while (n > 0)
+    {
+      std::size_t count = std::min (n, BATCH_SIZE);
+      Peek ()->RandU01 (u, count);
+      for (std::size_t i = 0; i < count; ++i)
+        {
+          double v = min + u[i] * (max - min);
+          if (antithetic)
+            {
+              v = min + (max - v);
+            }
+          values[i] = (uint32_t)v;
+        }
+      values += count;
+      n -= count;
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED(ConstantRandomVariable);
 
@@ -445,6 +581,47 @@ ExponentialRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_mean, m_bound);
 }
+void
+ExponentialRandomVariable::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  if (m_bound != 0)
+    {
+      // Rejected draws consume extra uniforms, so a bounded
+      // distribution cannot transform a fixed block.
+      RandomVariableStream::GetValues (values, n);
+      return;
+    }
+  Peek ()->RandU01 (values, n);
+  const double mean = m_mean;
+  const bool antithetic = IsAntithetic ();
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      double v = values[i];
+      if (antithetic)
+        {
+          v = (1 - v);
+        }
+      values[i] = -mean*std::log (v);
+    }
+}
+void
+ExponentialRandomVariable::GetIntegers (uint32_t *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  double r[BATCH_SIZE];
+  while (n > 0)
+    {
+      std::size_t count = std::min (n, BATCH_SIZE);
+      GetValues (r, count);
+      for (std::size_t i = 0; i < count; ++i)
+        {
+          values[i] = (uint32_t)r[i];
+        }
+      values += count;
+      n -= count;
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED(ParetoRandomVariable);
 
@@ -779,6 +956,13 @@ NormalRandomVariable::GetInteger (void)
   return (uint32_t)GetValue (m_mean, m_variance, m_bound);
 }
 
+void
+NormalRandomVariable::DiscardCachedValues (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nextValid = false;
+}
+
 NS_OBJECT_ENSURE_REGISTERED(LogNormalRandomVariable);
 
 TypeId 
@@ -1029,6 +1213,13 @@ GammaRandomVariable::GetInteger (void)
   return (uint32_t)GetValue (m_alpha, m_beta);
 }
 
+void
+GammaRandomVariable::DiscardCachedValues (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nextValid = false;
+}
+
 double 
 GammaRandomVariable::GetNormalValue (double mean, double variance, double bound)
 {
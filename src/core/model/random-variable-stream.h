@@ -29,6 +29,7 @@
 #include "type-id.h"
 #include "object.h"
 #include "attribute-helper.h"
+#include <cstddef>
 #include <stdint.h>
 
 /**
@@ -137,6 +138,24 @@ public:
    */
   bool IsAntithetic(void) const;
 
+  /**
+   * \brief Restart every existing stream from the current seed and run.
+   *
+   * Streams draw their seed and run number from RngSeedManager when
+   * their stream number is set, so changing the run number does not
+   * normally affect streams which already exist.  This restarts the
+   * RngStream of every existing RandomVariableStream, keeping its
+   * stream number, from the current RngSeedManager seed and run.
+   *
+   * This is meant for replications which share the beginning of a
+   * simulation, such as the children of Simulator::ForkAt:
+   * \code
+   *   RngSeedManager::SetRun (replication);
+   *   RandomVariableStream::ReseedAll ();
+   * \endcode
+   */
+  static void ReseedAll (void);
+
   /**
    * \brief Get the next random value as a double drawn from the distribution.
    * \return A floating point random value.
@@ -149,6 +168,32 @@ public:
    */
   virtual uint32_t GetInteger (void) = 0;
 
+  /**
+   * \brief Fill an array with the next \p n values drawn from the
+   * distribution.
+   *
+   * The values are the same, and in the same order, as those returned
+   * by \p n successive calls to GetValue(void).  The default
+   * implementation simply makes those calls; distributions which can
+   * transform a block of uniforms at once override it.
+   *
+   * \param [out] values The array to fill, at least \p n long.
+   * \param [in] n The number of values to draw.
+   */
+  virtual void GetValues (double *values, std::size_t n);
+
+  /**
+   * \brief Fill an array with the next \p n integers drawn from the
+   * distribution.
+   *
+   * The values are the same, and in the same order, as those returned
+   * by \p n successive calls to GetInteger(void).
+   *
+   * \param [out] values The array to fill, at least \p n long.
+   * \param [in] n The number of values to draw.
+   */
+  virtual void GetIntegers (uint32_t *values, std::size_t n);
+
 protected:
   /**
    * \brief Get the pointer to the underlying RngStream.
@@ -156,6 +201,15 @@ protected:
    */
   RngStream *Peek(void) const;
 
+  /**
+   * \brief Discard any value drawn ahead of time from the RngStream.
+   *
+   * Called by ReseedAll after the RngStream has been restarted.
+   * Subclasses which keep values drawn ahead of time must override
+   * this; the default does nothing.
+   */
+  virtual void DiscardCachedValues (void);
+
 private:
   /**
    * Copy constructor.  These objects are not copyable.
@@ -187,6 +241,12 @@ private:
   /** The stream number for the RngStream. */
   int64_t m_stream;
 
+  /**
+   * The index of the RngStream, including automatically allocated
+   * ones, so that it can be restarted by ReseedAll.
+   */
+  uint64_t m_streamIndex;
+
 };  // class RandomVariableStream
 
   
@@ -294,6 +354,8 @@ public:
    * \note The upper limit is included in the output range.
    */
   virtual uint32_t GetInteger (void);
+  virtual void GetValues (double *values, std::size_t n);
+  virtual void GetIntegers (uint32_t *values, std::size_t n);
   
 private:
   /** The lower bound on values that can be returned by this RNG stream. */
@@ -586,6 +648,8 @@ public:
   // Inherited from RandomVariableStream
   virtual double GetValue (void);
   virtual uint32_t GetInteger (void);
+  virtual void GetValues (double *values, std::size_t n);
+  virtual void GetIntegers (uint32_t *values, std::size_t n);
 
 private:
   /** The mean value of the unbounded exponential distribution. */
@@ -1235,6 +1299,9 @@ public:
   virtual uint32_t GetInteger (void);
 
 private:
+  // Inherited
+  virtual void DiscardCachedValues (void);
+
   /** The mean value for the normal distribution returned by this RNG stream. */
   double m_mean;
 
@@ -1632,6 +1699,9 @@ private:
    */
   double GetNormalValue (double mean, double variance, double bound);
 
+  // Inherited
+  virtual void DiscardCachedValues (void);
+
   /** The alpha value for the gamma distribution returned by this RNG stream. */
   double m_alpha;
 
@@ -31,9 +31,11 @@
 #include "system-mutex.h"
 #include "boolean.h"
 #include "enum.h"
+#include "object-factory.h"
 
 
 #include <cmath>
+#include <algorithm>
 
 
 /**
@@ -69,12 +71,24 @@ RealtimeSimulatorImpl::GetTypeId (void)
                    TimeValue (Seconds (0.1)),
                    MakeTimeAccessor (&RealtimeSimulatorImpl::m_hardLimit),
                    MakeTimeChecker ())
+    .AddAttribute ("SynchronizerType",
+                   "The type of the Synchronizer which paces the simulation.",
+                   TypeIdValue (WallClockSynchronizer::GetTypeId ()),
+                   MakeTypeIdAccessor (&RealtimeSimulatorImpl::SetSynchronizerType),
+                   MakeTypeIdChecker ())
+    .AddAttribute ("Synchronizer",
+                   "The Synchronizer which paces the simulation.",
+                   TypeId::ATTR_GET,
+                   PointerValue (),
+                   MakePointerAccessor (&RealtimeSimulatorImpl::GetSynchronizer),
+                   MakePointerChecker<Synchronizer> ())
   ;
   return tid;
 }
 
 
 RealtimeSimulatorImpl::RealtimeSimulatorImpl ()
+  : m_eventsWithContext (1024)
 {
   NS_LOG_FUNCTION (this);
 
@@ -95,6 +109,8 @@ RealtimeSimulatorImpl::RealtimeSimulatorImpl ()
 
   // Be very careful not to do anything that would cause a change or assignment
   // of the underlying reference counts of m_synchronizer or you will be sorry.
+  // It is replaced by SetSynchronizerType when the attributes are set, before
+  // any other thread can see it.
   m_synchronizer = CreateObject<WallClockSynchronizer> ();
 }
 
@@ -112,6 +128,13 @@ RealtimeSimulatorImpl::DoDispose (void)
       Scheduler::Event next = m_events->RemoveNext ();
       next.impl->Unref ();
     }
+  // another thread may have seen the simulation running and handed an
+  // event over after the last drain of Run().
+  EventWithContext event;
+  while (m_eventsWithContext.TryPop (event))
+    {
+      event.event->Unref ();
+    }
   m_events = 0;
   m_synchronizer = 0;
   SimulatorImpl::DoDispose ();
@@ -221,6 +244,14 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
         NS_ASSERT_MSG (m_synchronizer->Realtime (), 
                        "RealtimeSimulatorImpl::ProcessOneEvent (): Synchronizer reports not Realtime ()");
 
+        //
+        // Reset the synchronizer before looking at the events from other
+        // threads, so that any event they hand over from now on, which we
+        // would not see below, will cause it to interrupt.
+        //
+        m_synchronizer->SetCondition (false);
+        ProcessEventsWithContext ();
+
         //
         // tsNow is set to the normalized current real time.  When the simulation was
         // started, the current real time was effectively set to zero; so tsNow is
@@ -253,10 +284,9 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
         // We've figured out how long we need to delay in order to pace the 
         // simulation time with the real time.  We're going to sleep, but need
         // to work with the synchronizer to make sure we're awakened if something 
-        // external happens (like a packet is received).  This next line resets
-        // the synchronizer so that any future event will cause it to interrupt.
+        // external happens (like a packet is received).  The synchronizer was
+        // reset above so that any future event will cause it to interrupt.
         //
-        m_synchronizer->SetCondition (false);
       }
 
       //
@@ -326,6 +356,7 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
     // event we're working on won't be on the list and so subsequent operations won't
     // mess with us.
     //
+    ProcessEventsWithContext ();
     NS_ASSERT_MSG (m_events->IsEmpty () == false, 
                    "RealtimeSimulatorImpl::ProcessOneEvent(): event queue is empty");
     next = m_events->RemoveNext ();
@@ -387,6 +418,7 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
   // changing things out from under us.
 
   EventImpl *event = next.impl;
+  m_synchronizer->SetEventTime (next.key.m_ts);
   m_synchronizer->EventStart ();
   event->Invoke ();
   m_synchronizer->EventEnd ();
@@ -442,6 +474,7 @@ RealtimeSimulatorImpl::Run (void)
       {
         CriticalSection cs (m_mutex);
 
+        ProcessEventsWithContext ();
         if (!m_events->IsEmpty ())
           {
             process = true;
@@ -477,6 +510,35 @@ RealtimeSimulatorImpl::Run (void)
   }
 
   m_running = false;
+
+  //
+  // Other threads use the event list directly from now on: move the events
+  // they may have handed over in the meantime.  A thread which saw the
+  // simulation running may still hand an event over after this: the next
+  // Run() schedules it, or DoDispose() releases it.
+  //
+  {
+    CriticalSection cs (m_mutex);
+    ProcessEventsWithContext ();
+  }
+}
+
+void
+RealtimeSimulatorImpl::ProcessEventsWithContext (void)
+{
+  EventWithContext event;
+  while (m_eventsWithContext.TryPop (event))
+    {
+      Scheduler::Event ev;
+      ev.impl = event.event;
+      // the event may have been handed over after the current event started.
+      ev.key.m_ts = std::max (event.timestamp, m_currentTs);
+      ev.key.m_context = event.context;
+      ev.key.m_uid = m_uid;
+      m_uid++;
+      m_unscheduledEvents++;
+      m_events->Insert (ev);
+    }
 }
 
 bool
@@ -543,6 +605,26 @@ RealtimeSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
 {
   NS_LOG_FUNCTION (this << context << delay << impl);
 
+  if (m_running && !SystemThread::Equals (m_main))
+    {
+      //
+      // While the simulator is running, other threads hand their events over
+      // through a lock-free queue, which the main thread drains before it
+      // looks at the event list.  The realtime clock is read now so that the
+      // time spent in the queue does not delay the event.
+      //
+      EventWithContext ev;
+      ev.context = context;
+      ev.timestamp = m_synchronizer->GetCurrentRealtime () + delay.GetTimeStep ();
+      ev.event = impl;
+      if (m_eventsWithContext.TryPush (ev))
+        {
+          m_synchronizer->Signal ();
+          return;
+        }
+      // the queue is full: fall back to the event list.
+    }
+
   {
     CriticalSection cs (m_mutex);
     uint64_t ts;
@@ -750,10 +832,29 @@ RealtimeSimulatorImpl::Remove (const EventId &id)
 void
 RealtimeSimulatorImpl::Cancel (const EventId &id)
 {
-  if (IsExpired (id) == false)
+  if (IsExpired (id))
     {
+      return;
+    }
+  if (id.GetUid () == 2)
+    {
+      // destroy events are not in the event list.
       id.PeekEventImpl ()->Cancel ();
+      return;
     }
+
+  {
+    CriticalSection cs (m_mutex);
+
+    Scheduler::Event event;
+    event.impl = id.PeekEventImpl ();
+    event.key.m_ts = id.GetTs ();
+    event.key.m_context = id.GetContext ();
+    event.key.m_uid = id.GetUid ();
+
+    // the scheduler releases the events it compacts away.
+    m_unscheduledEvents -= m_events->Cancel (event);
+  }
 }
 
 bool
@@ -832,6 +933,23 @@ RealtimeSimulatorImpl::GetSynchronizationMode (void) const
   return m_synchronizationMode;
 }
 
+void
+RealtimeSimulatorImpl::SetSynchronizerType (TypeId tid)
+{
+  NS_LOG_FUNCTION (this << tid);
+  NS_ASSERT_MSG (!m_running, "Cannot change the Synchronizer of a running simulation");
+  ObjectFactory factory;
+  factory.SetTypeId (tid);
+  m_synchronizer = factory.Create<Synchronizer> ();
+}
+
+Ptr<Synchronizer>
+RealtimeSimulatorImpl::GetSynchronizer (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_synchronizer;
+}
+
 void 
 RealtimeSimulatorImpl::SetHardLimit (Time limit)
 {
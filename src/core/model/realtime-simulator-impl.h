@@ -30,6 +30,7 @@
 #include "assert.h"
 #include "log.h"
 #include "system-mutex.h"
+#include "mpsc-queue.h"
 
 #include <list>
 
@@ -154,6 +155,19 @@ public:
    */
   Time GetHardLimit (void) const;
 
+  /**
+   * Replace the Synchronizer by a new one.
+   *
+   * \param [in] tid The TypeId of the new Synchronizer.
+   */
+  void SetSynchronizerType (TypeId tid);
+  /**
+   * Get the Synchronizer.
+   *
+   * \returns The Synchronizer which paces the simulation.
+   */
+  Ptr<Synchronizer> GetSynchronizer (void) const;
+
 private:
   /**
    * Is the simulator running?
@@ -172,9 +186,29 @@ private:
   uint64_t NextTs (void) const;
   /** Process the next event. */
   void ProcessOneEvent (void);
+  /**
+   * Move the events from other threads into the event list.
+   * Should be called with the critical section locked.
+   */
+  void ProcessEventsWithContext (void);
   /** Destructor implementation. */
   virtual void DoDispose (void);
 
+  /** Wrap an event from another thread with its execution context. */
+  struct EventWithContext {
+    /** The event context. */
+    uint32_t context;
+    /** Absolute event timestamp. */
+    uint64_t timestamp;
+    /** The event implementation. */
+    EventImpl *event;
+  };
+  /**
+   * Lock-free queue of the events scheduled by other threads while
+   * the simulator is running.
+   */
+  MpscQueue<struct EventWithContext> m_eventsWithContext;
+
   /** Container type for events to be run at destroy time. */
   typedef std::list<EventId> DestroyEvents;
   /** Container for events to be run at destroy time. */
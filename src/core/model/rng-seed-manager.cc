@@ -23,6 +23,7 @@
 #include "integer.h"
 #include "config.h"
 #include "log.h"
+#include "simulation-local.h"
 
 /**
  * \file
@@ -39,7 +40,7 @@ NS_LOG_COMPONENT_DEFINE ("RngSeedManager");
  * The next random number generator stream number to use
  * for automatic assignment.
  */
-static uint64_t g_nextStreamIndex = 0;
+static NS_SIMULATION_LOCAL uint64_t g_nextStreamIndex = 0;
 /**
  * \relates RngSeedManager
  * The random number generator seed number global value.  This is used to
@@ -67,10 +68,39 @@ static ns3::GlobalValue g_rngRun ("RngRun",
                                   ns3::IntegerValue (1),
                                   ns3::MakeIntegerChecker<int64_t> ());
 
+#ifdef ENABLE_THREAD_LOCAL_SIMULATOR
+/**
+ * \relates RngSeedManager
+ * Whether the calling thread has set its own seed.
+ */
+static thread_local bool g_localSeedSet = false;
+/**
+ * \relates RngSeedManager
+ * The seed set by the calling thread, which overrides RngSeed.
+ */
+static thread_local uint32_t g_localSeed = 0;
+/**
+ * \relates RngSeedManager
+ * Whether the calling thread has set its own run number.
+ */
+static thread_local bool g_localRunSet = false;
+/**
+ * \relates RngSeedManager
+ * The run number set by the calling thread, which overrides RngRun.
+ */
+static thread_local uint64_t g_localRun = 0;
+#endif /* ENABLE_THREAD_LOCAL_SIMULATOR */
+
 
 uint32_t RngSeedManager::GetSeed (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
+#ifdef ENABLE_THREAD_LOCAL_SIMULATOR
+  if (g_localSeedSet)
+    {
+      return g_localSeed;
+    }
+#endif /* ENABLE_THREAD_LOCAL_SIMULATOR */
   IntegerValue seedValue;
   g_rngSeed.GetValue (seedValue);
   return seedValue.Get ();
@@ -79,18 +109,36 @@ void
 RngSeedManager::SetSeed (uint32_t seed)
 {
   NS_LOG_FUNCTION (seed);
+#ifdef ENABLE_THREAD_LOCAL_SIMULATOR
+  // RngSeed is shared by all the simulation threads.
+  g_localSeedSet = true;
+  g_localSeed = seed;
+#else /* ENABLE_THREAD_LOCAL_SIMULATOR */
   Config::SetGlobal ("RngSeed", IntegerValue(seed));
+#endif /* ENABLE_THREAD_LOCAL_SIMULATOR */
 }
 
 void RngSeedManager::SetRun (uint64_t run)
 {
   NS_LOG_FUNCTION (run);
+#ifdef ENABLE_THREAD_LOCAL_SIMULATOR
+  // RngRun is shared by all the simulation threads.
+  g_localRunSet = true;
+  g_localRun = run;
+#else /* ENABLE_THREAD_LOCAL_SIMULATOR */
   Config::SetGlobal ("RngRun", IntegerValue (run));
+#endif /* ENABLE_THREAD_LOCAL_SIMULATOR */
 }
 
 uint64_t RngSeedManager::GetRun ()
 {
   NS_LOG_FUNCTION_NOARGS ();
+#ifdef ENABLE_THREAD_LOCAL_SIMULATOR
+  if (g_localRunSet)
+    {
+      return g_localRun;
+    }
+#endif /* ENABLE_THREAD_LOCAL_SIMULATOR */
   IntegerValue value;
   g_rngRun.GetValue (value);
   int run = value.Get();
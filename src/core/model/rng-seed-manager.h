@@ -35,6 +35,11 @@ namespace ns3 {
  *
  * Manage the seed number and run number of the underlying
  * random number generator, and automatic assignment of stream numbers.
+ *
+ * With --enable-thread-local-simulator, the automatic stream numbers
+ * belong to the simulation of each thread, and SetSeed and SetRun
+ * only affect the calling thread; the RngSeed and RngRun global
+ * values remain the defaults of all the threads.
  */
 class RngSeedManager
 {
@@ -329,35 +329,66 @@ namespace ns3 {
 
 using namespace MRG32k3a;
   
-double RngStream::RandU01 ()
+void
+RngStream::Generate (double *values, std::size_t n)
 {
-  int32_t k;
-  double p1, p2, u;
-
-  /* Component 1 */
-  p1 = a12 * m_currentState[1] - a13n * m_currentState[0];
-  k = static_cast<int32_t> (p1 / m1);
-  p1 -= k * m1;
-  if (p1 < 0.0)
+  /* Component 1: store p1 for each step in values. */
+  double s0 = m_currentState[0];
+  double s1 = m_currentState[1];
+  double s2 = m_currentState[2];
+  for (std::size_t i = 0; i < n; ++i)
     {
-      p1 += m1;
+      double p1 = a12 * s1 - a13n * s0;
+      int32_t k = static_cast<int32_t> (p1 / m1);
+      p1 -= k * m1;
+      if (p1 < 0.0)
+        {
+          p1 += m1;
+        }
+      s0 = s1; s1 = s2; s2 = p1;
+      values[i] = p1;
     }
-  m_currentState[0] = m_currentState[1]; m_currentState[1] = m_currentState[2]; m_currentState[2] = p1;
+  m_currentState[0] = s0; m_currentState[1] = s1; m_currentState[2] = s2;
 
-  /* Component 2 */
-  p2 = a21 * m_currentState[5] - a23n * m_currentState[3];
-  k = static_cast<int32_t> (p2 / m2);
-  p2 -= k * m2;
-  if (p2 < 0.0)
+  /* Component 2, combined with the stored p1. */
+  double s3 = m_currentState[3];
+  double s4 = m_currentState[4];
+  double s5 = m_currentState[5];
+  for (std::size_t i = 0; i < n; ++i)
     {
-      p2 += m2;
+      double p2 = a21 * s5 - a23n * s3;
+      int32_t k = static_cast<int32_t> (p2 / m2);
+      p2 -= k * m2;
+      if (p2 < 0.0)
+        {
+          p2 += m2;
+        }
+      s3 = s4; s4 = s5; s5 = p2;
+
+      /* Combination */
+      double p1 = values[i];
+      values[i] = ((p1 > p2) ? (p1 - p2) * norm : (p1 - p2 + m1) * norm);
     }
-  m_currentState[3] = m_currentState[4]; m_currentState[4] = m_currentState[5]; m_currentState[5] = p2;
+  m_currentState[3] = s3; m_currentState[4] = s4; m_currentState[5] = s5;
+}
 
-  /* Combination */
-  u = ((p1 > p2) ? (p1 - p2) * norm : (p1 - p2 + m1) * norm);
+void
+RngStream::Refill (void)
+{
+  Generate (m_buffer, BUFFER_SIZE);
+  m_next = 0;
+}
 
-  return u;
+void
+RngStream::RandU01 (double *values, std::size_t n)
+{
+  /* Drain what is already buffered, so the order is unchanged. */
+  while (n > 0 && m_next < BUFFER_SIZE)
+    {
+      *values++ = m_buffer[m_next++];
+      --n;
+    }
+  Generate (values, n);
 }
 
 RngStream::RngStream (uint32_t seedNumber, uint64_t stream, uint64_t substream)
@@ -372,6 +403,7 @@ RngStream::RngStream (uint32_t seedNumber, uint64_t stream, uint64_t substream)
     }
   AdvanceNthBy (stream, 127, m_currentState);
   AdvanceNthBy (substream, 76, m_currentState);
+  m_next = BUFFER_SIZE;
 }
 
 RngStream::RngStream(const RngStream& r)
@@ -380,6 +412,11 @@ RngStream::RngStream(const RngStream& r)
     {
       m_currentState[i] = r.m_currentState[i];
     }
+  for (uint32_t i = 0; i < BUFFER_SIZE; ++i)
+    {
+      m_buffer[i] = r.m_buffer[i];
+    }
+  m_next = r.m_next;
 }
 
 void 
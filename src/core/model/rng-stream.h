@@ -20,6 +20,7 @@
 #ifndef RNGSTREAM_H
 #define RNGSTREAM_H
 #include <string>
+#include <cstddef>
 #include <stdint.h>
 
 /**
@@ -67,11 +68,42 @@ public:
    * Generate the next random number for this stream.
    * Uniformly distributed between 0 and 1.
    *
+   * Values are served from a small per-stream buffer which is
+   * refilled in blocks, so the sequence is exactly the one the
+   * recurrence would produce one step at a time.
+   *
    * \returns The next random.
    */
   double RandU01 (void);
+  /**
+   * Generate the next \p n random numbers for this stream.
+   *
+   * The values are the same, and in the same order, as those
+   * returned by \p n successive calls to RandU01(void).
+   *
+   * \param [out] values The array to fill, at least \p n long.
+   * \param [in] n The number of values to generate.
+   */
+  void RandU01 (double *values, std::size_t n);
 
 private:
+  /**
+   * Step the recurrence \p n times, writing each output to \p values.
+   *
+   * The state is kept in locals for the duration of the loop, and
+   * the two components are advanced in separate passes so that each
+   * pass is a short, branch-light recurrence.
+   *
+   * \param [out] values The array to fill, at least \p n long.
+   * \param [in] n The number of values to generate.
+   */
+  void Generate (double *values, std::size_t n);
+  /** Refill the prefetch buffer. */
+  void Refill (void);
+
+  /** Number of values prefetched at a time. */
+  static const uint32_t BUFFER_SIZE = 16;
+
   /**
    * Advance \p state of the RNG by leaps and bounds.
    *
@@ -83,8 +115,22 @@ private:
 
   /** The RNG state vector. */
   double m_currentState[6];
+  /** Prefetched values, not yet returned by RandU01(). */
+  double m_buffer[BUFFER_SIZE];
+  /** Index of the next value to return from m_buffer. */
+  uint32_t m_next;
 };
 
+inline double
+RngStream::RandU01 (void)
+{
+  if (m_next == BUFFER_SIZE)
+    {
+      Refill ();
+    }
+  return m_buffer[m_next++];
+}
+
 } // namespace ns3
 
 #endif
@@ -19,6 +19,9 @@
  */
 
 #include "scheduler.h"
+#include "event-impl.h"
+#include "double.h"
+#include "uinteger.h"
 #include "assert.h"
 #include "log.h"
 
@@ -34,6 +37,12 @@ NS_LOG_COMPONENT_DEFINE ("Scheduler");
 
 NS_OBJECT_ENSURE_REGISTERED (Scheduler);
 
+Scheduler::Scheduler ()
+  : m_cancelled (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
 Scheduler::~Scheduler ()
 {
   NS_LOG_FUNCTION (this);
@@ -45,8 +54,83 @@ Scheduler::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::Scheduler")
     .SetParent<Object> ()
     .SetGroupName ("Core")
+    .AddAttribute ("MaxCancelledFraction",
+                   "The fraction of cancelled events in the event list "
+                   "above which they are all removed. "
+                   "A value of 1 disables the removal.",
+                   DoubleValue (0.5),
+                   MakeDoubleAccessor (&Scheduler::m_maxCancelledFraction),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("MinCancelledEvents",
+                   "The smallest number of cancelled events "
+                   "which are removed at once.",
+                   UintegerValue (256),
+                   MakeUintegerAccessor (&Scheduler::m_minCancelledEvents),
+                   MakeUintegerChecker<uint32_t> (1))
   ;
   return tid;
 }
 
+void
+Scheduler::InsertSorted (const std::vector<Event> &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+  for (std::vector<Event>::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      Insert (*i);
+    }
+}
+
+uint32_t
+Scheduler::GetSize (void) const
+{
+  return 0;
+}
+
+uint32_t
+Scheduler::Cancel (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  ev.impl->Cancel ();
+  m_cancelled++;
+  if (m_cancelled >= m_minCancelledEvents
+      && m_cancelled > m_maxCancelledFraction * GetSize ())
+    {
+      return Compact ();
+    }
+  return 0;
+}
+
+uint32_t
+Scheduler::Compact (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t removed = DoCompact ();
+  NS_LOG_LOGIC ("removed " << removed << " of " << m_cancelled << " cancelled events");
+  m_cancelled = 0;
+  return removed;
+}
+
+uint32_t
+Scheduler::GetCancelledCount (void) const
+{
+  return m_cancelled;
+}
+
+void
+Scheduler::NotifyRemoved (const Event &ev)
+{
+  // Events may also be cancelled without Cancel (): do not underflow.
+  if (m_cancelled != 0 && ev.impl->IsCancelled ())
+    {
+      m_cancelled--;
+    }
+}
+
+uint32_t
+Scheduler::DoCompact (void)
+{
+  return 0;
+}
+
 } // namespace ns3
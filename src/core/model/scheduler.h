@@ -22,6 +22,7 @@
 #define SCHEDULER_H
 
 #include <stdint.h>
+#include <vector>
 #include "object.h"
 
 /**
@@ -62,6 +63,15 @@ class EventImpl;
  * calling EventId::Ref and SimpleRefCount::Unref at the right time.
  * Typically, EventId::Ref is called before Insert and SimpleRefCount::Unref is called
  * after a call to one of the Remove methods.
+ *
+ * Cancelled events are not removed from the event list right away:
+ * Cancel() only marks them, and they are skipped when they reach the
+ * head of the list.  The scheduler counts them, and once they make up
+ * more than \c MaxCancelledFraction of the event list they are all
+ * removed at once by Compact(), which releases the reference the
+ * caller held on each of them.  Subclasses which support compaction
+ * override GetSize() and DoCompact(), and call NotifyRemoved() on the
+ * events returned by RemoveNext().
  */
 class Scheduler : public Object
 {
@@ -95,6 +105,8 @@ public:
     EventKey key;          /**< Key for sorting and ordering Events. */
   };
 
+  /** Constructor. */
+  Scheduler ();
   /** Destructor. */
   virtual ~Scheduler () = 0;
 
@@ -104,6 +116,16 @@ public:
    * \param [in] ev Event to store in the event list
    */
   virtual void Insert (const Event &ev) = 0;
+  /**
+   * Insert several new Events in the schedule.
+   *
+   * The default implementation calls Insert() for each event; subclasses
+   * override it when they can take advantage of the order of the events.
+   *
+   * \param [in] events The events to store in the event list, sorted
+   *             in increasing EventKey order.
+   */
+  virtual void InsertSorted (const std::vector<Event> &events);
   /**
    * Test if the schedule is empty.
    *
@@ -135,6 +157,63 @@ public:
    * \param [in] ev The event to remove
    */
   virtual void Remove (const Event &ev) = 0;
+  /**
+   * Get the number of events in the event list.
+   *
+   * \returns The number of events, including the cancelled ones, or 0
+   *          if the subclass does not support compaction.
+   */
+  virtual uint32_t GetSize (void) const;
+
+  /**
+   * Cancel an event of the event list.
+   *
+   * The event is marked as cancelled but stays in the event list, unless
+   * this brings the cancelled events above \c MaxCancelledFraction of the
+   * event list, in which case they are all removed by Compact().
+   *
+   * \param [in] ev The event to cancel.
+   * \returns The number of events removed from the event list.
+   */
+  uint32_t Cancel (const Event &ev);
+  /**
+   * Remove all the cancelled events from the event list, and Unref them.
+   *
+   * \returns The number of events removed from the event list.
+   */
+  uint32_t Compact (void);
+  /**
+   * Get the number of cancelled events in the event list.
+   *
+   * \returns The number of events cancelled through Cancel() which
+   *          are still in the event list.
+   */
+  uint32_t GetCancelledCount (void) const;
+
+protected:
+  /**
+   * Account for an event which left the event list through RemoveNext().
+   *
+   * \param [in] ev The event removed.
+   */
+  void NotifyRemoved (const Event &ev);
+
+private:
+  /**
+   * Remove all the cancelled events from the event list, and Unref them.
+   *
+   * The default implementation does nothing.
+   *
+   * \returns The number of events removed from the event list.
+   */
+  virtual uint32_t DoCompact (void);
+
+  /** Fraction of cancelled events which triggers a compaction. */
+  double m_maxCancelledFraction;
+  /** Smallest number of cancelled events which triggers a compaction. */
+  uint32_t m_minCancelledEvents;
+  /** Number of cancelled events in the event list. */
+  uint32_t m_cancelled;
 };
 
 /**
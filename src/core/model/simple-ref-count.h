@@ -28,6 +28,12 @@
 #include <stdint.h>
 #include <limits>
 
+#ifdef ENABLE_OBJECT_ACCOUNTING
+#include "object-accounting.h"
+#include <type_traits>
+#include <typeinfo>
+#endif
+
 /**
  * \file
  * \ingroup ptr
@@ -36,6 +42,8 @@
 
 namespace ns3 {
 
+class ObjectBase;
+
 /**
  * \ingroup ptr
  * \brief A template-based reference counting class
@@ -75,14 +83,33 @@ public:
   /** Default constructor.  */
   SimpleRefCount ()
     : m_count (1)
-  {}
+  {
+#ifdef ENABLE_OBJECT_ACCOUNTING
+    AccountConstruct ();
+#endif
+  }
   /**
    * Copy constructor
    * \param [in] o The object to copy into this one.
    */
   SimpleRefCount (const SimpleRefCount &o)
     : m_count (1)
-  {}
+  {
+#ifdef ENABLE_OBJECT_ACCOUNTING
+    AccountConstruct ();
+#endif
+  }
+#ifdef ENABLE_OBJECT_ACCOUNTING
+  /** Destructor. */
+  ~SimpleRefCount ()
+  {
+    ObjectAccounting::Counter *counter = GetAccountingCounter ();
+    if (counter != 0)
+      {
+        ObjectAccounting::Remove (counter);
+      }
+  }
+#endif
   /**
    * Assignment operator
    * \param [in] o The object to copy
@@ -130,6 +157,34 @@ public:
   }
 
 private:
+#ifdef ENABLE_OBJECT_ACCOUNTING
+  /**
+   * Get the ObjectAccounting counter of \p T.  Objects are counted
+   * by TypeId instead, so they have none.
+   *
+   * \returns The counter, or 0.
+   */
+  static ObjectAccounting::Counter * GetAccountingCounter (void)
+  {
+    if (std::is_same<PARENT, ObjectBase>::value)
+      {
+        return 0;
+      }
+    static ObjectAccounting::Counter *counter =
+      ObjectAccounting::GetCounter (typeid (T), sizeof (T));
+    return counter;
+  }
+  /** Count this instance. */
+  void AccountConstruct (void)
+  {
+    ObjectAccounting::Counter *counter = GetAccountingCounter ();
+    if (counter != 0)
+      {
+        ObjectAccounting::Add (counter);
+      }
+  }
+#endif
+
   /**
    * The reference count.
    *
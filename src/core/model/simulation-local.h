@@ -0,0 +1,55 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SIMULATION_LOCAL_H
+#define SIMULATION_LOCAL_H
+
+#include "ns3/core-config.h"
+
+/**
+ * \file
+ * \ingroup simulator
+ * NS_SIMULATION_LOCAL macro definition.
+ */
+
+/**
+ * \ingroup simulator
+ * \def NS_SIMULATION_LOCAL
+ * Storage class of the state which belongs to one simulation, such
+ * as the Simulator implementation, the NodeList or the Names.
+ *
+ * When ns-3 is configured with --enable-thread-local-simulator, this
+ * state is thread_local, so that each thread runs an independent
+ * simulation: a driver can run replications on several threads of one
+ * process.  TypeIds, GlobalValues, attribute defaults and the logging
+ * configuration remain shared, and must be set before the threads
+ * start.  Threads which schedule events for the simulation of
+ * another thread, such as the workers of MultithreadedSimulatorImpl or
+ * the reader threads of emulated devices, are not supported in this
+ * mode.  Otherwise this expands to nothing and the state is shared
+ * by the whole process.
+ *
+ * \code
+ *   static NS_SIMULATION_LOCAL SimulatorImpl *impl = 0;
+ * \endcode
+ */
+#ifdef ENABLE_THREAD_LOCAL_SIMULATOR
+# define NS_SIMULATION_LOCAL thread_local
+#else
+# define NS_SIMULATION_LOCAL
+#endif
+
+#endif /* SIMULATION_LOCAL_H */
@@ -38,6 +38,10 @@ namespace ns3 {
  *
  * For a singleton with a lifetime bounded by the process,
  * not the simulation run, see Singleton.
+ *
+ * Like the other state of a simulation, the instance is
+ * NS_SIMULATION_LOCAL: with --enable-thread-local-simulator
+ * each thread has its own.
  */
 template <typename T>
 class SimulationSingleton
@@ -99,6 +103,7 @@ private:
  ********************************************************************/
 
 #include "simulator.h"
+#include "simulation-local.h"
 
 namespace ns3 {
 
@@ -114,7 +119,7 @@ template <typename T>
 T **
 SimulationSingleton<T>::GetObject (void)
 {
-  static T *pobject = 0;
+  static NS_SIMULATION_LOCAL T *pobject = 0;
   if (pobject == 0)
     {
       pobject = new T ();
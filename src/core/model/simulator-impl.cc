@@ -42,4 +42,14 @@ SimulatorImpl::GetTypeId (void)
   return tid;
 }
 
+void
+SimulatorImpl::ScheduleBatch (const std::vector<Simulator::BatchEvent> &batch)
+{
+  NS_LOG_FUNCTION (this << batch.size ());
+  for (std::vector<Simulator::BatchEvent>::const_iterator i = batch.begin (); i != batch.end (); ++i)
+    {
+      ScheduleWithContext (i->context, i->delay, i->event);
+    }
+}
+
 } // namespace ns3
@@ -27,6 +27,9 @@
 #include "object.h"
 #include "object-factory.h"
 #include "ptr.h"
+#include "simulator.h"
+
+#include <vector>
 
 /**
  * \file
@@ -67,6 +70,12 @@ public:
   virtual EventId Schedule (const Time &delay, EventImpl *event) = 0;
   /** \copydoc Simulator::ScheduleWithContext(uint32_t,const Time&,EventImpl*) */
   virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event) = 0;
+  /**
+   * \copydoc Simulator::ScheduleBatch
+   *
+   * The default implementation calls ScheduleWithContext() for each event.
+   */
+  virtual void ScheduleBatch (const std::vector<Simulator::BatchEvent> &batch);
   /** \copydoc Simulator::ScheduleNow(const Ptr<EventImpl>&) */
   virtual EventId ScheduleNow (EventImpl *event) = 0;
   /** \copydoc Simulator::ScheduleDestroy(const Ptr<EventImpl>&) */
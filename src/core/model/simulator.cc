@@ -24,20 +24,31 @@
 #include "map-scheduler.h"
 #include "event-impl.h"
 #include "des-metrics.h"
+#include "simulation-local.h"
+#include "object-accounting.h"
 
 #include "ptr.h"
 #include "string.h"
 #include "object-factory.h"
 #include "global-value.h"
 #include "assert.h"
+#include "abort.h"
 #include "log.h"
 
 #include <cmath>
 #include <fstream>
 #include <list>
+#include <set>
 #include <vector>
 #include <iostream>
 #include <iomanip>
+#include <cstdio>
+
+#ifdef HAVE_SYS_WAIT_H
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 /**
  * \file
@@ -132,6 +143,48 @@ NodePrinter (std::ostream &os)
     }
 }
 
+/**
+ * \ingroup logging
+ * Default LogStampGetter implementation, which stamps binary log
+ * records with the time and node id printed by TimePrinter() and
+ * NodePrinter().
+ *
+ * \param [out] time The simulation time, in units of
+ *              10<sup>-digits</sup> seconds.
+ * \param [out] digits The number of decimal places of the time.
+ * \param [out] context The simulation node id.
+ */
+static void
+StampGetter (int64_t &time, uint8_t &digits, uint32_t &context)
+{
+  Time now = Simulator::Now ();
+  switch (Time::GetResolution ())
+    {
+    case Time::US:
+      time = now.GetTimeStep ();
+      digits = 6;
+      break;
+    case Time::NS:
+      time = now.GetTimeStep ();
+      digits = 9;
+      break;
+    case Time::PS:
+      time = now.GetTimeStep ();
+      digits = 12;
+      break;
+    case Time::FS:
+      time = now.GetTimeStep ();
+      digits = 15;
+      break;
+    default:
+      // Coarser resolutions are printed with 5 decimal places.
+      time = now.GetMicroSeconds () / 10;
+      digits = 5;
+      break;
+    }
+  context = Simulator::GetContext ();
+}
+
 /**
  * \ingroup simulator
  * \brief Get the static SimulatorImpl instance.
@@ -139,7 +192,7 @@ NodePrinter (std::ostream &os)
  */
 static SimulatorImpl **PeekImpl (void)
 {
-  static SimulatorImpl *impl = 0;
+  static NS_SIMULATION_LOCAL SimulatorImpl *impl = 0;
   return &impl;
 }
 
@@ -182,6 +235,7 @@ static SimulatorImpl * GetImpl (void)
 //
       LogSetTimePrinter (&TimePrinter);
       LogSetNodePrinter (&NodePrinter);
+      LogSetStampGetter (&StampGetter);
     }
   return *pimpl;
 }
@@ -203,6 +257,7 @@ Simulator::Destroy (void)
    */
   LogSetTimePrinter (0);
   LogSetNodePrinter (0);
+  LogSetStampGetter (0);
   (*pimpl)->Destroy ();
   (*pimpl)->Unref ();
   *pimpl = 0;
@@ -227,6 +282,9 @@ Simulator::Run (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
   Time::ClearMarkedTimes ();
+#ifdef ENABLE_OBJECT_ACCOUNTING
+  ObjectAccounting::Start ();
+#endif
   GetImpl ()->Run ();
 }
 
@@ -245,6 +303,87 @@ Simulator::Stop (Time const &delay)
   GetImpl ()->Stop (delay);
 }
 
+uint32_t
+Simulator::ForkAt (Time const &time, uint32_t n, uint32_t maxRunning)
+{
+  NS_LOG_FUNCTION (time << n << maxRunning);
+  NS_ABORT_MSG_IF (time < Now (), "Simulator::ForkAt(): checkpoint " << time << " is in the past");
+
+  Stop (time - Now ());
+  Run ();
+  NS_LOG_LOGIC ("checkpoint reached at " << Now ());
+
+#ifdef HAVE_SYS_WAIT_H
+  // Anything left in the output buffers would be written once by
+  // each child as well as by the parent.
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::clog.flush ();
+  std::fflush (0);
+#ifdef ENABLE_DES_METRICS
+  DesMetrics::Get ()->Flush ();
+#endif
+
+  std::set<pid_t> running;
+  uint32_t failed = 0;
+  uint32_t next = 1;
+  while (next <= n || !running.empty ())
+    {
+      if (next <= n && (maxRunning == 0 || running.size () < maxRunning))
+        {
+          LogBinaryPrepareFork ();
+          pid_t pid = fork ();
+          NS_ABORT_MSG_IF (pid < 0, "Simulator::ForkAt(): fork failed for child " << next);
+          if (pid == 0)
+            {
+              LogBinaryAfterFork (next);
+#ifdef ENABLE_DES_METRICS
+              DesMetrics::Get ()->AfterFork (next);
+#endif
+              return next;
+            }
+          LogBinaryAfterFork (0);
+          NS_LOG_LOGIC ("forked child " << next << " as process " << pid);
+          running.insert (pid);
+          ++next;
+          continue;
+        }
+      // Either all the children have been forked or as many as allowed
+      // are running: wait for one of them to exit.  Only our children
+      // are waited for, so that the other children of the program are
+      // left for it to reap.
+      bool exited = false;
+      for (std::set<pid_t>::iterator i = running.begin (); i != running.end (); )
+        {
+          int status;
+          pid_t pid = waitpid (*i, &status, WNOHANG);
+          NS_ABORT_MSG_IF (pid < 0, "Simulator::ForkAt(): waitpid failed for process " << *i);
+          if (pid == 0)
+            {
+              ++i;
+              continue;
+            }
+          if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+            {
+              NS_LOG_WARN ("child process " << pid << " failed with status " << status);
+              ++failed;
+            }
+          running.erase (i++);
+          exited = true;
+        }
+      if (!exited)
+        {
+          usleep (10000);
+        }
+    }
+  NS_ABORT_MSG_IF (failed != 0, "Simulator::ForkAt(): " << failed << " of " << n << " children failed");
+  return 0;
+#else /* HAVE_SYS_WAIT_H */
+  NS_FATAL_ERROR ("Simulator::ForkAt(): fork is not available on this system");
+  return 0;
+#endif /* HAVE_SYS_WAIT_H */
+}
+
 Time
 Simulator::Now (void)
 {
@@ -280,6 +419,30 @@ Simulator::ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *
 #endif
   return GetImpl ()->ScheduleWithContext (context, delay, impl);
 }
+Simulator::BatchEvent::BatchEvent ()
+  : context (0),
+    event (0)
+{
+}
+
+Simulator::BatchEvent::BatchEvent (uint32_t context, const Time &delay, EventImpl *event)
+  : context (context),
+    delay (delay),
+    event (event)
+{
+}
+
+void
+Simulator::ScheduleBatch (const std::vector<BatchEvent> &batch)
+{
+#ifdef ENABLE_DES_METRICS
+  for (std::vector<BatchEvent>::const_iterator i = batch.begin (); i != batch.end (); ++i)
+    {
+      DesMetrics::Get ()->TraceWithContext (i->context, Now (), i->delay);
+    }
+#endif
+  GetImpl ()->ScheduleBatch (batch);
+}
 EventId
 Simulator::ScheduleDestroy (const Ptr<EventImpl> &ev)
 {
@@ -419,6 +582,7 @@ Simulator::SetImplementation (Ptr<SimulatorImpl> impl)
 //
   LogSetTimePrinter (&TimePrinter);
   LogSetNodePrinter (&NodePrinter);
+  LogSetStampGetter (&StampGetter);
 }
 
 Ptr<SimulatorImpl>
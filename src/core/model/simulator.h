@@ -30,6 +30,7 @@
 
 #include <stdint.h>
 #include <string>
+#include <vector>
 
 /**
  * @file
@@ -166,6 +167,69 @@ public:
    */
   static void Stop (const Time &delay);
 
+  /**
+   * Run the simulation up to a checkpoint, then continue it in
+   * several child processes.
+   *
+   * The simulation runs until the checkpoint \p time, as if by
+   * Simulator::Stop and Simulator::Run, in the calling process.  The
+   * process then forks \p n children with fork(), each of which
+   * starts from a copy-on-write image of the simulation at the
+   * checkpoint.  This shares a common warm-up (routing convergence,
+   * association, ARP) among the replications of a parameter sweep.
+   *
+   * In the i-th child, ForkAt returns i, from 1 to \p n.  The child
+   * should then make its replication distinct, for example by changing
+   * the run number of the random variables or some attributes, and
+   * write its results under a distinct output prefix, before running
+   * the rest of the simulation:
+   * \code
+   *   uint32_t replication = Simulator::ForkAt (Minutes (30), 100, 8);
+   *   if (replication == 0)
+   *     {
+   *       // The parent: all the replications have finished.
+   *       return 0;
+   *     }
+   *   RngSeedManager::SetRun (replication);
+   *   RandomVariableStream::ReseedAll ();
+   *   std::ostringstream prefix;
+   *   prefix << "sweep-" << replication;
+   *   ...
+   *   Simulator::Run ();
+   *   Simulator::Destroy ();
+   *   return 0;
+   * \endcode
+   *
+   * In the calling process, ForkAt returns 0 once all the children
+   * have exited.  If any child exits with a non-zero status or is
+   * killed by a signal, ForkAt stops the program with NS_FATAL_ERROR.
+   *
+   * ForkAt flushes the standard streams and the DES Metrics trace
+   * before forking, but not the other buffered file sinks, such as
+   * the OutputStreamWrapper or PcapFileWrapper trace files: whatever
+   * they buffer would be written by each child as well as by the
+   * calling process.  Flush or close them before the checkpoint, and
+   * open the trace files of each replication after the fork.
+   * The binary log of LogSetBinaryOutput() and the DES Metrics trace
+   * are the exceptions: each child writes them to files of its own,
+   * named after the files of the calling process followed by a dot
+   * and the index of the child.
+   *
+   * Children inherit only the calling thread, so ForkAt must not be
+   * used with simulator implementations which run their own threads,
+   * nor when the warm-up has started other threads.  It is only
+   * available on systems which provide fork().
+   *
+   * \param [in] time The absolute simulation time of the checkpoint;
+   *             it must not be in the past.
+   * \param [in] n The number of children to fork.
+   * \param [in] maxRunning The maximum number of children to run at
+   *             the same time, or 0 to run all of them at once.
+   * \returns 0 in the calling process, the index of the child in
+   *             each child.
+   */
+  static uint32_t ForkAt (const Time &time, uint32_t n, uint32_t maxRunning = 0);
+
   /**
    * Get the current simulation context.
    *
@@ -1290,6 +1354,42 @@ public:
    */
   static void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
 
+  /**
+   * An event of a batch scheduled by ScheduleBatch().
+   */
+  struct BatchEvent
+  {
+    /** Constructor. */
+    BatchEvent ();
+    /**
+     * Constructor.
+     *
+     * @param [in] context The event context.
+     * @param [in] delay The delay until the event expires.
+     * @param [in] event The event, for example created by MakeEvent().
+     */
+    BatchEvent (uint32_t context, const Time &delay, EventImpl *event);
+
+    uint32_t context;   //!< The event context.
+    Time delay;         //!< The delay until the event expires.
+    EventImpl *event;   //!< The event.
+  };
+
+  /**
+   * Schedule several future events, each in its context.
+   *
+   * This is equivalent to calling ScheduleWithContext() for each
+   * event of the batch, in order, but the simulator implementation
+   * can insert all the events in a single operation of its scheduler.
+   * Broadcast channels use it to schedule the receptions of a
+   * transmission.  This method is thread-safe: it can be called
+   * from any thread.
+   *
+   * @param [in] batch The events.  The simulator takes over the
+   *             references to the events held by the batch.
+   */
+  static void ScheduleBatch (const std::vector<BatchEvent> &batch);
+
   /**
    * Schedule an event to run at the end of the simulation, after
    * the Stop() time or condition has been reached.
@@ -0,0 +1,237 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SIZE_CLASS_ALLOCATOR_H
+#define SIZE_CLASS_ALLOCATOR_H
+
+#include <cstddef>
+#include <new>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup core
+ * ns3::SizeClassAllocator declaration and template implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup core
+ * The allocations of a SizeClassAllocator in one thread.
+ */
+struct SizeClassAllocatorStatistics
+{
+  uint64_t allocations;   //!< The blocks allocated.
+  uint64_t reuses;        //!< The allocations served from the free lists.
+  uint64_t releases;      //!< The blocks freed to the free lists.
+  uint64_t freeBlocks;    //!< The blocks currently on the free lists.
+};
+
+/**
+ * \ingroup core
+ * \brief Per-thread free lists of memory blocks, one per size class.
+ *
+ * Blocks are rounded up to a multiple of SIZE_STEP bytes, and a freed
+ * block is kept on the free list of its size class in the calling
+ * thread, for the next allocation of the same size class in that
+ * thread.  Blocks larger than MAX_SIZE bytes are not recycled.
+ *
+ * A block freed by another thread than the one which allocated it
+ * goes to the lists of the freeing thread, so each list holds at most
+ * MAX_FREE_BLOCKS blocks: those freed beyond go back to the global
+ * heap.  The lists of a thread are released when it exits; Purge()
+ * releases those of the calling thread earlier.
+ *
+ * \tparam TAG \explicit The type whose memory is allocated, to keep
+ *             separate lists for each user.
+ * \tparam SIZE_CLASSES \explicit The number of size classes.
+ */
+template <typename TAG, std::size_t SIZE_CLASSES>
+class SizeClassAllocator
+{
+public:
+  /** Granularity of the size classes, in bytes. */
+  static const std::size_t SIZE_STEP = 16;
+  /** The size of the largest blocks recycled. */
+  static const std::size_t MAX_SIZE = SIZE_STEP * SIZE_CLASSES;
+  /** The largest number of blocks on each free list of a thread. */
+  static const uint64_t MAX_FREE_BLOCKS = 4096;
+
+  /**
+   * Allocate a block from the free list of its size class.
+   *
+   * \param [in] size The size of the block.
+   * \returns The memory block.
+   */
+  static void * Allocate (std::size_t size);
+  /**
+   * Release a block to the free list of its size class.
+   *
+   * \param [in] p The memory block.
+   * \param [in] size The size of the block.
+   */
+  static void Deallocate (void *p, std::size_t size);
+  /**
+   * Get the allocations in the calling thread.
+   *
+   * \returns The statistics.
+   */
+  static SizeClassAllocatorStatistics GetStatistics (void);
+  /**
+   * Release the free blocks of the calling thread to the global heap.
+   */
+  static void Purge (void);
+
+private:
+  /** A free memory block, linked to the next one of its size class. */
+  struct FreeBlock
+  {
+    FreeBlock *next;  //!< The next free block.
+  };
+  /**
+   * The free lists and statistics of a thread.
+   *
+   * This is trivially destructible, so that it is still usable by
+   * the blocks freed after the Cleaner has run.
+   */
+  struct ThreadState
+  {
+    FreeBlock *freeLists[SIZE_CLASSES];     //!< The free lists.
+    uint64_t lengths[SIZE_CLASSES];         //!< The lengths of the free lists.
+    SizeClassAllocatorStatistics statistics; //!< The statistics.
+    bool released;                          //!< Whether the thread exits.
+  };
+  /** Release the free lists of a thread when it exits. */
+  struct Cleaner
+  {
+    ~Cleaner ()
+    {
+      Purge ();
+      s_state.released = true;
+    }
+  };
+
+  /**
+   * Get the size class of a block.
+   *
+   * \param [in] size The size of the block.
+   * \returns The size class, or SIZE_CLASSES if it is too large.
+   */
+  static std::size_t GetSizeClass (std::size_t size)
+  {
+    std::size_t sizeClass = (size + SIZE_STEP - 1) / SIZE_STEP - 1;
+    return sizeClass < SIZE_CLASSES ? sizeClass : SIZE_CLASSES;
+  }
+
+  static thread_local ThreadState s_state;  //!< The state of the calling thread.
+  static thread_local Cleaner s_cleaner;    //!< The cleaner of the calling thread.
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename TAG, std::size_t SIZE_CLASSES>
+thread_local typename SizeClassAllocator<TAG, SIZE_CLASSES>::ThreadState
+SizeClassAllocator<TAG, SIZE_CLASSES>::s_state;
+
+template <typename TAG, std::size_t SIZE_CLASSES>
+thread_local typename SizeClassAllocator<TAG, SIZE_CLASSES>::Cleaner
+SizeClassAllocator<TAG, SIZE_CLASSES>::s_cleaner;
+
+template <typename TAG, std::size_t SIZE_CLASSES>
+void *
+SizeClassAllocator<TAG, SIZE_CLASSES>::Allocate (std::size_t size)
+{
+  ThreadState &state = s_state;
+  state.statistics.allocations++;
+  std::size_t sizeClass = GetSizeClass (size);
+  if (sizeClass == SIZE_CLASSES)
+    {
+      return ::operator new (size);
+    }
+  FreeBlock *block = state.freeLists[sizeClass];
+  if (block != 0)
+    {
+      state.freeLists[sizeClass] = block->next;
+      state.lengths[sizeClass]--;
+      state.statistics.reuses++;
+      state.statistics.freeBlocks--;
+      return block;
+    }
+  // make sure the free lists of this thread are released on exit
+  (void)&s_cleaner;
+  return ::operator new ((sizeClass + 1) * SIZE_STEP);
+}
+
+template <typename TAG, std::size_t SIZE_CLASSES>
+void
+SizeClassAllocator<TAG, SIZE_CLASSES>::Deallocate (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  ThreadState &state = s_state;
+  std::size_t sizeClass = GetSizeClass (size);
+  if (sizeClass == SIZE_CLASSES || state.released
+      || state.lengths[sizeClass] >= MAX_FREE_BLOCKS)
+    {
+      ::operator delete (p);
+      return;
+    }
+  FreeBlock *block = static_cast<FreeBlock *> (p);
+  block->next = state.freeLists[sizeClass];
+  state.freeLists[sizeClass] = block;
+  state.lengths[sizeClass]++;
+  state.statistics.releases++;
+  state.statistics.freeBlocks++;
+}
+
+template <typename TAG, std::size_t SIZE_CLASSES>
+SizeClassAllocatorStatistics
+SizeClassAllocator<TAG, SIZE_CLASSES>::GetStatistics (void)
+{
+  return s_state.statistics;
+}
+
+template <typename TAG, std::size_t SIZE_CLASSES>
+void
+SizeClassAllocator<TAG, SIZE_CLASSES>::Purge (void)
+{
+  ThreadState &state = s_state;
+  for (std::size_t i = 0; i < SIZE_CLASSES; i++)
+    {
+      while (state.freeLists[i] != 0)
+        {
+          FreeBlock *block = state.freeLists[i];
+          state.freeLists[i] = block->next;
+          ::operator delete (block);
+        }
+      state.lengths[i] = 0;
+    }
+  state.statistics.freeBlocks = 0;
+}
+
+} // namespace ns3
+
+#endif /* SIZE_CLASS_ALLOCATOR_H */
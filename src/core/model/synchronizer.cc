@@ -125,6 +125,19 @@ Synchronizer::EventStart (void)
   DoEventStart ();
 }
 
+void
+Synchronizer::SetEventTime (uint64_t ts)
+{
+  NS_LOG_FUNCTION (this << ts);
+  DoSetEventTime (TimeStepToNanosecond (ts));
+}
+
+void
+Synchronizer::DoSetEventTime (uint64_t ns)
+{
+  NS_LOG_FUNCTION (this << ns);
+}
+
 uint64_t
 Synchronizer::EventEnd (void)
 {
@@ -179,6 +179,16 @@ public:
    */
   void EventStart (void);
 
+  /**
+   * @brief Tell the synchronizer the simulation time of the event about
+   * to start, so that it can measure how late the event is.
+   *
+   * Called by the simulator just before EventStart.
+   *
+   * @param [in] ts The timestamp of the event (in Time resolution units).
+   */
+  void SetEventTime (uint64_t ts);
+
   /**
    * @brief Ask the synchronizer to return the time step between the instant
    * remembered during EventStart and now.
@@ -309,6 +319,14 @@ protected:
    * @returns The elapsed real time, in ns.
    */
   virtual uint64_t DoEventEnd (void) = 0;
+  /**
+   * @brief Record the simulation time of the event about to start.
+   *
+   * The default implementation does nothing.
+   *
+   * @param [in] ns The timestamp of the event, in ns.
+   */
+  virtual void DoSetEventTime (uint64_t ns);
 
   /** The real time, in ns, when SetOrigin was called. */
   uint64_t m_realtimeOriginNano;
@@ -246,6 +246,11 @@ Time::SetResolution (enum Unit unit, struct Resolution *resolution,
           info->toMul = true;
           info->fromMul = false;
         }
+      info->maxTo = std::numeric_limits<int64_t>::max ();
+      if (info->toMul)
+        {
+          info->maxTo /= factor;
+        }
     }
   resolution->unit = unit;
 }
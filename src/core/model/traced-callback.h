@@ -22,7 +22,11 @@
 #define TRACED_CALLBACK_H
 
 #include <list>
+#include <vector>
+#include <stdint.h>
 #include "callback.h"
+#include "ptr.h"
+#include "simple-ref-count.h"
 
 /**
  * \file
@@ -32,6 +36,21 @@
 
 namespace ns3 {
 
+/**
+ * \ingroup tracing
+ * The number of TracedCallbacks firing in the calling thread.
+ *
+ * \tparam DUMMY \explicit Unused, to define the counter in this header.
+ */
+template <typename DUMMY = void>
+struct TracedCallbackDepth
+{
+  static thread_local uint32_t value;  //!< The number of firings in progress.
+};
+
+template <typename DUMMY>
+thread_local uint32_t TracedCallbackDepth<DUMMY>::value = 0;
+
 /**
  * \ingroup tracing
  * \brief Forward calls to a chain of Callback
@@ -46,6 +65,13 @@ namespace ns3 {
  * calling one of the \c operator() forms with the appropriate
  * number of arguments.
  *
+ * A TracedCallback without any Callback holds a single null pointer,
+ * and invoking it only tests that pointer; the chain of Callbacks is
+ * a contiguous array, replaced rather than modified by Connect and
+ * Disconnect.  A Callback which connects or disconnects Callbacks
+ * while the chain is invoked therefore only affects the next
+ * invocations.
+ *
  * \tparam T1 \explicit Type of the first argument to the functor.
  * \tparam T2 \explicit Type of the second argument to the functor.
  * \tparam T3 \explicit Type of the third argument to the functor.
@@ -93,6 +119,13 @@ public:
    * \param [in] path Context path which was used to connect the Callback.
    */
   void Disconnect (const CallbackBase & callback, std::string path);
+  /**
+   * Check if any Callback is connected, to skip computing the
+   * arguments of the Callbacks when there is none.
+   *
+   * \returns \c true if the chain of Callbacks is empty.
+   */
+  bool IsEmpty (void) const;
   /**
    * \name Functors taking various numbers of arguments.
    *
@@ -234,9 +267,37 @@ private:
    * \tparam T7 \deduced Type of the seventh argument to the functor.
    * \tparam T8 \deduced Type of the eighth argument to the functor.
    */
-  typedef std::list<Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> > CallbackList;
-  /** The chain of Callbacks. */
-  CallbackList m_callbackList;
+  typedef std::vector<Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> > CallbackList;
+  /** An immutable chain of Callbacks, shared by reference counting. */
+  struct Chain : public SimpleRefCount<Chain>
+  {
+    CallbackList callbacks;             //!< The Callbacks.
+    /**
+     * The chain this one replaced while Callbacks were firing, which
+     * may still be iterated.
+     */
+    Ptr<const Chain> replaced;
+  };
+  /**
+   * Append a Callback to the chain.
+   *
+   * \param [in] callback The Callback to append.
+   */
+  void Append (const Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> &callback);
+  /**
+   * Replace the chain.
+   *
+   * The firing operators iterate the chain without a reference to it,
+   * so a chain replaced while a TracedCallback fires in this thread,
+   * for example by a Callback which disconnects itself, is kept by the
+   * new chain until the next change made when none fires.
+   *
+   * \param [in] chain The new chain.
+   */
+  void SetChain (Ptr<Chain> chain);
+
+  /** The chain of Callbacks, null when empty. */
+  Ptr<const Chain> m_chain;
 };
 
 } // namespace ns3
@@ -248,12 +309,12 @@ private:
 
 namespace ns3 {
 
-template<typename T1, typename T2, 
+template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::TracedCallback ()
-  : m_callbackList () 
+  : m_chain (0)
 {
 }
 template<typename T1, typename T2,
@@ -261,12 +322,49 @@ template<typename T1, typename T2,
          typename T5, typename T6,
          typename T7, typename T8>
 void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Append (const Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> &callback)
+{
+  Ptr<Chain> chain = Create<Chain> ();
+  if (m_chain != 0)
+    {
+      chain->callbacks.reserve (m_chain->callbacks.size () + 1);
+      chain->callbacks.assign (m_chain->callbacks.begin (), m_chain->callbacks.end ());
+    }
+  chain->callbacks.push_back (callback);
+  SetChain (chain);
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::SetChain (Ptr<Chain> chain)
+{
+  if (TracedCallbackDepth<>::value > 0)
+    {
+      chain->replaced = m_chain;
+      m_chain = chain;
+    }
+  else if (chain->callbacks.empty ())
+    {
+      m_chain = 0;
+    }
+  else
+    {
+      m_chain = chain;
+    }
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::ConnectWithoutContext (const CallbackBase & callback)
 {
   Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> cb;
   if (!cb.Assign (callback))
     NS_FATAL_ERROR_NO_MSG();
-  m_callbackList.push_back (cb);
+  Append (cb);
 }
 template<typename T1, typename T2,
          typename T3, typename T4,
@@ -279,29 +377,34 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Connect (const CallbackBase & callback,
   if (!cb.Assign (callback))
     NS_FATAL_ERROR ("when connecting to " << path);
   Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> realCb = cb.Bind (path);
-  m_callbackList.push_back (realCb);
+  Append (realCb);
 }
-template<typename T1, typename T2, 
+template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::DisconnectWithoutContext (const CallbackBase & callback)
 {
-  for (typename CallbackList::iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); /* empty */)
+  if (m_chain == 0)
     {
-      if ((*i).IsEqual (callback))
-        {
-          i = m_callbackList.erase (i);
-        }
-      else
+      return;
+    }
+  Ptr<Chain> chain = Create<Chain> ();
+  for (typename CallbackList::const_iterator i = m_chain->callbacks.begin ();
+       i != m_chain->callbacks.end (); i++)
+    {
+      if (!(*i).IsEqual (callback))
         {
-          i++;
+          chain->callbacks.push_back (*i);
         }
     }
+  if (chain->callbacks.size () != m_chain->callbacks.size ())
+    {
+      SetChain (chain);
+    }
 }
-template<typename T1, typename T2, 
+template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
@@ -314,122 +417,203 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Disconnect (const CallbackBase & callba
   Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> realCb = cb.Bind (path);
   DisconnectWithoutContext (realCb);
 }
-template<typename T1, typename T2, 
+template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+bool
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::IsEmpty (void) const
+{
+  return m_chain == 0 || m_chain->callbacks.empty ();
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+inline void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (void) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_chain == 0)
+    {
+      return;
+    }
+  // a Callback may change the chain: the Chain outlives this firing
+  const Chain *chain = PeekPointer (m_chain);
+  TracedCallbackDepth<>::value++;
+  for (typename CallbackList::const_iterator i = chain->callbacks.begin ();
+       i != chain->callbacks.end (); i++)
     {
       (*i)();
     }
+  TracedCallbackDepth<>::value--;
 }
-template<typename T1, typename T2, 
+template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_chain == 0)
+    {
+      return;
+    }
+  // a Callback may change the chain: the Chain outlives this firing
+  const Chain *chain = PeekPointer (m_chain);
+  TracedCallbackDepth<>::value++;
+  for (typename CallbackList::const_iterator i = chain->callbacks.begin ();
+       i != chain->callbacks.end (); i++)
     {
       (*i)(a1);
     }
+  TracedCallbackDepth<>::value--;
 }
-template<typename T1, typename T2, 
+template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_chain == 0)
+    {
+      return;
+    }
+  // a Callback may change the chain: the Chain outlives this firing
+  const Chain *chain = PeekPointer (m_chain);
+  TracedCallbackDepth<>::value++;
+  for (typename CallbackList::const_iterator i = chain->callbacks.begin ();
+       i != chain->callbacks.end (); i++)
     {
       (*i)(a1, a2);
     }
+  TracedCallbackDepth<>::value--;
 }
-template<typename T1, typename T2, 
+template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_chain == 0)
+    {
+      return;
+    }
+  // a Callback may change the chain: the Chain outlives this firing
+  const Chain *chain = PeekPointer (m_chain);
+  TracedCallbackDepth<>::value++;
+  for (typename CallbackList::const_iterator i = chain->callbacks.begin ();
+       i != chain->callbacks.end (); i++)
     {
       (*i)(a1, a2, a3);
     }
+  TracedCallbackDepth<>::value--;
 }
-template<typename T1, typename T2, 
+template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_chain == 0)
+    {
+      return;
+    }
+  // a Callback may change the chain: the Chain outlives this firing
+  const Chain *chain = PeekPointer (m_chain);
+  TracedCallbackDepth<>::value++;
+  for (typename CallbackList::const_iterator i = chain->callbacks.begin ();
+       i != chain->callbacks.end (); i++)
     {
       (*i)(a1, a2, a3, a4);
     }
+  TracedCallbackDepth<>::value--;
 }
-template<typename T1, typename T2, 
+template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_chain == 0)
+    {
+      return;
+    }
+  // a Callback may change the chain: the Chain outlives this firing
+  const Chain *chain = PeekPointer (m_chain);
+  TracedCallbackDepth<>::value++;
+  for (typename CallbackList::const_iterator i = chain->callbacks.begin ();
+       i != chain->callbacks.end (); i++)
     {
       (*i)(a1, a2, a3, a4, a5);
     }
+  TracedCallbackDepth<>::value--;
 }
-template<typename T1, typename T2, 
+template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_chain == 0)
+    {
+      return;
+    }
+  // a Callback may change the chain: the Chain outlives this firing
+  const Chain *chain = PeekPointer (m_chain);
+  TracedCallbackDepth<>::value++;
+  for (typename CallbackList::const_iterator i = chain->callbacks.begin ();
+       i != chain->callbacks.end (); i++)
     {
       (*i)(a1, a2, a3, a4, a5, a6);
     }
+  TracedCallbackDepth<>::value--;
 }
-template<typename T1, typename T2, 
+template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_chain == 0)
+    {
+      return;
+    }
+  // a Callback may change the chain: the Chain outlives this firing
+  const Chain *chain = PeekPointer (m_chain);
+  TracedCallbackDepth<>::value++;
+  for (typename CallbackList::const_iterator i = chain->callbacks.begin ();
+       i != chain->callbacks.end (); i++)
     {
       (*i)(a1, a2, a3, a4, a5, a6, a7);
     }
+  TracedCallbackDepth<>::value--;
 }
-template<typename T1, typename T2, 
+template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (m_chain == 0)
+    {
+      return;
+    }
+  // a Callback may change the chain: the Chain outlives this firing
+  const Chain *chain = PeekPointer (m_chain);
+  TracedCallbackDepth<>::value++;
+  for (typename CallbackList::const_iterator i = chain->callbacks.begin ();
+       i != chain->callbacks.end (); i++)
     {
       (*i)(a1, a2, a3, a4, a5, a6, a7, a8);
     }
+  TracedCallbackDepth<>::value--;
 }
 
 } // namespace ns3
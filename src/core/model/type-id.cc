@@ -78,6 +78,8 @@ NS_LOG_COMPONENT_DEFINE ("TypeId");
 class IidManager : public Singleton<IidManager>
 {
 public:
+  /** Constructor. */
+  IidManager ();
   /**
    * Create a new unique type id.
    * \param [in] name The name of this type id.
@@ -143,6 +145,19 @@ public:
    * \returns The parent type id of the type id.
    */
   uint16_t GetParent (uint16_t uid) const;
+  /**
+   * Get the generation of the attributes of all the type ids.
+   * \returns The generation.
+   */
+  uint32_t GetAttributeGeneration (void) const;
+  /**
+   * Check if a type id is a strict descendant of another, in
+   * constant time.
+   * \param [in] uid The id.
+   * \param [in] other The id of the potential ancestor.
+   * \returns \c true if \p other is an ancestor of \p uid.
+   */
+  bool IsChildOf (uint16_t uid, uint16_t other) const;
   /**
    * Get the group name of a type id.
    * \param [in] uid The id.
@@ -301,6 +316,12 @@ private:
     TypeId::hash_t hash;
     /** The parent type id. */
     uint16_t parent;
+    /**
+     * The ancestors of the type id, from the root of its hierarchy to
+     * the type id itself, so that the ancestor at depth \c d, if any,
+     * is <tt>ancestors[d]</tt>.
+     */
+    std::vector<uint16_t> ancestors;
     /** The group name. */
     std::string groupName;
     /** The size of the object represented by this type id. */
@@ -343,6 +364,11 @@ private:
   /** The by-hash index. */
   hashmap_t m_hashmap;
 
+  /**
+   * Incremented when a type id gains an attribute, or a new parent,
+   * or when the initial value of an attribute changes.
+   */
+  uint32_t m_attributeGeneration;
 
   /** IidManager constants. */
   enum {
@@ -378,6 +404,11 @@ IidManager::Hasher (const std::string name)
  */
 #define IIDL IID << ": "
 
+IidManager::IidManager ()
+  : m_attributeGeneration (0)
+{
+}
+
 uint16_t
 IidManager::AllocateUid (std::string name)
 {
@@ -442,6 +473,7 @@ IidManager::AllocateUid (std::string name)
   m_information.push_back (information);
   uint32_t uid = m_information.size ();
   NS_ASSERT (uid <= 0xffff);
+  m_information.back ().ancestors.push_back (uid);
 
   // Add to both maps:
   m_namemap.insert (std::make_pair (name, uid));
@@ -466,6 +498,15 @@ IidManager::SetParent (uint16_t uid, uint16_t parent)
   NS_ASSERT (parent <= m_information.size ());
   struct IidInformation *information = LookupInformation (uid);
   information->parent = parent;
+  // The parent is complete by now, since SetParent<T> calls
+  // T::GetTypeId: extend its ancestors.
+  information->ancestors.clear ();
+  if (parent != 0 && parent != uid)
+    {
+      information->ancestors = LookupInformation (parent)->ancestors;
+    }
+  information->ancestors.push_back (uid);
+  m_attributeGeneration++;
 }
 void 
 IidManager::SetGroupName (uint16_t uid, std::string groupName)
@@ -554,6 +595,23 @@ IidManager::GetParent (uint16_t uid) const
   NS_LOG_LOGIC (IIDL << pid);
   return pid;
 }
+uint32_t
+IidManager::GetAttributeGeneration (void) const
+{
+  return m_attributeGeneration;
+}
+bool
+IidManager::IsChildOf (uint16_t uid, uint16_t other) const
+{
+  NS_LOG_FUNCTION (IID << uid << other);
+  if (other == 0)
+    {
+      return false;
+    }
+  const std::vector<uint16_t> &ancestors = LookupInformation (uid)->ancestors;
+  std::size_t depth = LookupInformation (other)->ancestors.size () - 1;
+  return depth + 1 < ancestors.size () && ancestors[depth] == other;
+}
 std::string 
 IidManager::GetGroupName (uint16_t uid) const
 {
@@ -675,6 +733,7 @@ IidManager::AddAttribute (uint16_t uid,
   info.supportLevel = supportLevel;
   info.supportMsg = supportMsg;
   information->attributes.push_back (info);
+  m_attributeGeneration++;
   NS_LOG_LOGIC (IIDL << information->attributes.size () - 1);
 }
 void 
@@ -686,6 +745,7 @@ IidManager::SetAttributeInitialValue(uint16_t uid,
   struct IidInformation *information = LookupInformation (uid);
   NS_ASSERT (i < information->attributes.size ());
   information->attributes[i].initialValue = initialValue;
+  m_attributeGeneration++;
 }
 
 
@@ -865,6 +925,11 @@ TypeId::GetRegisteredN (void)
   NS_LOG_FUNCTION_NOARGS ();
   return IidManager::Get ()->GetRegisteredN ();
 }
+uint32_t
+TypeId::GetAttributeGeneration (void)
+{
+  return IidManager::Get ()->GetAttributeGeneration ();
+}
 TypeId 
 TypeId::GetRegistered (uint32_t i)
 {
@@ -949,12 +1014,7 @@ bool
 TypeId::IsChildOf (TypeId other) const
 {
   NS_LOG_FUNCTION (this << other.GetUid ());
-  TypeId tmp = *this;
-  while (tmp != other && tmp != tmp.GetParent ())
-    {
-      tmp = tmp.GetParent ();
-    }
-  return tmp == other && *this != other;
+  return IidManager::Get ()->IsChildOf (m_tid, other.m_tid);
 }
 std::string 
 TypeId::GetGroupName (void) const
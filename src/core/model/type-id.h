@@ -164,6 +164,14 @@ public:
    * \returns The TypeId instance whose index is \c i.
    */
   static TypeId GetRegistered (uint32_t i);
+  /**
+   * Get a counter which changes whenever a TypeId gains an attribute
+   * or a parent, or the initial value of an attribute changes, so
+   * that caches built from the attributes know when to refresh.
+   *
+   * \returns The generation of the attributes.
+   */
+  static uint32_t GetAttributeGeneration (void);
 
   /**
    * Constructor.
@@ -203,7 +211,8 @@ public:
    *
    * Calling this method is roughly similar to calling dynamic_cast
    * except that you do not need object instances: you can do the check
-   * with TypeId instances instead.
+   * with TypeId instances instead.  The check takes constant time,
+   * whatever the depth of the hierarchy.
    */
   bool IsChildOf (TypeId other) const;
 
@@ -35,6 +35,8 @@
 #include "ns3/object-factory.h"
 #include "ns3/nstime.h"
 
+#include <set>
+
 using namespace ns3;
 
 /**
@@ -1314,6 +1316,67 @@ PointerAttributeTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_NE (storedPtr4, storedPtr5, "aotPtr and aotPtr2 are unique, but their Derived member is not");
 }
 
+// ===========================================================================
+// Objects created in bulk by an ObjectFactory get their own attribute
+// values, and follow the changes of the default values.
+// ===========================================================================
+class ObjectFactoryBulkTestCase : public TestCase
+{
+public:
+  ObjectFactoryBulkTestCase (std::string description);
+  virtual ~ObjectFactoryBulkTestCase () {}
+
+private:
+  virtual void DoRun (void);
+};
+
+ObjectFactoryBulkTestCase::ObjectFactoryBulkTestCase (std::string description)
+  : TestCase (description)
+{
+}
+
+void
+ObjectFactoryBulkTestCase::DoRun (void)
+{
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::AttributeObjectTest");
+  factory.Set ("TestInt16WithBounds", IntegerValue (3));
+  std::vector<Ptr<AttributeObjectTest> > objects = factory.Create<AttributeObjectTest> (3);
+  NS_TEST_ASSERT_MSG_EQ (objects.size (), 3, "Unable to factory.Create(3) AttributeObjectTest");
+
+  IntegerValue iv;
+  PointerValue ptr;
+  std::set<Ptr<Object> > randoms;
+  for (uint32_t i = 0; i < objects.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_NE (objects[i], 0, "Unable to factory.Create(3) AttributeObjectTest");
+      objects[i]->GetAttribute ("TestInt16WithBounds", iv);
+      NS_TEST_ASSERT_MSG_EQ (iv.Get (), 3, "Attribute not set by the factory");
+      objects[i]->GetAttribute ("TestInt16", iv);
+      NS_TEST_ASSERT_MSG_EQ (iv.Get (), -2, "Attribute not set to its initial value");
+      // the random variable is created from a string for each object
+      objects[i]->GetAttribute ("TestRandom", ptr);
+      randoms.insert (ptr.Get<Object> ());
+    }
+  NS_TEST_ASSERT_MSG_EQ (randoms.size (), 3, "Objects share the object of a PointerValue attribute");
+
+  //
+  // Change the default value after the first objects, and make sure
+  // the new objects see it.
+  //
+  Config::SetDefault ("ns3::AttributeObjectTest::TestInt16", IntegerValue (7));
+  objects = factory.Create<AttributeObjectTest> (2);
+  for (uint32_t i = 0; i < objects.size (); i++)
+    {
+      objects[i]->GetAttribute ("TestInt16", iv);
+      NS_TEST_ASSERT_MSG_EQ (iv.Get (), 7, "New default value not used");
+    }
+  Config::SetDefault ("ns3::AttributeObjectTest::TestInt16", IntegerValue (-2));
+  Ptr<AttributeObjectTest> p = factory.Create<AttributeObjectTest> ();
+  p->GetAttribute ("TestInt16", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), -2, "Default value not restored");
+}
+
 // ===========================================================================
 // Test the Attributes of type CallbackValue.
 // ===========================================================================
@@ -1417,6 +1480,7 @@ AttributesTestSuite::AttributesTestSuite ()
   AddTestCase (new ObjectVectorAttributeTestCase ("Check Attributes of type ObjectVectorValue"), TestCase::QUICK);
   AddTestCase (new ObjectMapAttributeTestCase ("Check Attributes of type ObjectMapValue"), TestCase::QUICK);
   AddTestCase (new PointerAttributeTestCase ("Check Attributes of type PointerValue"), TestCase::QUICK);
+  AddTestCase (new ObjectFactoryBulkTestCase ("Check bulk creation of objects with attributes"), TestCase::QUICK);
   AddTestCase (new CallbackValueTestCase ("Check Attributes of type CallbackValue"), TestCase::QUICK);
   AddTestCase (new IntegerTraceSourceAttributeTestCase ("Ensure TracedValue<uint8_t> can be set like IntegerValue"), TestCase::QUICK);
   AddTestCase (new IntegerTraceSourceTestCase ("Ensure TracedValue<uint8_t> also works as trace source"), TestCase::QUICK);
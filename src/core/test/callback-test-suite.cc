@@ -557,6 +557,123 @@ NullifyCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (target1.IsNull (), true, "Nullified Callback reports not IsNull()");
 }
 
+// ===========================================================================
+// Test the inline storage of small callbacks
+// ===========================================================================
+class InlineCallbackTestCase : public TestCase
+{
+public:
+  InlineCallbackTestCase ();
+  virtual ~InlineCallbackTestCase () {}
+
+  int Target1 (int a) { m_test1 = a; return a; }
+
+private:
+  virtual void DoRun (void);
+
+  int m_test1;
+};
+
+/// Reference counted object, to check the bound arguments are released
+class InlineCallbackCounted : public SimpleRefCount<InlineCallbackCounted>
+{
+};
+
+int gInlineCallbackTest;
+void InlineCallbackTarget (Ptr<InlineCallbackCounted> p, int a)
+{
+  gInlineCallbackTest = a;
+}
+
+/**
+ * \param [in] cb The callback
+ * \returns \c true if the implementation of cb is stored inline
+ */
+bool
+IsStoredInline (const CallbackBase &cb)
+{
+  const char *impl = reinterpret_cast<const char *> (cb.PeekImpl ());
+  const char *base = reinterpret_cast<const char *> (&cb);
+  return impl >= base && impl < base + sizeof (cb);
+}
+
+/// A small Callback implementation which does not declare Copy()
+class InlineCallbackCustomImpl : public CallbackImpl<int,int,empty,empty,empty,empty,empty,empty,empty,empty>
+{
+public:
+  virtual int operator() (int a)
+  {
+    return a + 1;
+  }
+  virtual bool IsEqual (Ptr<const CallbackImplBase> other) const
+  {
+    return dynamic_cast<const InlineCallbackCustomImpl *> (PeekPointer (other)) != 0;
+  }
+};
+
+InlineCallbackTestCase::InlineCallbackTestCase ()
+  : TestCase ("Check the inline storage of small callbacks")
+{
+}
+
+void
+InlineCallbackTestCase::DoRun (void)
+{
+  Callback<int, int> target1 = MakeCallback (&InlineCallbackTestCase::Target1, this);
+  NS_TEST_ASSERT_MSG_EQ (IsStoredInline (target1), true, "Member function callback not stored inline");
+  Callback<int, int> copy1 = target1;
+  NS_TEST_EXPECT_MSG_EQ (IsStoredInline (copy1), true, "Copy of an inline callback not stored inline");
+  NS_TEST_EXPECT_MSG_EQ (copy1.IsEqual (target1), true, "Copy of an inline callback not equal");
+  NS_TEST_EXPECT_MSG_EQ (copy1 (7), 7, "Copy of an inline callback did not fire");
+  NS_TEST_EXPECT_MSG_EQ (m_test1, 7, "Copy of an inline callback did not fire");
+  copy1 = copy1;
+  NS_TEST_EXPECT_MSG_EQ (copy1 (8), 8, "Self-assigned callback did not fire");
+
+  // the bound arguments live as long as the callback and its copies
+  Ptr<InlineCallbackCounted> counted = Create<InlineCallbackCounted> ();
+  {
+    Callback<void, int> target2 = MakeBoundCallback (&InlineCallbackTarget, counted);
+    NS_TEST_EXPECT_MSG_EQ (IsStoredInline (target2), true, "Bound callback not stored inline");
+    Callback<void, int> copy2 (target2);
+    NS_TEST_EXPECT_MSG_EQ (counted->GetReferenceCount (), 3, "Bound argument not copied");
+    copy2 (9);
+    NS_TEST_EXPECT_MSG_EQ (gInlineCallbackTest, 9, "Copy of a bound callback did not fire");
+    copy2.Nullify ();
+    NS_TEST_EXPECT_MSG_EQ (counted->GetReferenceCount (), 2, "Bound argument not released by Nullify");
+  }
+  NS_TEST_EXPECT_MSG_EQ (counted->GetReferenceCount (), 1, "Bound argument not released");
+
+  // larger implementations are shared
+  Callback<int> target3 = target1.Bind (10);
+  NS_TEST_EXPECT_MSG_EQ (IsStoredInline (target3), false, "Bound Callback stored inline");
+  Callback<int> copy3 = target3;
+  NS_TEST_EXPECT_MSG_EQ (copy3.PeekImpl (), target3.PeekImpl (), "Heap implementation not shared");
+  NS_TEST_EXPECT_MSG_EQ (copy3 (), 10, "Copy of a heap callback did not fire");
+
+  // the implementation returned by GetImpl outlives the callback
+  Ptr<CallbackImplBase> impl;
+  {
+    Callback<int, int> target4 = MakeCallback (&InlineCallbackTestCase::Target1, this);
+    impl = target4.GetImpl ();
+  }
+  NS_TEST_EXPECT_MSG_EQ (impl->IsEqual (target1.PeekImpl ()), true, "Implementation copy not equal");
+
+  // an implementation which cannot copy itself is shared
+  InlineCallbackCustomImpl custom;
+  Callback<int, int> target6 (custom, CallbackBase::ImplTag ());
+  NS_TEST_EXPECT_MSG_EQ (IsStoredInline (target6), false, "Implementation without Copy stored inline");
+  Callback<int, int> copy6 = target6;
+  NS_TEST_ASSERT_MSG_EQ (copy6.IsNull (), false, "Copy of a custom callback is null");
+  NS_TEST_EXPECT_MSG_EQ (copy6 (12), 13, "Copy of a custom callback did not fire");
+
+  // attribute values hold a copy too
+  CallbackValue value (target1);
+  Callback<int, int> target5;
+  NS_TEST_EXPECT_MSG_EQ (value.GetAccessor (target5), true, "Callback value not assigned");
+  NS_TEST_EXPECT_MSG_EQ (target5.IsEqual (target1), true, "Assigned callback not equal");
+  NS_TEST_EXPECT_MSG_EQ (target5 (11), 11, "Assigned callback did not fire");
+}
+
 // ===========================================================================
 // Make sure that various MakeCallback template functions compile and execute.
 // Doesn't check an results of the execution.
@@ -704,6 +821,7 @@ CallbackTestSuite::CallbackTestSuite ()
   AddTestCase (new MakeCallbackTestCase, TestCase::QUICK);
   AddTestCase (new MakeBoundCallbackTestCase, TestCase::QUICK);
   AddTestCase (new NullifyCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new InlineCallbackTestCase, TestCase::QUICK);
   AddTestCase (new MakeCallbackTemplatesTestCase, TestCase::QUICK);
 }
 
@@ -821,6 +821,121 @@ SearchAttributesOfParentObjectsTestCase::DoRun (void)
 
 }
 
+/**
+ * \ingroup config-tests
+ * Test compiled Config paths and the match cache.
+ */
+class CompiledPathConfigTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  CompiledPathConfigTestCase ();
+  /** Destructor. */
+  virtual ~CompiledPathConfigTestCase () {}
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check that a compiled path matches the same objects as
+   * Config::LookupMatches.
+   *
+   * \param [in] path The Config path.
+   * \param [in] n The expected number of matches.
+   */
+  void CheckMatches (std::string path, uint32_t n);
+};
+
+CompiledPathConfigTestCase::CompiledPathConfigTestCase ()
+  : TestCase ("Check compiled Config paths and the match cache")
+{
+}
+
+void
+CompiledPathConfigTestCase::CheckMatches (std::string path, uint32_t n)
+{
+  Config::CompiledPath compiled (path);
+  Config::MatchContainer expected = Config::LookupMatches (path);
+  // match twice, to use the attributes found the first time
+  for (uint32_t k = 0; k < 2; k++)
+    {
+      Config::MatchContainer matches = compiled.LookupMatches ();
+      NS_TEST_ASSERT_MSG_EQ (matches.GetN (), n, "Unexpected number of matches for " << path);
+      NS_TEST_ASSERT_MSG_EQ (expected.GetN (), n, "Unexpected number of matches for " << path);
+      NS_TEST_ASSERT_MSG_EQ (matches.GetPath (), path, "Unexpected path");
+      if (matches.GetN () != n || expected.GetN () != n)
+        {
+          return;
+        }
+      for (uint32_t i = 0; i < n; i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (matches.Get (i), expected.Get (i), "Different match for " << path);
+          NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (i), expected.GetMatchedPath (i),
+                                 "Different matched path for " << path);
+        }
+    }
+}
+
+void
+CompiledPathConfigTestCase::DoRun (void)
+{
+  IntegerValue iv;
+
+  //
+  // Name the root of a small tree, so that the paths below do not match
+  // the root namespace objects of the other test cases.
+  //
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Names::Add ("CompiledRoot", root);
+  Ptr<ConfigTestObject> a = CreateObject<ConfigTestObject> ();
+  root->SetNodeA (a);
+  std::vector<Ptr<ConfigTestObject> > objects;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      objects.push_back (CreateObject<ConfigTestObject> ());
+      root->AddNodeB (objects[i]);
+    }
+
+  CheckMatches ("/Names/CompiledRoot/NodesB/*", 4);
+  CheckMatches ("/Names/CompiledRoot/NodesB/[1-2]", 2);
+  CheckMatches ("/Names/CompiledRoot/NodesB/3", 1);
+  CheckMatches ("/Names/CompiledRoot/NodesB/0|3", 2);
+  CheckMatches ("/Names/CompiledRoot/NodesB/7", 0);
+  // a trailing container matches nothing
+  CheckMatches ("/Names/CompiledRoot/*", 1);
+  CheckMatches ("/Names/CompiledRoot/NodeA/$ConfigTestObject", 1);
+
+  Config::CompiledPath compiled ("/Names/CompiledRoot/NodesB/[1-2]/A");
+  compiled.Set (IntegerValue (-21));
+  objects[0]->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 10, "Object Attribute \"A\" unexpectedly set");
+  objects[1]->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), -21, "Object Attribute \"A\" not set as expected");
+  objects[2]->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), -21, "Object Attribute \"A\" not set as expected");
+  objects[3]->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 10, "Object Attribute \"A\" unexpectedly set");
+
+  //
+  // With the cache, a new object is only matched once the cache is
+  // invalidated, which adding a name does.
+  //
+  Config::EnableMatchCache ();
+  std::string path = "/Names/CompiledRoot/NodesB/*";
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches (path).GetN (), 4, "Unexpected number of matches");
+  root->AddNodeB (CreateObject<ConfigTestObject> ());
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches (path).GetN (), 4, "Cached matches not used");
+  Config::InvalidateMatchCache ();
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches (path).GetN (), 5, "Cache not invalidated");
+
+  path = "/Names/CompiledRoot/Child";
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches (path).GetN (), 0, "Unexpected match");
+  Names::Add ("CompiledRoot/Child", CreateObject<ConfigTestObject> ());
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches (path).GetN (), 1, "Cache not invalidated by Names::Add");
+  Config::DisableMatchCache ();
+
+  Names::Clear ();
+}
+
 /**
  * \ingroup config-tests
  * The Test Suite that glues all of the Test Cases together.
@@ -839,6 +954,7 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new UnderRootNamespaceConfigTestCase);
   AddTestCase (new ObjectVectorConfigTestCase);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase);
+  AddTestCase (new CompiledPathConfigTestCase);
 }
 
 /**
@@ -0,0 +1,273 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+#include "ns3/core-config.h"
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifdef HAVE_SYS_WAIT_H
+#include <unistd.h>
+#endif
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup logging
+ * \ingroup log-tests
+ * Logging test suite.
+ */
+
+/**
+ * \ingroup core-tests
+ * \defgroup log-tests Logging test suite
+ */
+
+namespace ns3 {
+
+  namespace tests {
+
+NS_LOG_COMPONENT_DEFINE ("LogTestSuite");
+
+#ifdef NS3_LOG_ENABLE
+
+/**
+ * \ingroup log-tests
+ * Log a few messages of each kind.
+ *
+ * \param [in] value A value to log.
+ */
+static void
+LogSome (int value)
+{
+  NS_LOG_FUNCTION (value << "text");
+  NS_LOG_FUNCTION_NOARGS ();
+  NS_LOG_DEBUG ("value " << value << " " << 1.5);
+  NS_LOG_INFO (std::string (300, 'x'));
+  NS_LOG_WARN ("");
+}
+
+#undef NS_LOG_COMPILE_LEVEL
+#define NS_LOG_COMPILE_LEVEL ns3::LOG_LEVEL_WARN
+/**
+ * \ingroup log-tests
+ * Log messages, some of which are compiled out.
+ */
+static void
+LogFiltered (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  NS_LOG_INFO ("info");
+  NS_LOG_WARN ("warn");
+}
+#undef NS_LOG_COMPILE_LEVEL
+#define NS_LOG_COMPILE_LEVEL ns3::LOG_LEVEL_ALL
+
+/**
+ * \ingroup log-tests
+ * Check that a binary log file decodes to the text logged to std::clog.
+ */
+class BinaryLogTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  BinaryLogTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Log from a simulation, and after it.
+   */
+  void Run (void);
+  /**
+   * Decode a binary log file.
+   * \param [in] filename The file name.
+   * \returns The decoded text.
+   */
+  std::string Decode (std::string filename);
+};
+
+BinaryLogTestCase::BinaryLogTestCase ()
+  : TestCase ("Check that a binary log decodes to the text log")
+{
+}
+
+void
+BinaryLogTestCase::Run (void)
+{
+  Simulator::ScheduleWithContext (3, NanoSeconds (1500000123), &LogSome, 42);
+  Simulator::Schedule (Seconds (2), &LogSome, 7);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  LogSome (1);
+}
+
+std::string
+BinaryLogTestCase::Decode (std::string filename)
+{
+  std::ifstream is (filename.c_str (), std::ios::in | std::ios::binary);
+  std::ostringstream os;
+  NS_TEST_EXPECT_MSG_EQ (LogDecodeBinary (is, os), true, "Cannot decode " << filename);
+  return os.str ();
+}
+
+void
+BinaryLogTestCase::DoRun (void)
+{
+  LogComponentEnable ("LogTestSuite", LogLevel (LOG_LEVEL_ALL | LOG_PREFIX_ALL));
+
+  std::ostringstream text;
+  std::streambuf *clog = std::clog.rdbuf (text.rdbuf ());
+  Run ();
+  std::clog.rdbuf (clog);
+
+  std::string filename = CreateTempDirFilename ("binary.log");
+  LogSetBinaryOutput (filename);
+  NS_TEST_ASSERT_MSG_EQ (LogIsBinaryOutput (), true, "Binary output not enabled");
+  Run ();
+  LogSetBinaryOutput ("");
+  NS_TEST_ASSERT_MSG_EQ (LogIsBinaryOutput (), false, "Binary output not disabled");
+
+  NS_TEST_ASSERT_MSG_NE (text.str (), "", "Nothing logged");
+  NS_TEST_ASSERT_MSG_EQ (Decode (filename), text.str (), "Decoded log differs");
+
+  // Only the levels compiled in are logged.
+  LogSetBinaryOutput (filename);
+  LogFiltered ();
+  LogSetBinaryOutput ("");
+  NS_TEST_ASSERT_MSG_EQ (Decode (filename), "LogTestSuite:LogFiltered(): [WARN ] warn\n",
+                         "Compiled out levels logged");
+
+  LogComponentDisable ("LogTestSuite", LogLevel (LOG_LEVEL_ALL | LOG_PREFIX_ALL));
+
+  // A file which is not a binary log, and a truncated binary log.
+  std::istringstream text2 ("not a log file");
+  std::ostringstream os;
+  NS_TEST_ASSERT_MSG_EQ (LogDecodeBinary (text2, os), false, "Decoded a text file");
+  std::ifstream is (filename.c_str (), std::ios::in | std::ios::binary);
+  std::string binary ((std::istreambuf_iterator<char> (is)), std::istreambuf_iterator<char> ());
+  std::istringstream truncated (binary.substr (0, binary.size () - 1));
+  NS_TEST_ASSERT_MSG_EQ (LogDecodeBinary (truncated, os), false, "Decoded a truncated file");
+}
+
+#ifdef HAVE_SYS_WAIT_H
+/**
+ * \ingroup log-tests
+ * Check that the children of Simulator::ForkAt() write their binary
+ * log to files of their own.
+ */
+class ForkBinaryLogTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  ForkBinaryLogTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Decode a binary log file.
+   * \param [in] filename The file name.
+   * \returns The decoded text.
+   */
+  std::string Decode (std::string filename);
+};
+
+ForkBinaryLogTestCase::ForkBinaryLogTestCase ()
+  : TestCase ("Check that forked children write binary logs of their own")
+{
+}
+
+std::string
+ForkBinaryLogTestCase::Decode (std::string filename)
+{
+  std::ifstream is (filename.c_str (), std::ios::in | std::ios::binary);
+  std::ostringstream os;
+  NS_TEST_EXPECT_MSG_EQ (LogDecodeBinary (is, os), true, "Cannot decode " << filename);
+  return os.str ();
+}
+
+void
+ForkBinaryLogTestCase::DoRun (void)
+{
+  const uint32_t n = 3;
+  LogComponentEnable ("LogTestSuite", LOG_LEVEL_INFO);
+  std::string filename = CreateTempDirFilename ("fork.log");
+  LogSetBinaryOutput (filename);
+  NS_LOG_INFO ("warm-up");
+
+  uint32_t child = Simulator::ForkAt (Seconds (1), n, 2);
+  if (child != 0)
+    {
+      NS_LOG_INFO ("child " << child);
+      LogSetBinaryOutput ("");
+      _exit (0);
+    }
+
+  NS_LOG_INFO ("parent");
+  LogSetBinaryOutput ("");
+  LogComponentDisable ("LogTestSuite", LOG_LEVEL_INFO);
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (Decode (filename), "warm-up\nparent\n", "Wrong parent log");
+  for (uint32_t i = 1; i <= n; ++i)
+    {
+      std::ostringstream name;
+      name << filename << "." << i;
+      std::ostringstream text;
+      text << "child " << i << "\n";
+      NS_TEST_EXPECT_MSG_EQ (Decode (name.str ()), text.str (), "Wrong log of child " << i);
+    }
+}
+#endif /* HAVE_SYS_WAIT_H */
+
+#endif /* NS3_LOG_ENABLE */
+
+/**
+ * \ingroup log-tests
+ * Logging test suite.
+ */
+class LogTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  LogTestSuite ();
+};
+
+LogTestSuite::LogTestSuite ()
+  : TestSuite ("log")
+{
+#ifdef NS3_LOG_ENABLE
+  AddTestCase (new BinaryLogTestCase);
+#ifdef HAVE_SYS_WAIT_H
+  AddTestCase (new ForkBinaryLogTestCase);
+#endif
+#endif
+}
+
+/**
+ * \ingroup log-tests
+ * LogTestSuite instance variable.
+ */
+static LogTestSuite g_logTestSuite;
+
+
+  }  // namespace tests
+
+}  // namespace ns3
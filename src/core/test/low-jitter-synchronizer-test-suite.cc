@@ -0,0 +1,272 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/realtime-simulator-impl.h"
+#include "ns3/low-jitter-synchronizer.h"
+#include "ns3/wall-clock-synchronizer.h"
+#include "ns3/make-event.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/system-thread.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup realtime
+ * \ingroup core-tests
+ * LowJitterSynchronizer test suite.
+ */
+
+namespace ns3 {
+
+  namespace tests {
+
+/**
+ * \ingroup core-tests
+ * Base class of the LowJitterSynchronizer tests, which run a
+ * RealtimeSimulatorImpl with a LowJitterSynchronizer.
+ */
+class LowJitterSynchronizerTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] name The test case name.
+   */
+  LowJitterSynchronizerTestCase (std::string name);
+
+protected:
+  virtual void DoSetup (void);
+  virtual void DoTeardown (void);
+  /**
+   * Get the synchronizer of the current simulation.
+   * \returns The synchronizer.
+   */
+  Ptr<LowJitterSynchronizer> GetSynchronizer (void);
+};
+
+LowJitterSynchronizerTestCase::LowJitterSynchronizerTestCase (std::string name)
+  : TestCase (name)
+{
+}
+
+void
+LowJitterSynchronizerTestCase::DoSetup (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType",
+                     StringValue ("ns3::RealtimeSimulatorImpl"));
+  Config::SetDefault ("ns3::RealtimeSimulatorImpl::SynchronizerType",
+                      TypeIdValue (LowJitterSynchronizer::GetTypeId ()));
+}
+
+void
+LowJitterSynchronizerTestCase::DoTeardown (void)
+{
+  Config::SetDefault ("ns3::RealtimeSimulatorImpl::SynchronizerType",
+                      TypeIdValue (WallClockSynchronizer::GetTypeId ()));
+  Config::SetGlobal ("SimulatorImplementationType",
+                     StringValue ("ns3::DefaultSimulatorImpl"));
+}
+
+Ptr<LowJitterSynchronizer>
+LowJitterSynchronizerTestCase::GetSynchronizer (void)
+{
+  Ptr<RealtimeSimulatorImpl> impl =
+    DynamicCast<RealtimeSimulatorImpl> (Simulator::GetImplementation ());
+  NS_ASSERT (impl != 0);
+  return DynamicCast<LowJitterSynchronizer> (impl->GetSynchronizer ());
+}
+
+/**
+ * \ingroup core-tests
+ * Check that the events are paced, never early, and that their
+ * lateness is recorded.
+ */
+class LowJitterPacingTestCase : public LowJitterSynchronizerTestCase
+{
+public:
+  /** Constructor. */
+  LowJitterPacingTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Record the lateness of an event.
+   * \param [in] lateness The lateness.
+   */
+  void Lateness (Time lateness);
+  /**
+   * An event.
+   * \param [in] last Whether it is the last event.
+   */
+  void Event (bool last);
+
+  std::vector<Time> m_lateness;  //!< The lateness of each event.
+};
+
+LowJitterPacingTestCase::LowJitterPacingTestCase ()
+  : LowJitterSynchronizerTestCase ("Check the pacing of the events")
+{
+}
+
+void
+LowJitterPacingTestCase::Lateness (Time lateness)
+{
+  m_lateness.push_back (lateness);
+}
+
+void
+LowJitterPacingTestCase::Event (bool last)
+{
+  // A realtime simulation only ends when it is stopped.
+  if (last)
+    {
+      Simulator::Stop ();
+    }
+}
+
+void
+LowJitterPacingTestCase::DoRun (void)
+{
+  Ptr<LowJitterSynchronizer> synchronizer = GetSynchronizer ();
+  NS_TEST_ASSERT_MSG_NE (synchronizer, 0, "Not a LowJitterSynchronizer");
+  synchronizer->TraceConnectWithoutContext
+    ("Lateness", MakeCallback (&LowJitterPacingTestCase::Lateness, this));
+
+  const uint32_t n = 100;
+  for (uint32_t i = 1; i <= n; ++i)
+    {
+      Simulator::Schedule (MicroSeconds (1000 * i + 7 * (i % 5)),
+                           &LowJitterPacingTestCase::Event, this, i == n);
+    }
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  Simulator::Run ();
+  double elapsed = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (elapsed, 0.1, "Events not paced");
+  NS_TEST_ASSERT_MSG_EQ (m_lateness.size (), n, "Lateness not traced");
+  Time max (0);
+  for (std::vector<Time>::const_iterator i = m_lateness.begin (); i != m_lateness.end (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (*i, Time (0), "Event run early");
+      max = Max (max, *i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (synchronizer->GetMaxLateness (), max, "Wrong maximum lateness");
+
+  std::vector<uint64_t> histogram = synchronizer->GetLatenessHistogram ();
+  uint64_t count = 0;
+  for (std::vector<uint64_t>::const_iterator i = histogram.begin (); i != histogram.end (); ++i)
+    {
+      count += *i;
+    }
+  NS_TEST_EXPECT_MSG_EQ (count, n, "Events missing from the histogram");
+  StringValue text;
+  synchronizer->GetAttribute ("LatenessHistogram", text);
+  NS_TEST_EXPECT_MSG_NE (text.Get (), "", "Empty LatenessHistogram attribute");
+}
+
+/**
+ * \ingroup core-tests
+ * Check that an event handed over by another thread interrupts a sleep.
+ */
+class LowJitterInterruptTestCase : public LowJitterSynchronizerTestCase
+{
+public:
+  /** Constructor. */
+  LowJitterInterruptTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Schedule an event which stops the simulation, from another thread.
+   */
+  void Thread (void);
+  /** Stop the simulation. */
+  static void StopNow (void);
+
+  Ptr<SimulatorImpl> m_impl;  //!< The simulator implementation.
+};
+
+LowJitterInterruptTestCase::LowJitterInterruptTestCase ()
+  : LowJitterSynchronizerTestCase ("Check that another thread interrupts a sleep")
+{
+}
+
+void
+LowJitterInterruptTestCase::StopNow (void)
+{
+  Simulator::Stop ();
+}
+
+void
+LowJitterInterruptTestCase::Thread (void)
+{
+  std::this_thread::sleep_for (std::chrono::milliseconds (20));
+  m_impl->ScheduleWithContext (0, Time (0), MakeEvent (&LowJitterInterruptTestCase::StopNow));
+}
+
+void
+LowJitterInterruptTestCase::DoRun (void)
+{
+  m_impl = Simulator::GetImplementation ();
+  Simulator::Schedule (Seconds (10), &LowJitterInterruptTestCase::StopNow);
+  Ptr<SystemThread> thread =
+    Create<SystemThread> (MakeCallback (&LowJitterInterruptTestCase::Thread, this));
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  thread->Start ();
+  Simulator::Run ();
+  double elapsed = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+  thread->Join ();
+  m_impl = 0;
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_LT (elapsed, 5, "Sleep not interrupted");
+}
+
+/**
+ * \ingroup core-tests
+ * LowJitterSynchronizer test suite.
+ */
+class LowJitterSynchronizerTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  LowJitterSynchronizerTestSuite ();
+};
+
+LowJitterSynchronizerTestSuite::LowJitterSynchronizerTestSuite ()
+  : TestSuite ("low-jitter-synchronizer")
+{
+  AddTestCase (new LowJitterPacingTestCase);
+  AddTestCase (new LowJitterInterruptTestCase);
+}
+
+/**
+ * \ingroup core-tests
+ * LowJitterSynchronizerTestSuite instance variable.
+ */
+static LowJitterSynchronizerTestSuite g_lowJitterSynchronizerTestSuite;
+
+
+  }  // namespace tests
+
+}  // namespace ns3
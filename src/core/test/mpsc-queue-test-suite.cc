@@ -0,0 +1,185 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/test.h"
+#include "ns3/mpsc-queue.h"
+#include "ns3/system-thread.h"
+#include "ns3/callback.h"
+
+#include <vector>
+#include <thread>
+
+using namespace ns3;
+
+/**
+ * Check the queue from a single thread: capacity, order and wrap around.
+ */
+class MpscQueueSequentialTestCase : public TestCase
+{
+public:
+  MpscQueueSequentialTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+MpscQueueSequentialTestCase::MpscQueueSequentialTestCase ()
+  : TestCase ("Check the order and capacity of a lock-free queue")
+{
+}
+
+void
+MpscQueueSequentialTestCase::DoRun (void)
+{
+  MpscQueue<uint32_t> queue (5);
+  NS_TEST_ASSERT_MSG_EQ (queue.GetCapacity (), 8, "Capacity not rounded up to a power of two");
+  NS_TEST_EXPECT_MSG_EQ (queue.IsEmpty (), true, "New queue not empty");
+
+  uint32_t item = 0;
+  uint32_t next = 0;
+  for (uint32_t lap = 0; lap < 3; ++lap)
+    {
+      for (uint32_t i = 0; i < 8; ++i)
+        {
+          NS_TEST_EXPECT_MSG_EQ (queue.TryPush (lap * 8 + i), true, "Push failed before the queue is full");
+        }
+      NS_TEST_EXPECT_MSG_EQ (queue.TryPush (1000), false, "Push succeeded on a full queue");
+      NS_TEST_EXPECT_MSG_EQ (queue.IsEmpty (), false, "Full queue reported empty");
+      // leave some items in the queue, so that the next lap wraps around
+      for (uint32_t i = 0; i < (lap == 2 ? 8 : 5); ++i)
+        {
+          NS_TEST_EXPECT_MSG_EQ (queue.TryPop (item), true, "Pop failed on a non-empty queue");
+          NS_TEST_EXPECT_MSG_EQ (item, next, "Items out of order");
+          next++;
+        }
+      while (queue.TryPop (item))
+        {
+          NS_TEST_EXPECT_MSG_EQ (item, next, "Items out of order");
+          next++;
+        }
+      next = (lap + 1) * 8;
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue.IsEmpty (), true, "Drained queue not empty");
+  NS_TEST_EXPECT_MSG_EQ (queue.TryPop (item), false, "Pop succeeded on an empty queue");
+}
+
+/**
+ * Check that items pushed concurrently by several threads are all
+ * received, in the order each thread pushed them.
+ */
+class MpscQueueThreadedTestCase : public TestCase
+{
+public:
+  MpscQueueThreadedTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Push items until they are all in the queue.
+   *
+   * \param [in] test The test case.
+   * \param [in] producer The index of the producer thread.
+   */
+  static void Produce (MpscQueueThreadedTestCase *test, uint32_t producer);
+
+  /** An item, tagged with its producer. */
+  struct Item
+  {
+    uint32_t producer;     //!< The producer index.
+    uint32_t sequence;     //!< The sequence number within the producer.
+  };
+  /** The queue under test. */
+  MpscQueue<Item> m_queue;
+};
+
+static const uint32_t g_producers = 4;
+static const uint32_t g_itemsPerProducer = 20000;
+
+MpscQueueThreadedTestCase::MpscQueueThreadedTestCase ()
+  : TestCase ("Check a lock-free queue with concurrent producers"),
+    m_queue (64)
+{
+}
+
+void
+MpscQueueThreadedTestCase::Produce (MpscQueueThreadedTestCase *test, uint32_t producer)
+{
+  for (uint32_t i = 0; i < g_itemsPerProducer; ++i)
+    {
+      Item item;
+      item.producer = producer;
+      item.sequence = i;
+      while (!test->m_queue.TryPush (item))
+        {
+          // the queue is small: let the consumer catch up
+          std::this_thread::yield ();
+        }
+    }
+}
+
+void
+MpscQueueThreadedTestCase::DoRun (void)
+{
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < g_producers; ++i)
+    {
+      threads.push_back (Create<SystemThread> (MakeBoundCallback (&MpscQueueThreadedTestCase::Produce, this, i)));
+    }
+  for (uint32_t i = 0; i < g_producers; ++i)
+    {
+      threads[i]->Start ();
+    }
+
+  std::vector<uint32_t> next (g_producers, 0);
+  uint32_t received = 0;
+  bool ordered = true;
+  Item item;
+  while (received < g_producers * g_itemsPerProducer)
+    {
+      if (!m_queue.TryPop (item))
+        {
+          std::this_thread::yield ();
+          continue;
+        }
+      if (item.producer >= g_producers || item.sequence != next[item.producer])
+        {
+          ordered = false;
+        }
+      else
+        {
+          next[item.producer]++;
+        }
+      received++;
+    }
+  for (uint32_t i = 0; i < g_producers; ++i)
+    {
+      threads[i]->Join ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (ordered, true, "Items of a producer received out of order");
+  NS_TEST_EXPECT_MSG_EQ (received, g_producers * g_itemsPerProducer, "Items lost");
+  NS_TEST_EXPECT_MSG_EQ (m_queue.IsEmpty (), true, "Items left in the queue");
+}
+
+/**
+ * The lock-free queue test suite.
+ */
+class MpscQueueTestSuite : public TestSuite
+{
+public:
+  MpscQueueTestSuite ()
+    : TestSuite ("mpsc-queue")
+  {
+    AddTestCase (new MpscQueueSequentialTestCase (), TestCase::QUICK);
+    AddTestCase (new MpscQueueThreadedTestCase (), TestCase::QUICK);
+  }
+} g_mpscQueueTestSuite;
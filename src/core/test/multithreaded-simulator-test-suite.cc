@@ -0,0 +1,213 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/simulator-impl.h"
+#include "ns3/object-factory.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+#include "ns3/core-config.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Run a ring of contexts which exchange events with the lookahead
+ * delay and schedule local events in between, and check that every
+ * context sees the same history as with the default simulator.
+ */
+class MultithreadedSimulatorRingTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param [in] threads The number of worker threads.
+   */
+  MultithreadedSimulatorRingTestCase (uint32_t threads);
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Run the ring scenario with the current simulator.
+   *
+   * \return The history of each context.
+   */
+  std::vector<std::vector<uint64_t> > RunRing (void);
+  /**
+   * Receive a token on a context.
+   *
+   * \param [in] hops The number of hops left.
+   */
+  void Receive (uint32_t hops);
+  /** Record a local timer expiration. */
+  void Timer (void);
+
+  uint32_t m_threads;                          //!< Number of worker threads.
+  std::vector<std::vector<uint64_t> > m_log;   //!< Event times per context.
+};
+
+static const uint32_t g_ringSize = 16;
+static const Time g_lookAhead = MilliSeconds (2);
+
+MultithreadedSimulatorRingTestCase::MultithreadedSimulatorRingTestCase (uint32_t threads)
+  : TestCase ("Check that a ring of contexts runs the same with worker threads"),
+    m_threads (threads)
+{
+}
+
+void
+MultithreadedSimulatorRingTestCase::Receive (uint32_t hops)
+{
+  uint32_t context = Simulator::GetContext ();
+  m_log[context].push_back (Simulator::Now ().GetNanoSeconds ());
+  if (hops == 0)
+    {
+      return;
+    }
+  Simulator::Schedule (MicroSeconds (100 + context), &MultithreadedSimulatorRingTestCase::Timer, this);
+  Simulator::ScheduleWithContext ((context + 1) % g_ringSize, g_lookAhead + MicroSeconds (context),
+                                  &MultithreadedSimulatorRingTestCase::Receive, this, hops - 1);
+}
+
+void
+MultithreadedSimulatorRingTestCase::Timer (void)
+{
+  m_log[Simulator::GetContext ()].push_back (Simulator::Now ().GetNanoSeconds () + 1);
+}
+
+std::vector<std::vector<uint64_t> >
+MultithreadedSimulatorRingTestCase::RunRing (void)
+{
+  m_log.assign (g_ringSize, std::vector<uint64_t> ());
+  for (uint32_t i = 0; i < g_ringSize; i += 3)
+    {
+      Simulator::ScheduleWithContext (i, MicroSeconds (i), &MultithreadedSimulatorRingTestCase::Receive, this, 50);
+    }
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return m_log;
+}
+
+void
+MultithreadedSimulatorRingTestCase::DoRun (void)
+{
+  std::vector<std::vector<uint64_t> > expected = RunRing ();
+
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::MultithreadedSimulatorImpl");
+  factory.Set ("ThreadCount", UintegerValue (m_threads));
+  factory.Set ("LookAhead", TimeValue (g_lookAhead));
+  Simulator::SetImplementation (factory.Create<SimulatorImpl> ());
+  std::vector<std::vector<uint64_t> > actual = RunRing ();
+
+  for (uint32_t i = 0; i < g_ringSize; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (actual[i].size (), expected[i].size (), "Wrong number of events for context " << i);
+      for (uint32_t j = 0; j < expected[i].size (); ++j)
+        {
+          NS_TEST_EXPECT_MSG_EQ (actual[i][j], expected[i][j], "Wrong event " << j << " for context " << i);
+        }
+    }
+}
+
+/**
+ * Check the global events, Stop and Now with a multithreaded simulator.
+ */
+class MultithreadedSimulatorStopTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorStopTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /** Reschedule itself on the current context forever. */
+  void Tick (void);
+  /** Record the time of a global event. */
+  void Global (void);
+
+  uint64_t m_ticks;    //!< Number of ticks of context 0.
+  Time m_global;       //!< Time of the global event.
+};
+
+MultithreadedSimulatorStopTestCase::MultithreadedSimulatorStopTestCase ()
+  : TestCase ("Check global events and Stop with a multithreaded simulator")
+{
+}
+
+void
+MultithreadedSimulatorStopTestCase::Tick (void)
+{
+  if (Simulator::GetContext () == 0)
+    {
+      m_ticks++;
+    }
+  Simulator::Schedule (MilliSeconds (1), &MultithreadedSimulatorStopTestCase::Tick, this);
+}
+
+void
+MultithreadedSimulatorStopTestCase::Global (void)
+{
+  m_global = Simulator::Now ();
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetContext (), Simulator::NO_CONTEXT, "Global event run with a context");
+}
+
+void
+MultithreadedSimulatorStopTestCase::DoRun (void)
+{
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::MultithreadedSimulatorImpl");
+  factory.Set ("ThreadCount", UintegerValue (3));
+  factory.Set ("LookAhead", TimeValue (MilliSeconds (5)));
+  Simulator::SetImplementation (factory.Create<SimulatorImpl> ());
+
+  m_ticks = 0;
+  for (uint32_t i = 0; i < 6; ++i)
+    {
+      Simulator::ScheduleWithContext (i, MilliSeconds (1), &MultithreadedSimulatorStopTestCase::Tick, this);
+    }
+  Simulator::Schedule (MicroSeconds (12345), &MultithreadedSimulatorStopTestCase::Global, this);
+  Simulator::Stop (MilliSeconds (100));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_global, MicroSeconds (12345), "Global event run at the wrong time");
+  NS_TEST_EXPECT_MSG_EQ (m_ticks, 99, "Wrong number of events before Stop");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), MilliSeconds (100), "Wrong time after Stop");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::IsFinished (), true, "Simulator should be stopped");
+  Simulator::Destroy ();
+}
+
+/**
+ * The multithreaded simulator test suite.
+ */
+class MultithreadedSimulatorTestSuite : public TestSuite
+{
+public:
+  MultithreadedSimulatorTestSuite ()
+    : TestSuite ("multithreaded-simulator")
+  {
+#ifndef ENABLE_THREAD_LOCAL_SIMULATOR
+    uint32_t threadCounts[] = { 1, 2, 5 };
+    for (uint32_t i = 0; i < sizeof (threadCounts) / sizeof (threadCounts[0]); ++i)
+      {
+        AddTestCase (new MultithreadedSimulatorRingTestCase (threadCounts[i]), TestCase::QUICK);
+      }
+    AddTestCase (new MultithreadedSimulatorStopTestCase (), TestCase::QUICK);
+#endif /* ENABLE_THREAD_LOCAL_SIMULATOR */
+  }
+} g_multithreadedSimulatorTestSuite;
@@ -16,6 +16,8 @@
 
 #include "ns3/test.h"
 #include "ns3/names.h"
+#include <sstream>
+#include <vector>
 
 
 /**
@@ -1001,6 +1003,78 @@ AlternateFindTestCase::DoRun (void)
                          "Unexpectedly able to GetObject<TestObject> on an AlternateTestObject");
 }
 
+/**
+ * \ingroup names-tests
+ * Test bulk registration and the cached paths of renamed subtrees.
+ *
+ *     AddMany (std::string path, names, objects);
+ *     AddMany (Ptr<Object> context, names, objects);
+ */
+class AddManyTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  AddManyTestCase ();
+  /** Destructor. */
+  virtual ~AddManyTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+};
+
+AddManyTestCase::AddManyTestCase ()
+  : TestCase ("Check Names::AddMany and path updates on Names::Rename")
+{
+}
+
+AddManyTestCase::~AddManyTestCase ()
+{
+}
+
+void
+AddManyTestCase::DoTeardown (void)
+{
+  Names::Clear ();
+}
+
+void
+AddManyTestCase::DoRun (void)
+{
+  std::vector<std::string> names;
+  std::vector<Ptr<Object> > objects;
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      std::ostringstream oss;
+      oss << "node" << i;
+      names.push_back (oss.str ());
+      objects.push_back (CreateObject<TestObject> ());
+    }
+  Names::AddMany ("/Names", names, objects);
+
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> (names[i]), objects[i], "Could not Names::AddMany and Names::Find an Object");
+      NS_TEST_ASSERT_MSG_EQ (Names::FindPath (objects[i]), "/Names/" + names[i], "Unexpected path for an Object added by Names::AddMany");
+    }
+
+  std::vector<std::string> childNames;
+  std::vector<Ptr<Object> > children;
+  childNames.push_back ("eth0");
+  childNames.push_back ("eth1");
+  children.push_back (CreateObject<TestObject> ());
+  children.push_back (CreateObject<TestObject> ());
+  Names::AddMany (objects[1], childNames, children);
+
+  NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> ("/Names/node1/eth1"), children[1], "Could not Names::AddMany under a context");
+  NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> ("node1", "eth0"), children[0], "Could not Names::AddMany under a context");
+
+  Names::Rename ("node1", "router");
+  NS_TEST_ASSERT_MSG_EQ (Names::FindPath (children[0]), "/Names/router/eth0", "Path of a child not updated by Names::Rename");
+  NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> ("router/eth1"), children[1], "Could not Names::Find a child after Names::Rename");
+  NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> ("node1/eth1"), 0, "Unexpectedly found a child under its old path");
+}
+
 /**
  * \ingroup names-tests
  * Names Test Suite 
@@ -1029,6 +1103,7 @@ NamesTestSuite::NamesTestSuite ()
   AddTestCase (new FullyQualifiedFindTestCase);
   AddTestCase (new RelativeFindTestCase);
   AddTestCase (new AlternateFindTestCase);
+  AddTestCase (new AddManyTestCase);
 }
 
 /**
@@ -22,6 +22,11 @@
 #include "ns3/object.h"
 #include "ns3/object-factory.h"
 #include "ns3/assert.h"
+#include "ns3/object-accounting.h"
+#include "ns3/object-pool.h"
+#include "ns3/simple-ref-count.h"
+#include <sstream>
+#include <vector>
 
 /**
  * \file
@@ -398,6 +403,76 @@ AggregateObjectTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_NE (baseA, 0, "Unable to GetObject on released object");
 }
 
+/**
+ * \ingroup object-tests
+ * Test GetObject through the TypeId ancestors and the aggregate index.
+ */
+class AggregateIndexTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  AggregateIndexTestCase ();
+  /** Destructor. */
+  virtual ~AggregateIndexTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AggregateIndexTestCase::AggregateIndexTestCase ()
+  : TestCase ("Check GetObject by TypeId ancestors on aggregates")
+{
+}
+
+AggregateIndexTestCase::~AggregateIndexTestCase ()
+{
+}
+
+void
+AggregateIndexTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (DerivedA::GetTypeId ().IsChildOf (BaseA::GetTypeId ()), true,
+                         "DerivedA not a child of BaseA");
+  NS_TEST_ASSERT_MSG_EQ (DerivedA::GetTypeId ().IsChildOf (ObjectBase::GetTypeId ()), true,
+                         "DerivedA not a child of ObjectBase");
+  NS_TEST_ASSERT_MSG_EQ (DerivedA::GetTypeId ().IsChildOf (DerivedA::GetTypeId ()), false,
+                         "DerivedA is a child of itself");
+  NS_TEST_ASSERT_MSG_EQ (BaseA::GetTypeId ().IsChildOf (DerivedA::GetTypeId ()), false,
+                         "BaseA is a child of DerivedA");
+  NS_TEST_ASSERT_MSG_EQ (DerivedA::GetTypeId ().IsChildOf (BaseB::GetTypeId ()), false,
+                         "DerivedA is a child of BaseB");
+
+  Ptr<DerivedA> derivedA = CreateObject<DerivedA> ();
+  Ptr<DerivedB> derivedB = CreateObject<DerivedB> ();
+  derivedA->AggregateObject (derivedB);
+
+  //
+  // Look the objects up from each side of the aggregate, by their own
+  // type and by the types of their ancestors.
+  //
+  Ptr<Object> sides[2] = { derivedA, derivedB };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (sides[i]->GetObject<DerivedA> (), derivedA, "Unable to GetObject<DerivedA>");
+      NS_TEST_ASSERT_MSG_EQ (sides[i]->GetObject<BaseA> (), derivedA, "Unable to GetObject<BaseA>");
+      NS_TEST_ASSERT_MSG_EQ (sides[i]->GetObject<DerivedB> (), derivedB, "Unable to GetObject<DerivedB>");
+      NS_TEST_ASSERT_MSG_EQ (sides[i]->GetObject<BaseB> (), derivedB, "Unable to GetObject<BaseB>");
+      NS_TEST_ASSERT_MSG_NE (sides[i]->GetObject<Object> (), 0, "Unable to GetObject<Object>");
+    }
+
+  //
+  // A third object of a type which is not an ancestor of the others.
+  //
+  Ptr<BaseA> baseA = CreateObject<BaseA> ();
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<DerivedA> (), 0, "BaseA unexpectedly responds to GetObject for DerivedA");
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<BaseB> (), 0, "BaseA unexpectedly responds to GetObject for BaseB");
+  Ptr<BaseB> baseB = CreateObject<BaseB> ();
+  baseA->AggregateObject (baseB);
+  NS_TEST_ASSERT_MSG_EQ (baseB->GetObject<BaseA> (), baseA, "Unable to GetObject<BaseA>");
+  NS_TEST_ASSERT_MSG_EQ (baseB->GetObject<DerivedA> (), 0, "Unexpectedly able to GetObject<DerivedA>");
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<DerivedB> (), 0, "Unexpectedly able to GetObject<DerivedB>");
+}
+
 /**
  * \ingroup object-tests
  * Test an Object factory can create Objects
@@ -473,6 +548,179 @@ ObjectFactoryTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_NE (a->GetObject<DerivedA> (), 0, "Unexpectedly able to work around C++ type system");
 }
 
+#ifdef ENABLE_OBJECT_ACCOUNTING
+/**
+ * \ingroup object-tests
+ * Test that ObjectAccounting counts the live Objects of each TypeId.
+ */
+class ObjectAccountingTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  ObjectAccountingTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+ObjectAccountingTestCase::ObjectAccountingTestCase ()
+  : TestCase ("Check ObjectAccounting counts")
+{
+}
+
+void
+ObjectAccountingTestCase::DoRun (void)
+{
+  ObjectAccounting::Counter *baseA = ObjectAccounting::GetCounter (BaseA::GetTypeId ());
+  ObjectAccounting::Counter *derivedA = ObjectAccounting::GetCounter (DerivedA::GetTypeId ());
+  int64_t liveBaseA = baseA->live;
+  int64_t liveDerivedA = derivedA->live;
+  uint64_t totalDerivedA = derivedA->total;
+
+  {
+    Ptr<BaseA> a1 = CreateObject<BaseA> ();
+    Ptr<BaseA> a2 = CreateObject<BaseA> ();
+    Ptr<DerivedA> d = CreateObject<DerivedA> ();
+    NS_TEST_ASSERT_MSG_EQ (baseA->live, liveBaseA + 2, "BaseA not counted");
+    NS_TEST_ASSERT_MSG_EQ (derivedA->live, liveDerivedA + 1, "DerivedA not counted");
+    NS_TEST_ASSERT_MSG_GT_OR_EQ (baseA->peak, liveBaseA + 2, "BaseA peak not updated");
+    NS_TEST_ASSERT_MSG_EQ (derivedA->size, sizeof (DerivedA), "DerivedA size not set");
+
+    std::ostringstream oss;
+    ObjectAccounting::Print (oss);
+    NS_TEST_ASSERT_MSG_NE (oss.str ().find ("ObjectTest:DerivedA"), std::string::npos,
+                           "DerivedA not reported");
+  }
+
+  NS_TEST_ASSERT_MSG_EQ (baseA->live, liveBaseA, "BaseA not uncounted");
+  NS_TEST_ASSERT_MSG_EQ (derivedA->live, liveDerivedA, "DerivedA not uncounted");
+  NS_TEST_ASSERT_MSG_EQ (derivedA->total, totalDerivedA + 1, "DerivedA total not updated");
+}
+#endif /* ENABLE_OBJECT_ACCOUNTING */
+
+/**
+ * \ingroup object-tests
+ * A reference counted type whose memory is recycled.
+ */
+class PooledItem : public SimpleRefCount<PooledItem>, public ObjectPool<PooledItem>
+{
+public:
+  /** Destructor. */
+  virtual ~PooledItem ()
+  {
+  }
+  uint64_t m_data[2];  //!< Some data.
+};
+
+/**
+ * \ingroup object-tests
+ * A larger subclass of PooledItem.
+ */
+class LargePooledItem : public PooledItem
+{
+public:
+  uint64_t m_more[8];  //!< More data.
+};
+
+/**
+ * \ingroup object-tests
+ * An Object whose memory is recycled.
+ */
+class PooledObject : public Object, public ObjectPool<PooledObject>
+{
+public:
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ObjectTest:PooledObject")
+      .SetParent<Object> ()
+      .SetGroupName ("Core")
+      .HideFromDocumentation ()
+      .AddConstructor<PooledObject> ();
+    return tid;
+  }
+};
+
+/**
+ * \ingroup object-tests
+ * Test that ObjectPool recycles the memory of Create() and CreateObject().
+ */
+class ObjectPoolTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  ObjectPoolTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+ObjectPoolTestCase::ObjectPoolTestCase ()
+  : TestCase ("Check ObjectPool recycling")
+{
+}
+
+void
+ObjectPoolTestCase::DoRun (void)
+{
+  ObjectPool<PooledItem>::Purge ();
+  ObjectPoolStatistics before = ObjectPool<PooledItem>::GetStatistics ();
+
+  Ptr<PooledItem> item = Create<PooledItem> ();
+  PooledItem *address = PeekPointer (item);
+  item = 0;
+  ObjectPoolStatistics after = ObjectPool<PooledItem>::GetStatistics ();
+  NS_TEST_ASSERT_MSG_EQ (after.releases, before.releases + 1, "Item not released to the pool");
+  NS_TEST_ASSERT_MSG_EQ (after.freeBlocks, 1, "Item not on the free list");
+  item = Create<PooledItem> ();
+  NS_TEST_ASSERT_MSG_EQ (PeekPointer (item), address, "Item memory not reused");
+
+  // A subclass of another size has its own size class
+  Ptr<PooledItem> large = Create<LargePooledItem> ();
+  NS_TEST_ASSERT_MSG_NE (PeekPointer (large), address, "Sizes mixed up");
+  PooledItem *largeAddress = PeekPointer (large);
+  large = 0;
+  item = 0;
+  large = Create<LargePooledItem> ();
+  NS_TEST_ASSERT_MSG_EQ (PeekPointer (large), largeAddress, "Subclass memory not reused");
+  large = 0;
+
+  after = ObjectPool<PooledItem>::GetStatistics ();
+  NS_TEST_ASSERT_MSG_EQ (after.allocations, before.allocations + 4, "Wrong allocations");
+  NS_TEST_ASSERT_MSG_EQ (after.reuses, before.reuses + 2, "Wrong reuses");
+  NS_TEST_ASSERT_MSG_EQ (after.freeBlocks, 2, "Wrong free blocks");
+  ObjectPool<PooledItem>::Purge ();
+  NS_TEST_ASSERT_MSG_EQ (ObjectPool<PooledItem>::GetStatistics ().freeBlocks, 0,
+                         "Free blocks not purged");
+
+  // The free lists are bounded, the blocks beyond go back to the heap
+  std::vector<Ptr<PooledItem> > items;
+  for (uint64_t i = 0; i < 2 * ObjectPool<PooledItem>::MAX_FREE_BLOCKS; i++)
+    {
+      items.push_back (Create<PooledItem> ());
+    }
+  items.clear ();
+  NS_TEST_ASSERT_MSG_EQ (ObjectPool<PooledItem>::GetStatistics ().freeBlocks,
+                         ObjectPool<PooledItem>::MAX_FREE_BLOCKS, "Free list not bounded");
+  ObjectPool<PooledItem>::Purge ();
+
+  Ptr<PooledObject> object = CreateObject<PooledObject> ();
+  Object *objectAddress = PeekPointer (object);
+  object->Dispose ();
+  object = 0;
+  object = CreateObject<PooledObject> ();
+  NS_TEST_ASSERT_MSG_EQ (PeekPointer (object), objectAddress, "Object memory not reused");
+  object = 0;
+
+  std::ostringstream oss;
+  ObjectPoolRegistry::Print (oss);
+  NS_TEST_ASSERT_MSG_NE (oss.str ().find ("PooledObject"), std::string::npos,
+                         "PooledObject not reported");
+}
+
 /**
  * \ingroup object-tests
  * The Test Suite that glues the Test Cases together.
@@ -489,7 +737,12 @@ ObjectTestSuite::ObjectTestSuite ()
 {
   AddTestCase (new CreateObjectTestCase);
   AddTestCase (new AggregateObjectTestCase);
+  AddTestCase (new AggregateIndexTestCase);
   AddTestCase (new ObjectFactoryTestCase);
+#ifdef ENABLE_OBJECT_ACCOUNTING
+  AddTestCase (new ObjectAccountingTestCase);
+#endif
+  AddTestCase (new ObjectPoolTestCase);
 }
 
 /**
@@ -35,6 +35,7 @@
 #include "ns3/integer.h"
 #include "ns3/test.h"
 #include "ns3/log.h"
+#include "ns3/object-factory.h"
 #include "ns3/rng-seed-manager.h"
 #include "ns3/random-variable-stream.h"
 
@@ -2878,6 +2879,116 @@ RandomVariableStreamEmpiricalAntitheticTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (valueMean, expectedMean, TOLERANCE, "Wrong mean value."); 
 }
 
+// ===========================================================================
+// Test case for batched draws from random variable stream generators
+// ===========================================================================
+class RandomVariableStreamBatchTestCase : public TestCase
+{
+public:
+  RandomVariableStreamBatchTestCase ();
+  virtual ~RandomVariableStreamBatchTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Check that batches drawn from \p batch match single draws from
+   * \p single, which must be an identical stream.
+   *
+   * \param [in] single The stream to draw one value at a time from.
+   * \param [in] batch The stream to draw batches from.
+   * \param [in] name The name of the distribution, for messages.
+   */
+  void CheckSame (Ptr<RandomVariableStream> single,
+                  Ptr<RandomVariableStream> batch,
+                  std::string name);
+};
+
+RandomVariableStreamBatchTestCase::RandomVariableStreamBatchTestCase ()
+  : TestCase ("Batched draws match single draws")
+{
+}
+
+RandomVariableStreamBatchTestCase::~RandomVariableStreamBatchTestCase ()
+{
+}
+
+void
+RandomVariableStreamBatchTestCase::CheckSame (Ptr<RandomVariableStream> single,
+                                              Ptr<RandomVariableStream> batch,
+                                              std::string name)
+{
+  single->SetStream (1234);
+  batch->SetStream (1234);
+
+  // Odd batch sizes, with single draws in between, so that batches
+  // start and end part way through the prefetched values.
+  const std::size_t sizes[] = { 1, 3, 17, 100, 5, 1000 };
+  std::vector<double> values;
+  std::vector<uint32_t> integers;
+  for (std::size_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); ++s)
+    {
+      std::size_t n = sizes[s];
+      values.resize (n);
+      batch->GetValues (&values[0], n);
+      for (std::size_t i = 0; i < n; ++i)
+        {
+          NS_TEST_ASSERT_MSG_EQ (values[i], single->GetValue (),
+                                 name << " GetValues differs at " << i);
+        }
+      NS_TEST_ASSERT_MSG_EQ (batch->GetValue (), single->GetValue (),
+                             name << " GetValue differs after GetValues");
+
+      integers.resize (n);
+      batch->GetIntegers (&integers[0], n);
+      for (std::size_t i = 0; i < n; ++i)
+        {
+          NS_TEST_ASSERT_MSG_EQ (integers[i], single->GetInteger (),
+                                 name << " GetIntegers differs at " << i);
+        }
+      NS_TEST_ASSERT_MSG_EQ (batch->GetInteger (), single->GetInteger (),
+                             name << " GetInteger differs after GetIntegers");
+    }
+}
+
+void
+RandomVariableStreamBatchTestCase::DoRun (void)
+{
+  SetTestSuiteSeed ();
+
+  ObjectFactory factory;
+  const std::string types[] = {
+    "ns3::UniformRandomVariable",
+    "ns3::ExponentialRandomVariable",
+    "ns3::NormalRandomVariable"
+  };
+  for (std::size_t t = 0; t < sizeof (types) / sizeof (types[0]); ++t)
+    {
+      factory.SetTypeId (types[t]);
+      for (int antithetic = 0; antithetic < 2; ++antithetic)
+        {
+          factory.Set ("Antithetic", BooleanValue (antithetic));
+          CheckSame (factory.Create<RandomVariableStream> (),
+                     factory.Create<RandomVariableStream> (),
+                     types[t]);
+        }
+    }
+
+  // A bounded exponential rejects some draws.
+  Ptr<ExponentialRandomVariable> single = CreateObject<ExponentialRandomVariable> ();
+  Ptr<ExponentialRandomVariable> batch = CreateObject<ExponentialRandomVariable> ();
+  single->SetAttribute ("Bound", DoubleValue (0.5));
+  batch->SetAttribute ("Bound", DoubleValue (0.5));
+  CheckSame (single, batch, "bounded ExponentialRandomVariable");
+
+  // Uniform integers over the full range of the integer type.
+  Ptr<UniformRandomVariable> wide1 = CreateObject<UniformRandomVariable> ();
+  Ptr<UniformRandomVariable> wide2 = CreateObject<UniformRandomVariable> ();
+  wide1->SetAttribute ("Max", DoubleValue (1000000));
+  wide2->SetAttribute ("Max", DoubleValue (1000000));
+  CheckSame (wide1, wide2, "wide UniformRandomVariable");
+}
+
 class RandomVariableStreamTestSuite : public TestSuite
 {
 public:
@@ -2922,6 +3033,7 @@ RandomVariableStreamTestSuite::RandomVariableStreamTestSuite ()
   AddTestCase (new RandomVariableStreamDeterministicTestCase, TestCase::QUICK);
   AddTestCase (new RandomVariableStreamEmpiricalTestCase, TestCase::QUICK);
   AddTestCase (new RandomVariableStreamEmpiricalAntitheticTestCase, TestCase::QUICK);
+  AddTestCase (new RandomVariableStreamBatchTestCase, TestCase::QUICK);
 }
 
 static RandomVariableStreamTestSuite randomVariableStreamTestSuite;
@@ -23,6 +23,33 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/enum.h"
+#include "ns3/simulator-impl.h"
+#include "ns3/event-profiler.h"
+#include "ns3/progress-reporter.h"
+#include "ns3/des-metrics.h"
+#include "ns3/config.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/core-config.h"
+#include "ns3/names.h"
+#include "ns3/system-thread.h"
+#include "ns3/make-event.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <set>
+
+#ifdef HAVE_SYS_WAIT_H
+#include <unistd.h>
+#endif
 
 using namespace ns3;
 
@@ -168,6 +195,801 @@ SimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_destroy, true, "Event should have run");
 }
 
+class SimulatorRandomEventsTestCase : public TestCase
+{
+public:
+  SimulatorRandomEventsTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  void Event (uint32_t i);
+  Ptr<UniformRandomVariable> m_rand;
+  std::vector<EventId> m_ids;
+  std::vector<bool> m_expected;
+  uint32_t m_ran;
+  Time m_last;
+  bool m_ordered;
+  ObjectFactory m_schedulerFactory;
+};
+
+SimulatorRandomEventsTestCase::SimulatorRandomEventsTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check that many random events run in order with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+void
+SimulatorRandomEventsTestCase::Event (uint32_t i)
+{
+  if (Simulator::Now () < m_last || !m_expected[i])
+    {
+      m_ordered = false;
+    }
+  m_last = Simulator::Now ();
+  m_expected[i] = false;
+  m_ran++;
+  double r = m_rand->GetValue ();
+  if (r < 0.5 && m_ids.size () < 10000)
+    {
+      // a short timer, often at the same time
+      Time delay = NanoSeconds (r < 0.1 ? 0 : m_rand->GetInteger (0, 100));
+      m_ids.push_back (Simulator::Schedule (delay, &SimulatorRandomEventsTestCase::Event, this, m_ids.size ()));
+      m_expected.push_back (true);
+    }
+  else if (r < 0.7)
+    {
+      uint32_t j = m_rand->GetInteger (0, m_ids.size () - 1);
+      if (!m_ids[j].IsExpired ())
+        {
+          if (r < 0.6)
+            {
+              Simulator::Remove (m_ids[j]);
+            }
+          else
+            {
+              Simulator::Cancel (m_ids[j]);
+            }
+          m_expected[j] = false;
+        }
+    }
+}
+
+void
+SimulatorRandomEventsTestCase::DoRun (void)
+{
+  Simulator::SetScheduler (m_schedulerFactory);
+  m_rand = CreateObject<UniformRandomVariable> ();
+  m_rand->SetStream (1);
+  m_ran = 0;
+  m_last = Seconds (0);
+  m_ordered = true;
+  for (uint32_t i = 0; i < 5000; ++i)
+    {
+      Time at = NanoSeconds (m_rand->GetInteger (0, i < 2500 ? 100000 : 1000000000));
+      m_ids.push_back (Simulator::Schedule (at, &SimulatorRandomEventsTestCase::Event, this, i));
+      m_expected.push_back (true);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  uint32_t removed = 0;
+  for (uint32_t i = 0; i < m_ids.size (); ++i)
+    {
+      if (m_expected[i])
+        {
+          removed++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_ordered, true, "Events did not run in order");
+  NS_TEST_EXPECT_MSG_EQ (removed, 0, "Some events did not run");
+  NS_TEST_EXPECT_MSG_GT (m_ran, 5000, "Too few events ran");
+}
+
+/**
+ * Check that cancelled events are compacted away by the schedulers.
+ */
+class SimulatorCompactionTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param [in] schedulerFactory The factory of the scheduler to check.
+   */
+  SimulatorCompactionTestCase (ObjectFactory schedulerFactory);
+private:
+  virtual void DoRun (void);
+  /**
+   * An event which must not be cancelled.
+   *
+   * \param [in] i The event index.
+   */
+  void Event (uint32_t i);
+
+  uint32_t m_ran;                       //!< Number of events run.
+  bool m_ordered;                       //!< Whether the events ran in order.
+  Time m_last;                          //!< Time of the last event.
+  ObjectFactory m_schedulerFactory;     //!< The scheduler factory.
+};
+
+SimulatorCompactionTestCase::SimulatorCompactionTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check that cancelled events are compacted with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+void
+SimulatorCompactionTestCase::Event (uint32_t i)
+{
+  if (Simulator::Now () < m_last || i % 4 != 0)
+    {
+      m_ordered = false;
+    }
+  m_last = Simulator::Now ();
+  m_ran++;
+}
+
+void
+SimulatorCompactionTestCase::DoRun (void)
+{
+  m_schedulerFactory.Set ("MaxCancelledFraction", DoubleValue (0.2));
+  m_schedulerFactory.Set ("MinCancelledEvents", UintegerValue (10));
+  Simulator::SetScheduler (m_schedulerFactory);
+  m_ran = 0;
+  m_ordered = true;
+  m_last = Seconds (0);
+
+  uint64_t base = EventImpl::GetLiveCount ();
+  std::vector<EventId> ids;
+  for (uint32_t i = 0; i < 1000; ++i)
+    {
+      // spread the events in time, out of order
+      Time at = MicroSeconds ((i * 7919) % 1000);
+      ids.push_back (Simulator::Schedule (at, &SimulatorCompactionTestCase::Event, this, i));
+    }
+  for (uint32_t i = 0; i < ids.size (); ++i)
+    {
+      if (i % 4 != 0)
+        {
+          Simulator::Cancel (ids[i]);
+        }
+    }
+  ids.clear ();
+  // without compaction, the 750 cancelled events would still be alive
+  NS_TEST_EXPECT_MSG_LT (EventImpl::GetLiveCount (), base + 250 + 100, "Cancelled events were not compacted");
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_ran, 250, "Wrong number of events run");
+  NS_TEST_EXPECT_MSG_EQ (m_ordered, true, "Events did not run in order");
+  NS_TEST_EXPECT_MSG_EQ (EventImpl::GetLiveCount (), base, "Events were not released");
+  Simulator::Destroy ();
+}
+
+/**
+ * Check that Simulator::ScheduleBatch() runs the events as
+ * ScheduleWithContext() called for each of them would.
+ */
+class SimulatorBatchTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param [in] schedulerFactory The factory of the scheduler to check.
+   */
+  SimulatorBatchTestCase (ObjectFactory schedulerFactory);
+private:
+  virtual void DoRun (void);
+  /**
+   * Run the simulation, and record the order of the events.
+   *
+   * \param [in] batch Whether to schedule the events with ScheduleBatch().
+   * \returns The ids of the events, in the order they ran.
+   */
+  std::vector<uint32_t> RunEvents (bool batch);
+  /**
+   * Schedule the events, from a running event.
+   *
+   * \param [in] batch Whether to schedule the events with ScheduleBatch().
+   * \param [in] n The number of events.
+   * \param [in] first The id of the first event.
+   */
+  void Fanout (bool batch, uint32_t n, uint32_t first);
+  /**
+   * A scheduled event.
+   *
+   * \param [in] id The event id.
+   * \param [in] context The expected context.
+   */
+  void Event (uint32_t id, uint32_t context);
+
+  std::vector<uint32_t> m_order;        //!< The ids of the events run.
+  bool m_contexts;                      //!< Whether the contexts were right.
+  ObjectFactory m_schedulerFactory;     //!< The scheduler factory.
+};
+
+SimulatorBatchTestCase::SimulatorBatchTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check that batches of events run in order with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+void
+SimulatorBatchTestCase::Event (uint32_t id, uint32_t context)
+{
+  if (Simulator::GetContext () != context)
+    {
+      m_contexts = false;
+    }
+  m_order.push_back (id);
+}
+
+void
+SimulatorBatchTestCase::Fanout (bool batch, uint32_t n, uint32_t first)
+{
+  std::vector<Simulator::BatchEvent> events;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      uint32_t id = first + i;
+      // mostly the same delay, as for a broadcast, with a few others
+      Time delay = (i % 7 == 0) ? MicroSeconds ((i * 13) % 10) : MicroSeconds (5);
+      EventImpl *event = MakeEvent (&SimulatorBatchTestCase::Event, this, id, i);
+      if (batch)
+        {
+          events.push_back (Simulator::BatchEvent (i, delay, event));
+        }
+      else
+        {
+          Simulator::ScheduleWithContext (i, delay, event);
+        }
+    }
+  Simulator::ScheduleBatch (events);
+}
+
+std::vector<uint32_t>
+SimulatorBatchTestCase::RunEvents (bool batch)
+{
+  Simulator::SetScheduler (m_schedulerFactory);
+  m_order.clear ();
+  // events already in the schedule, around and between the batches
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      Simulator::ScheduleWithContext (0xffffffff, MicroSeconds ((i * 7919) % 40),
+                                      &SimulatorBatchTestCase::Event, this, 10000 + i, 0xffffffff);
+    }
+  // a large batch and a small batch
+  Simulator::Schedule (MicroSeconds (1), &SimulatorBatchTestCase::Fanout, this, batch, 1000, 0);
+  Simulator::Schedule (MicroSeconds (2), &SimulatorBatchTestCase::Fanout, this, batch, 3, 1000);
+  Simulator::Schedule (MicroSeconds (20), &SimulatorBatchTestCase::Fanout, this, batch, 50, 2000);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return m_order;
+}
+
+void
+SimulatorBatchTestCase::DoRun (void)
+{
+  m_contexts = true;
+  std::vector<uint32_t> expected = RunEvents (false);
+  std::vector<uint32_t> order = RunEvents (true);
+  NS_TEST_ASSERT_MSG_EQ (order.size (), expected.size (), "Wrong number of events run");
+  for (uint32_t i = 0; i < order.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (order[i], expected[i], "Event " << i << " ran out of order");
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_contexts, true, "Events ran in the wrong context");
+}
+
+/**
+ * Check the live event counters and the recycling of the event memory.
+ */
+class SimulatorEventCountTestCase : public TestCase
+{
+public:
+  SimulatorEventCountTestCase ();
+private:
+  virtual void DoRun (void);
+  /** An event without arguments. */
+  void Nop (void);
+  /**
+   * An event with arguments, which makes a larger EventImpl.
+   *
+   * \param [in] a The first argument.
+   * \param [in] b The second argument.
+   * \param [in] c The third argument.
+   */
+  void NopArgs (uint64_t a, uint64_t b, uint64_t c);
+};
+
+SimulatorEventCountTestCase::SimulatorEventCountTestCase ()
+  : TestCase ("Check that the live events are counted and their memory recycled")
+{
+}
+
+void
+SimulatorEventCountTestCase::Nop (void)
+{
+}
+
+void
+SimulatorEventCountTestCase::NopArgs (uint64_t a, uint64_t b, uint64_t c)
+{
+}
+
+void
+SimulatorEventCountTestCase::DoRun (void)
+{
+  Simulator::Now ();
+  uint64_t base = EventImpl::GetLiveCount ();
+  EventImpl::ResetPeakCount ();
+  uint64_t peak = EventImpl::GetPeakCount ();
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      Simulator::Schedule (MicroSeconds (i), &SimulatorEventCountTestCase::Nop, this);
+      Simulator::Schedule (MicroSeconds (i), &SimulatorEventCountTestCase::NopArgs, this, i, i, i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (EventImpl::GetLiveCount (), base + 200, "Wrong number of live events");
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (EventImpl::GetLiveCount (), base, "Events were not released");
+  NS_TEST_EXPECT_MSG_EQ (EventImpl::GetPeakCount (), peak + 200, "Wrong peak number of events");
+
+  EventId id = Simulator::Schedule (MicroSeconds (1), &SimulatorEventCountTestCase::Nop, this);
+  EventImpl *first = id.PeekEventImpl ();
+  id = EventId ();
+  Simulator::Run ();
+  id = Simulator::Schedule (MicroSeconds (1), &SimulatorEventCountTestCase::Nop, this);
+  NS_TEST_EXPECT_MSG_EQ (id.PeekEventImpl (), first, "The memory of the last event was not reused");
+  id = EventId ();
+  Simulator::Destroy ();
+  NS_TEST_EXPECT_MSG_EQ (EventImpl::GetLiveCount (), base, "Events were not released by Destroy");
+
+  // events freed by another thread are counted, and kept on its
+  // free lists only up to their limit.
+  std::vector<EventImpl *> events;
+  for (uint32_t i = 0; i < 2 * EventImpl::Allocator::MAX_FREE_BLOCKS; ++i)
+    {
+      events.push_back (MakeEvent (&SimulatorEventCountTestCase::Nop, this));
+    }
+  NS_TEST_EXPECT_MSG_EQ (EventImpl::GetLiveCount (), base + events.size (), "Wrong number of live events");
+  SizeClassAllocatorStatistics statistics;
+  std::thread releaser ([&events, &statistics] ()
+                        {
+                          for (std::vector<EventImpl *>::iterator i = events.begin (); i != events.end (); ++i)
+                            {
+                              (*i)->Unref ();
+                            }
+                          statistics = EventImpl::Allocator::GetStatistics ();
+                        });
+  releaser.join ();
+  NS_TEST_EXPECT_MSG_EQ (EventImpl::GetLiveCount (), base, "Events freed by another thread were not counted");
+  NS_TEST_EXPECT_MSG_EQ (statistics.freeBlocks, EventImpl::Allocator::MAX_FREE_BLOCKS, "The free list is not limited");
+}
+
+/**
+ * Check the event profile written by the default simulator.
+ */
+class SimulatorProfileTestCase : public TestCase
+{
+public:
+  SimulatorProfileTestCase ();
+private:
+  virtual void DoRun (void);
+  /** A profiled event. */
+  void Profiled (void);
+  /**
+   * Run a few events with profiling enabled.
+   *
+   * \param [in] format The profile format.
+   * \returns The profile.
+   */
+  std::string RunProfile (EventProfiler::Format format);
+};
+
+SimulatorProfileTestCase::SimulatorProfileTestCase ()
+  : TestCase ("Check the event profile of the default simulator")
+{
+}
+
+void
+SimulatorProfileTestCase::Profiled (void)
+{
+}
+
+std::string
+SimulatorProfileTestCase::RunProfile (EventProfiler::Format format)
+{
+  std::string filename = CreateTempDirFilename ("event-profile.txt");
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::DefaultSimulatorImpl");
+  factory.Set ("ProfileFile", StringValue (filename));
+  factory.Set ("ProfileFormat", EnumValue (format));
+  Simulator::SetImplementation (factory.Create<SimulatorImpl> ());
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      Simulator::ScheduleWithContext (7, MicroSeconds (i), &SimulatorProfileTestCase::Profiled, this);
+    }
+  EventId cancelled = Simulator::Schedule (MicroSeconds (5), &SimulatorProfileTestCase::Profiled, this);
+  Simulator::Cancel (cancelled);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::ifstream is (filename.c_str ());
+  std::ostringstream oss;
+  oss << is.rdbuf ();
+  return oss.str ();
+}
+
+void
+SimulatorProfileTestCase::DoRun (void)
+{
+  std::string report = RunProfile (EventProfiler::REPORT);
+  NS_TEST_EXPECT_MSG_NE (report.find ("Event profile: 11 events"), std::string::npos,
+                         "Wrong event count in " << report);
+  NS_TEST_EXPECT_MSG_NE (report.find ("SimulatorProfileTestCase::Profiled"), std::string::npos,
+                         "Function not named in " << report);
+  NS_TEST_EXPECT_MSG_NE (report.find ("context 7"), std::string::npos,
+                         "Context missing from " << report);
+  NS_TEST_EXPECT_MSG_NE (report.find ("(cancelled events)"), std::string::npos,
+                         "Cancelled events missing from " << report);
+
+  std::string folded = RunProfile (EventProfiler::FOLDED);
+  NS_TEST_EXPECT_MSG_EQ (folded.find ("context 7;"), 0, "Wrong folded stacks " << folded);
+  NS_TEST_EXPECT_MSG_NE (folded.find ("SimulatorProfileTestCase::Profiled"), std::string::npos,
+                         "Function not named in " << folded);
+}
+
+/**
+ * Check the progress reports of the default simulator.
+ */
+class SimulatorProgressTestCase : public TestCase
+{
+public:
+  SimulatorProgressTestCase ();
+private:
+  virtual void DoRun (void);
+  /** An event which takes a millisecond of wall clock time. */
+  void Busy (void);
+  /**
+   * Run a simulation with progress reports.
+   *
+   * \param [in] format The report format.
+   * \param [in] checkpoint If positive, stop and run again at this time.
+   * \returns The reports.
+   */
+  std::vector<std::string> RunProgress (ProgressReporter::Format format,
+                                        Time checkpoint = Time (0));
+};
+
+SimulatorProgressTestCase::SimulatorProgressTestCase ()
+  : TestCase ("Check the progress reports of the default simulator")
+{
+}
+
+void
+SimulatorProgressTestCase::Busy (void)
+{
+  std::chrono::steady_clock::time_point end =
+    std::chrono::steady_clock::now () + std::chrono::milliseconds (1);
+  while (std::chrono::steady_clock::now () < end)
+    {
+    }
+}
+
+std::vector<std::string>
+SimulatorProgressTestCase::RunProgress (ProgressReporter::Format format, Time checkpoint)
+{
+  std::string filename = CreateTempDirFilename ("progress.txt");
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::DefaultSimulatorImpl");
+  factory.Set ("ProgressInterval", TimeValue (MilliSeconds (10)));
+  factory.Set ("ProgressFile", StringValue (filename));
+  factory.Set ("ProgressFormat", EnumValue (format));
+  Simulator::SetImplementation (factory.Create<SimulatorImpl> ());
+  for (uint32_t i = 1; i <= 100; ++i)
+    {
+      Simulator::Schedule (MilliSeconds (i), &SimulatorProgressTestCase::Busy, this);
+    }
+  if (checkpoint.IsStrictlyPositive ())
+    {
+      Simulator::Stop (checkpoint);
+      Simulator::Run ();
+    }
+  Simulator::Stop (Seconds (1) - Simulator::Now ());
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::ifstream is (filename.c_str ());
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline (is, line))
+    {
+      lines.push_back (line);
+    }
+  return lines;
+}
+
+void
+SimulatorProgressTestCase::DoRun (void)
+{
+  std::vector<std::string> lines = RunProgress (ProgressReporter::JSON);
+  // about 10 reports during the 100 ms of the simulation
+  NS_TEST_ASSERT_MSG_GT (lines.size (), 3, "Too few progress reports");
+  for (uint32_t i = 0; i + 1 < lines.size (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (lines[i].find ("{\"state\":\"running\""), 0, "Wrong report " << lines[i]);
+      NS_TEST_EXPECT_MSG_EQ (lines[i].find ("\"eta\":null"), std::string::npos,
+                             "No estimated time left in " << lines[i]);
+    }
+  std::string last = lines.back ();
+  NS_TEST_EXPECT_MSG_EQ (last.find ("{\"state\":\"done\""), 0, "Wrong last report " << last);
+  // the 100 events, and the stop event
+  NS_TEST_EXPECT_MSG_NE (last.find ("\"events\":101,"), std::string::npos, "Wrong event count in " << last);
+  NS_TEST_EXPECT_MSG_NE (last.find ("\"sim\":1.000000000,"), std::string::npos, "Wrong time in " << last);
+  NS_TEST_EXPECT_MSG_EQ (last.find ("\"rss\":0,"), std::string::npos, "No memory in " << last);
+
+  lines = RunProgress (ProgressReporter::TEXT);
+  NS_TEST_ASSERT_MSG_GT (lines.size (), 3, "Too few progress reports");
+  NS_TEST_EXPECT_MSG_EQ (lines.back ().find ("progress: done"), 0, "Wrong last report " << lines.back ());
+  NS_TEST_EXPECT_MSG_NE (lines.front ().find ("events/s"), std::string::npos, "Wrong report " << lines.front ());
+
+  // After a checkpoint, the time left is estimated from the new stop
+  // time, not from the one already reached.
+  lines = RunProgress (ProgressReporter::JSON, MilliSeconds (20));
+  uint32_t resumed = 0;
+  while (resumed < lines.size () && lines[resumed].find ("{\"state\":\"done\"") != 0)
+    {
+      ++resumed;
+    }
+  ++resumed;
+  NS_TEST_ASSERT_MSG_LT (resumed + 1, lines.size (), "No report after the checkpoint");
+  NS_TEST_EXPECT_MSG_EQ (lines[resumed].find ("{\"state\":\"running\""), 0, "Wrong report " << lines[resumed]);
+  NS_TEST_EXPECT_MSG_EQ (lines[resumed].find ("\"eta\":0.0}"), std::string::npos,
+                         "Time left estimated from a past stop time in " << lines[resumed]);
+}
+
+/**
+ * Check the binary DES Metrics traces.
+ */
+class SimulatorDesMetricsTestCase : public TestCase
+{
+public:
+  SimulatorDesMetricsTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Trace an event sent to another context.
+   *
+   * \param [in] context The context of the new event.
+   */
+  void Send (uint32_t context);
+};
+
+SimulatorDesMetricsTestCase::SimulatorDesMetricsTestCase ()
+  : TestCase ("Check the binary DES Metrics traces")
+{
+}
+
+void
+SimulatorDesMetricsTestCase::Send (uint32_t context)
+{
+  DesMetrics::Get ()->TraceWithContext (context, Simulator::Now (), MicroSeconds (context));
+}
+
+void
+SimulatorDesMetricsTestCase::DoRun (void)
+{
+  const uint32_t n = 40000;   // more than one buffer of records
+  std::string name = "des-metrics-test";
+  std::string filename = CreateTempDirFilename (name + ".desm");
+  std::string dir = filename.substr (0, filename.size () - name.size () - 6);
+  Config::SetGlobal ("DesMetricsFormat", EnumValue (DesMetrics::BINARY));
+  char program[] = "des-metrics-test";
+  char *argv[] = { program };
+  DesMetrics::Get ()->Initialize (1, argv, dir);
+  Config::SetGlobal ("DesMetricsFormat", EnumValue (DesMetrics::JSON));
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      Simulator::ScheduleWithContext (i % 8, MicroSeconds (i), &SimulatorDesMetricsTestCase::Send, this, 8 + i % 3);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  DesMetrics::Get ()->Flush ();
+
+  std::ifstream is (filename.c_str (), std::ios::in | std::ios::binary);
+  DesMetrics::BinaryHeader header;
+  NS_TEST_ASSERT_MSG_EQ (DesMetrics::ReadBinaryHeader (is, header), true, "Wrong header in " << filename);
+  NS_TEST_EXPECT_MSG_EQ (header.modelName, "des-metrics-test", "Wrong model name");
+  NS_TEST_EXPECT_MSG_EQ (header.resolution, static_cast<uint64_t> (TimeStep (1).GetFemtoSeconds ()), "Wrong resolution");
+  DesMetrics::Record record;
+  uint32_t count = 0;
+  bool right = true;
+  while (DesMetrics::ReadRecord (is, record))
+    {
+      uint32_t i = count;
+      right = right
+        && record.sendContext == i % 8
+        && record.recvContext == 8 + i % 3
+        && record.sendTime == MicroSeconds (i).GetTimeStep ()
+        && record.recvTime == MicroSeconds (i + 8 + i % 3).GetTimeStep ();
+      count++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (count, n, "Wrong number of records");
+  NS_TEST_EXPECT_MSG_EQ (right, true, "Wrong records");
+}
+
+#ifdef HAVE_SYS_WAIT_H
+/**
+ * Check that Simulator::ForkAt continues a simulation in child
+ * processes, and that reseeded children draw different values.
+ */
+class SimulatorForkTestCase : public TestCase
+{
+public:
+  SimulatorForkTestCase ();
+private:
+  virtual void DoRun (void);
+  /** Draw a value from the random variable. */
+  void Draw (void);
+  /** The random variable shared by the warm-up and the children. */
+  Ptr<UniformRandomVariable> m_random;
+  /** The last value drawn. */
+  double m_value;
+  /** The number of values drawn. */
+  uint32_t m_draws;
+};
+
+SimulatorForkTestCase::SimulatorForkTestCase ()
+  : TestCase ("Check that Simulator::ForkAt continues the simulation in children")
+{
+}
+
+void
+SimulatorForkTestCase::Draw (void)
+{
+  m_value = m_random->GetValue ();
+  ++m_draws;
+}
+
+void
+SimulatorForkTestCase::DoRun (void)
+{
+  const uint32_t n = 4;
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_draws = 0;
+  Simulator::Schedule (Seconds (5), &SimulatorForkTestCase::Draw, this);
+  Simulator::Schedule (Seconds (20), &SimulatorForkTestCase::Draw, this);
+
+  uint64_t run = RngSeedManager::GetRun ();
+  uint32_t child = Simulator::ForkAt (Seconds (10), n, 2);
+  if (child != 0)
+    {
+      // Only the exit status and the file reach the parent, so the
+      // checks of the child cannot use the test macros.
+      bool ok = Simulator::Now () == Seconds (10) && m_draws == 1;
+      RngSeedManager::SetRun (run + child);
+      RandomVariableStream::ReseedAll ();
+      Simulator::Run ();
+      ok = ok && Simulator::Now () == Seconds (20) && m_draws == 2;
+      std::ostringstream oss;
+      oss << "fork-" << child;
+      std::ofstream os (CreateTempDirFilename (oss.str ()).c_str ());
+      os.precision (17);
+      os << m_value << std::endl;
+      os.close ();
+      _exit (ok && os ? 0 : 1);
+    }
+
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), Seconds (10), "The parent did not stop at the checkpoint");
+  NS_TEST_EXPECT_MSG_EQ (m_draws, 1, "The parent ran past the checkpoint");
+  std::set<double> values;
+  for (uint32_t i = 1; i <= n; ++i)
+    {
+      std::ostringstream oss;
+      oss << "fork-" << i;
+      std::ifstream is (CreateTempDirFilename (oss.str ()).c_str ());
+      double value = -1;
+      is >> value;
+      NS_TEST_EXPECT_MSG_EQ (is.fail (), false, "No value from child " << i);
+      values.insert (value);
+    }
+  NS_TEST_EXPECT_MSG_EQ (values.size (), n, "Reseeded children drew the same values");
+  Simulator::Destroy ();
+  m_random = 0;
+}
+#endif /* HAVE_SYS_WAIT_H */
+
+#ifdef ENABLE_THREAD_LOCAL_SIMULATOR
+/**
+ * Check that threads run independent simulations when the simulator
+ * is thread-local.
+ */
+class SimulatorThreadLocalTestCase : public TestCase
+{
+public:
+  SimulatorThreadLocalTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Run one replication in the calling thread.
+   *
+   * \param [in] test The test case.
+   * \param [in] i The index of the replication.
+   */
+  static void Replicate (SimulatorThreadLocalTestCase *test, uint32_t i);
+  /**
+   * Draw a value from a random variable.
+   *
+   * \param [in] random The random variable.
+   * \param [in] value Where to store the value.
+   */
+  static void Draw (Ptr<UniformRandomVariable> random, double *value);
+
+  /** The number of replications. */
+  static const uint32_t N = 3;
+  /** The run number of each replication. */
+  uint64_t m_runs[N];
+  /** The value drawn by each replication. */
+  double m_values[N];
+  /** The time at which each replication ended. */
+  Time m_ends[N];
+  /** Whether each replication found its own name. */
+  bool m_named[N];
+};
+
+SimulatorThreadLocalTestCase::SimulatorThreadLocalTestCase ()
+  : TestCase ("Check that threads run independent thread-local simulations")
+{
+}
+
+void
+SimulatorThreadLocalTestCase::Draw (Ptr<UniformRandomVariable> random, double *value)
+{
+  *value = random->GetValue ();
+}
+
+void
+SimulatorThreadLocalTestCase::Replicate (SimulatorThreadLocalTestCase *test, uint32_t i)
+{
+  RngSeedManager::SetRun (test->m_runs[i]);
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  Ptr<Object> object = CreateObject<Object> ();
+  Names::Add ("replication", object);
+  Simulator::Schedule (Seconds (i + 1), &SimulatorThreadLocalTestCase::Draw,
+                       random, &test->m_values[i]);
+  Simulator::Run ();
+  test->m_ends[i] = Simulator::Now ();
+  test->m_named[i] = Names::Find<Object> ("replication") == object;
+  Names::Clear ();
+  Simulator::Destroy ();
+}
+
+void
+SimulatorThreadLocalTestCase::DoRun (void)
+{
+  m_runs[0] = 1;
+  m_runs[1] = 1;
+  m_runs[2] = 2;
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < N; ++i)
+    {
+      threads.push_back (Create<SystemThread> (MakeBoundCallback (&SimulatorThreadLocalTestCase::Replicate, this, i)));
+      threads[i]->Start ();
+    }
+  for (uint32_t i = 0; i < N; ++i)
+    {
+      threads[i]->Join ();
+    }
+
+  for (uint32_t i = 0; i < N; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_ends[i], Seconds (i + 1), "Replication " << i << " ran the events of another thread");
+      NS_TEST_EXPECT_MSG_EQ (m_named[i], true, "Replication " << i << " did not find its own name");
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_values[0], m_values[1], "Replications with the same run drew different values");
+  NS_TEST_EXPECT_MSG_NE (m_values[0], m_values[2], "Replications with different runs drew the same value");
+}
+#endif /* ENABLE_THREAD_LOCAL_SIMULATOR */
+
 class SimulatorTemplateTestCase : public TestCase
 {
 public:
@@ -475,5 +1297,32 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+
+    std::string schedulerTypes[] = {
+      "ns3::ListScheduler",
+      "ns3::HeapScheduler",
+      "ns3::MapScheduler",
+      "ns3::CalendarScheduler",
+      "ns3::LadderScheduler"
+    };
+    for (uint32_t i = 0; i < sizeof (schedulerTypes) / sizeof (schedulerTypes[0]); ++i)
+      {
+        factory.SetTypeId (schedulerTypes[i]);
+        AddTestCase (new SimulatorRandomEventsTestCase (factory), TestCase::QUICK);
+        AddTestCase (new SimulatorCompactionTestCase (factory), TestCase::QUICK);
+        AddTestCase (new SimulatorBatchTestCase (factory), TestCase::QUICK);
+      }
+    AddTestCase (new SimulatorEventCountTestCase (), TestCase::QUICK);
+    AddTestCase (new SimulatorProfileTestCase (), TestCase::QUICK);
+    AddTestCase (new SimulatorProgressTestCase (), TestCase::QUICK);
+    AddTestCase (new SimulatorDesMetricsTestCase (), TestCase::QUICK);
+#ifdef HAVE_SYS_WAIT_H
+    AddTestCase (new SimulatorForkTestCase (), TestCase::QUICK);
+#endif /* HAVE_SYS_WAIT_H */
+#ifdef ENABLE_THREAD_LOCAL_SIMULATOR
+    AddTestCase (new SimulatorThreadLocalTestCase (), TestCase::QUICK);
+#endif /* ENABLE_THREAD_LOCAL_SIMULATOR */
   }
 } g_simulatorTestSuite;
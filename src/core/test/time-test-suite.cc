@@ -20,8 +20,10 @@
  * TimeStep support by Emmanuelle Laprise <emmanuelle.laprise@bluekazoo.ca>
  */
 
+#include <cmath>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <string>
 #include <sstream>
 
@@ -230,6 +232,63 @@ TimeInputOutputTestCase::DoRun (void)
   std::cout << std::endl;
 }
     
+/**
+ * Check that the integer fast paths of Time::ToDouble() and
+ * Time::FromDouble() give the same results as the int64x64_t
+ * conversions, Time::To() and Time::From().
+ */
+class TimeFastPathTestCase : public TestCase
+{
+public:
+  TimeFastPathTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TimeFastPathTestCase::TimeFastPathTestCase ()
+  : TestCase ("Check the integer fast paths of the unit conversions")
+{
+}
+
+void
+TimeFastPathTestCase::DoRun (void)
+{
+  const Time::Unit units[] = { Time::Y, Time::D, Time::H, Time::MIN, Time::S,
+                               Time::MS, Time::US, Time::NS, Time::PS, Time::FS };
+  // A simple linear congruential generator, to cover all magnitudes.
+  uint64_t state = 12345;
+  for (uint32_t i = 0; i < 5000; ++i)
+    {
+      state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+      int64_t data = static_cast<int64_t> (state) >> (state % 63);
+      Time t = TimeStep (data);
+      for (uint32_t j = 0; j < sizeof (units) / sizeof (units[0]); ++j)
+        {
+          if (units[j] > Time::GetResolution ()
+              && std::abs (static_cast<double> (data)) * 1e6 > 9e18)
+            {
+              // To () would overflow
+              continue;
+            }
+          double expected = t.To (units[j]).GetDouble ();
+          double actual = t.ToDouble (units[j]);
+          NS_TEST_ASSERT_MSG_EQ (actual, expected, "ToDouble of " << data << " steps, unit " << units[j]);
+
+          // Some value in [-1, 1) times 2^e, within the range of Time
+          double value = std::ldexp (static_cast<double> (static_cast<int64_t> (state)),
+                                     -63 - static_cast<int> ((state >> 8) % 80));
+          double max = Time (std::numeric_limits<int64_t>::max () / 4).ToDouble (units[j]);
+          value = std::fmod (value * 1e6, max);
+          Time expectedTime = Time::From (int64x64_t (value), units[j]);
+          Time actualTime = Time::FromDouble (value, units[j]);
+          NS_TEST_ASSERT_MSG_EQ (actualTime, expectedTime, "FromDouble of " << value << ", unit " << units[j]);
+        }
+    }
+  // Values just below a whole number of steps round down, as in From ()
+  NS_TEST_ASSERT_MSG_EQ (Seconds (0.3), Time::From (int64x64_t (0.3), Time::S), "Seconds (0.3)");
+  NS_TEST_ASSERT_MSG_EQ (Seconds (-0.3), Time::From (int64x64_t (-0.3), Time::S), "Seconds (-0.3)");
+}
+
 static class TimeTestSuite : public TestSuite
 {
 public:
@@ -238,6 +297,7 @@ public:
   {
     AddTestCase (new TimeWithSignTestCase (), TestCase::QUICK);
     AddTestCase (new TimeInputOutputTestCase (), TestCase::QUICK);
+    AddTestCase (new TimeFastPathTestCase (), TestCase::QUICK);
     // This should be last, since it changes the resolution
     AddTestCase (new TimeSimpleTestCase (), TestCase::QUICK);
   }
@@ -108,6 +108,72 @@ BasicTracedCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_two, true, "Callback CbTwo not called");
 }
 
+class ChainTracedCallbackTestCase : public TestCase
+{
+public:
+  ChainTracedCallbackTestCase ();
+  virtual ~ChainTracedCallbackTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  void CbFirst (uint32_t a);
+  void CbSecond (uint32_t a);
+
+  TracedCallback<uint32_t> m_trace;
+  std::string m_calls;
+};
+
+ChainTracedCallbackTestCase::ChainTracedCallbackTestCase ()
+  : TestCase ("Check TracedCallback chain modifications")
+{
+}
+
+void
+ChainTracedCallbackTestCase::CbFirst (uint32_t a)
+{
+  m_calls += "1";
+  // only affects the next invocations
+  m_trace.DisconnectWithoutContext (MakeCallback (&ChainTracedCallbackTestCase::CbFirst, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&ChainTracedCallbackTestCase::CbSecond, this));
+}
+
+void
+ChainTracedCallbackTestCase::CbSecond (uint32_t a)
+{
+  m_calls += "2";
+}
+
+void
+ChainTracedCallbackTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), true, "New TracedCallback not empty");
+  m_trace (0);
+
+  m_trace.ConnectWithoutContext (MakeCallback (&ChainTracedCallbackTestCase::CbFirst, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&ChainTracedCallbackTestCase::CbSecond, this));
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), false, "Connected TracedCallback empty");
+  TracedCallback<uint32_t> copy = m_trace;
+
+  m_trace (1);
+  NS_TEST_EXPECT_MSG_EQ (m_calls, "12", "Callbacks not called in order");
+  m_calls = "";
+  m_trace (2);
+  NS_TEST_EXPECT_MSG_EQ (m_calls, "22", "Chain not modified by a Callback");
+  NS_TEST_EXPECT_MSG_EQ (TracedCallbackDepth<>::value, 0, "Firing not completed");
+
+  // the copy keeps its own chain
+  m_calls = "";
+  copy (3);
+  NS_TEST_EXPECT_MSG_EQ (m_calls, "12", "Copy of a TracedCallback modified");
+
+  m_trace.DisconnectWithoutContext (MakeCallback (&ChainTracedCallbackTestCase::CbSecond, this));
+  NS_TEST_EXPECT_MSG_EQ (m_trace.IsEmpty (), true, "Disconnected TracedCallback not empty");
+  m_calls = "";
+  m_trace (4);
+  NS_TEST_EXPECT_MSG_EQ (m_calls, "", "Disconnected Callback called");
+}
+
 class TracedCallbackTestSuite : public TestSuite
 {
 public:
@@ -118,6 +184,7 @@ TracedCallbackTestSuite::TracedCallbackTestSuite ()
   : TestSuite ("traced-callback", UNIT)
 {
   AddTestCase (new BasicTracedCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new ChainTracedCallbackTestCase, TestCase::QUICK);
 }
 
 static TracedCallbackTestSuite tracedCallbackTestSuite;
@@ -223,19 +223,22 @@ CsmaChannel::TransmitEnd ()
   NS_LOG_LOGIC ("Receive");
 
   std::vector<CsmaDeviceRec>::iterator it;
+  std::vector<Simulator::BatchEvent> batch;
+  batch.reserve (m_deviceList.size ());
   uint32_t devId = 0;
   for (it = m_deviceList.begin (); it < m_deviceList.end (); it++)
     {
       if (it->IsActive ())
         {
           // schedule reception events
-          Simulator::ScheduleWithContext (it->devicePtr->GetNode ()->GetId (),
-                                          m_delay,
-                                          &CsmaNetDevice::Receive, it->devicePtr,
-                                          m_currentPkt->Copy (), m_deviceList[m_currentSrc].devicePtr);
+          batch.push_back (Simulator::BatchEvent (it->devicePtr->GetNode ()->GetId (),
+                                                  m_delay,
+                                                  MakeEvent (&CsmaNetDevice::Receive, it->devicePtr,
+                                                             m_currentPkt->Copy (), m_deviceList[m_currentSrc].devicePtr)));
         }
       devId++;
     }
+  Simulator::ScheduleBatch (batch);
 
   // also schedule for the tx side to go back to IDLE
   Simulator::Schedule (m_delay, &CsmaChannel::PropagationCompleteEvent,
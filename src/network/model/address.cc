@@ -24,6 +24,7 @@
 #include <cstring>
 #include <iostream>
 #include <iomanip>
+#include <atomic>
 
 namespace ns3 {
 
@@ -138,9 +139,10 @@ uint8_t
 Address::Register (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  static uint8_t type = 1;
-  type++;
-  return type;
+  // Address types are shared by all the simulation threads, and may
+  // be registered by any of them.
+  static std::atomic<uint8_t> type (1);
+  return ++type;
 }
 
 uint32_t
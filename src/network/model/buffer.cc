@@ -20,6 +20,10 @@
 #include "buffer.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/unused.h"
+#ifdef ENABLE_OBJECT_ACCOUNTING
+#include "ns3/object-accounting.h"
+#endif
 
 #define LOG_INTERNAL_STATE(y)                                                                    \
   NS_LOG_LOGIC (y << "start="<<m_start<<", end="<<m_end<<", zero start="<<m_zeroAreaStart<<              \
@@ -49,8 +53,36 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Buffer");
 
+#ifdef ENABLE_OBJECT_ACCOUNTING
+/**
+ * \ingroup packet
+ * Get the ObjectAccounting counter of the Buffer::Data blocks.
+ * \returns The counter.
+ */
+static ObjectAccounting::Counter *
+GetDataCounter (void)
+{
+  static ObjectAccounting::Counter *counter =
+    ObjectAccounting::GetCounter ("ns3::Buffer::Data", 0);
+  return counter;
+}
+
+/**
+ * \ingroup packet
+ * Get the ObjectAccounting counter of the Buffer::Payload blocks.
+ * \returns The counter.
+ */
+static ObjectAccounting::Counter *
+GetPayloadCounter (void)
+{
+  static ObjectAccounting::Counter *counter =
+    ObjectAccounting::GetCounter ("ns3::Buffer::Payload", 0);
+  return counter;
+}
+#endif
 
-uint32_t Buffer::g_recommendedStart = 0;
+
+NS_SIMULATION_LOCAL uint32_t Buffer::g_recommendedStart = 0;
 #ifdef BUFFER_FREE_LIST
 /* The following macros are pretty evil but they are needed to allow us to
  * keep track of 3 possible states for the g_freeList variable:
@@ -75,9 +107,9 @@ uint32_t Buffer::g_recommendedStart = 0;
 #define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
 #define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
 #define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
-struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
+NS_SIMULATION_LOCAL uint32_t Buffer::g_maxSize = 0;
+NS_SIMULATION_LOCAL Buffer::FreeList *Buffer::g_freeList = 0;
+NS_SIMULATION_LOCAL struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
 
 Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
 {
@@ -100,6 +132,11 @@ Buffer::Recycle (struct Buffer::Data *data)
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
   NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
+  if (data->m_payload != 0)
+    {
+      UnrefPayload (data->m_payload);
+      data->m_payload = 0;
+    }
   g_maxSize = std::max (g_maxSize, data->m_size);
   /* feed into free list */
   if (data->m_size < g_maxSize ||
@@ -123,6 +160,9 @@ Buffer::Create (uint32_t dataSize)
   if (IS_UNINITIALIZED (g_freeList))
     {
       g_freeList = new Buffer::FreeList ();
+      // A thread_local destructor only runs if the variable was used
+      // by the thread.
+      NS_UNUSED (&g_localStaticDestructor);
     }
   else if (IS_INITIALIZED (g_freeList))
     {
@@ -148,6 +188,11 @@ Buffer::Recycle (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
+  if (data->m_payload != 0)
+    {
+      UnrefPayload (data->m_payload);
+      data->m_payload = 0;
+    }
   Deallocate (data);
 }
 
@@ -173,6 +218,10 @@ Buffer::Allocate (uint32_t reqSize)
   struct Buffer::Data *data = reinterpret_cast<struct Buffer::Data*>(b);
   data->m_size = reqSize;
   data->m_count = 1;
+  data->m_payload = 0;
+#ifdef ENABLE_OBJECT_ACCOUNTING
+  ObjectAccounting::Add (GetDataCounter (), size);
+#endif
   return data;
 }
 
@@ -181,10 +230,48 @@ Buffer::Deallocate (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
+#ifdef ENABLE_OBJECT_ACCOUNTING
+  ObjectAccounting::Remove (GetDataCounter (),
+                            data->m_size - 1 + sizeof (struct Buffer::Data));
+#endif
   uint8_t *buf = reinterpret_cast<uint8_t *> (data);
   delete [] buf;
 }
 
+struct Buffer::Payload *
+Buffer::AllocatePayload (uint32_t size)
+{
+  NS_LOG_FUNCTION (size);
+  uint32_t reqSize = std::max (size, 1U);
+  uint32_t allocSize = reqSize - 1 + sizeof (struct Buffer::Payload);
+  uint8_t *b = new uint8_t [allocSize];
+  struct Buffer::Payload *payload = reinterpret_cast<struct Buffer::Payload*>(b);
+  payload->m_size = reqSize;
+  // the Buffer::Data which references it takes the first count.
+  payload->m_count = 0;
+#ifdef ENABLE_OBJECT_ACCOUNTING
+  ObjectAccounting::Add (GetPayloadCounter (), allocSize);
+#endif
+  return payload;
+}
+
+void
+Buffer::UnrefPayload (struct Buffer::Payload *payload)
+{
+  NS_LOG_FUNCTION (payload);
+  NS_ASSERT (payload->m_count > 0);
+  payload->m_count--;
+  if (payload->m_count == 0)
+    {
+#ifdef ENABLE_OBJECT_ACCOUNTING
+      ObjectAccounting::Remove (GetPayloadCounter (),
+                                payload->m_size - 1 + sizeof (struct Buffer::Payload));
+#endif
+      uint8_t *buf = reinterpret_cast<uint8_t *> (payload);
+      delete [] buf;
+    }
+}
+
 Buffer::Buffer ()
 {
   NS_LOG_FUNCTION (this);
@@ -206,6 +293,19 @@ Buffer::Buffer (uint32_t dataSize, bool initialize)
     }
 }
 
+Buffer::Buffer (uint8_t const *payload, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << &payload << size);
+  if (size == 0)
+    {
+      Initialize (0);
+      return;
+    }
+  struct Buffer::Payload *data = AllocatePayload (size);
+  memcpy (data->m_data, payload, size);
+  Initialize (data, 0, size);
+}
+
 bool
 Buffer::CheckInternalState (void) const
 {
@@ -250,11 +350,26 @@ Buffer::Initialize (uint32_t zeroSize)
   m_zeroAreaStart = m_start;
   m_zeroAreaEnd = m_zeroAreaStart + zeroSize;
   m_end = m_zeroAreaEnd;
+  m_payloadStart = 0;
   m_data->m_dirtyStart = m_start;
   m_data->m_dirtyEnd = m_end;
   NS_ASSERT (CheckInternalState ());
 }
 
+void
+Buffer::Initialize (struct Buffer::Payload *payload, uint32_t payloadStart, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << payload << payloadStart << size);
+  Initialize (size);
+  if (payload != 0)
+    {
+      NS_ASSERT (payloadStart + size <= payload->m_size);
+      m_data->m_payload = payload;
+      payload->m_count++;
+      m_payloadStart = payloadStart;
+    }
+}
+
 Buffer &
 Buffer::operator = (Buffer const&o)
 {
@@ -276,6 +391,7 @@ Buffer::operator = (Buffer const&o)
   m_zeroAreaEnd = o.m_zeroAreaEnd;
   m_start = o.m_start;
   m_end = o.m_end;
+  m_payloadStart = o.m_payloadStart;
   NS_ASSERT (CheckInternalState ());
   return *this;
 }
@@ -328,6 +444,12 @@ Buffer::AddAtStart (uint32_t start)
       uint32_t newSize = GetInternalSize () + start;
       struct Buffer::Data *newData = Buffer::Create (newSize);
       memcpy (newData->m_data + start, m_data->m_data + m_start, GetInternalSize ());
+      // the payload bytes are shared, not copied.
+      newData->m_payload = m_data->m_payload;
+      if (newData->m_payload != 0)
+        {
+          newData->m_payload->m_count++;
+        }
       m_data->m_count--;
       if (m_data->m_count == 0)
         {
@@ -373,6 +495,12 @@ Buffer::AddAtEnd (uint32_t end)
       uint32_t newSize = GetInternalSize () + end;
       struct Buffer::Data *newData = Buffer::Create (newSize);
       memcpy (newData->m_data, m_data->m_data + m_start, GetInternalSize ());
+      // the payload bytes are shared, not copied.
+      newData->m_payload = m_data->m_payload;
+      if (newData->m_payload != 0)
+        {
+          newData->m_payload->m_count++;
+        }
       m_data->m_count--;
       if (m_data->m_count == 0) 
         {
@@ -400,7 +528,17 @@ void
 Buffer::AddAtEnd (const Buffer &o)
 {
   NS_LOG_FUNCTION (this << &o);
+  if (o.GetSize () == 0)
+    {
+      return;
+    }
+  uint32_t zeroSize = m_zeroAreaEnd - m_zeroAreaStart;
+  uint32_t oZeroSize = o.m_zeroAreaEnd - o.m_zeroAreaStart;
+  struct Buffer::Payload *payload = zeroSize > 0 ? m_data->m_payload : 0;
+  struct Buffer::Payload *oPayload = oZeroSize > 0 ? o.m_data->m_payload : 0;
   if (m_data->m_count == 1 &&
+      m_data->m_payload == 0 &&
+      oPayload == 0 &&
       m_end == m_zeroAreaEnd &&
       m_end == m_data->m_dirtyEnd &&
       o.m_start == o.m_zeroAreaStart &&
@@ -411,8 +549,7 @@ Buffer::AddAtEnd (const Buffer &o)
        * we attempt to aggregate two buffers which contain
        * adjacent zero areas.
        */
-      uint32_t zeroSize = o.m_zeroAreaEnd - o.m_zeroAreaStart;
-      m_zeroAreaEnd += zeroSize;
+      m_zeroAreaEnd += oZeroSize;
       m_end = m_zeroAreaEnd;
       m_data->m_dirtyEnd = m_zeroAreaEnd;
       uint32_t endData = o.m_end - o.m_zeroAreaEnd;
@@ -425,6 +562,67 @@ Buffer::AddAtEnd (const Buffer &o)
       NS_ASSERT (CheckInternalState ());
       return;
     }
+  if (oPayload != 0 && zeroSize == 0 && m_data != o.m_data)
+    {
+      /**
+       * Keep sharing the payload bytes of o: only the real
+       * bytes of both buffers are copied.
+       */
+      Buffer dst = o;
+      dst.AddAtStart (GetSize ());
+      dst.Begin ().Write (Begin (), End ());
+      *this = dst;
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
+  if (payload != 0 && oZeroSize == 0 && m_data != o.m_data)
+    {
+      uint32_t size = o.GetSize ();
+      AddAtEnd (size);
+      Buffer::Iterator dst = End ();
+      dst.Prev (size);
+      dst.Write (o.Begin (), o.End ());
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
+  if (payload != 0 || oPayload != 0)
+    {
+      /**
+       * The zero area of the result covers both zero areas and
+       * the real bytes in between. When they are adjacent slices
+       * of the same payload bytes, it is a slice of them too;
+       * otherwise, the bytes are copied once into new payload
+       * bytes, which are shared from then on.
+       */
+      uint32_t endSize = m_end - m_zeroAreaStart;
+      uint32_t oStartSize = o.m_zeroAreaEnd - o.m_start;
+      uint32_t payloadStart = 0;
+      if (payload != 0 && payload == oPayload &&
+          m_end == m_zeroAreaEnd && o.m_start == o.m_zeroAreaStart &&
+          m_payloadStart + zeroSize == o.m_payloadStart)
+        {
+          payloadStart = m_payloadStart;
+        }
+      else
+        {
+          payload = AllocatePayload (endSize + oStartSize);
+          CreateFragment (m_zeroAreaStart - m_start, endSize).CopyData (payload->m_data, endSize);
+          o.CopyData (payload->m_data + endSize, oStartSize);
+        }
+      Buffer dst (0, false);
+      dst.Initialize (payload, payloadStart, endSize + oStartSize);
+      uint32_t dataStart = m_zeroAreaStart - m_start;
+      dst.AddAtStart (dataStart);
+      dst.Begin ().Write (m_data->m_data + m_start, dataStart);
+      uint32_t dataEnd = o.m_end - o.m_zeroAreaEnd;
+      dst.AddAtEnd (dataEnd);
+      Buffer::Iterator i = dst.End ();
+      i.Prev (dataEnd);
+      i.Write (o.m_data->m_data + o.m_zeroAreaStart, dataEnd);
+      *this = dst;
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
 
   Buffer dst = CreateFullCopy ();
   Buffer src = o.CreateFullCopy ();
@@ -457,6 +655,7 @@ Buffer::RemoveAtStart (uint32_t start)
       m_start = m_zeroAreaStart;
       m_zeroAreaEnd -= delta;
       m_end -= delta;
+      m_payloadStart += delta;
     } 
   else if (newStart <= m_end)
     {
@@ -467,12 +666,14 @@ Buffer::RemoveAtStart (uint32_t start)
       uint32_t zeroSize = m_zeroAreaEnd - m_zeroAreaStart;
       m_start = newStart - zeroSize;
       m_end -= zeroSize;
+      m_payloadStart += zeroSize;
       m_zeroAreaStart = m_start;
       m_zeroAreaEnd = m_start;
     }
   else 
     {
       /* remove all buffer */
+      m_payloadStart += m_zeroAreaEnd - m_zeroAreaStart;
       m_end -= m_zeroAreaEnd - m_zeroAreaStart;
       m_start = m_end;
       m_zeroAreaEnd = m_end;
@@ -539,7 +740,15 @@ Buffer::CreateFullCopy (void) const
     {
       Buffer tmp;
       tmp.AddAtStart (m_zeroAreaEnd - m_zeroAreaStart);
-      tmp.Begin ().WriteU8 (0, m_zeroAreaEnd - m_zeroAreaStart);
+      uint8_t const *payload = GetPayloadData ();
+      if (payload != 0)
+        {
+          tmp.Begin ().Write (payload, m_zeroAreaEnd - m_zeroAreaStart);
+        }
+      else
+        {
+          tmp.Begin ().WriteU8 (0, m_zeroAreaEnd - m_zeroAreaStart);
+        }
       uint32_t dataStart = m_zeroAreaStart - m_start;
       tmp.AddAtStart (dataStart);
       tmp.Begin ().Write (m_data->m_data+m_start, dataStart);
@@ -559,6 +768,11 @@ uint32_t
 Buffer::GetSerializedSize (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_data->m_payload != 0 && m_zeroAreaEnd > m_zeroAreaStart)
+    {
+      // only zeroes are serialized as a length.
+      return CreateFullCopy ().GetSerializedSize ();
+    }
   uint32_t dataStart = (m_zeroAreaStart - m_start + 3) & (~0x3);
   uint32_t dataEnd = (m_end - m_zeroAreaEnd + 3) & (~0x3);
 
@@ -579,6 +793,10 @@ uint32_t
 Buffer::Serialize (uint8_t* buffer, uint32_t maxSize) const
 {
   NS_LOG_FUNCTION (this << &buffer << maxSize);
+  if (m_data->m_payload != 0 && m_zeroAreaEnd > m_zeroAreaStart)
+    {
+      return CreateFullCopy ().Serialize (buffer, maxSize);
+    }
   uint32_t* p = reinterpret_cast<uint32_t *> (buffer);
   uint32_t size = 0;
 
@@ -726,7 +944,13 @@ Buffer::CopyData (std::ostream *os, uint32_t size) const
         { 
           size -= m_zeroAreaStart-m_start;
           tmpsize = std::min (m_zeroAreaEnd - m_zeroAreaStart, size);
+          uint8_t const *payload = GetPayloadData ();
           uint32_t left = tmpsize;
+          if (payload != 0)
+            {
+              os->write ((const char*)payload, left);
+              left = 0;
+            }
           while (left > 0)
             {
               uint32_t toWrite = std::min (left, g_zeroes.size);
@@ -757,7 +981,14 @@ Buffer::CopyData (uint8_t *buffer, uint32_t size) const
       if (size > 0) 
         { 
           tmpsize = std::min (m_zeroAreaEnd - m_zeroAreaStart, size);
+          uint8_t const *payload = GetPayloadData ();
           uint32_t left = tmpsize;
+          if (payload != 0)
+            {
+              memcpy (buffer, payload, left);
+              buffer += left;
+              left = 0;
+            }
           while (left > 0)
             {
               uint32_t toWrite = std::min (left, g_zeroes.size);
@@ -846,27 +1077,43 @@ Buffer::Iterator::Write (Iterator start, Iterator end)
   uint32_t size = end.m_current - start.m_current;
   NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
                  GetWriteErrorMessage ());
+  // the bytes written are all before, or all after, the zero area.
+  uint8_t *to;
+  if (m_current <= m_zeroStart)
+    {
+      to = &m_data[m_current];
+    }
+  else
+    {
+      to = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+    }
+  m_current += size;
   if (start.m_current <= start.m_zeroStart)
     {
       uint32_t toCopy = std::min (size, start.m_zeroStart - start.m_current);
-      memcpy (&m_data[m_current], &start.m_data[start.m_current], toCopy);
+      memcpy (to, &start.m_data[start.m_current], toCopy);
       start.m_current += toCopy;
-      m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   if (start.m_current <= start.m_zeroEnd)
     {
       uint32_t toCopy = std::min (size, start.m_zeroEnd - start.m_current);
-      memset (&m_data[m_current], 0, toCopy);
+      if (start.m_payload != 0 && toCopy > 0)
+        {
+          memcpy (to, &start.m_payload[start.m_current - start.m_zeroStart], toCopy);
+        }
+      else
+        {
+          memset (to, 0, toCopy);
+        }
       start.m_current += toCopy;
-      m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   uint32_t toCopy = std::min (size, start.m_dataEnd - start.m_current);
-  uint8_t *from = &start.m_data[start.m_current - (start.m_zeroEnd-start.m_zeroStart)];
-  uint8_t *to = &m_data[m_current];
+  uint8_t const *from = &start.m_data[start.m_current - (start.m_zeroEnd-start.m_zeroStart)];
   memcpy (to, from, toCopy);
-  m_current += toCopy;
 }
 
 void 
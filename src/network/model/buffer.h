@@ -24,6 +24,7 @@
 #include <vector>
 #include <ostream>
 #include "ns3/assert.h"
+#include "ns3/simulation-local.h"
 
 #define BUFFER_FREE_LIST 1
 
@@ -88,6 +89,14 @@ namespace ns3 {
  * \endverbatim
  *
  * A simple state invariant is that m_start <= m_zeroStart <= m_zeroEnd <= m_end
+ *
+ * The bytes of the zero area are not always zeroes: a Buffer created
+ * from real payload bytes keeps them in a read-only, reference-counted
+ * Buffer::Payload block instead, and its zero area is a slice of this
+ * block. Copies and fragments of the buffer share the block, so that
+ * adding headers to them, or removing bytes from them, only ever copies
+ * the bytes of their start and end areas, never the payload bytes. The
+ * bytes of the zero area cannot be written, whatever their origin.
  */
 class Buffer 
 {
@@ -482,6 +491,11 @@ private:
      * to this pointer.
      */
     uint8_t *m_data;
+    /**
+     * a pointer to the bytes of the "virtual zero area" when they
+     * are payload bytes, or zero if they are zeroes.
+     */
+    uint8_t const *m_payload;
   };
 
   /**
@@ -641,8 +655,41 @@ private:
    * \param initialize initialize the buffer with zeroes.
    */
   Buffer (uint32_t dataSize, bool initialize);
+  /**
+   * \brief Constructor
+   *
+   * The buffer holds a copy of the payload bytes, which is then
+   * shared by the copies and fragments of the buffer: adding
+   * headers or trailers to them does not copy the payload again.
+   *
+   * \param payload the payload bytes
+   * \param size the number of payload bytes
+   */
+  Buffer (uint8_t const *payload, uint32_t size);
   ~Buffer ();
 private:
+  /**
+   * The read-only payload bytes shared by the zero areas of several
+   * buffers. Like Buffer::Data, this data structure is variable-sized
+   * through its last member.
+   */
+  struct Payload
+  {
+    /**
+     * The reference count of an instance of this data structure.
+     * Each Buffer::Data which references an instance holds a count.
+     */
+    uint32_t m_count;
+    /**
+     * the size of the m_data field below.
+     */
+    uint32_t m_size;
+    /**
+     * The payload bytes: at least one byte, m_size in total.
+     */
+    uint8_t m_data[1];
+  };
+
   /**
    * This data structure is variable-sized through its last member whose size
    * is determined at allocation time and stored in the m_size field.
@@ -678,6 +725,11 @@ private:
      * end of the area in which user bytes were written.
      */
     uint32_t m_dirtyEnd;
+    /**
+     * The bytes of the "virtual zero area" of the Buffer instances
+     * which reference this instance, or zero if they are zeroes.
+     */
+    struct Payload *m_payload;
     /**
      * The real data buffer holds _at least_ one byte.
      * Its real size is stored in the m_size field.
@@ -685,6 +737,32 @@ private:
     uint8_t m_data[1];
   };
 
+  /**
+   * \brief Initializes the buffer with a slice of payload bytes.
+   *
+   * \param payload the payload bytes, or zero for zeroes
+   * \param payloadStart the offset of the slice in the payload bytes
+   * \param size the size of the slice
+   */
+  void Initialize (struct Payload *payload, uint32_t payloadStart, uint32_t size);
+  /**
+   * \brief Get the bytes of the "virtual zero area".
+   * \returns the payload bytes, or zero if they are zeroes.
+   */
+  inline uint8_t const *GetPayloadData (void) const;
+  /**
+   * \brief Allocate the storage of payload bytes
+   * \param size the number of payload bytes
+   * \returns a pointer to the allocated storage
+   */
+  static struct Buffer::Payload *AllocatePayload (uint32_t size);
+  /**
+   * \brief Release a reference to payload bytes, and deallocate them
+   * when it was the last one.
+   * \param payload the payload bytes
+   */
+  static void UnrefPayload (struct Buffer::Payload *payload);
+
   /**
    * \brief Create a full copy of the buffer, including
    * all the internal structures.
@@ -767,7 +845,7 @@ private:
    * writing data. i.e., m_start should be initialized to this 
    * value.
    */
-  static uint32_t g_recommendedStart;
+  static NS_SIMULATION_LOCAL uint32_t g_recommendedStart;
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -789,6 +867,11 @@ private:
    * instance from the start of m_data->m_data
    */
   uint32_t m_end;
+  /**
+   * offset to the bytes of the zero area from the start of
+   * m_data->m_payload->m_data
+   */
+  uint32_t m_payloadStart;
 
 #ifdef BUFFER_FREE_LIST
   /// Container for buffer data
@@ -798,9 +881,9 @@ private:
   {
     ~LocalStaticDestructor ();
   };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
+  static NS_SIMULATION_LOCAL uint32_t g_maxSize; //!< Max observed data size
+  static NS_SIMULATION_LOCAL FreeList *g_freeList; //!< Buffer data container
+  static NS_SIMULATION_LOCAL struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
 #endif
 };
 
@@ -817,7 +900,8 @@ Buffer::Iterator::Iterator ()
     m_dataStart (0),
     m_dataEnd (0),
     m_current (0),
-    m_data (0)
+    m_data (0),
+    m_payload (0)
 {
 }
 Buffer::Iterator::Iterator (Buffer const*buffer)
@@ -839,6 +923,7 @@ Buffer::Iterator::Construct (const Buffer *buffer)
   m_dataStart = buffer->m_start;
   m_dataEnd = buffer->m_end;
   m_data = buffer->m_data->m_data;
+  m_payload = buffer->GetPayloadData ();
 }
 
 void 
@@ -945,7 +1030,7 @@ Buffer::Iterator::WriteHtonU32 (uint32_t data)
 uint16_t 
 Buffer::Iterator::ReadNtohU16 (void)
 {
-  uint8_t *buffer;
+  uint8_t const *buffer;
   if (m_current + 2 <= m_zeroStart)
     {
       buffer = &m_data[m_current];
@@ -954,6 +1039,10 @@ Buffer::Iterator::ReadNtohU16 (void)
     {
       buffer = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
     }
+  else if (m_payload != 0 && m_current >= m_zeroStart && m_current + 2 <= m_zeroEnd)
+    {
+      buffer = &m_payload[m_current - m_zeroStart];
+    }
   else
     {
       return SlowReadNtohU16 ();
@@ -969,7 +1058,7 @@ Buffer::Iterator::ReadNtohU16 (void)
 uint32_t 
 Buffer::Iterator::ReadNtohU32 (void)
 {
-  uint8_t *buffer;
+  uint8_t const *buffer;
   if (m_current + 4 <= m_zeroStart)
     {
       buffer = &m_data[m_current];
@@ -978,6 +1067,10 @@ Buffer::Iterator::ReadNtohU32 (void)
     {
       buffer = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
     }
+  else if (m_payload != 0 && m_current >= m_zeroStart && m_current + 4 <= m_zeroEnd)
+    {
+      buffer = &m_payload[m_current - m_zeroStart];
+    }
   else
     {
       return SlowReadNtohU32 ();
@@ -1008,7 +1101,7 @@ Buffer::Iterator::PeekU8 (void)
     }
   else if (m_current < m_zeroEnd)
     {
-      return 0;
+      return m_payload == 0 ? 0 : m_payload[m_current - m_zeroStart];
     }
   else
     {
@@ -1053,7 +1146,8 @@ Buffer::Buffer (Buffer const&o)
     m_zeroAreaStart (o.m_zeroAreaStart),
     m_zeroAreaEnd (o.m_zeroAreaEnd),
     m_start (o.m_start),
-    m_end (o.m_end)
+    m_end (o.m_end),
+    m_payloadStart (o.m_payloadStart)
 {
   m_data->m_count++;
   NS_ASSERT (CheckInternalState ());
@@ -1065,6 +1159,16 @@ Buffer::GetSize (void) const
   return m_end - m_start;
 }
 
+uint8_t const *
+Buffer::GetPayloadData (void) const
+{
+  if (m_data->m_payload == 0)
+    {
+      return 0;
+    }
+  return m_data->m_payload->m_data + m_payloadStart;
+}
+
 Buffer::Iterator 
 Buffer::Begin (void) const
 {
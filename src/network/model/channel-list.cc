@@ -19,6 +19,7 @@
 #include "ns3/simulator.h"
 #include "ns3/object-vector.h"
 #include "ns3/config.h"
+#include "ns3/simulation-local.h"
 #include "ns3/log.h"
 #include "ns3/assert.h"
 #include "channel-list.h"
@@ -128,7 +129,7 @@ Ptr<ChannelListPriv> *
 ChannelListPriv::DoGet (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  static Ptr<ChannelListPriv> ptr = 0;
+  static NS_SIMULATION_LOCAL Ptr<ChannelListPriv> ptr = 0;
   if (ptr == 0)
     {
       ptr = CreateObject<ChannelListPriv> ();
@@ -176,6 +177,7 @@ ChannelListPriv::Add (Ptr<Channel> channel)
   NS_LOG_FUNCTION (this << channel);
   uint32_t index = m_channels.size ();
   m_channels.push_back (channel);
+  Config::InvalidateMatchCache ();
   return index;
 
 }
@@ -22,6 +22,7 @@
 #include "ns3/simulator.h"
 #include "ns3/object-vector.h"
 #include "ns3/config.h"
+#include "ns3/simulation-local.h"
 #include "ns3/log.h"
 #include "ns3/assert.h"
 #include "node-list.h"
@@ -130,7 +131,7 @@ Ptr<NodeListPriv> *
 NodeListPriv::DoGet (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  static Ptr<NodeListPriv> ptr = 0;
+  static NS_SIMULATION_LOCAL Ptr<NodeListPriv> ptr = 0;
   if (ptr == 0)
     {
       ptr = CreateObject<NodeListPriv> ();
@@ -178,6 +179,7 @@ NodeListPriv::Add (Ptr<Node> node)
   NS_LOG_FUNCTION (this << node);
   uint32_t index = m_nodes.size ();
   m_nodes.push_back (node);
+  Config::InvalidateMatchCache ();
   Simulator::ScheduleWithContext (index, TimeStep (0), &Node::Initialize, node);
   return index;
 
@@ -29,6 +29,7 @@
 #include "ns3/log.h"
 #include "ns3/assert.h"
 #include "ns3/global-value.h"
+#include "ns3/config.h"
 #include "ns3/boolean.h"
 #include "ns3/simulator.h"
 
@@ -130,6 +131,7 @@ Node::AddDevice (Ptr<NetDevice> device)
   NS_LOG_FUNCTION (this << device);
   uint32_t index = m_devices.size ();
   m_devices.push_back (device);
+  Config::InvalidateMatchCache ();
   device->SetNode (this);
   device->SetIfIndex (index);
   device->SetReceiveCallback (MakeCallback (&Node::NonPromiscReceiveFromDevice, this));
@@ -159,6 +161,7 @@ Node::AddApplication (Ptr<Application> application)
   NS_LOG_FUNCTION (this << application);
   uint32_t index = m_applications.size ();
   m_applications.push_back (application);
+  Config::InvalidateMatchCache ();
   application->SetNode (this);
   Simulator::ScheduleWithContext (GetId (), Seconds (0.0), 
                                   &Application::Initialize, application);
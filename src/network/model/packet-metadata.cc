@@ -33,10 +33,11 @@ NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
-bool PacketMetadata::m_metadataSkipped = false;
-uint32_t PacketMetadata::m_maxSize = 0;
-uint16_t PacketMetadata::m_chunkUid = 0;
-PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+NS_SIMULATION_LOCAL bool PacketMetadata::m_metadataSkipped = false;
+NS_SIMULATION_LOCAL uint32_t PacketMetadata::m_maxSize = 0;
+NS_SIMULATION_LOCAL uint16_t PacketMetadata::m_chunkUid = 0;
+NS_SIMULATION_LOCAL PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+NS_SIMULATION_LOCAL bool PacketMetadata::m_freeListDestroyed = false;
 
 PacketMetadata::DataFreeList::~DataFreeList ()
 {
@@ -45,7 +46,9 @@ PacketMetadata::DataFreeList::~DataFreeList ()
     {
       PacketMetadata::Deallocate (*i);
     }
-  PacketMetadata::m_enable = false;
+  // m_enable is shared by all the simulation threads, so it cannot
+  // be used to stop recycling into this list.
+  PacketMetadata::m_freeListDestroyed = true;
 }
 
 void 
@@ -596,7 +599,7 @@ void
 PacketMetadata::Recycle (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
-  if (!m_enable)
+  if (!m_enable || m_freeListDestroyed)
     {
       PacketMetadata::Deallocate (data);
       return;
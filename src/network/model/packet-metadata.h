@@ -27,6 +27,7 @@
 #include "ns3/assert.h"
 #include "ns3/type-id.h"
 #include "buffer.h"
+#include "ns3/simulation-local.h"
 
 namespace ns3 {
 
@@ -661,7 +662,12 @@ public:
    */
   static void Deallocate (struct PacketMetadata::Data *data);
 
-  static DataFreeList m_freeList; //!< the metadata data storage
+  static NS_SIMULATION_LOCAL DataFreeList m_freeList; //!< the metadata data storage
+  /**
+   * Set when m_freeList has been destroyed, after which the data
+   * is deallocated instead of recycled.
+   */
+  static NS_SIMULATION_LOCAL bool m_freeListDestroyed;
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
 
@@ -670,10 +676,10 @@ public:
    * m_enable is false; used to detect enabling of metadata in the
    * middle of a simulation, which isn't allowed.
    */
-  static bool m_metadataSkipped;
+  static NS_SIMULATION_LOCAL bool m_metadataSkipped;
 
-  static uint32_t m_maxSize; //!< maximum metadata size
-  static uint16_t m_chunkUid; //!< Chunk Uid
+  static NS_SIMULATION_LOCAL uint32_t m_maxSize; //!< maximum metadata size
+  static NS_SIMULATION_LOCAL uint16_t m_chunkUid; //!< Chunk Uid
 
   struct Data *m_data; //!< Metadata storage
   /*
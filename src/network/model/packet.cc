@@ -28,7 +28,7 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
-uint32_t Packet::m_globalUid = 0;
+NS_SIMULATION_LOCAL uint32_t Packet::m_globalUid = 0;
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -195,7 +195,7 @@ Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
 }
 
 Packet::Packet (uint8_t const*buffer, uint32_t size)
-  : m_buffer (),
+  : m_buffer (buffer, size),
     m_byteTagList (),
     m_packetTagList (),
     /* The upper 32 bits of the packet id in 
@@ -208,9 +208,6 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
     m_nixVector (0)
 {
   m_globalUid++;
-  m_buffer.AddAtStart (size);
-  Buffer::Iterator i = m_buffer.Begin ();
-  i.Write (buffer, size);
 }
 
 Packet::Packet (const Buffer &buffer,  const ByteTagList &byteTagList, 
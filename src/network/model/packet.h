@@ -33,7 +33,9 @@
 #include "ns3/callback.h"
 #include "ns3/assert.h"
 #include "ns3/ptr.h"
+#include "ns3/object-pool.h"
 #include "ns3/deprecated.h"
+#include "ns3/simulation-local.h"
 
 namespace ns3 {
 
@@ -228,7 +230,7 @@ private:
  * The performance aspects copy-on-write semantics of the
  * Packet API are discussed in \ref packetperf
  */
-class Packet : public SimpleRefCount<Packet>
+class Packet : public SimpleRefCount<Packet>, public ObjectPool<Packet>
 {
 public:
 
@@ -278,7 +280,9 @@ public:
    * of this buffer.
    *
    * The input data is copied: the input
-   * buffer is untouched.
+   * buffer is untouched. The copy is then shared by the
+   * copies and fragments of the packet, as their payload:
+   * adding headers to them does not copy it again.
    *
    * \param buffer the data to store in the packet.
    * \param size the size of the input buffer.
@@ -756,7 +760,7 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
-  static uint32_t m_globalUid; //!< Global counter of packets Uid
+  static NS_SIMULATION_LOCAL uint32_t m_globalUid; //!< Global counter of packets Uid
 };
 
 /**
@@ -22,6 +22,7 @@
 #include "ns3/random-variable-stream.h"
 #include "ns3/double.h"
 #include "ns3/test.h"
+#include <vector>
 
 using namespace ns3;
 
@@ -378,6 +379,213 @@ BufferTest::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Buffer payload unit tests: random fragments, headers, trailers and
+ * concatenations of buffers created from payload bytes, checked
+ * against a plain copy of their bytes.
+ */
+class BufferPayloadTest : public TestCase {
+private:
+  /**
+   * Checks the buffer content, read in every possible way.
+   * \param b The buffer to check
+   * \param expected The bytes which should be in the buffer
+   */
+  void CheckBytes (Buffer b, const std::vector<uint8_t> &expected);
+public:
+  virtual void DoRun (void);
+  BufferPayloadTest ();
+};
+
+BufferPayloadTest::BufferPayloadTest ()
+  : TestCase ("Buffer payload slices")
+{
+}
+
+void
+BufferPayloadTest::CheckBytes (Buffer b, const std::vector<uint8_t> &expected)
+{
+  uint32_t n = expected.size ();
+  NS_TEST_ASSERT_MSG_EQ (b.GetSize (), n, "Bad buffer size");
+  std::vector<uint8_t> copied (n + 1);
+  NS_TEST_ASSERT_MSG_EQ (b.CopyData (&copied[0], n), n, "CopyData return bad size");
+  std::ostringstream os;
+  b.CopyData (&os, n);
+  std::string streamed = os.str ();
+  NS_TEST_ASSERT_MSG_EQ (streamed.size (), n, "CopyData to a stream bad size");
+  Buffer::Iterator i = b.Begin ();
+  uint32_t read;
+  for (uint32_t j = 0; j < n; j++)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t)copied[j], (uint32_t)expected[j], "Bad copied byte " << j);
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t)(uint8_t)streamed[j], (uint32_t)expected[j], "Bad streamed byte " << j);
+      read = i.ReadU8 ();
+      NS_TEST_ASSERT_MSG_EQ (read, (uint32_t)expected[j], "Bad read byte " << j);
+    }
+  for (uint32_t j = 0; j + 4 <= n; j++)
+    {
+      i = b.Begin ();
+      i.Next (j);
+      uint32_t u16 = (expected[j] << 8) | expected[j + 1];
+      read = i.ReadNtohU16 ();
+      NS_TEST_ASSERT_MSG_EQ (read, u16, "Bad ReadNtohU16 at " << j);
+      i.Prev (2);
+      uint32_t u32 = (u16 << 16) | (expected[j + 2] << 8) | expected[j + 3];
+      read = i.ReadNtohU32 ();
+      NS_TEST_ASSERT_MSG_EQ (read, u32, "Bad ReadNtohU32 at " << j);
+    }
+
+  Buffer other;
+  other.AddAtStart (n);
+  other.Begin ().Write (b.Begin (), b.End ());
+  uint8_t const *peeked = other.PeekData ();
+  for (uint32_t j = 0; j < n; j++)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t)peeked[j], (uint32_t)expected[j], "Bad iterator copy byte " << j);
+    }
+
+  std::vector<uint32_t> serialized (b.GetSerializedSize () / 4 + 1);
+  NS_TEST_ASSERT_MSG_EQ (b.Serialize (reinterpret_cast<uint8_t *> (&serialized[0]),
+                                      b.GetSerializedSize ()), 1, "Serialize failed");
+  Buffer deserialized (0, false);
+  // as in Packet::Deserialize, the size includes a 4 bytes length field
+  deserialized.Deserialize (reinterpret_cast<uint8_t *> (&serialized[0]), b.GetSerializedSize () + 4);
+  NS_TEST_ASSERT_MSG_EQ (deserialized.GetSize (), n, "Bad deserialized size");
+  NS_TEST_ASSERT_MSG_EQ (deserialized.CopyData (&copied[0], n), n, "CopyData return bad size");
+  for (uint32_t j = 0; j < n; j++)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t)copied[j], (uint32_t)expected[j], "Bad deserialized byte " << j);
+    }
+
+  peeked = b.PeekData ();
+  for (uint32_t j = 0; j < n; j++)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t)peeked[j], (uint32_t)expected[j], "Bad peeked byte " << j);
+    }
+}
+
+void
+BufferPayloadTest::DoRun (void)
+{
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+
+  // Buffers and the bytes they should hold: payload bytes, zeroes and
+  // real bytes, with headers and trailers.
+  std::vector<Buffer> buffers;
+  std::vector<std::vector<uint8_t> > bytes;
+  for (uint32_t k = 0; k < 3; k++)
+    {
+      std::vector<uint8_t> payload (100 + 50 * k);
+      for (uint32_t j = 0; j < payload.size (); j++)
+        {
+          payload[j] = random->GetInteger (0, 255);
+        }
+      buffers.push_back (Buffer (&payload[0], payload.size ()));
+      bytes.push_back (payload);
+    }
+  buffers.push_back (Buffer (40));
+  bytes.push_back (std::vector<uint8_t> (40, 0));
+  buffers.push_back (Buffer ());
+  buffers.back ().AddAtStart (30);
+  bytes.push_back (std::vector<uint8_t> (30));
+  for (uint32_t j = 0; j < 30; j++)
+    {
+      bytes.back ()[j] = j + 1;
+    }
+  buffers.back ().Begin ().Write (&bytes.back ()[0], 30);
+
+  for (uint32_t step = 0; step < 400; step++)
+    {
+      uint32_t a = random->GetInteger (0, buffers.size () - 1);
+      Buffer b = buffers[a];
+      std::vector<uint8_t> expected = bytes[a];
+      uint32_t size = expected.size ();
+      switch (random->GetInteger (0, 5))
+        {
+        case 0:
+          {
+            // fragment
+            uint32_t start = random->GetInteger (0, size);
+            uint32_t length = random->GetInteger (0, size - start);
+            b = b.CreateFragment (start, length);
+            expected = std::vector<uint8_t> (expected.begin () + start,
+                                             expected.begin () + start + length);
+          }
+          break;
+        case 1:
+        case 2:
+          {
+            // add a header or a trailer
+            uint32_t n = random->GetInteger (1, 20);
+            std::vector<uint8_t> header (n);
+            for (uint32_t j = 0; j < n; j++)
+              {
+                header[j] = random->GetInteger (0, 255);
+              }
+            Buffer::Iterator i;
+            if (random->GetInteger (0, 1) == 0)
+              {
+                b.AddAtStart (n);
+                i = b.Begin ();
+                expected.insert (expected.begin (), header.begin (), header.end ());
+              }
+            else
+              {
+                b.AddAtEnd (n);
+                i = b.End ();
+                i.Prev (n);
+                expected.insert (expected.end (), header.begin (), header.end ());
+              }
+            for (uint32_t j = 0; j < n; j++)
+              {
+                i.WriteU8 (header[j]);
+              }
+          }
+          break;
+        case 3:
+          {
+            // remove a header and a trailer
+            uint32_t start = random->GetInteger (0, size);
+            uint32_t end = random->GetInteger (0, size - start);
+            b.RemoveAtStart (start);
+            b.RemoveAtEnd (end);
+            expected = std::vector<uint8_t> (expected.begin () + start,
+                                             expected.end () - end);
+          }
+          break;
+        case 4:
+          {
+            // concatenate another buffer
+            uint32_t o = random->GetInteger (0, buffers.size () - 1);
+            b.AddAtEnd (buffers[o]);
+            expected.insert (expected.end (), bytes[o].begin (), bytes[o].end ());
+          }
+          break;
+        case 5:
+          {
+            // cut into adjacent fragments, and concatenate them back
+            uint32_t cut = random->GetInteger (0, size);
+            Buffer tail = b.CreateFragment (cut, size - cut);
+            b.RemoveAtEnd (size - cut);
+            b.AddAtEnd (tail);
+          }
+          break;
+        }
+      CheckBytes (b, expected);
+      // the buffers it was derived from are untouched
+      CheckBytes (buffers[a], bytes[a]);
+      if (expected.size () < 2000)
+        {
+          buffers.push_back (b);
+          bytes.push_back (expected);
+        }
+    }
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -394,6 +602,7 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferPayloadTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
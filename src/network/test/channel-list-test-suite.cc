@@ -0,0 +1,80 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/config.h"
+#include "ns3/simulator.h"
+#include "ns3/channel-list.h"
+#include "ns3/simple-channel.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that adding a Channel invalidates the cached Config matches.
+ */
+class ChannelListMatchCacheTestCase : public TestCase
+{
+public:
+  ChannelListMatchCacheTestCase ();
+  virtual void DoRun (void);
+};
+
+ChannelListMatchCacheTestCase::ChannelListMatchCacheTestCase ()
+  : TestCase ("Check that adding a Channel invalidates the Config match cache")
+{
+}
+
+void
+ChannelListMatchCacheTestCase::DoRun (void)
+{
+  std::string path = "/ChannelList/*";
+  Config::CompiledPath compiled (path);
+  CreateObject<SimpleChannel> ();
+  uint32_t n = ChannelList::GetNChannels ();
+  NS_TEST_ASSERT_MSG_EQ (compiled.LookupMatches ().GetN (), n, "Unexpected number of matches");
+
+  Config::EnableMatchCache ();
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches (path).GetN (), n, "Unexpected number of matches");
+  CreateObject<SimpleChannel> ();
+  NS_TEST_ASSERT_MSG_EQ (compiled.LookupMatches ().GetN (), n + 1, "New Channel not matched");
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches (path).GetN (), n + 1, "Cache not invalidated by a new Channel");
+  Config::DisableMatchCache ();
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * ChannelList TestSuite
+ */
+class ChannelListTestSuite : public TestSuite
+{
+public:
+  ChannelListTestSuite ();
+};
+
+ChannelListTestSuite::ChannelListTestSuite ()
+  : TestSuite ("channel-list", UNIT)
+{
+  AddTestCase (new ChannelListMatchCacheTestCase, TestCase::QUICK);
+}
+
+static ChannelListTestSuite channelListTestSuite; //!< Static variable for test initialization
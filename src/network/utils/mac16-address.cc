@@ -22,6 +22,7 @@
 #include "ns3/address.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/simulation-local.h"
 #include <iomanip>
 #include <iostream>
 #include <cstring>
@@ -140,7 +141,7 @@ Mac16Address
 Mac16Address::Allocate (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  static uint64_t id = 0;
+  static NS_SIMULATION_LOCAL uint64_t id = 0;
   id++;
   Mac16Address address;
   address.m_address[0] = (id >> 8) & 0xff;
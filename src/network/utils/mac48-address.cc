@@ -21,6 +21,7 @@
 #include "ns3/address.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/simulation-local.h"
 #include <iomanip>
 #include <iostream>
 #include <cstring>
@@ -135,7 +136,7 @@ Mac48Address
 Mac48Address::Allocate (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  static uint64_t id = 0;
+  static NS_SIMULATION_LOCAL uint64_t id = 0;
   id++;
   Mac48Address address;
   address.m_address[0] = (id >> 40) & 0xff;
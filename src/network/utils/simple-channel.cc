@@ -57,6 +57,8 @@ SimpleChannel::Send (Ptr<Packet> p, uint16_t protocol,
                      Ptr<SimpleNetDevice> sender)
 {
   NS_LOG_FUNCTION (this << p << protocol << to << from << sender);
+  std::vector<Simulator::BatchEvent> batch;
+  batch.reserve (m_devices.size ());
   for (std::vector<Ptr<SimpleNetDevice> >::const_iterator i = m_devices.begin (); i != m_devices.end (); ++i)
     {
       Ptr<SimpleNetDevice> tmp = *i;
@@ -72,9 +74,10 @@ SimpleChannel::Send (Ptr<Packet> p, uint16_t protocol,
               continue;
             }
         }
-      Simulator::ScheduleWithContext (tmp->GetNode ()->GetId (), m_delay,
-                                      &SimpleNetDevice::Receive, tmp, p->Copy (), protocol, to, from);
+      batch.push_back (Simulator::BatchEvent (tmp->GetNode ()->GetId (), m_delay,
+                                              MakeEvent (&SimpleNetDevice::Receive, tmp, p->Copy (), protocol, to, from)));
     }
+  Simulator::ScheduleBatch (batch);
 }
 
 void
@@ -23,6 +23,7 @@
 
 #include <ns3/ptr.h>
 #include <ns3/simple-ref-count.h>
+#include <ns3/object-pool.h>
 #include <ns3/spectrum-model.h>
 #include <ostream>
 #include <vector>
@@ -55,7 +56,7 @@ typedef std::vector<double> Values;
  * things, such as power spectral densities, frequency-dependent
  * propagation losses, spectral masks, etc.
  */
-class SpectrumValue : public SimpleRefCount<SpectrumValue>
+class SpectrumValue : public SimpleRefCount<SpectrumValue>, public ObjectPool<SpectrumValue>
 {
 public:
   /**
@@ -163,6 +163,8 @@ UanChannel::TxPacket (Ptr<UanTransducer> src, Ptr<Packet> packet,
         }
     }
   NS_ASSERT (senderMobility != 0);
+  std::vector<Simulator::BatchEvent> batch;
+  batch.reserve (m_devList.size ());
   uint32_t j = 0;
   UanDeviceList::const_iterator i = m_devList.begin ();
   for (; i != m_devList.end (); i++)
@@ -184,17 +186,18 @@ UanChannel::TxPacket (Ptr<UanTransducer> src, Ptr<Packet> packet,
 
           uint32_t dstNodeId = i->first->GetNode ()->GetId ();
           Ptr<Packet> copy = packet->Copy ();
-          Simulator::ScheduleWithContext (dstNodeId, delay,
-                                          &UanChannel::SendUp,
-                                          this,
-                                          j,
-                                          copy,
-                                          rxPowerDb,
-                                          txMode,
-                                          pdp);
+          batch.push_back (Simulator::BatchEvent (dstNodeId, delay,
+                                                  MakeEvent (&UanChannel::SendUp,
+                                                             this,
+                                                             j,
+                                                             copy,
+                                                             rxPowerDb,
+                                                             txMode,
+                                                             pdp)));
         }
       j++;
     }
+  Simulator::ScheduleBatch (batch);
 }
 
 void
@@ -23,6 +23,7 @@
 
 #include "ns3/nstime.h"
 #include "ns3/packet.h"
+#include "ns3/object-pool.h"
 #include "wifi-tx-vector.h"
 #include "error-rate-model.h"
 
@@ -38,7 +39,8 @@ public:
   /**
    * Signal event for a packet.
    */
-  class Event : public SimpleRefCount<InterferenceHelper::Event>
+  class Event : public SimpleRefCount<InterferenceHelper::Event>,
+                public ObjectPool<InterferenceHelper::Event>
   {
 public:
     /**
@@ -25,6 +25,7 @@
 #define WIFI_MAC_QUEUE_H
 
 #include "ns3/queue.h"
+#include "ns3/object-pool.h"
 #include "wifi-mac-header.h"
 
 namespace ns3 {
@@ -36,7 +37,8 @@ class QosBlockedDestinations;
  * WifiMacQueueItem stores (const) packets along with their Wifi MAC headers
  * and the time when they were enqueued.
  */
-class WifiMacQueueItem : public SimpleRefCount<WifiMacQueueItem>
+class WifiMacQueueItem : public SimpleRefCount<WifiMacQueueItem>,
+                         public ObjectPool<WifiMacQueueItem>
 {
 public:
   /**
@@ -80,6 +80,8 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
   NS_LOG_FUNCTION (this << sender << packet << txPowerDbm << duration.GetSeconds ());
   Ptr<MobilityModel> senderMobility = sender->GetMobility ();
   NS_ASSERT (senderMobility != 0);
+  std::vector<Simulator::BatchEvent> batch;
+  batch.reserve (m_phyList.size ());
   for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
     {
       if (sender != (*i))
@@ -107,11 +109,12 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
               dstNode = dstNetDevice->GetNode ()->GetId ();
             }
 
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive,
-                                          (*i), copy, rxPowerDbm, duration);
+          batch.push_back (Simulator::BatchEvent (dstNode, delay,
+                                                  MakeEvent (&YansWifiChannel::Receive,
+                                                             (*i), copy, rxPowerDbm, duration)));
         }
     }
+  Simulator::ScheduleBatch (batch);
 }
 
 void
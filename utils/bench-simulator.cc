@@ -18,6 +18,7 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
 #include <fstream>
@@ -32,14 +33,39 @@ using namespace ns3;
 bool g_debug = false;
 
 std::string g_me;
-#define LOG(x)   std::cout << x << std::endl
+/// The stream of the text output: std::cerr when the JSON goes to stdout
+std::ostream *g_log = &std::cout;
+#define LOG(x)   *g_log << x << std::endl
     #define LOGME(x) LOG (g_me << x)
     #define DEB(x) if (g_debug) { LOGME (x); }
 
 // Output field width
 int g_fwidth = 6;
 
-/// Bench class
+/// Result of one benchmark run, for the JSON output.
+struct Result
+{
+  std::string scheduler;  ///< scheduler type name
+  std::string workload;   ///< workload name
+  uint32_t run;           ///< run number
+  uint32_t population;    ///< initial event population
+  uint64_t events;        ///< number of events run
+  double init;            ///< initialization time, in seconds
+  double simu;            ///< simulation time, in seconds
+  uint64_t peak;          ///< peak number of live events
+};
+
+/// Results of all the runs
+std::vector<Result> g_results;
+
+/**
+ * Bench class: the hold model.
+ *
+ * Each event schedules a single new event, after an interval drawn
+ * from the random stream, so the population stays constant.
+ * The other workloads derive from this class and override Seed()
+ * and Cb().
+ */
 class Bench
 {
 public:
@@ -55,6 +81,11 @@ public:
   {
   }
 
+  /** destructor */
+  virtual ~Bench ()
+  {
+  }
+
   /**
    * Set random stream
    * \param stream the random variable stream
@@ -82,11 +113,24 @@ public:
     m_total = total;
   }
 
-  /// Run function
-  void RunBench (void);
-private:
+  /**
+   * Run function
+   * \param result the result of the run
+   */
+  void RunBench (Result &result);
+protected:
+  /// Schedule the initial population
+  virtual void Seed (void);
   /// callback function
-  void Cb (void);
+  virtual void Cb (void);
+  /**
+   * Draw an interval from the random stream
+   * \returns the interval
+   */
+  Time Interval (void)
+  {
+    return NanoSeconds (m_rand->GetValue ());
+  }
 
   Ptr<RandomVariableStream> m_rand; ///< random variable
   uint32_t m_population; ///< population
@@ -95,21 +139,17 @@ private:
 };
 
 void
-Bench::RunBench (void)
+Bench::RunBench (Result &result)
 {
   SystemWallClockMs time;
   double init, simu;
 
   DEB ("initializing");
   m_count = 0;
-
+  EventImpl::ResetPeakCount ();
 
   time.Start ();
-  for (uint32_t i = 0; i < m_population; ++i)
-    {
-      Time at = NanoSeconds (m_rand->GetValue ());
-      Simulator::Schedule (at, &Bench::Cb, this);
-    }
+  Seed ();
   init = time.End ();
   init /= 1000;
   DEB ("initialization took " << init << "s");
@@ -128,6 +168,20 @@ Bench::RunBench (void)
        std::setw (g_fwidth) << (m_count / simu) <<
        std::setw (g_fwidth) << (simu / m_count));
 
+  result.population = m_population;
+  result.events = m_count;
+  result.init = init;
+  result.simu = simu;
+  result.peak = EventImpl::GetPeakCount ();
+}
+
+void
+Bench::Seed (void)
+{
+  for (uint32_t i = 0; i < m_population; ++i)
+    {
+      Simulator::Schedule (Interval (), &Bench::Cb, this);
+    }
 }
 
 void
@@ -139,12 +193,195 @@ Bench::Cb (void)
     }
   DEB ("event at " << Simulator::Now ().GetSeconds () << "s");
 
-  Time after = NanoSeconds (m_rand->GetValue ());
-  Simulator::Schedule (after, &Bench::Cb, this);
+  Simulator::Schedule (Interval (), &Bench::Cb, this);
+  ++m_count;
+}
+
+
+/**
+ * Bursty fan-out: each burst schedules \c fanout events at the same
+ * timestamp, as a broadcast or a timer wheel tick would, then the
+ * next burst at that timestamp too.
+ */
+class FanoutBench : public Bench
+{
+public:
+  /**
+   * constructor
+   * \param population the population
+   * \param total the total
+   * \param fanout the number of events per burst
+   */
+  FanoutBench (const uint32_t population, const uint32_t total, const uint32_t fanout)
+    : Bench (population, total),
+      m_fanout (fanout)
+  {
+  }
+protected:
+  virtual void Seed (void);
+  virtual void Cb (void);
+  /// leaf event of a burst
+  void Leaf (void);
+
+  uint32_t m_fanout; ///< events per burst
+};
+
+void
+FanoutBench::Seed (void)
+{
+  for (uint32_t i = 0; i < std::max (m_population / m_fanout, 1U); ++i)
+    {
+      Simulator::Schedule (Interval (), &FanoutBench::Cb, this);
+    }
+}
+
+void
+FanoutBench::Cb (void)
+{
+  if (m_count >= m_total)
+    {
+      return;
+    }
+  DEB ("burst at " << Simulator::Now ().GetSeconds () << "s");
+
+  Time after = Interval ();
+  for (uint32_t i = 0; i < m_fanout; ++i)
+    {
+      Simulator::Schedule (after, &FanoutBench::Leaf, this);
+    }
+  Simulator::Schedule (after, &FanoutBench::Cb, this);
+  ++m_count;
+}
+
+void
+FanoutBench::Leaf (void)
+{
   ++m_count;
 }
 
 
+/**
+ * Cancel-heavy timers: each event restarts a retransmission-like
+ * timeout, far in the future, which is cancelled by the next event
+ * of the same timer before it expires.
+ */
+class CancelBench : public Bench
+{
+public:
+  /**
+   * constructor
+   * \param population the population
+   * \param total the total
+   */
+  CancelBench (const uint32_t population, const uint32_t total)
+    : Bench (population, total)
+  {
+  }
+protected:
+  virtual void Seed (void);
+  /**
+   * timer event
+   * \param timer the timer index
+   */
+  void Tick (uint32_t timer);
+  /// timeout event, rarely reached
+  void Timeout (void);
+
+  std::vector<EventId> m_timeouts; ///< pending timeout of each timer
+};
+
+void
+CancelBench::Seed (void)
+{
+  m_timeouts.assign (m_population, EventId ());
+  for (uint32_t i = 0; i < m_population; ++i)
+    {
+      Simulator::Schedule (Interval (), &CancelBench::Tick, this, i);
+    }
+}
+
+void
+CancelBench::Tick (uint32_t timer)
+{
+  if (m_count >= m_total)
+    {
+      m_timeouts[timer].Cancel ();
+      return;
+    }
+  DEB ("timer " << timer << " at " << Simulator::Now ().GetSeconds () << "s");
+
+  m_timeouts[timer].Cancel ();
+  m_timeouts[timer] = Simulator::Schedule (Interval () * 50, &CancelBench::Timeout, this);
+  Simulator::Schedule (Interval (), &CancelBench::Tick, this, timer);
+  ++m_count;
+}
+
+void
+CancelBench::Timeout (void)
+{
+  ++m_count;
+}
+
+
+/**
+ * ScheduleWithContext storm: each source event sends to \c fanout
+ * contexts with a short random delay, as a broadcast on a shared
+ * channel does, and each receiver may schedule the next source.
+ */
+class ContextBench : public FanoutBench
+{
+public:
+  /**
+   * constructor
+   * \param population the population
+   * \param total the total
+   * \param fanout the number of contexts per storm
+   */
+  ContextBench (const uint32_t population, const uint32_t total, const uint32_t fanout)
+    : FanoutBench (population, total, fanout),
+      m_context (0)
+  {
+  }
+protected:
+  virtual void Cb (void);
+  /**
+   * receiver event
+   * \param last \c true for the last receiver of the storm
+   */
+  void Receive (bool last);
+
+  uint32_t m_context; ///< next context to send to
+};
+
+void
+ContextBench::Cb (void)
+{
+  if (m_count >= m_total)
+    {
+      return;
+    }
+  DEB ("storm at " << Simulator::Now ().GetSeconds () << "s");
+
+  for (uint32_t i = 0; i < m_fanout; ++i)
+    {
+      Time delay = NanoSeconds (1 + m_context % 16);
+      Simulator::ScheduleWithContext (m_context, delay, &ContextBench::Receive, this, i + 1 == m_fanout);
+      m_context = (m_context + 1) % (m_population + 1);
+    }
+  ++m_count;
+}
+
+void
+ContextBench::Receive (bool last)
+{
+  ++m_count;
+  if (last)
+    {
+      Simulator::Schedule (Interval (), &ContextBench::Cb, this);
+    }
+}
+
+
 Ptr<RandomVariableStream>
 GetRandomStream (std::string filename)
 {
@@ -200,18 +437,82 @@ GetRandomStream (std::string filename)
 
 
 
+/**
+ * Create the benchmark of a workload
+ * \param workload the workload name
+ * \param pop the population
+ * \param total the total
+ * \param fanout the fan-out of the bursty workloads
+ * \returns the benchmark, or 0 if the workload is unknown
+ */
+Bench *
+CreateBench (std::string workload, uint32_t pop, uint32_t total, uint32_t fanout)
+{
+  if (workload == "hold")
+    {
+      return new Bench (pop, total);
+    }
+  if (workload == "fanout")
+    {
+      return new FanoutBench (pop, total, fanout);
+    }
+  if (workload == "cancel")
+    {
+      return new CancelBench (pop, total);
+    }
+  if (workload == "context")
+    {
+      return new ContextBench (pop, total, fanout);
+    }
+  return 0;
+}
+
+/**
+ * Write the results as JSON
+ * \param os the output stream
+ * \param total the total number of events per run
+ */
+void
+WriteJson (std::ostream &os, uint32_t total)
+{
+  os << "{" << std::endl
+     << "  \"benchmark\": \"bench-simulator\"," << std::endl
+     << "  \"total\": " << total << "," << std::endl
+     << "  \"results\": [";
+  for (std::vector<Result>::const_iterator i = g_results.begin (); i != g_results.end (); ++i)
+    {
+      os << (i == g_results.begin () ? "" : ",") << std::endl
+         << "    { \"scheduler\": \"" << i->scheduler << "\""
+         << ", \"workload\": \"" << i->workload << "\""
+         << ", \"run\": " << i->run
+         << ", \"population\": " << i->population
+         << ", \"events\": " << i->events
+         << ", \"init_s\": " << i->init
+         << ", \"run_s\": " << i->simu
+         << ", \"events_per_s\": " << (i->simu > 0 ? i->events / i->simu : 0)
+         << ", \"peak_live_events\": " << i->peak << " }";
+    }
+  os << std::endl << "  ]" << std::endl << "}" << std::endl;
+}
+
+
 int main (int argc, char *argv[])
 {
 
   bool schedCal  = false;
   bool schedHeap = false;
   bool schedList = false;
+  bool schedLadder = false;
   bool schedMap  = true;
+  bool schedAll  = false;
 
   uint32_t pop   =  100000;
   uint32_t total = 1000000;
   uint32_t runs  =       1;
+  uint32_t fanout =     64;
   std::string filename = "";
+  std::string workloadName = "hold";
+  std::string jsonName = "";
 
   CommandLine cmd;
   cmd.Usage ("Benchmark the simulator scheduler.\n"
@@ -221,86 +522,176 @@ int main (int argc, char *argv[])
              "  an ascii file, given by the --file=\"<filename>\" argument,\n"
              "  or standard input, by the argument --file=\"-\"\n"
              "In the case of either --file form, the input is expected\n"
-             "to be ascii, giving the relative event times in ns.");
+             "to be ascii, giving the relative event times in ns.\n"
+             "\n"
+             "Workloads, selected by --workload:\n"
+             "  hold:    each event schedules one new event (default),\n"
+             "  fanout:  bursts of --fanout events at the same timestamp,\n"
+             "  cancel:  timers whose timeouts are almost always cancelled,\n"
+             "  context: storms of ScheduleWithContext to --fanout contexts,\n"
+             "  all:     each of the above in turn.");
   cmd.AddValue ("cal",   "use CalendarSheduler",          schedCal);
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
+  cmd.AddValue ("ladder", "use LadderScheduler",          schedLadder);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
+  cmd.AddValue ("all",   "use every Scheduler in turn",   schedAll);
   cmd.AddValue ("debug", "enable debugging output",       g_debug);
   cmd.AddValue ("pop",   "event population size (default 1E5)",         pop);
   cmd.AddValue ("total", "total number of events to run (default 1E6)", total);
   cmd.AddValue ("runs",  "number of runs (default 1)",    runs);
   cmd.AddValue ("file",  "file of relative event times",  filename);
   cmd.AddValue ("prec",  "printed output precision",      g_fwidth);
+  cmd.AddValue ("workload", "hold, fanout, cancel, context or all", workloadName);
+  cmd.AddValue ("fanout", "events per burst (default 64)", fanout);
+  cmd.AddValue ("json",  "write the results as JSON to this file (\"-\" for stdout, "
+                "which sends the text output to stderr)", jsonName);
   cmd.Parse (argc, argv);
   g_me = cmd.GetName () + ": ";
+  if (jsonName == "-")
+    {
+      // keep stdout for the JSON alone
+      g_log = &std::cerr;
+    }
   g_fwidth += 6;  // 5 extra chars in '2.000002e+07 ': . e+0 _
 
-  ObjectFactory factory ("ns3::MapScheduler");
-  if (schedCal)
+  std::vector<std::string> schedulers;
+  if (schedAll)
+    {
+      TypeId scheduler = TypeId::LookupByName ("ns3::Scheduler");
+      for (uint32_t i = 0; i < TypeId::GetRegisteredN (); i++)
+        {
+          TypeId tid = TypeId::GetRegistered (i);
+          if (tid != scheduler && tid.IsChildOf (scheduler) && tid.HasConstructor ())
+            {
+              schedulers.push_back (tid.GetName ());
+            }
+        }
+    }
+  else if (schedCal)
+    {
+      schedulers.push_back ("ns3::CalendarScheduler");
+    }
+  else if (schedHeap)
     {
-      factory.SetTypeId ("ns3::CalendarScheduler");
+      schedulers.push_back ("ns3::HeapScheduler");
     }
-  if (schedHeap)
+  else if (schedList)
     {
-      factory.SetTypeId ("ns3::HeapScheduler");
+      schedulers.push_back ("ns3::ListScheduler");
     }
-  if (schedList)
+  else if (schedLadder)
     {
-      factory.SetTypeId ("ns3::ListScheduler");
+      schedulers.push_back ("ns3::LadderScheduler");
+    }
+  else
+    {
+      schedulers.push_back ("ns3::MapScheduler");
+    }
+
+  std::vector<std::string> workloads;
+  if (workloadName == "all")
+    {
+      workloads.push_back ("hold");
+      workloads.push_back ("fanout");
+      workloads.push_back ("cancel");
+      workloads.push_back ("context");
+    }
+  else
+    {
+      workloads.push_back (workloadName);
+    }
+  if (fanout == 0)
+    {
+      NS_FATAL_ERROR ("The fan-out must be at least 1");
     }
-  Simulator::SetScheduler (factory);
 
   LOGME (std::setprecision (g_fwidth - 6));
   DEB ("debugging is ON");
 
-  LOGME ("scheduler: " << factory.GetTypeId ().GetName ());
   LOGME ("population: " << pop);
   LOGME ("total events: " << total);
   LOGME ("runs: " << runs);
 
-  Bench *bench = new Bench (pop, total);
-  bench->SetRandomStream (GetRandomStream (filename));
+  Ptr<RandomVariableStream> stream = GetRandomStream (filename);
 
-  // table header
-  LOG ("");
-  LOG (std::left << std::setw (g_fwidth) << "Run #" <<
-       std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
-       std::left << std::setw (3 * g_fwidth) << "Simulation:");
-  LOG (std::left << std::setw (g_fwidth) << "" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" );
-  LOG (std::setfill ('-') <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::setfill (' ')
-       );
-
-  // prime
-  DEB ("priming");
-  std::cout << std::left << std::setw (g_fwidth) << "(prime)";
-  bench->RunBench ();
-
-  bench->SetPopulation (pop);
-  bench->SetTotal (total);
-  for (uint32_t i = 0; i < runs; i++)
+  for (std::vector<std::string>::const_iterator s = schedulers.begin (); s != schedulers.end (); ++s)
     {
-      std::cout << std::setw (g_fwidth) << i;
+      for (std::vector<std::string>::const_iterator w = workloads.begin (); w != workloads.end (); ++w)
+        {
+          Bench *bench = CreateBench (*w, pop, total, fanout);
+          if (bench == 0)
+            {
+              NS_FATAL_ERROR ("Unknown workload " << *w);
+            }
+          bench->SetRandomStream (stream);
+
+          // a fresh simulator for each scheduler and workload
+          ObjectFactory factory (*s);
+          Simulator::SetScheduler (factory);
+
+          LOG ("");
+          LOGME ("scheduler: " << *s);
+          LOGME ("workload: " << *w);
+
+          // table header
+          LOG ("");
+          LOG (std::left << std::setw (g_fwidth) << "Run #" <<
+               std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
+               std::left << std::setw (3 * g_fwidth) << "Simulation:");
+          LOG (std::left << std::setw (g_fwidth) << "" <<
+               std::left << std::setw (g_fwidth) << "Time (s)" <<
+               std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+               std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
+               std::left << std::setw (g_fwidth) << "Time (s)" <<
+               std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+               std::left << std::setw (g_fwidth) << "Per (s/ev)" );
+          LOG (std::setfill ('-') <<
+               std::right << std::setw (g_fwidth) << " " <<
+               std::right << std::setw (g_fwidth) << " " <<
+               std::right << std::setw (g_fwidth) << " " <<
+               std::right << std::setw (g_fwidth) << " " <<
+               std::right << std::setw (g_fwidth) << " " <<
+               std::right << std::setw (g_fwidth) << " " <<
+               std::right << std::setw (g_fwidth) << " " <<
+               std::setfill (' ')
+               );
+
+          Result result;
+          result.scheduler = *s;
+          result.workload = *w;
+
+          // prime
+          DEB ("priming");
+          *g_log << std::left << std::setw (g_fwidth) << "(prime)";
+          bench->RunBench (result);
+
+          bench->SetPopulation (pop);
+          bench->SetTotal (total);
+          for (uint32_t i = 0; i < runs; i++)
+            {
+              *g_log << std::setw (g_fwidth) << i;
+
+              bench->RunBench (result);
+              result.run = i;
+              g_results.push_back (result);
+            }
 
-      bench->RunBench ();
+          Simulator::Destroy ();
+          delete bench;
+        }
     }
 
   LOG ("");
-  Simulator::Destroy ();
-  delete bench;
+  if (jsonName == "-")
+    {
+      WriteJson (std::cout, total);
+    }
+  else if (jsonName != "")
+    {
+      std::ofstream json (jsonName.c_str ());
+      WriteJson (json, total);
+      LOGME ("results written to " << jsonName);
+    }
   return 0;
 }
@@ -0,0 +1,173 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "ns3/core-module.h"
+
+/**
+ * \file
+ * \ingroup time
+ * Measure the conversions of ns3::Time from and to doubles, with the
+ * integer fast paths of Time::ToDouble() and Time::FromDouble(), and
+ * with the int64x64_t conversions Time::To() and Time::From() which
+ * they replace.
+ *
+ * \code
+ *   $ ./waf --run "bench-time --n=10000000"
+ * \endcode
+ */
+
+using namespace ns3;
+
+namespace {
+
+/** The sum of the results, printed so no conversion is optimized away. */
+double g_sink = 0;
+
+/**
+ * Print the time per operation of a benchmark.
+ * \param [in] name The operation.
+ * \param [in] fast The time taken by the fast path, in seconds.
+ * \param [in] reference The time taken by the int64x64_t path, in seconds.
+ * \param [in] n The number of operations.
+ */
+void
+Print (std::string name, double fast, double reference, uint32_t n)
+{
+  std::cout << std::left << std::setw (28) << name << std::right << std::fixed
+            << std::setprecision (2)
+            << std::setw (10) << fast * 1e9 / n << " ns"
+            << std::setw (10) << reference * 1e9 / n << " ns"
+            << std::setw (9) << reference / fast << "x" << std::endl;
+}
+
+/**
+ * Get the time elapsed since a start.
+ * \param [in] start The start.
+ * \returns The time elapsed, in seconds.
+ */
+double
+Since (std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+}
+
+/**
+ * Time a conversion to a double, both ways.
+ * \param [in] name The operation.
+ * \param [in] times The times to convert.
+ * \param [in] unit The unit to convert to.
+ */
+void
+BenchTo (std::string name, const std::vector<Time> &times, Time::Unit unit)
+{
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  for (std::vector<Time>::const_iterator i = times.begin (); i != times.end (); ++i)
+    {
+      g_sink += i->ToDouble (unit);
+    }
+  double fast = Since (start);
+  start = std::chrono::steady_clock::now ();
+  for (std::vector<Time>::const_iterator i = times.begin (); i != times.end (); ++i)
+    {
+      g_sink += i->To (unit).GetDouble ();
+    }
+  Print (name, fast, Since (start), times.size ());
+}
+
+/**
+ * Time a conversion from a double, both ways.
+ * \param [in] name The operation.
+ * \param [in] values The values to convert.
+ * \param [in] unit The unit of the values.
+ */
+void
+BenchFrom (std::string name, const std::vector<double> &values, Time::Unit unit)
+{
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  for (std::vector<double>::const_iterator i = values.begin (); i != values.end (); ++i)
+    {
+      g_sink += Time::FromDouble (*i, unit).GetTimeStep ();
+    }
+  double fast = Since (start);
+  start = std::chrono::steady_clock::now ();
+  for (std::vector<double>::const_iterator i = values.begin (); i != values.end (); ++i)
+    {
+      g_sink += Time::From (int64x64_t (*i), unit).GetTimeStep ();
+    }
+  Print (name, fast, Since (start), values.size ());
+}
+
+/**
+ * Run the benchmarks.
+ * \param [in] n The number of conversions of each kind.
+ */
+void
+Bench (uint32_t n)
+{
+  // Times up to an hour, and the transmission times of packets of
+  // 64 to 1500 bytes at 1 Mb/s to 10 Gb/s, as in DataRate.
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  std::vector<Time> times (n);
+  std::vector<double> seconds (n);
+  std::vector<double> txTimes (n);
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      times[i] = NanoSeconds (static_cast<int64_t> (random->GetValue (0, 3600e9)));
+      seconds[i] = random->GetValue (0, 3600);
+      double bytes = random->GetInteger (64, 1500);
+      double bps = std::pow (10, random->GetValue (6, 10));
+      txTimes[i] = bytes * 8 / bps;
+    }
+
+  std::cout << "Resolution " << Time::GetResolution () << ", "
+            << n << " conversions of each kind" << std::endl;
+  std::cout << std::left << std::setw (28) << "operation" << std::right
+            << std::setw (13) << "fast" << std::setw (13) << "int64x64"
+            << std::setw (10) << "speedup" << std::endl;
+  BenchTo ("GetSeconds", times, Time::S);
+  BenchTo ("GetMicroSeconds (double)", times, Time::US);
+  BenchTo ("GetPicoSeconds (double)", times, Time::PS);
+  BenchFrom ("Seconds (double)", seconds, Time::S);
+  BenchFrom ("Seconds (tx time)", txTimes, Time::S);
+  BenchFrom ("MilliSeconds (double)", seconds, Time::MS);
+  std::cout << "(checksum " << g_sink << ")" << std::endl;
+}
+
+} // unnamed namespace
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t n = 1000000;
+
+  CommandLine cmd;
+  cmd.Usage ("Compare the fast paths of the Time conversions with the "
+             "int64x64_t conversions.");
+  cmd.AddValue ("n", "The number of conversions of each kind", n);
+  cmd.Parse (argc, argv);
+
+  // Until the simulation runs, each Time is recorded in case the
+  // resolution changes, which would dwarf the conversions.
+  Simulator::Schedule (Seconds (0), &Bench, n);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,63 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <iostream>
+
+#include "ns3/core-module.h"
+
+/**
+ * \file
+ * \ingroup logging
+ * Print a binary log file, written after ns3::LogSetBinaryOutput(),
+ * as the text which logging to std::clog would have shown.
+ *
+ * \code
+ *   $ ./waf --run "decode-log --file=run.log"
+ * \endcode
+ */
+
+using namespace ns3;
+
+int
+main (int argc, char *argv[])
+{
+  std::string filename;
+
+  CommandLine cmd;
+  cmd.Usage ("Print a binary log file as text.");
+  cmd.AddValue ("file", "The binary log file to print", filename);
+  cmd.Parse (argc, argv);
+
+  if (filename.empty ())
+    {
+      std::cerr << "decode-log: no --file given" << std::endl;
+      return 1;
+    }
+  std::ifstream is (filename.c_str (), std::ios::in | std::ios::binary);
+  if (!is.good ())
+    {
+      std::cerr << "decode-log: cannot open " << filename << std::endl;
+      return 1;
+    }
+  if (!LogDecodeBinary (is, std::cout))
+    {
+      std::cerr << "decode-log: " << filename
+                << " is not a binary log file, or is truncated" << std::endl;
+      return 1;
+    }
+  return 0;
+}
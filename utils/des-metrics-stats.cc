@@ -0,0 +1,307 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#include "ns3/core-module.h"
+
+/**
+ * \file
+ * \ingroup simulator
+ * Compute, from a binary DES Metrics trace, the statistics which help
+ * choose the partitions of a distributed simulation: the lookahead
+ * (the smallest delay of an event sent to another context), the load
+ * of each partition, and the events which cross partitions.
+ *
+ * The contexts (nodes) are assigned to \c --partitions partitions in
+ * contiguous blocks, or round robin with \c --scheme=roundrobin, or as
+ * given by a \c --map file of <tt>context partition</tt> lines.
+ *
+ * \code
+ *   $ ./waf --run "des-metrics-stats --file=my-program.desm --partitions=4"
+ * \endcode
+ */
+
+using namespace ns3;
+
+namespace {
+
+/** The events between two contexts. */
+struct Traffic
+{
+  uint64_t count;       //!< The number of events.
+  int64_t minDelay;     //!< The smallest delay, in time steps.
+};
+
+/** A map of the traffic, by source context (high word) and destination. */
+typedef std::map<uint64_t, Traffic> TrafficMap;
+/** An entry of a TrafficMap. */
+typedef std::pair<uint64_t, Traffic> TrafficEntry;
+
+/**
+ * Add an event to a traffic map.
+ * \param [in,out] traffic The map.
+ * \param [in] key The source and destination.
+ * \param [in] delay The delay of the event.
+ */
+void
+AddTraffic (TrafficMap &traffic, uint64_t key, int64_t delay)
+{
+  std::pair<TrafficMap::iterator, bool> i = traffic.insert (std::make_pair (key, Traffic ()));
+  if (i.second)
+    {
+      i.first->second.count = 0;
+      i.first->second.minDelay = std::numeric_limits<int64_t>::max ();
+    }
+  i.first->second.count++;
+  i.first->second.minDelay = std::min (i.first->second.minDelay, delay);
+}
+
+/**
+ * Compare traffic map entries by decreasing count.
+ * \param [in] a The first entry.
+ * \param [in] b The second entry.
+ * \returns \c true if \p a has more events than \p b.
+ */
+bool
+MoreTraffic (const TrafficEntry &a, const TrafficEntry &b)
+{
+  return a.second.count > b.second.count;
+}
+
+} // unnamed namespace
+
+int
+main (int argc, char *argv[])
+{
+  std::string filename;
+  uint32_t partitions = 1;
+  std::string scheme = "block";
+  std::string mapFile;
+  uint32_t top = 10;
+
+  CommandLine cmd;
+  cmd.Usage ("Compute the lookahead and the traffic between partitions "
+             "of a binary DES Metrics trace.");
+  cmd.AddValue ("file", "The binary DES Metrics trace (.desm)", filename);
+  cmd.AddValue ("partitions", "The number of partitions", partitions);
+  cmd.AddValue ("scheme", "How contexts are assigned to partitions: block or roundrobin", scheme);
+  cmd.AddValue ("map", "A file of 'context partition' lines, instead of the scheme", mapFile);
+  cmd.AddValue ("top", "The number of busiest context pairs to list", top);
+  cmd.Parse (argc, argv);
+
+  if (filename.empty ())
+    {
+      std::cerr << "des-metrics-stats: no --file given" << std::endl;
+      return 1;
+    }
+  if (partitions == 0 || (scheme != "block" && scheme != "roundrobin"))
+    {
+      std::cerr << "des-metrics-stats: wrong --partitions or --scheme" << std::endl;
+      return 1;
+    }
+  std::ifstream is (filename.c_str (), std::ios::in | std::ios::binary);
+  DesMetrics::BinaryHeader header;
+  if (!is.good () || !DesMetrics::ReadBinaryHeader (is, header))
+    {
+      std::cerr << "des-metrics-stats: " << filename
+                << " is not a binary DES Metrics trace" << std::endl;
+      return 1;
+    }
+
+  // One pass over the trace collects the traffic between each pair of
+  // contexts; the partitions are then computed from the pairs.
+  TrafficMap traffic;
+  uint64_t events = 0;
+  uint64_t noSender = 0;
+  uint32_t maxContext = 0;
+  int64_t endTime = 0;
+  std::vector<uint64_t> received;
+  DesMetrics::Record record;
+  while (DesMetrics::ReadRecord (is, record))
+    {
+      events++;
+      endTime = std::max (endTime, record.recvTime);
+      if (record.recvContext != Simulator::NO_CONTEXT)
+        {
+          maxContext = std::max (maxContext, record.recvContext);
+          if (record.recvContext >= received.size ())
+            {
+              received.resize (record.recvContext + 1, 0);
+            }
+          received[record.recvContext]++;
+        }
+      if (record.sendContext == Simulator::NO_CONTEXT)
+        {
+          // scheduled by the main program, before the simulation runs
+          noSender++;
+          continue;
+        }
+      maxContext = std::max (maxContext, record.sendContext);
+      uint64_t key = (static_cast<uint64_t> (record.sendContext) << 32) | record.recvContext;
+      AddTraffic (traffic, key, record.recvTime - record.sendTime);
+    }
+
+  std::vector<uint32_t> partitionOf (maxContext + 1);
+  uint64_t block = (static_cast<uint64_t> (maxContext) + partitions) / partitions;
+  for (uint32_t i = 0; i <= maxContext; ++i)
+    {
+      if (scheme == "block")
+        {
+          partitionOf[i] = i / block;
+        }
+      else
+        {
+          partitionOf[i] = i % partitions;
+        }
+    }
+  if (!mapFile.empty ())
+    {
+      std::ifstream map (mapFile.c_str ());
+      uint32_t context, partition;
+      while (map >> context >> partition)
+        {
+          if (context <= maxContext)
+            {
+              partitionOf[context] = partition;
+              partitions = std::max (partitions, partition + 1);
+            }
+        }
+    }
+
+  double step = header.resolution * 1e-15;
+  uint64_t self = 0;
+  uint64_t cross = 0;
+  int64_t lookahead = std::numeric_limits<int64_t>::max ();
+  std::vector<uint64_t> load (partitions, 0);
+  for (uint32_t i = 0; i < received.size (); ++i)
+    {
+      load[partitionOf[i]] += received[i];
+    }
+  TrafficMap partitionTraffic;
+  uint64_t crossPartition = 0;
+  int64_t partitionLookahead = std::numeric_limits<int64_t>::max ();
+  for (TrafficMap::const_iterator i = traffic.begin (); i != traffic.end (); ++i)
+    {
+      uint32_t src = i->first >> 32;
+      uint32_t dst = i->first & 0xffffffff;
+      if (src == dst)
+        {
+          self += i->second.count;
+        }
+      else
+        {
+          cross += i->second.count;
+          lookahead = std::min (lookahead, i->second.minDelay);
+        }
+      if (dst == Simulator::NO_CONTEXT)
+        {
+          continue;
+        }
+      uint32_t from = partitionOf[src];
+      uint32_t to = partitionOf[dst];
+      if (from != to)
+        {
+          crossPartition += i->second.count;
+          partitionLookahead = std::min (partitionLookahead, i->second.minDelay);
+          uint64_t key = (static_cast<uint64_t> (from) << 32) | to;
+          Traffic &t = partitionTraffic[key];
+          if (t.count == 0)
+            {
+              t.minDelay = i->second.minDelay;
+            }
+          t.count += i->second.count;
+          t.minDelay = std::min (t.minDelay, i->second.minDelay);
+        }
+    }
+
+  std::cout << std::fixed;
+  std::cout << "Trace of " << header.modelName << ": " << events << " events over "
+            << std::setprecision (6) << endTime * step << " s, "
+            << maxContext + 1 << " contexts" << std::endl;
+  std::cout << "  from the main program: " << noSender << std::endl;
+  std::cout << "  to the same context:   " << self << std::endl;
+  std::cout << "  to another context:    " << cross << std::endl;
+  if (cross > 0)
+    {
+      std::cout << "Lookahead between contexts: " << std::setprecision (9)
+                << lookahead * step << " s" << std::endl;
+    }
+
+  uint64_t total = 0;
+  uint64_t maxLoad = 0;
+  for (uint32_t i = 0; i < partitions; ++i)
+    {
+      total += load[i];
+      maxLoad = std::max (maxLoad, load[i]);
+    }
+  std::cout << std::endl << partitions << " partitions ("
+            << (mapFile.empty () ? scheme : mapFile) << ")" << std::endl;
+  for (uint32_t i = 0; i < partitions; ++i)
+    {
+      std::cout << "  partition " << i << ": " << load[i] << " events" << std::endl;
+    }
+  if (total > 0)
+    {
+      std::cout << "  load imbalance (max/mean): " << std::setprecision (3)
+                << static_cast<double> (maxLoad) * partitions / total << std::endl;
+    }
+  std::cout << "  cross-partition events: " << crossPartition;
+  if (total > 0)
+    {
+      std::cout << " (" << std::setprecision (2) << 100.0 * crossPartition / total << "%)";
+    }
+  std::cout << std::endl;
+  if (crossPartition > 0)
+    {
+      std::cout << "  lookahead between partitions: " << std::setprecision (9)
+                << partitionLookahead * step << " s" << std::endl;
+      for (TrafficMap::const_iterator i = partitionTraffic.begin (); i != partitionTraffic.end (); ++i)
+        {
+          std::cout << "    " << (i->first >> 32) << " -> " << (i->first & 0xffffffff)
+                    << ": " << i->second.count << " events, lookahead "
+                    << i->second.minDelay * step << " s" << std::endl;
+        }
+    }
+
+  std::vector<TrafficEntry> busiest;
+  for (TrafficMap::const_iterator i = traffic.begin (); i != traffic.end (); ++i)
+    {
+      if ((i->first >> 32) != (i->first & 0xffffffff))
+        {
+          busiest.push_back (*i);
+        }
+    }
+  std::sort (busiest.begin (), busiest.end (), &MoreTraffic);
+  if (!busiest.empty () && top > 0)
+    {
+      std::cout << std::endl << "Busiest context pairs:" << std::endl;
+    }
+  for (uint32_t i = 0; i < busiest.size () && i < top; ++i)
+    {
+      std::cout << "  " << (busiest[i].first >> 32) << " -> " << (busiest[i].first & 0xffffffff)
+                << ": " << busiest[i].second.count << " events, lookahead "
+                << std::setprecision (9) << busiest[i].second.minDelay * step << " s" << std::endl;
+    }
+  return 0;
+}